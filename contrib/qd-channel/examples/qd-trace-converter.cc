@@ -0,0 +1,54 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2020 SIGNET Lab, Department of Information Engineering,
+ * University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * This program converts the text QD files of a scenario to the binary
+ * format read by the QdChannelModel.
+ * For each Output/Ns3/QdFiles/TxNRxM.txt file of the scenario, a
+ * TxNRxM.qdbin file is written in the same folder. When the binary files
+ * are present, the QdChannelModel memory-maps them instead of parsing the
+ * text files, considerably reducing the startup time and the memory
+ * footprint of large scenarios.
+ *
+ * Usage:
+ * ./waf --run "qd-trace-converter --qdFilesPath=contrib/qd-channel/model/QD/ --scenario=Indoor1"
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/qd-channel-model.h"
+
+NS_LOG_COMPONENT_DEFINE ("QdTraceConverter");
+
+using namespace ns3;
+
+int
+main (int argc, char *argv[])
+{
+  std::string qdFilesPath = "contrib/qd-channel/model/QD/"; // The path of the folder with the QD scenarios
+  std::string scenario = "Indoor1"; // The name of the scenario
+
+  CommandLine cmd;
+  cmd.AddValue ("qdFilesPath", "The path of the folder with the QD scenarios", qdFilesPath);
+  cmd.AddValue ("scenario", "The name of the scenario", scenario);
+  cmd.Parse (argc, argv);
+
+  QdChannelModel::ConvertQdFiles (qdFilesPath, scenario);
+
+  return 0;
+}
@@ -0,0 +1,215 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2020 SIGNET Lab, Department of Information Engineering,
+ * University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/qd-binary-trace.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("QdBinaryTrace");
+
+namespace {
+
+const char QD_BINARY_MAGIC[8] = {'N', 'S', '3', 'Q', 'D', 'B', 'I', 'N'}; //!< magic string of the binary QD traces
+
+/**
+ * Header of a binary QD trace
+ */
+struct Header
+{
+  char magic[8]; //!< the magic string
+  uint32_t version; //!< the format version
+  uint32_t reserved; //!< reserved, set to 0
+  uint64_t numTimesteps; //!< the number of timesteps
+};
+
+} // unnamed namespace
+
+const uint32_t QdBinaryTrace::VERSION;
+
+QdBinaryTrace::QdBinaryTrace (const std::string &fileName)
+  : m_fileName (fileName),
+    m_data (nullptr),
+    m_size (0),
+    m_numTimesteps (0),
+    m_index (nullptr)
+{
+  NS_LOG_FUNCTION (this << fileName);
+
+  int fd = open (fileName.c_str (), O_RDONLY);
+  NS_ABORT_MSG_IF (fd < 0, fileName + " not found");
+
+  struct stat st;
+  NS_ABORT_MSG_IF (fstat (fd, &st) != 0, "Unable to stat " << fileName);
+  m_size = st.st_size;
+  NS_ABORT_MSG_IF (m_size < sizeof (Header), fileName << " is not a binary QD trace (too short)");
+
+#ifdef HAVE_SYS_MMAN_H
+  void *data = mmap (nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close (fd);
+  NS_ABORT_MSG_IF (data == MAP_FAILED, "Unable to map " << fileName << ": " << std::strerror (errno));
+  m_data = static_cast<const uint8_t *> (data);
+#else
+  // the buffer of uint64_t keeps the columns aligned as in the mapping
+  m_buffer.resize ((m_size + sizeof (uint64_t) - 1) / sizeof (uint64_t));
+  char *buffer = reinterpret_cast<char *> (m_buffer.data ());
+  size_t numRead = 0;
+  while (numRead < m_size)
+    {
+      ssize_t n = read (fd, buffer + numRead, m_size - numRead);
+      NS_ABORT_MSG_IF (n <= 0, "Unable to read " << fileName << ": " << std::strerror (errno));
+      numRead += n;
+    }
+  close (fd);
+  m_data = reinterpret_cast<const uint8_t *> (buffer);
+#endif
+
+  Header header;
+  std::memcpy (&header, m_data, sizeof (Header));
+  NS_ABORT_MSG_IF (std::memcmp (header.magic, QD_BINARY_MAGIC, sizeof (QD_BINARY_MAGIC)) != 0,
+                   fileName << " is not a binary QD trace");
+  NS_ABORT_MSG_IF (header.version != VERSION,
+                   fileName << " has version " << header.version << ", expected " << VERSION);
+
+  m_numTimesteps = header.numTimesteps;
+  NS_ABORT_MSG_IF (m_numTimesteps > (m_size - sizeof (Header)) / sizeof (IndexEntry),
+                   fileName << " is truncated (index)");
+  m_index = reinterpret_cast<const IndexEntry *> (m_data + sizeof (Header));
+
+  // validate the index once, so that the accessors do not need to
+  for (uint64_t t = 0; t < m_numTimesteps; ++t)
+    {
+      const IndexEntry &entry = m_index[t];
+      uint64_t maxMpcs = m_size / (QdInfo::NUM_COLUMNS * sizeof (double));
+      NS_ABORT_MSG_IF (entry.numMpcs > maxMpcs
+                       || entry.offset % sizeof (double) != 0
+                       || entry.offset > m_size
+                       || entry.numMpcs * QdInfo::NUM_COLUMNS * sizeof (double) > m_size - entry.offset,
+                       fileName << " is truncated or corrupted, timestep=" << t);
+    }
+
+  NS_LOG_DEBUG ("Mapped " << fileName << ", " << m_size << " bytes, " << m_numTimesteps << " timesteps");
+}
+
+QdBinaryTrace::~QdBinaryTrace ()
+{
+  NS_LOG_FUNCTION (this);
+#ifdef HAVE_SYS_MMAN_H
+  if (m_data != nullptr)
+    {
+      munmap (const_cast<uint8_t *> (m_data), m_size);
+    }
+#endif
+}
+
+const std::string &
+QdBinaryTrace::GetFileName (void) const
+{
+  return m_fileName;
+}
+
+uint64_t
+QdBinaryTrace::GetNumTimesteps (void) const
+{
+  return m_numTimesteps;
+}
+
+uint64_t
+QdBinaryTrace::GetNumMpcs (uint64_t timestep) const
+{
+  NS_ASSERT_MSG (timestep < m_numTimesteps, "timestep=" << timestep << " >= " << m_numTimesteps);
+  return m_index[timestep].numMpcs;
+}
+
+const double *
+QdBinaryTrace::GetColumn (uint64_t timestep, QdInfo::Column column) const
+{
+  NS_ASSERT_MSG (timestep < m_numTimesteps, "timestep=" << timestep << " >= " << m_numTimesteps);
+  NS_ASSERT (column < QdInfo::NUM_COLUMNS);
+  const IndexEntry &entry = m_index[timestep];
+  return reinterpret_cast<const double *> (m_data + entry.offset) + column * entry.numMpcs;
+}
+
+QdInfo
+QdBinaryTrace::GetQdInfo (uint64_t timestep) const
+{
+  NS_LOG_FUNCTION (this << timestep);
+
+  // the data block has the same layout of QdInfo::data
+  QdInfo qdInfo (GetNumMpcs (timestep));
+  if (qdInfo.numMpcs > 0)
+    {
+      std::memcpy (qdInfo.data.data (), m_data + m_index[timestep].offset, qdInfo.data.size () * sizeof (double));
+    }
+  return qdInfo;
+}
+
+void
+QdBinaryTrace::Write (const std::string &fileName, const std::vector<QdInfo> &qdInfoVector)
+{
+  NS_LOG_FUNCTION (fileName << qdInfoVector.size ());
+
+  std::ofstream file (fileName.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+  NS_ABORT_MSG_IF (!file.good (), "Unable to open " << fileName);
+
+  Header header;
+  std::memcpy (header.magic, QD_BINARY_MAGIC, sizeof (QD_BINARY_MAGIC));
+  header.version = VERSION;
+  header.reserved = 0;
+  header.numTimesteps = qdInfoVector.size ();
+  file.write (reinterpret_cast<const char *> (&header), sizeof (Header));
+
+  // the header and the index entries are multiple of 8 bytes, hence all the
+  // data blocks are aligned to double
+  uint64_t offset = sizeof (Header) + qdInfoVector.size () * sizeof (IndexEntry);
+  for (const QdInfo &qdInfo : qdInfoVector)
+    {
+      IndexEntry entry;
+      entry.numMpcs = qdInfo.numMpcs;
+      entry.offset = offset;
+      file.write (reinterpret_cast<const char *> (&entry), sizeof (IndexEntry));
+      offset += qdInfo.numMpcs * QdInfo::NUM_COLUMNS * sizeof (double);
+    }
+
+  for (const QdInfo &qdInfo : qdInfoVector)
+    {
+      if (qdInfo.numMpcs == 0)
+        {
+          continue;
+        }
+      NS_ABORT_MSG_IF (qdInfo.data.size () != qdInfo.numMpcs * QdInfo::NUM_COLUMNS,
+                       "mismatch between data size (" << qdInfo.data.size () <<
+                       ") and number of MPCs (" << qdInfo.numMpcs << ")");
+      file.write (reinterpret_cast<const char *> (qdInfo.data.data ()), qdInfo.data.size () * sizeof (double));
+    }
+
+  NS_ABORT_MSG_IF (!file.good (), "Error while writing " << fileName);
+}
+
+} // namespace ns3
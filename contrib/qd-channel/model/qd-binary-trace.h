@@ -0,0 +1,205 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2020 SIGNET Lab, Department of Information Engineering,
+ * University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef QD_BINARY_TRACE_H
+#define QD_BINARY_TRACE_H
+
+#include <string>
+#include <vector>
+#include "ns3/simple-ref-count.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup spectrum
+ *
+ * Structure containing the multipath components of a node pair for a
+ * given timestep of a QD scenario. The parameters are stored in a single
+ * packed block, one column after the other, i.e., numMpcs delays, followed
+ * by numMpcs path gains, and so on. Angles are in radians.
+ */
+struct QdInfo
+{
+  /**
+   * Columns stored for each timestep, in the order they appear in the block
+   */
+  enum Column
+  {
+    DELAY = 0, //!< delay [s]
+    PATH_GAIN, //!< path gain [dB]
+    PHASE, //!< phase [rad]
+    EL_AOD, //!< elevation angle of departure [rad]
+    AZ_AOD, //!< azimuth angle of departure [rad]
+    EL_AOA, //!< elevation angle of arrival [rad]
+    AZ_AOA, //!< azimuth angle of arrival [rad]
+    NUM_COLUMNS
+  };
+
+  /**
+   * Constructor
+   * \param n the number of multipath components
+   */
+  QdInfo (uint64_t n = 0)
+    : numMpcs (n),
+      data (NUM_COLUMNS * n)
+  {
+  }
+
+  /**
+   * Get a pointer to a column
+   * \param column the column
+   * \return pointer to numMpcs contiguous values
+   */
+  const double *GetColumn (Column column) const
+  {
+    return data.data () + column * numMpcs;
+  }
+
+  /**
+   * Get a pointer to a column
+   * \param column the column
+   * \return pointer to numMpcs contiguous values
+   */
+  double *GetColumn (Column column)
+  {
+    return data.data () + column * numMpcs;
+  }
+
+  /**
+   * Get a copy of a column
+   * \param column the column
+   * \return the values of the column
+   */
+  std::vector<double> GetColumnVector (Column column) const
+  {
+    return std::vector<double> (GetColumn (column), GetColumn (column) + numMpcs);
+  }
+
+  uint64_t numMpcs; //!< the number of multipath components
+  std::vector<double> data; //!< the packed columns
+};
+
+/**
+ * \ingroup spectrum
+ *
+ * Read-only view of a binary QD trace, i.e., the content of a TxNRxM.txt
+ * QD file converted with QdBinaryTrace::Write.
+ *
+ * The file is memory-mapped when the object is created and nothing is
+ * parsed: the multipath components of a timestep are read from the mapping
+ * only when they are requested, so that only the pages of the timesteps
+ * actually used are loaded in memory. If memory mapping is not available,
+ * the whole file is read in memory instead.
+ *
+ * The file is organized as follows (native byte order):
+ * - a header containing the magic string "NS3QDBIN", the format version
+ *   (uint32_t), a reserved field (uint32_t) and the number of timesteps T
+ *   (uint64_t);
+ * - an index with T entries, each containing the number of multipath
+ *   components M (uint64_t) and the offset of the data block of the
+ *   timestep from the beginning of the file (uint64_t);
+ * - T data blocks, each storing the QdInfo::NUM_COLUMNS columns of the
+ *   timestep one after the other, i.e., M delays, followed by M path gains,
+ *   and so on, with the same layout of QdInfo::data. All the values are
+ *   stored as double, angles are in radians.
+ */
+class QdBinaryTrace : public SimpleRefCount<QdBinaryTrace>
+{
+public:
+  /**
+   * Constructor. Memory-maps the file, aborts if the file can not be opened
+   * or if it is not a valid binary QD trace.
+   * \param fileName the name of the binary QD trace
+   */
+  QdBinaryTrace (const std::string &fileName);
+
+  /**
+   * Destructor. Unmaps the file.
+   */
+  ~QdBinaryTrace ();
+
+  /**
+   * Get the name of the mapped file
+   * \return the file name
+   */
+  const std::string &GetFileName (void) const;
+
+  /**
+   * Get the number of timesteps stored in the trace
+   * \return the number of timesteps
+   */
+  uint64_t GetNumTimesteps (void) const;
+
+  /**
+   * Get the number of multipath components of a timestep
+   * \param timestep the timestep
+   * \return the number of multipath components
+   */
+  uint64_t GetNumMpcs (uint64_t timestep) const;
+
+  /**
+   * Get a pointer to a column of a timestep, directly in the mapped memory
+   * \param timestep the timestep
+   * \param column the column
+   * \return pointer to GetNumMpcs (timestep) contiguous values, valid for
+   *         the lifetime of this object
+   */
+  const double *GetColumn (uint64_t timestep, QdInfo::Column column) const;
+
+  /**
+   * Materialize the multipath components of a timestep
+   * \param timestep the timestep
+   * \return the multipath components of the timestep
+   */
+  QdInfo GetQdInfo (uint64_t timestep) const;
+
+  /**
+   * Write a binary QD trace
+   * \param fileName the name of the file to write
+   * \param qdInfoVector the multipath components of each timestep
+   */
+  static void Write (const std::string &fileName, const std::vector<QdInfo> &qdInfoVector);
+
+  static const uint32_t VERSION = 1; //!< version of the binary format
+
+private:
+  // disable copy, the mapping is owned by this object
+  QdBinaryTrace (const QdBinaryTrace &) = delete;
+  QdBinaryTrace &operator= (const QdBinaryTrace &) = delete;
+
+  /**
+   * Entry of the index of the timesteps
+   */
+  struct IndexEntry
+  {
+    uint64_t numMpcs; //!< number of multipath components
+    uint64_t offset; //!< offset of the data block from the beginning of the file
+  };
+
+  std::string m_fileName; //!< name of the mapped file
+  const uint8_t *m_data; //!< pointer to the mapped file
+  size_t m_size; //!< size of the mapped file
+  std::vector<uint64_t> m_buffer; //!< content of the file, if it is read instead of mapped
+  uint64_t m_numTimesteps; //!< number of timesteps
+  const IndexEntry *m_index; //!< pointer to the index, in the mapped file
+};
+
+} // namespace ns3
+
+#endif /* QD_BINARY_TRACE_H */
@@ -33,7 +33,21 @@
 #include <glob.h>
 #include <fstream>
 #include <sstream>
+#include <tuple>
 #include <ns3/node-list.h>
+#include "ns3/uinteger.h"
+#include "ns3/core-config.h"
+#include <cstring>
+#include <deque>
+#include <set>
+#ifdef HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-thread.h"
+#include <condition_variable>
+#include <mutex>
+#endif
 
 
 namespace ns3 {
@@ -43,7 +57,179 @@ NS_LOG_COMPONENT_DEFINE ("QdChannelModel");
 NS_OBJECT_ENSURE_REGISTERED (QdChannelModel);
 
 
+/**
+ * Materializes the timesteps of the binary QD traces in a background
+ * thread. If threads are not available, the timesteps are materialized
+ * when they are requested.
+ *
+ * The prefetcher only stores raw pointers to the traces, which must not be
+ * released until Stop has been called.
+ */
+class QdBinaryTracePrefetcher : public SimpleRefCount<QdBinaryTracePrefetcher>
+{
+public:
+  /**
+   * Constructor
+   */
+  QdBinaryTracePrefetcher ();
+
+  /**
+   * Destructor. Stops the background thread.
+   */
+  ~QdBinaryTracePrefetcher ();
+
+  /**
+   * Request the materialization of a timestep
+   * \param key the key of the node pair
+   * \param trace the binary QD trace of the node pair
+   * \param timestep the timestep
+   */
+  void Request (uint32_t key, const QdBinaryTrace *trace, uint64_t timestep);
+
+  /**
+   * Move the timesteps of a node pair materialized so far into timesteps.
+   * The timesteps before minTimestep are discarded.
+   * \param key the key of the node pair
+   * \param minTimestep the first timestep of interest
+   * \param timesteps the map where the materialized timesteps are moved
+   */
+  void Collect (uint32_t key, uint64_t minTimestep, std::map<uint64_t, QdInfo> &timesteps);
+
+  /**
+   * Drop the pending requests and stop the background thread
+   */
+  void Stop (void);
+
+private:
+  /**
+   * Body of the background thread
+   */
+  void Run (void);
+
+  /**
+   * A request for the materialization of a timestep
+   */
+  struct PrefetchRequest
+  {
+    uint32_t key; //!< the key of the node pair
+    const QdBinaryTrace *trace; //!< the binary QD trace of the node pair
+    uint64_t timestep; //!< the timestep
+  };
+
+  std::deque<PrefetchRequest> m_queue; //!< the pending requests
+  std::map<uint32_t, std::map<uint64_t, QdInfo> > m_ready; //!< the materialized timesteps, for each node pair
+  bool m_stop; //!< true if the background thread has to stop
+#ifdef HAVE_PTHREAD_H
+  std::mutex m_mutex; //!< protects m_queue, m_ready and m_stop
+  std::condition_variable m_condition; //!< signals new requests and the stop request to the background thread
+  Ptr<SystemThread> m_thread; //!< the background thread
+#endif
+};
+
+QdBinaryTracePrefetcher::QdBinaryTracePrefetcher ()
+  : m_stop (false)
+{
+}
+
+QdBinaryTracePrefetcher::~QdBinaryTracePrefetcher ()
+{
+  Stop ();
+}
+
+void
+QdBinaryTracePrefetcher::Request (uint32_t key, const QdBinaryTrace *trace, uint64_t timestep)
+{
+  PrefetchRequest request;
+  request.key = key;
+  request.trace = trace;
+  request.timestep = timestep;
+
+#ifdef HAVE_PTHREAD_H
+  {
+    std::lock_guard<std::mutex> lock (m_mutex);
+    m_queue.push_back (request);
+  }
+  if (!m_thread)
+    {
+      m_thread = Create<SystemThread> (MakeCallback (&QdBinaryTracePrefetcher::Run, this));
+      m_thread->Start ();
+    }
+  m_condition.notify_one ();
+#else
+  m_ready[key].insert (std::make_pair (timestep, trace->GetQdInfo (timestep)));
+#endif
+}
+
+void
+QdBinaryTracePrefetcher::Collect (uint32_t key, uint64_t minTimestep, std::map<uint64_t, QdInfo> &timesteps)
+{
+#ifdef HAVE_PTHREAD_H
+  std::lock_guard<std::mutex> lock (m_mutex);
+#endif
+  auto readyIt = m_ready.find (key);
+  if (readyIt == m_ready.end ())
+    {
+      return;
+    }
+  for (auto it = readyIt->second.lower_bound (minTimestep); it != readyIt->second.end (); ++it)
+    {
+      timesteps.insert (std::make_pair (it->first, std::move (it->second)));
+    }
+  m_ready.erase (readyIt);
+}
+
+void
+QdBinaryTracePrefetcher::Stop (void)
+{
+#ifdef HAVE_PTHREAD_H
+  if (m_thread)
+    {
+      {
+        std::lock_guard<std::mutex> lock (m_mutex);
+        m_stop = true;
+      }
+      m_condition.notify_one ();
+      m_thread->Join ();
+      m_thread = 0;
+      m_stop = false;
+    }
+#endif
+  m_queue.clear ();
+  m_ready.clear ();
+}
+
+void
+QdBinaryTracePrefetcher::Run (void)
+{
+#ifdef HAVE_PTHREAD_H
+  std::unique_lock<std::mutex> lock (m_mutex);
+  while (true)
+    {
+      // the queue is checked under the same mutex of the requests, hence
+      // no notification can be missed between the check and the wait
+      m_condition.wait (lock, [this] () { return !m_queue.empty () || m_stop; });
+      if (m_stop)
+        {
+          return;
+        }
+
+      PrefetchRequest request = m_queue.front ();
+      m_queue.pop_front ();
+      lock.unlock ();
+
+      // the mapped file is read-only, this can be done without holding the lock
+      QdInfo qdInfo = request.trace->GetQdInfo (request.timestep);
+
+      lock.lock ();
+      m_ready[request.key].insert (std::make_pair (request.timestep, std::move (qdInfo)));
+    }
+#endif
+}
+
+
 QdChannelModel::QdChannelModel (std::string path, std::string scenario)
+  : m_cacheSize (0),
+    m_streamingWindow (0)
 {
   NS_LOG_FUNCTION (this);
 
@@ -54,6 +240,30 @@ QdChannelModel::QdChannelModel (std::string path, std::string scenario)
 QdChannelModel::~QdChannelModel ()
 {
   NS_LOG_FUNCTION (this);
+  if (m_prefetcher)
+    {
+      m_prefetcher->Stop ();
+    }
+}
+
+void
+QdChannelModel::DoDispose ()
+{
+  NS_LOG_FUNCTION (this);
+  // the prefetcher uses the traces, stop it before releasing them
+  if (m_prefetcher)
+    {
+      m_prefetcher->Stop ();
+      m_prefetcher = 0;
+    }
+  m_channelMap.clear ();
+  m_cacheMap.clear ();
+  m_cacheList.clear ();
+  m_qdInfoMap.clear ();
+  m_qdTraceInfoMap.clear ();
+  m_qdTraceMap.clear ();
+  m_prefetchNextTimestep.clear ();
+  MatrixBasedChannelModel::DoDispose ();
 }
 
 TypeId
@@ -69,7 +279,27 @@ QdChannelModel::GetTypeId (void)
                    DoubleValue (0.0),
                    MakeDoubleAccessor (&QdChannelModel::SetFrequency,
                                        &QdChannelModel::GetFrequency),
-                   MakeDoubleChecker<double> ());
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("StreamingWindow",
+                   "Number of timesteps of the binary QD files which are "
+                   "prefetched in background ahead of the current one. "
+                   "If greater than 0, only the current and the prefetched "
+                   "timesteps are kept in memory, otherwise every timestep "
+                   "read from the binary QD files is kept until the end of "
+                   "the simulation. Text QD files are always fully loaded.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&QdChannelModel::m_streamingWindow),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("CacheSize",
+                   "Maximum number of channel matrices kept in the cache. "
+                   "Since QD traces are deterministic, a channel matrix is "
+                   "reused whenever the same pair of nodes, timestep and "
+                   "antenna arrays are found again, and the least recently "
+                   "used one is evicted when the cache is full. Set to 0 "
+                   "to disable the cache.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&QdChannelModel::m_cacheSize),
+                   MakeUintegerChecker<uint32_t> ());
 
   return tid;
 }
@@ -77,7 +307,7 @@ QdChannelModel::GetTypeId (void)
 std::vector<std::string>
 QdChannelModel::GetQdFilesList (const std::string& pattern)
 {
-  NS_LOG_FUNCTION (this << pattern);
+  NS_LOG_FUNCTION (pattern);
 
   glob_t glob_result;
   glob (pattern.c_str (), GLOB_TILDE, NULL, &glob_result);
@@ -93,7 +323,7 @@ QdChannelModel::GetQdFilesList (const std::string& pattern)
 std::vector<double>
 QdChannelModel::ParseCsv (const std::string& str)
 {
-  NS_LOG_FUNCTION (this << str);
+  NS_LOG_FUNCTION (str);
 
   std::stringstream ss (str);
   std::vector<double> vect{};
@@ -212,27 +442,125 @@ QdChannelModel::ReadParaCfgFile ()
 
 }
 
+std::pair<uint32_t, uint32_t>
+QdChannelModel::GetRtIdsFromFileName (const std::string& fileName)
+{
+  // get the nodes IDs from the file name, i.e., TxNRxM.*
+  std::string::size_type txIndex = fileName.rfind ("Tx");
+  std::string::size_type rxIndex = fileName.rfind ("Rx");
+  std::string::size_type extIndex = fileName.rfind (".");
+  NS_ABORT_MSG_IF (txIndex == std::string::npos || rxIndex == std::string::npos
+                   || extIndex == std::string::npos || !(txIndex < rxIndex && rxIndex < extIndex),
+                   "Invalid QD file name " << fileName);
+
+  uint32_t id_tx = ::atoi (fileName.substr (txIndex + 2, rxIndex - txIndex - 2).c_str ());
+  uint32_t id_rx = ::atoi (fileName.substr (rxIndex + 2, extIndex - rxIndex - 2).c_str ());
+  return std::make_pair (id_tx, id_rx);
+}
+
+std::vector<QdInfo>
+QdChannelModel::ReadQdTextFile (const std::string& fileName)
+{
+  NS_LOG_FUNCTION (fileName);
+
+  std::ifstream qdFile{fileName.c_str ()};
+  NS_ABORT_MSG_IF (!qdFile.good (), fileName + " not found");
+
+  // after the number of multipath components, the file has a line for each
+  // column: delays, path gains, phases, elev AoDs, az AoDs, elev AoAs, az AoAs
+  static const char* columnNames[QdInfo::NUM_COLUMNS] = {"path delays", "path gains", "path phases",
+                                                          "path elev AoDs", "path az AoDs",
+                                                          "path elev AoAs", "path az AoAs"};
+
+  std::string line{};
+  std::vector<QdInfo> qdInfoVector;
+
+  while (std::getline (qdFile, line))
+    {
+      // the file has a line with the number of multipath components
+      QdInfo qdInfo (std::stoul (line, 0, 10));
+      NS_LOG_LOGIC ("numMpcs " << qdInfo.numMpcs);
+
+      if (qdInfo.numMpcs > 0)
+        {
+          for (uint8_t c = 0; c < QdInfo::NUM_COLUMNS; ++c)
+            {
+              QdInfo::Column column = static_cast<QdInfo::Column> (c);
+              std::getline (qdFile, line);
+              auto values = ParseCsv (line);
+              NS_ABORT_MSG_IF (values.size () != qdInfo.numMpcs,
+                               "mismatch between number of " << columnNames[c] << " (" << values.size () <<
+                               ") and number of MPCs (" << qdInfo.numMpcs <<
+                               "), timestep=" << qdInfoVector.size () + 1 <<
+                               ", fileName=" << fileName);
+              // angles are stored in degrees
+              if (column >= QdInfo::EL_AOD)
+                {
+                  values = DegreesToRadians (values);
+                }
+              std::copy (values.begin (), values.end (), qdInfo.GetColumn (column));
+            }
+        }
+      qdInfoVector.push_back (std::move (qdInfo));
+    }
+  NS_LOG_DEBUG ("qdInfoVector.size ()=" << qdInfoVector.size ());
+  return qdInfoVector;
+}
+
+/**
+ * Get the last modification time of a file
+ * \param fileName the name of the file
+ * \return the modification time, in seconds, or 0 if it is not available
+ */
+static int64_t
+GetModificationTime (const std::string &fileName)
+{
+#ifdef HAVE_SYS_STAT_H
+  struct stat st;
+  if (stat (fileName.c_str (), &st) == 0)
+    {
+      return st.st_mtime;
+    }
+#endif
+  return 0;
+}
+
 void
 QdChannelModel::ReadQdFiles (QdChannelModel::RtIdToNs3IdMap_t rtIdToNs3IdMap)
 {
   NS_LOG_FUNCTION (this);
 
-  // QdFiles input
+  // QdFiles input, the text and binary files of each tx/rx pair
   NS_LOG_DEBUG ("m_path + m_scenario = " << m_path + m_scenario);
-  auto qdFileList = GetQdFilesList (m_path + m_scenario + "Output/Ns3/QdFiles/*");
-  NS_LOG_DEBUG ("qdFileList.size ()=" << qdFileList.size ());
+  std::map<std::string, std::pair<std::string, std::string> > pairFiles;
+  for (auto fileName : GetQdFilesList (m_path + m_scenario + "Output/Ns3/QdFiles/*.txt"))
+    {
+      pairFiles[fileName.substr (0, fileName.rfind ("."))].first = fileName;
+    }
+  for (auto fileName : GetQdFilesList (m_path + m_scenario + "Output/Ns3/QdFiles/*.qdbin"))
+    {
+      pairFiles[fileName.substr (0, fileName.rfind ("."))].second = fileName;
+    }
+  NS_LOG_DEBUG ("pairFiles.size ()=" << pairFiles.size ());
 
-  for (auto fileName : qdFileList)
+  for (auto &files : pairFiles)
     {
-      // get the nodes IDs from the file name
-      int txIndex = fileName.find ("Tx");
-      int rxIndex = fileName.find ("Rx");
-      int txtIndex = fileName.find (".txt");
+      // the binary file is preferred, unless the text file has been modified
+      // after the conversion
+      const std::string &textFileName = files.second.first;
+      const std::string &binFileName = files.second.second;
+      bool binary = !binFileName.empty ();
+      if (binary && !textFileName.empty ()
+          && GetModificationTime (textFileName) > GetModificationTime (binFileName))
+        {
+          NS_LOG_WARN (binFileName << " is older than " << textFileName << ", the text file is used");
+          binary = false;
+        }
+      const std::string &fileName = binary ? binFileName : textFileName;
+      NS_LOG_LOGIC ("fileName " << fileName << ", binary=" << binary);
 
-      int len {rxIndex - txIndex - 2};
-      int id_tx {::atoi (fileName.substr (txIndex + 2, len).c_str ())};
-      len = txtIndex - rxIndex - 2;
-      int id_rx {::atoi (fileName.substr (rxIndex + 2, len).c_str ())};
+      uint32_t id_tx, id_rx;
+      std::tie (id_tx, id_rx) = GetRtIdsFromFileName (fileName);
 
       NS_ABORT_MSG_IF (rtIdToNs3IdMap.find (id_tx) == rtIdToNs3IdMap.end (), "ID not found for TX!");
       uint32_t nodeIdTx = rtIdToNs3IdMap.find (id_tx)->second;
@@ -243,93 +571,130 @@ QdChannelModel::ReadQdFiles (QdChannelModel::RtIdToNs3IdMap_t rtIdToNs3IdMap)
       NS_LOG_LOGIC (id_rx);
 
       uint32_t key = GetKey (nodeIdTx, nodeIdRx);
-      // std::pair<Ptr<const MobilityModel>, Ptr<const MobilityModel>> idPair {std::make_pair(tx_mm, rx_mm)};
 
-      std::ifstream qdFile{fileName.c_str ()};
+      if (binary)
+        {
+          // nothing is parsed here, the timesteps are materialized on first access
+          m_qdTraceMap.insert (std::make_pair (key, Create<const QdBinaryTrace> (fileName)));
+        }
+      else
+        {
+          m_qdInfoMap.insert (std::make_pair (key, ReadQdTextFile (fileName)));
+        }
+    }
+
+  NS_LOG_DEBUG ("Imported files for " << m_qdInfoMap.size () + m_qdTraceMap.size () << " tx/rx pairs");
+}
+
+const QdInfo&
+QdChannelModel::GetQdInfo (uint32_t key, uint64_t timestep) const
+{
+  NS_LOG_FUNCTION (this << key << timestep);
+
+  auto qdInfoIt = m_qdInfoMap.find (key);
+  if (qdInfoIt != m_qdInfoMap.end ())
+    {
+      return qdInfoIt->second.at (timestep);
+    }
 
-      std::string line{};
-      std::vector<QdInfo> qdInfoVector;
+  auto traceIt = m_qdTraceMap.find (key);
+  NS_ABORT_MSG_IF (traceIt == m_qdTraceMap.end (), "No QD file found for key " << key);
+  NS_ABORT_MSG_IF (timestep >= traceIt->second->GetNumTimesteps (),
+                   "timestep=" << timestep << " not available in " << traceIt->second->GetFileName ());
 
-      while (std::getline (qdFile, line))
+  std::map<uint64_t, QdInfo> &timesteps = m_qdTraceInfoMap[key];
+  if (m_streamingWindow > 0)
+    {
+      // evict the previous timesteps and retrieve the prefetched ones
+      timesteps.erase (timesteps.begin (), timesteps.lower_bound (timestep));
+      if (!m_prefetcher)
         {
-          QdInfo qdInfo {};
-          // the file has a line with the number of multipath components
-          qdInfo.numMpcs = std::stoul (line, 0, 10);
-          NS_LOG_LOGIC ("numMpcs " << qdInfo.numMpcs);
+          m_prefetcher = Create<QdBinaryTracePrefetcher> ();
+        }
+      m_prefetcher->Collect (key, timestep, timesteps);
+    }
 
-          if (qdInfo.numMpcs > 0)
-            {
-              // a line with the delays
-              std::getline (qdFile, line);
-              auto pathDelays = ParseCsv (line);
-              NS_ABORT_MSG_IF (pathDelays.size () != qdInfo.numMpcs,
-                               "mismatch between number of path delays (" << pathDelays.size () <<
-                               ") and number of MPCs (" << qdInfo.numMpcs <<
-                               "), timestep=" << qdInfoVector.size () + 1 <<
-                               ", fileName=" << fileName);
-              qdInfo.delay_s = pathDelays;
-              // a line with the path gains
-              std::getline (qdFile, line);
-              auto pathGains = ParseCsv (line);
-              NS_ABORT_MSG_IF (pathGains.size () != qdInfo.numMpcs,
-                               "mismatch between number of path gains (" << pathGains.size () <<
-                               ") and number of MPCs (" << qdInfo.numMpcs <<
-                               "), timestep=" << qdInfoVector.size () + 1 <<
-                               ", fileName=" << fileName);
-              qdInfo.pathGain_dbpow = pathGains;
-              // a line with the path phases
-              std::getline (qdFile, line);
-              auto pathPhases = ParseCsv (line);
-              NS_ABORT_MSG_IF (pathPhases.size () != qdInfo.numMpcs,
-                               "mismatch between number of path phases (" << pathPhases.size () <<
-                               ") and number of MPCs (" << qdInfo.numMpcs <<
-                               "), timestep=" << qdInfoVector.size () + 1 <<
-                               ", fileName=" << fileName);
-              qdInfo.phase_rad = pathPhases;
-              // a line with the elev AoD
-              std::getline (qdFile, line);
-              auto pathElevAod = ParseCsv (line);
-              NS_ABORT_MSG_IF (pathElevAod.size () != qdInfo.numMpcs,
-                               "mismatch between number of path elev AoDs (" << pathElevAod.size () <<
-                               ") and number of MPCs (" << qdInfo.numMpcs <<
-                               "), timestep=" << qdInfoVector.size () + 1 <<
-                               ", fileName=" << fileName);
-              qdInfo.elAod_rad = DegreesToRadians (pathElevAod);
-              // a line with the azimuth AoD
-              std::getline (qdFile, line);
-              auto pathAzAod = ParseCsv (line);
-              NS_ABORT_MSG_IF (pathAzAod.size () != qdInfo.numMpcs,
-                               "mismatch between number of path az AoDs (" << pathAzAod.size () <<
-                               ") and number of MPCs (" << qdInfo.numMpcs <<
-                               "), timestep=" << qdInfoVector.size () + 1 <<
-                               ", fileName=" << fileName);
-              qdInfo.azAod_rad = DegreesToRadians (pathAzAod);
-              // a line with the elev AoA
-              std::getline (qdFile, line);
-              auto pathElevAoa = ParseCsv (line);
-              NS_ABORT_MSG_IF (pathElevAoa.size () != qdInfo.numMpcs,
-                               "mismatch between number of path elev AoAs (" << pathElevAoa.size () <<
-                               ") and number of MPCs (" << qdInfo.numMpcs <<
-                               "), timestep=" << qdInfoVector.size () + 1 <<
-                               ", fileName=" << fileName);
-              qdInfo.elAoa_rad = DegreesToRadians (pathElevAoa);
-              // a line with the azimuth AoA
-              std::getline (qdFile, line);
-              auto pathAzAoa = ParseCsv (line);
-              NS_ABORT_MSG_IF (pathAzAoa.size () != qdInfo.numMpcs,
-                               "mismatch between number of path az AoAs (" << pathAzAoa.size () <<
-                               ") and number of MPCs (" << qdInfo.numMpcs <<
-                               "), timestep=" << qdInfoVector.size () + 1 <<
-                               ", fileName=" << fileName);
-              qdInfo.azAoa_rad = DegreesToRadians (pathAzAoa);
-            }
-          qdInfoVector.push_back (qdInfo);
+  auto it = timesteps.find (timestep);
+  if (it == timesteps.end ())
+    {
+      NS_LOG_LOGIC ("materialize timestep " << timestep << " from " << traceIt->second->GetFileName ());
+      it = timesteps.insert (std::make_pair (timestep, traceIt->second->GetQdInfo (timestep))).first;
+    }
+
+  if (m_streamingWindow > 0)
+    {
+      // request the following timesteps which have not been requested yet
+      uint64_t &next = m_prefetchNextTimestep[key];
+      uint64_t last = std::min<uint64_t> (timestep + m_streamingWindow, traceIt->second->GetNumTimesteps () - 1);
+      for (next = std::max (next, timestep + 1); next <= last; ++next)
+        {
+          NS_LOG_LOGIC ("prefetch timestep " << next << " from " << traceIt->second->GetFileName ());
+          m_prefetcher->Request (key, PeekPointer (traceIt->second), next);
+        }
+    }
+
+  return it->second;
+}
+
+std::vector<uint32_t>
+QdChannelModel::GetQdKeys (void) const
+{
+  std::set<uint32_t> keys;
+  for (const auto &entry : m_qdInfoMap)
+    {
+      keys.insert (entry.first);
+    }
+  for (const auto &entry : m_qdTraceMap)
+    {
+      keys.insert (entry.first);
+    }
+  return std::vector<uint32_t> (keys.begin (), keys.end ());
+}
+
+uint32_t
+QdChannelModel::GetNumTextQdFiles (void) const
+{
+  return m_qdInfoMap.size ();
+}
+
+uint32_t
+QdChannelModel::GetNumBinaryQdFiles (void) const
+{
+  return m_qdTraceMap.size ();
+}
+
+std::vector<uint64_t>
+QdChannelModel::GetResidentTimesteps (uint32_t key) const
+{
+  std::vector<uint64_t> timesteps;
+  auto it = m_qdTraceInfoMap.find (key);
+  if (it != m_qdTraceInfoMap.end ())
+    {
+      for (const auto &entry : it->second)
+        {
+          timesteps.push_back (entry.first);
         }
-      NS_LOG_DEBUG ("qdInfoVector.size ()=" << qdInfoVector.size ());
-      m_qdInfoMap.insert (std::make_pair (key, qdInfoVector));
     }
+  return timesteps;
+}
 
-  NS_LOG_DEBUG ("Imported files for " << m_qdInfoMap.size () << " tx/rx pairs");
+void
+QdChannelModel::ConvertQdFiles (std::string path, std::string scenario)
+{
+  NS_LOG_FUNCTION (path << scenario);
+
+  TrimFolderName (path);
+  TrimFolderName (scenario);
+
+  auto qdFileList = GetQdFilesList (path + scenario + "Output/Ns3/QdFiles/*.txt");
+  NS_ABORT_MSG_IF (qdFileList.empty (), "No QD file found in " << path + scenario + "Output/Ns3/QdFiles/");
+
+  for (auto fileName : qdFileList)
+    {
+      std::string binFileName = fileName.substr (0, fileName.rfind (".")) + ".qdbin";
+      NS_LOG_INFO ("Converting " << fileName << " to " << binFileName);
+      QdBinaryTrace::Write (binFileName, ReadQdTextFile (fileName));
+    }
 }
 
 void
@@ -338,16 +703,30 @@ QdChannelModel::ReadAllInputFiles ()
   NS_LOG_FUNCTION (this);
   NS_LOG_LOGIC ("ReadAllInputFiles for scenario " << m_scenario << " path " << m_path);
 
+  // the prefetcher uses the traces, stop it before releasing them
+  if (m_prefetcher)
+    {
+      m_prefetcher->Stop ();
+    }
   m_ns3IdToRtIdMap.clear ();
+  m_channelMap.clear ();
+  m_cacheMap.clear ();
+  m_cacheList.clear ();
   m_qdInfoMap.clear ();
+  m_qdTraceMap.clear ();
+  m_qdTraceInfoMap.clear ();
+  m_prefetchNextTimestep.clear ();
 
   ReadParaCfgFile ();
   QdChannelModel::RtIdToNs3IdMap_t rtIdToNs3IdMap = ReadNodesPosition ();
   ReadQdFiles (rtIdToNs3IdMap);
 
   // Setup simulation timings assuming constant periodicity
-  NS_ASSERT_MSG (m_totTimesteps == m_qdInfoMap.begin ()->second.size (),
-                 "m_totTimesteps = " << m_totTimesteps << " != QdFiles size = " << m_qdInfoMap.begin ()->second.size ());
+  NS_ABORT_MSG_IF (m_qdInfoMap.empty () && m_qdTraceMap.empty (), "No QD file found for scenario " << m_scenario);
+  uint64_t qdFileSize = m_qdInfoMap.empty () ? m_qdTraceMap.begin ()->second->GetNumTimesteps ()
+                                             : m_qdInfoMap.begin ()->second.size ();
+  NS_ASSERT_MSG (m_totTimesteps == qdFileSize,
+                 "m_totTimesteps = " << m_totTimesteps << " != QdFiles size = " << qdFileSize);
 
   m_updatePeriod = NanoSeconds ((double) m_totalTimeDuration.GetNanoSeconds () / (double) m_totTimesteps);
   NS_LOG_DEBUG ("m_totalTimeDuration=" << m_totalTimeDuration.GetSeconds () << " s"
@@ -363,6 +742,13 @@ QdChannelModel::GetQdSimTime () const
   return m_totalTimeDuration;
 }
 
+uint32_t
+QdChannelModel::GetNumTimesteps () const
+{
+  NS_LOG_FUNCTION (this);
+  return m_totTimesteps;
+}
+
 void
 QdChannelModel::SetFrequency (double freqHz)
 {
@@ -380,8 +766,8 @@ QdChannelModel::GetFrequency () const
 void
 QdChannelModel::TrimFolderName (std::string& folder)
 {
-  // avoid starting with multiple '/'
-  while (folder.front () == '/')
+  // avoid starting with multiple '/', but keep absolute paths absolute
+  while (folder.size () > 1 && folder[0] == '/' && folder[1] == '/')
     {
       folder = folder.substr (1, folder.size ());
     }
@@ -472,7 +858,23 @@ QdChannelModel::GetChannel (Ptr<const MobilityModel> aMob,
   uint32_t aId = aMob->GetObject<Node> ()->GetId ();
   uint32_t bId = bMob->GetObject<Node> ()->GetId ();
 
-  uint32_t channelId = GetKey (aId, bId);
+  // reciprocal pairs share the same realization, which is generated from
+  // the QD file of the node with the lowest ID, if available
+  if (aId > bId)
+    {
+      std::swap (aId, bId);
+      std::swap (aMob, bMob);
+      std::swap (aAntenna, bAntenna);
+    }
+  if (m_qdInfoMap.find (GetKey (aId, bId)) == m_qdInfoMap.end ()
+      && m_qdTraceMap.find (GetKey (aId, bId)) == m_qdTraceMap.end ())
+    {
+      std::swap (aId, bId);
+      std::swap (aMob, bMob);
+      std::swap (aAntenna, bAntenna);
+    }
+
+  uint32_t channelId = GetKey (std::min (aId, bId), std::max (aId, bId));
 
 
   NS_LOG_DEBUG ("channelId " << channelId <<
@@ -521,47 +923,104 @@ QdChannelModel::GetNewChannel (Ptr<const MobilityModel> aMob,
 {
   NS_LOG_FUNCTION (this << aMob << bMob << aAntenna << bAntenna);
 
-  Ptr<MatrixBasedChannelModel::ChannelMatrix> channelParams = Create<MatrixBasedChannelModel::ChannelMatrix> ();
-
-  uint32_t timestep = GetTimestep ();
+  uint64_t timestep = GetTimestep ();
   uint32_t aId = aMob->GetObject<Node> ()->GetId ();
   uint32_t bId = bMob->GetObject<Node> ()->GetId ();
   uint32_t channelId = GetKey (aId, bId);
 
-  QdInfo qdInfo = m_qdInfoMap.at (channelId)[timestep];
+  // QD traces are deterministic, the same pair, timestep and arrays always
+  // produce the same channel matrix
+  CacheKey cacheKey;
+  if (m_cacheSize > 0)
+    {
+      cacheKey.channelId = channelId;
+      cacheKey.timestep = timestep;
+      cacheKey.aGeometry = GetArrayGeometryKey (PeekPointer (aAntenna));
+      cacheKey.bGeometry = GetArrayGeometryKey (PeekPointer (bAntenna));
+      Ptr<const MatrixBasedChannelModel::ChannelMatrix> cached = CacheLookup (cacheKey);
+      if (cached)
+        {
+          NS_LOG_DEBUG ("channel matrix found in the cache, timestep " << timestep);
+          return cached;
+        }
+    }
+
+  const QdInfo &qdInfo = GetQdInfo (channelId, timestep);
+  Ptr<MatrixBasedChannelModel::ChannelMatrix> channelParams = ComputeChannelMatrix (qdInfo, PeekPointer (aAntenna), PeekPointer (bAntenna));
+  channelParams->m_nodeIds = std::make_pair (aId, bId);
+
+  if (m_cacheSize > 0)
+    {
+      // cached matrices may be used later during the same timestep, use the
+      // beginning of the timestep as the generation time
+      channelParams->m_generatedTime = m_updatePeriod * timestep;
+      CacheInsert (cacheKey, channelParams);
+    }
+  else
+    {
+      channelParams->m_generatedTime = Simulator::Now ();
+    }
+
+  return channelParams;
+}
+
+Ptr<MatrixBasedChannelModel::ChannelMatrix>
+QdChannelModel::ComputeChannelMatrix (const QdInfo &qdInfo,
+                                      const PhasedArrayModel *aAntenna,
+                                      const PhasedArrayModel *bAntenna) const
+{
+  Ptr<MatrixBasedChannelModel::ChannelMatrix> channelParams = Create<MatrixBasedChannelModel::ChannelMatrix> ();
 
   uint64_t bSize = bAntenna->GetNumberOfElements ();
   uint64_t aSize = aAntenna->GetNumberOfElements ();
 
+  // the element locations do not depend on the MPC, retrieve them once
+  std::vector<Vector> bLoc (bSize), aLoc (aSize);
+  for (uint64_t bIndex = 0; bIndex < bSize; ++bIndex)
+    {
+      bLoc[bIndex] = bAntenna->GetElementLocation (bIndex);
+    }
+  for (uint64_t aIndex = 0; aIndex < aSize; ++aIndex)
+    {
+      aLoc[aIndex] = aAntenna->GetElementLocation (aIndex);
+    }
+
   // channel coffecient H[u][s][n];
   // considering only 1 cluster for retrocompatibility -> n=1
-  MatrixBasedChannelModel::Complex3DVector H;
-
-  H.resize (bSize);
-  for (uint64_t bIndex = 0; bIndex < bSize; bIndex++)
+  MatrixBasedChannelModel::ComplexTensor3D H (bSize, aSize, qdInfo.numMpcs > 0 ? 1 : 0);
+
+  const double *delay = qdInfo.GetColumn (QdInfo::DELAY);
+  const double *pathGainDb = qdInfo.GetColumn (QdInfo::PATH_GAIN);
+  const double *phase = qdInfo.GetColumn (QdInfo::PHASE);
+  const double *elAod = qdInfo.GetColumn (QdInfo::EL_AOD);
+  const double *azAod = qdInfo.GetColumn (QdInfo::AZ_AOD);
+  const double *elAoa = qdInfo.GetColumn (QdInfo::EL_AOA);
+  const double *azAoa = qdInfo.GetColumn (QdInfo::AZ_AOA);
+
+  // conjugate steering vectors of the current MPC, reused across MPCs
+  PhasedArrayModel::ComplexVector bSvConj (bSize), aSvConj (aSize);
+  auto fillConjSteeringVector = [] (const std::vector<Vector> &loc, Angles angle, PhasedArrayModel::ComplexVector &svConj)
     {
-      H[bIndex].resize (aSize);
-      for (uint64_t aIndex = 0; aIndex < aSize; aIndex++)
+      double sinTheta = sin (angle.theta);
+      double ux = sinTheta * cos (angle.phi);
+      double uy = sinTheta * sin (angle.phi);
+      double uz = cos (angle.theta);
+      for (size_t i = 0; i < loc.size (); ++i)
         {
-          if (qdInfo.numMpcs > 0)
-            {
-              H[bIndex][aIndex].resize (1, std::complex<double> (0,0));
-            }
-          else
-            {
-              H[bIndex][aIndex].resize (0, std::complex<double> (0,0));
-            }
+          // same phase of PhasedArrayModel::GetSteeringVector, conjugated
+          double phase = 2 * M_PI * (ux * loc[i].x + uy * loc[i].y + uz * loc[i].z);
+          svConj[i] = std::polar<double> (1.0, phase);
         }
-    }
+    };
 
   for (uint64_t mpcIndex = 0; mpcIndex < qdInfo.numMpcs; ++mpcIndex)
     {
-      double initialPhase = -2 * M_PI * qdInfo.delay_s[mpcIndex] * m_frequency + qdInfo.phase_rad[mpcIndex];
-      double pathGain = pow (10, qdInfo.pathGain_dbpow[mpcIndex] / 20);
+      double initialPhase = -2 * M_PI * delay[mpcIndex] * m_frequency + phase[mpcIndex];
+      double pathGain = pow (10, pathGainDb[mpcIndex] / 20);
       
-      Angles bAngle = Angles (qdInfo.azAoa_rad[mpcIndex], qdInfo.elAoa_rad[mpcIndex]);
+      Angles bAngle = Angles (azAoa[mpcIndex], elAoa[mpcIndex]);
       NS_LOG_DEBUG ("bAngle (rx): " << bAngle);
-      Angles aAngle = Angles (qdInfo.azAod_rad[mpcIndex], qdInfo.elAod_rad[mpcIndex]);
+      Angles aAngle = Angles (azAod[mpcIndex], elAod[mpcIndex]);
       NS_LOG_DEBUG ("aAngle (tx): " << aAngle);
       
       // ignore polarization
@@ -574,38 +1033,254 @@ QdChannelModel::GetNewChannel (Ptr<const MobilityModel> aMob,
       double pgTimesGains = pathGain * bElementGain * aElementGain;
       std::complex<double> complexRay = pgTimesGains * std::polar (1.0, initialPhase);
 
-      PhasedArrayModel::ComplexVector bSv = bAntenna->GetSteeringVector (bAngle);
-      NS_ASSERT_MSG (bSv.size () == bSize,
-                     bSv.size () << "!=" << bSize);
-      PhasedArrayModel::ComplexVector aSv = aAntenna->GetSteeringVector (aAngle);
-      NS_ASSERT_MSG (aSv.size () == aSize,
-                     aSv.size () << "!=" << aSize);
-      
+      fillConjSteeringVector (bLoc, bAngle, bSvConj);
+      fillConjSteeringVector (aLoc, aAngle, aSvConj);
+
       for (uint64_t bIndex = 0; bIndex < bSize; ++bIndex)
         {
+          std::complex<double> rayB = complexRay * bSvConj[bIndex];
           for (uint64_t aIndex = 0; aIndex < aSize; ++aIndex)
             {
-              std::complex<double> ray =  complexRay * std::conj (bSv[bIndex]) * std::conj(aSv[aIndex]);
-              H[bIndex][aIndex][0] += ray;
+              H (bIndex, aIndex, 0) += rayB * aSvConj[aIndex];
             }
         }
     }
 
-  channelParams->m_channel = H;
-  channelParams->m_delay = qdInfo.delay_s;
+  channelParams->m_channel = std::move (H);
+  channelParams->m_delay = qdInfo.GetColumnVector (QdInfo::DELAY);
 
   channelParams->m_angle.clear ();
-  channelParams->m_angle.push_back (qdInfo.azAoa_rad);
-  channelParams->m_angle.push_back (qdInfo.elAoa_rad);
-  channelParams->m_angle.push_back (qdInfo.azAod_rad);
-  channelParams->m_angle.push_back (qdInfo.elAod_rad);
-
-  channelParams->m_generatedTime = Simulator::Now ();
-  channelParams->m_nodeIds = std::make_pair (aId, bId);
+  channelParams->m_angle.push_back (qdInfo.GetColumnVector (QdInfo::AZ_AOA));
+  channelParams->m_angle.push_back (qdInfo.GetColumnVector (QdInfo::EL_AOA));
+  channelParams->m_angle.push_back (qdInfo.GetColumnVector (QdInfo::AZ_AOD));
+  channelParams->m_angle.push_back (qdInfo.GetColumnVector (QdInfo::EL_AOD));
 
   return channelParams;
 }
 
+uint64_t
+QdChannelModel::GetArrayGeometryKey (const PhasedArrayModel *antenna)
+{
+  // FNV-1a hash of the element locations and of the element field pattern
+  // in a few directions, which also captures the orientation of the array
+  uint64_t hash = 14695981039346656037ULL;
+  auto add = [&hash] (double value)
+    {
+      uint64_t bits;
+      std::memcpy (&bits, &value, sizeof (bits));
+      for (uint8_t i = 0; i < sizeof (bits); ++i)
+        {
+          hash ^= (bits >> (8 * i)) & 0xff;
+          hash *= 1099511628211ULL;
+        }
+    };
+
+  uint64_t numElements = antenna->GetNumberOfElements ();
+  add (numElements);
+  for (uint64_t i = 0; i < numElements; ++i)
+    {
+      Vector loc = antenna->GetElementLocation (i);
+      add (loc.x);
+      add (loc.y);
+      add (loc.z);
+    }
+  for (const Angles &probe : {Angles (0, M_PI / 2), Angles (M_PI / 3, M_PI / 3), Angles (-M_PI / 2, 2 * M_PI / 3)})
+    {
+      double fieldPattH, fieldPattV;
+      std::tie (fieldPattH, fieldPattV) = antenna->GetElementFieldPattern (probe);
+      add (fieldPattH);
+      add (fieldPattV);
+    }
+  return hash;
+}
+
+bool
+QdChannelModel::CacheKey::operator< (const CacheKey &other) const
+{
+  return std::tie (channelId, timestep, aGeometry, bGeometry)
+         < std::tie (other.channelId, other.timestep, other.aGeometry, other.bGeometry);
+}
+
+Ptr<const MatrixBasedChannelModel::ChannelMatrix>
+QdChannelModel::CacheLookup (const CacheKey &key) const
+{
+  auto it = m_cacheMap.find (key);
+  if (it == m_cacheMap.end ())
+    {
+      return nullptr;
+    }
+  // move the entry to the front of the list
+  m_cacheList.splice (m_cacheList.begin (), m_cacheList, it->second);
+  return it->second->second;
+}
+
+void
+QdChannelModel::CacheInsert (const CacheKey &key, Ptr<const MatrixBasedChannelModel::ChannelMatrix> channelMatrix) const
+{
+  NS_ASSERT (m_cacheSize > 0);
+  auto it = m_cacheMap.find (key);
+  if (it != m_cacheMap.end ())
+    {
+      it->second->second = channelMatrix;
+      m_cacheList.splice (m_cacheList.begin (), m_cacheList, it->second);
+      return;
+    }
+
+  while (m_cacheList.size () >= m_cacheSize)
+    {
+      m_cacheMap.erase (m_cacheList.back ().first);
+      m_cacheList.pop_back ();
+    }
+  m_cacheList.emplace_front (key, channelMatrix);
+  m_cacheMap.insert (std::make_pair (key, m_cacheList.begin ()));
+}
+
+/**
+ * Links assigned to a precompute thread
+ */
+struct QdChannelModel::PrecomputeTask
+{
+  /**
+   * A link to precompute
+   */
+  struct Item
+  {
+    CacheKey key; //!< the cache key of the first timestep
+    const std::vector<QdInfo> *qdInfoVector; //!< the timesteps, if read from a text QD file
+    const QdBinaryTrace *trace; //!< the binary QD trace, if read from a binary QD file
+    const PhasedArrayModel *aAntenna; //!< antenna of the a device
+    const PhasedArrayModel *bAntenna; //!< antenna of the b device
+    std::pair<uint32_t, uint32_t> nodeIds; //!< the IDs of the a and b devices
+    std::vector<Ptr<MatrixBasedChannelModel::ChannelMatrix> > channels; //!< the computed channel matrices, one for each timestep
+  };
+
+  const QdChannelModel *model; //!< the channel model
+  uint64_t numTimesteps; //!< the number of timesteps
+  std::vector<Item> items; //!< the links assigned to the thread
+};
+
+void
+QdChannelModel::PrecomputeWorker (PrecomputeTask *task)
+{
+  // only raw pointers and objects created by this thread are used here, since
+  // the reference counts of the shared objects are not thread safe
+  for (PrecomputeTask::Item &item : task->items)
+    {
+      item.channels.reserve (task->numTimesteps);
+      for (uint64_t t = 0; t < task->numTimesteps; ++t)
+        {
+          if (item.qdInfoVector != nullptr)
+            {
+              item.channels.push_back (task->model->ComputeChannelMatrix (item.qdInfoVector->at (t), item.aAntenna, item.bAntenna));
+            }
+          else
+            {
+              QdInfo qdInfo = item.trace->GetQdInfo (t);
+              item.channels.push_back (task->model->ComputeChannelMatrix (qdInfo, item.aAntenna, item.bAntenna));
+            }
+        }
+    }
+}
+
+void
+QdChannelModel::PrecomputeChannels (const std::vector<PrecomputeLink> &links, uint32_t numThreads)
+{
+  NS_LOG_FUNCTION (this << links.size () << numThreads);
+  NS_ABORT_MSG_IF (numThreads == 0, "At least one thread is needed");
+
+  std::vector<PrecomputeTask> tasks (numThreads);
+  std::set<CacheKey> keys;
+  for (const PrecomputeLink &link : links)
+    {
+      uint32_t aId = link.aMob->GetObject<Node> ()->GetId ();
+      uint32_t bId = link.bMob->GetObject<Node> ()->GetId ();
+      const PhasedArrayModel *aAntenna = PeekPointer (link.aAntenna);
+      const PhasedArrayModel *bAntenna = PeekPointer (link.bAntenna);
+
+      // use the same orientation of GetChannel
+      if (aId > bId)
+        {
+          std::swap (aId, bId);
+          std::swap (aAntenna, bAntenna);
+        }
+      if (m_qdInfoMap.find (GetKey (aId, bId)) == m_qdInfoMap.end ()
+          && m_qdTraceMap.find (GetKey (aId, bId)) == m_qdTraceMap.end ())
+        {
+          std::swap (aId, bId);
+          std::swap (aAntenna, bAntenna);
+        }
+
+      PrecomputeTask::Item item;
+      item.key.channelId = GetKey (aId, bId);
+      item.key.timestep = 0;
+      item.key.aGeometry = GetArrayGeometryKey (aAntenna);
+      item.key.bGeometry = GetArrayGeometryKey (bAntenna);
+      if (!keys.insert (item.key).second)
+        {
+          NS_LOG_LOGIC ("skip link " << aId << "-" << bId << ", already scheduled");
+          continue;
+        }
+
+      auto qdInfoIt = m_qdInfoMap.find (item.key.channelId);
+      auto traceIt = m_qdTraceMap.find (item.key.channelId);
+      NS_ABORT_MSG_IF (qdInfoIt == m_qdInfoMap.end () && traceIt == m_qdTraceMap.end (),
+                       "No QD file found for nodes " << aId << " and " << bId);
+      item.qdInfoVector = (qdInfoIt != m_qdInfoMap.end ()) ? &qdInfoIt->second : nullptr;
+      item.trace = (traceIt != m_qdTraceMap.end ()) ? PeekPointer (traceIt->second) : nullptr;
+      item.aAntenna = aAntenna;
+      item.bAntenna = bAntenna;
+      item.nodeIds = std::make_pair (aId, bId);
+
+      tasks[keys.size () % numThreads].items.push_back (item);
+    }
+
+  NS_ABORT_MSG_IF (keys.size () * m_totTimesteps > m_cacheSize,
+                   "The CacheSize attribute (" << m_cacheSize << ") must be at least " <<
+                   keys.size () * m_totTimesteps << " to precompute the channels");
+
+  for (PrecomputeTask &task : tasks)
+    {
+      task.model = this;
+      task.numTimesteps = m_totTimesteps;
+    }
+
+#ifdef HAVE_PTHREAD_H
+  std::vector<Ptr<SystemThread> > threads;
+  for (uint32_t i = 1; i < numThreads; ++i)
+    {
+      threads.push_back (Create<SystemThread> (MakeBoundCallback (&QdChannelModel::PrecomputeWorker, &tasks[i])));
+      threads.back ()->Start ();
+    }
+  PrecomputeWorker (&tasks[0]);
+  for (auto &thread : threads)
+    {
+      thread->Join ();
+    }
+#else
+  for (PrecomputeTask &task : tasks)
+    {
+      PrecomputeWorker (&task);
+    }
+#endif
+
+  for (PrecomputeTask &task : tasks)
+    {
+      for (PrecomputeTask::Item &item : task.items)
+        {
+          for (uint64_t t = 0; t < item.channels.size (); ++t)
+            {
+              item.channels[t]->m_nodeIds = item.nodeIds;
+              item.channels[t]->m_generatedTime = m_updatePeriod * t;
+              CacheKey key = item.key;
+              key.timestep = t;
+              CacheInsert (key, item.channels[t]);
+            }
+        }
+    }
+
+  NS_LOG_DEBUG ("Precomputed " << keys.size () << " links, " << m_cacheList.size () << " channel matrices in the cache");
+}
+
 uint64_t
 QdChannelModel::GetTimestep (void) const
 {
@@ -21,6 +21,7 @@
 #define QD_CHANNEL_MODEL_H
 
 #include <complex.h>
+#include <list>
 #include <map>
 #include "ns3/angles.h"
 #include "ns3/object.h"
@@ -28,11 +29,13 @@
 #include "ns3/random-variable-stream.h"
 #include "ns3/boolean.h"
 #include "ns3/matrix-based-channel-model.h"
+#include "ns3/qd-binary-trace.h"
 
 namespace ns3 {
 
 class PhasedArrayModel;
 class MobilityModel;
+class QdBinaryTracePrefetcher;
 
 /**
  * \ingroup spectrum
@@ -75,6 +78,31 @@ public:
                                                                 Ptr<const PhasedArrayModel> aAntenna,
                                                                 Ptr<const PhasedArrayModel> bAntenna) override;
 
+  /**
+   * Pair of devices whose channel matrices can be precomputed
+   */
+  struct PrecomputeLink
+  {
+    Ptr<const MobilityModel> aMob; //!< mobility model of the a device
+    Ptr<const MobilityModel> bMob; //!< mobility model of the b device
+    Ptr<const PhasedArrayModel> aAntenna; //!< antenna of the a device
+    Ptr<const PhasedArrayModel> bAntenna; //!< antenna of the b device
+  };
+
+  /**
+   * Computes the channel matrices of all the timesteps for the given pairs
+   * of devices and stores them in the channel cache, so that GetChannel
+   * does not compute them during the simulation. The pairs are distributed
+   * among numThreads threads. Reciprocal pairs are computed once.
+   * The CacheSize attribute must be large enough to store all the matrices,
+   * and the antenna arrays must not be reconfigured afterwards, otherwise
+   * the precomputed matrices are not used.
+   *
+   * \param links the pairs of devices
+   * \param numThreads the number of threads
+   */
+  void PrecomputeChannels (const std::vector<PrecomputeLink> &links, uint32_t numThreads = 1);
+
   /*
    * Set the folder path containing the scenario of interest
    *
@@ -105,6 +133,19 @@ public:
    */
   std::string GetScenario () const;
 
+  /**
+   * Converts the QD files of a scenario, i.e., the text files in the
+   * Output/Ns3/QdFiles/ folder, to the binary format described in
+   * QdBinaryTrace. For each TxNRxM.txt file, a TxNRxM.qdbin file is written
+   * in the same folder. When the scenario is set, the binary file of a node
+   * pair is memory-mapped and its text file is ignored, unless the text file
+   * has been modified after the binary file.
+   *
+   * \param path folder path containing the scenario of interest
+   * \param scenario scenario folder name, containg the Input/ and the Output/Ns3/ folders
+   */
+  static void ConvertQdFiles (std::string path, std::string scenario);
+
   /**
    * Returns the center frequency
    * \return the center frequency in Hz
@@ -117,6 +158,55 @@ public:
    */
   Time GetQdSimTime () const;
 
+  /**
+   * Get the total number of timesteps
+   * \return the number of timesteps considered in the qd files
+   */
+  uint32_t GetNumTimesteps () const;
+
+  /**
+   * Get the multipath components of a node pair for a given timestep.
+   * If the StreamingWindow attribute is greater than 0, the timesteps of the
+   * binary QD files before the requested one are evicted from memory, and
+   * the following ones are prefetched in background.
+   *
+   * \param key the key of the node pair
+   * \param timestep the timestep
+   * \return the multipath components, valid until the next call
+   */
+  const QdInfo& GetQdInfo (uint32_t key, uint64_t timestep) const;
+
+  /**
+   * Get the keys of the node pairs with a QD file
+   * \return the keys of the node pairs, in increasing order
+   */
+  std::vector<uint32_t> GetQdKeys (void) const;
+
+  /**
+   * Get the number of node pairs read from the text QD files
+   * \return the number of node pairs read from the text QD files
+   */
+  uint32_t GetNumTextQdFiles (void) const;
+
+  /**
+   * Get the number of node pairs read from the binary QD files
+   * \return the number of node pairs read from the binary QD files
+   */
+  uint32_t GetNumBinaryQdFiles (void) const;
+
+  /**
+   * Get the timesteps of the binary QD file of a node pair which are
+   * materialized in memory. The prefetched timesteps are included only once
+   * they have been collected by GetQdInfo.
+   *
+   * \param key the key of the node pair
+   * \return the resident timesteps, in increasing order
+   */
+  std::vector<uint64_t> GetResidentTimesteps (uint32_t key) const;
+
+protected:
+  void DoDispose (void) override;
+
 private:
   using RtIdToNs3IdMap_t = std::map<uint32_t, uint32_t>;
   using Ns3IdToRtIdMap_t = std::map<uint32_t, uint32_t>;
@@ -149,6 +239,75 @@ private:
                                                                    Ptr<const PhasedArrayModel> aAntenna,
                                                                    Ptr<const PhasedArrayModel> bAntenna) const;
 
+  /**
+   * Compute the channel matrix between a and b from the multipath components
+   * of a timestep. This method only reads the arguments and m_frequency,
+   * hence it can be called by the precompute threads.
+   *
+   * \param qdInfo the multipath components
+   * \param aAntenna antenna of the a device
+   * \param bAntenna antenna of the b device
+   * \return the channel matrix, with the m_channel, m_delay and m_angle fields set
+   */
+  Ptr<MatrixBasedChannelModel::ChannelMatrix> ComputeChannelMatrix (const QdInfo &qdInfo,
+                                                                    const PhasedArrayModel *aAntenna,
+                                                                    const PhasedArrayModel *bAntenna) const;
+
+  /**
+   * Get a key identifying the geometry of an antenna array, i.e., the
+   * element locations and the element field pattern. Arrays with the same
+   * key produce the same channel matrices.
+   *
+   * \param antenna the antenna array
+   * \return the key
+   */
+  static uint64_t GetArrayGeometryKey (const PhasedArrayModel *antenna);
+
+  /**
+   * Key of the channel cache
+   */
+  struct CacheKey
+  {
+    uint32_t channelId; //!< key of the node pair
+    uint64_t timestep; //!< the timestep
+    uint64_t aGeometry; //!< geometry key of the antenna of the a device
+    uint64_t bGeometry; //!< geometry key of the antenna of the b device
+
+    /**
+     * Strict weak ordering
+     * \param other the other key
+     * \return true if this key is lower than other
+     */
+    bool operator< (const CacheKey &other) const;
+  };
+
+  /**
+   * Look for a channel matrix in the cache, and mark it as the most
+   * recently used
+   *
+   * \param key the key
+   * \return the channel matrix, or nullptr if not found
+   */
+  Ptr<const MatrixBasedChannelModel::ChannelMatrix> CacheLookup (const CacheKey &key) const;
+
+  /**
+   * Insert a channel matrix in the cache, evicting the least recently used
+   * one if the cache is full
+   *
+   * \param key the key
+   * \param channelMatrix the channel matrix
+   */
+  void CacheInsert (const CacheKey &key, Ptr<const MatrixBasedChannelModel::ChannelMatrix> channelMatrix) const;
+
+  struct PrecomputeTask;
+
+  /**
+   * Body of the precompute threads
+   *
+   * \param task the links assigned to the thread
+   */
+  static void PrecomputeWorker (PrecomputeTask *task);
+
   /**
    * Check if the channel matrix has to be updated
    * \param channelMatrix channel matrix
@@ -180,18 +339,37 @@ private:
   RtIdToNs3IdMap_t ReadNodesPosition (void);
 
   /**
-   * Read all QdFiles for the given scenario
+   * Read all QdFiles for the given scenario. Binary QD files are
+   * memory-mapped, and their timesteps are materialized on first access by
+   * GetQdInfo. The text QD file of a node pair is parsed only if it has no
+   * binary QD file, or if the binary QD file is older than the text one.
    * \param rtIdToNs3IdMap a map between user file name to ns-3 user ID
    */
   void ReadQdFiles (RtIdToNs3IdMap_t rtIdToNs3IdMap);
 
+  /**
+   * Parse a text QD file
+   *
+   * \param fileName the name of the QD file
+   * \return the multipath components of each timestep
+   */
+  static std::vector<QdInfo> ReadQdTextFile (const std::string& fileName);
+
   /**
    * Get the list of QD file names in the given path
    *
    * \param pattern glob pattern for QD files
    * \return list of QD file names
    */
-  std::vector<std::string> GetQdFilesList (const std::string& pattern);
+  static std::vector<std::string> GetQdFilesList (const std::string& pattern);
+
+  /**
+   * Get the RT node IDs from the name of a QD file, i.e., TxNRxM.*
+   *
+   * \param fileName name of the QD file
+   * \return the pair (N, M)
+   */
+  static std::pair<uint32_t, uint32_t> GetRtIdsFromFileName (const std::string& fileName);
 
   /**
    * Parse numerice CSV string
@@ -199,7 +377,7 @@ private:
    * \param str CSV-formatted string
    * \return vector of parsed numeric values
    */
-  std::vector<double> ParseCsv (const std::string& str);
+  static std::vector<double> ParseCsv (const std::string& str);
 
   /**
    * Trim folder name in order to avoid '/' at the beginning of the file name
@@ -209,29 +387,23 @@ private:
    */
   static void TrimFolderName (std::string& folder);
 
-  /*
-   * Structure containing information parsed from QdFiles
-   */
-  struct QdInfo
-  {
-    uint64_t numMpcs;
-    std::vector<double> delay_s;
-    std::vector<double> pathGain_dbpow;
-    std::vector<double> phase_rad;
-    std::vector<double> elAod_rad;
-    std::vector<double> azAod_rad;
-    std::vector<double> elAoa_rad;
-    std::vector<double> azAoa_rad;
-  };
-
   std::map<uint32_t, Ptr<const MatrixBasedChannelModel::ChannelMatrix> > m_channelMap; //!< map containing the channel realizations indexed by channel key
+  using CacheList_t = std::list<std::pair<CacheKey, Ptr<const MatrixBasedChannelModel::ChannelMatrix> > >;
+  mutable CacheList_t m_cacheList; //!< the cached channel matrices, from the most to the least recently used
+  mutable std::map<CacheKey, CacheList_t::iterator> m_cacheMap; //!< map containing the position of each cached channel matrix in m_cacheList
+  uint32_t m_cacheSize; //!< maximum number of cached channel matrices, 0 to disable the cache
   Time m_updatePeriod; //!< the channel update period
   uint32_t m_totTimesteps; //!< total number of timesteps for the simulation
   Time m_totalTimeDuration; //!< duration of the simulation
   double m_frequency; //!< the operating frequency [Hz]
   std::vector<Vector3D> m_nodePositionList; //!< initial position of each node
 
-  std::map<uint32_t, std::vector<QdInfo> > m_qdInfoMap; //!< map containing QD-related information for each node pair
+  std::map<uint32_t, std::vector<QdInfo> > m_qdInfoMap; //!< map containing QD-related information for each node pair, parsed from the text QD files
+  std::map<uint32_t, Ptr<const QdBinaryTrace> > m_qdTraceMap; //!< map containing the memory-mapped binary QD file of each node pair
+  mutable std::map<uint32_t, std::map<uint64_t, QdInfo> > m_qdTraceInfoMap; //!< map containing the timesteps materialized from the binary QD files
+  uint32_t m_streamingWindow; //!< number of timesteps of the binary QD files prefetched ahead of the current one, 0 to disable streaming
+  mutable std::map<uint32_t, uint64_t> m_prefetchNextTimestep; //!< map containing the next timestep to prefetch for each node pair
+  mutable Ptr<QdBinaryTracePrefetcher> m_prefetcher; //!< materializes the timesteps of the binary QD files in background
   Ns3IdToRtIdMap_t m_ns3IdToRtIdMap; //!< map containing a conversion from ns-3 node id to qd-realization node id
 
   std::string m_path; //!< folder path containing the scenario of interest
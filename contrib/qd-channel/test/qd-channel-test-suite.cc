@@ -2,6 +2,16 @@
 
 // Include a header file from your module to test.
 #include "ns3/qd-channel-model.h"
+#include "ns3/qd-binary-trace.h"
+#include "ns3/node-container.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/uniform-planar-array.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/system-path.h"
+#include <ctime>
+#include <fstream>
+#include <utime.h>
 
 // An essential include is test.h
 #include "ns3/test.h"
@@ -46,6 +56,361 @@ QdChannelTestCase1::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ_TOL (0.01, 0.01, 0.001, "Numbers are not equal within tolerance");
 }
 
+/**
+ * Test case for the binary QD trace format: writes a trace with
+ * QdBinaryTrace::Write, maps it and checks that the multipath components
+ * of each timestep are read back unchanged
+ */
+class QdBinaryTraceTestCase : public TestCase
+{
+public:
+  QdBinaryTraceTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+QdBinaryTraceTestCase::QdBinaryTraceTestCase ()
+  : TestCase ("Check the binary QD trace write and read round trip")
+{
+}
+
+void
+QdBinaryTraceTestCase::DoRun (void)
+{
+  std::vector<QdInfo> qdInfoVector;
+  for (uint64_t t = 0; t < 4; ++t)
+    {
+      // the second timestep has no multipath components
+      QdInfo qdInfo ((t == 1) ? 0 : t + 2);
+      for (uint64_t m = 0; m < qdInfo.numMpcs; ++m)
+        {
+          double v = t * 100.0 + m;
+          qdInfo.GetColumn (QdInfo::DELAY)[m] = v * 1e-9;
+          qdInfo.GetColumn (QdInfo::PATH_GAIN)[m] = -v;
+          qdInfo.GetColumn (QdInfo::PHASE)[m] = v / 100;
+          qdInfo.GetColumn (QdInfo::EL_AOD)[m] = v / 200;
+          qdInfo.GetColumn (QdInfo::AZ_AOD)[m] = v / 300;
+          qdInfo.GetColumn (QdInfo::EL_AOA)[m] = v / 400;
+          qdInfo.GetColumn (QdInfo::AZ_AOA)[m] = v / 500;
+        }
+      qdInfoVector.push_back (qdInfo);
+    }
+
+  std::string fileName = CreateTempDirFilename ("Tx0Rx1.qdbin");
+  QdBinaryTrace::Write (fileName, qdInfoVector);
+
+  Ptr<const QdBinaryTrace> trace = Create<const QdBinaryTrace> (fileName);
+  NS_TEST_ASSERT_MSG_EQ (trace->GetNumTimesteps (), qdInfoVector.size (), "wrong number of timesteps");
+  for (uint64_t t = 0; t < qdInfoVector.size (); ++t)
+    {
+      const QdInfo &expected = qdInfoVector[t];
+      QdInfo actual = trace->GetQdInfo (t);
+      NS_TEST_ASSERT_MSG_EQ (trace->GetNumMpcs (t), expected.numMpcs, "wrong number of MPCs, timestep=" << t);
+      NS_TEST_ASSERT_MSG_EQ (actual.numMpcs, expected.numMpcs, "wrong number of MPCs, timestep=" << t);
+      NS_TEST_EXPECT_MSG_EQ ((actual.data == expected.data), true, "wrong multipath components, timestep=" << t);
+      if (expected.numMpcs > 0)
+        {
+          NS_TEST_EXPECT_MSG_EQ (trace->GetColumn (t, QdInfo::AZ_AOA)[expected.numMpcs - 1],
+                                 expected.GetColumn (QdInfo::AZ_AOA)[expected.numMpcs - 1], "wrong column access, timestep=" << t);
+        }
+    }
+}
+
+/**
+ * Copy the Indoor1 scenario, whose QD files are in text format, to a
+ * temporary folder
+ * \param path the temporary folder
+ */
+static void
+CopyIndoor1Scenario (std::string path)
+{
+  std::string source = std::string (NS_TEST_SOURCEDIR) + "/../model/QD/Indoor1/";
+  for (std::string folder : {"Input/", "Output/Ns3/NodesPosition/", "Output/Ns3/QdFiles/"})
+    {
+      SystemPath::MakeDirectories (path + "Indoor1/" + folder);
+      for (std::string fileName : SystemPath::ReadFiles (source + folder))
+        {
+          if (fileName[0] == '.')
+            {
+              continue;
+            }
+          std::ifstream in ((source + folder + fileName).c_str (), std::ios::binary);
+          std::ofstream out ((path + "Indoor1/" + folder + fileName).c_str (), std::ios::binary);
+          out << in.rdbuf ();
+        }
+    }
+}
+
+/**
+ * Create two nodes in the initial positions of the ray tracer of the
+ * Indoor1 scenario
+ * \return the nodes
+ */
+static NodeContainer
+CreateIndoor1Nodes (void)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+  Ptr<MobilityModel> aMob = CreateObject<ConstantPositionMobilityModel> ();
+  aMob->SetPosition (Vector (5, 0.1, 2.9));
+  nodes.Get (0)->AggregateObject (aMob);
+  Ptr<MobilityModel> bMob = CreateObject<ConstantPositionMobilityModel> ();
+  bMob->SetPosition (Vector (5, 0.1, 1.5));
+  nodes.Get (1)->AggregateObject (bMob);
+  return nodes;
+}
+
+/**
+ * Test case for the choice between the text and the binary QD file of each
+ * node pair: the QD files of the Indoor1 scenario are converted, then the
+ * binary file of one pair is made older than its text file, so that the
+ * text file is read for that pair only
+ */
+class QdChannelFormatTestCase : public TestCase
+{
+public:
+  QdChannelFormatTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+QdChannelFormatTestCase::QdChannelFormatTestCase ()
+  : TestCase ("Check the choice of the QD file format of each node pair")
+{
+}
+
+void
+QdChannelFormatTestCase::DoRun (void)
+{
+  NodeContainer nodes = CreateIndoor1Nodes ();
+  Ptr<QdChannelModel> text = CreateObject<QdChannelModel> (std::string (NS_TEST_SOURCEDIR) + "/../model/QD/", "Indoor1");
+  NS_TEST_ASSERT_MSG_EQ (text->GetNumTextQdFiles (), 2, "the text QD files should be read");
+
+  std::string path = CreateTempDirFilename ("qd-format") + "/";
+  CopyIndoor1Scenario (path);
+  QdChannelModel::ConvertQdFiles (path, "Indoor1");
+
+  Ptr<QdChannelModel> binary = CreateObject<QdChannelModel> (path, "Indoor1");
+  NS_TEST_ASSERT_MSG_EQ (binary->GetNumBinaryQdFiles (), 2, "the binary QD files should be read");
+  NS_TEST_ASSERT_MSG_EQ (binary->GetNumTextQdFiles (), 0, "the text QD files should not be read");
+
+  // the text file of Tx1Rx0 is now newer than its binary file
+  std::string binFileName = path + "Indoor1/Output/Ns3/QdFiles/Tx1Rx0.qdbin";
+  struct utimbuf times;
+  times.actime = std::time (nullptr) - 1000;
+  times.modtime = times.actime;
+  NS_TEST_ASSERT_MSG_EQ (utime (binFileName.c_str (), &times), 0, "unable to set the modification time");
+
+  Ptr<QdChannelModel> mixed = CreateObject<QdChannelModel> (path, "Indoor1");
+  NS_TEST_ASSERT_MSG_EQ (mixed->GetNumBinaryQdFiles (), 1, "only the up to date binary QD file should be read");
+  NS_TEST_ASSERT_MSG_EQ (mixed->GetNumTextQdFiles (), 1, "the text QD file newer than its binary file should be read");
+
+  // both formats give the same multipath components
+  for (uint32_t key : text->GetQdKeys ())
+    {
+      for (uint64_t t = 0; t < text->GetNumTimesteps (); ++t)
+        {
+          const QdInfo &expected = text->GetQdInfo (key, t);
+          NS_TEST_ASSERT_MSG_EQ ((binary->GetQdInfo (key, t).data == expected.data), true,
+                                 "wrong binary multipath components, key=" << key << " timestep=" << t);
+          NS_TEST_ASSERT_MSG_EQ ((mixed->GetQdInfo (key, t).data == expected.data), true,
+                                 "wrong multipath components, key=" << key << " timestep=" << t);
+        }
+    }
+
+  text->Dispose ();
+  binary->Dispose ();
+  mixed->Dispose ();
+  Simulator::Destroy ();
+}
+
+/**
+ * Test case for the streaming of the binary QD files: every timestep of the
+ * Indoor1 scenario is read with a StreamingWindow of 0, with a short window
+ * and with a window larger than the whole trace, and compared with the text
+ * QD files. With streaming, the timesteps before the current one must have
+ * been evicted, and at most the prefetched window must be resident
+ */
+class QdChannelStreamingTestCase : public TestCase
+{
+public:
+  QdChannelStreamingTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+QdChannelStreamingTestCase::QdChannelStreamingTestCase ()
+  : TestCase ("Check the streaming of the binary QD files")
+{
+}
+
+void
+QdChannelStreamingTestCase::DoRun (void)
+{
+  NodeContainer nodes = CreateIndoor1Nodes ();
+  Ptr<QdChannelModel> text = CreateObject<QdChannelModel> (std::string (NS_TEST_SOURCEDIR) + "/../model/QD/", "Indoor1");
+  NS_TEST_ASSERT_MSG_EQ (text->GetNumTextQdFiles (), 2, "the text QD files should be read");
+  uint32_t numTimesteps = text->GetNumTimesteps ();
+
+  std::string path = CreateTempDirFilename ("qd-streaming") + "/";
+  CopyIndoor1Scenario (path);
+  QdChannelModel::ConvertQdFiles (path, "Indoor1");
+
+  std::vector<uint32_t> windows = {0u, 8u, numTimesteps + 10};
+  std::vector<Ptr<QdChannelModel> > models;
+  for (uint32_t window : windows)
+    {
+      Ptr<QdChannelModel> model = CreateObject<QdChannelModel> (path, "Indoor1");
+      model->SetAttribute ("StreamingWindow", UintegerValue (window));
+      NS_TEST_ASSERT_MSG_EQ (model->GetNumBinaryQdFiles (), 2, "the binary QD files should be read");
+      models.push_back (model);
+    }
+
+  // the node pairs are read alternately, as during a simulation
+  for (uint64_t t = 0; t < numTimesteps; ++t)
+    {
+      for (uint32_t key : text->GetQdKeys ())
+        {
+          const QdInfo &expected = text->GetQdInfo (key, t);
+          for (uint32_t i = 0; i < models.size (); ++i)
+            {
+              NS_TEST_ASSERT_MSG_EQ ((models[i]->GetQdInfo (key, t).data == expected.data), true,
+                                     "wrong multipath components, window=" << windows[i]
+                                                                           << " key=" << key << " timestep=" << t);
+
+              std::vector<uint64_t> resident = models[i]->GetResidentTimesteps (key);
+              if (windows[i] == 0)
+                {
+                  NS_TEST_ASSERT_MSG_EQ (resident.size (), t + 1, "every timestep read should be kept without streaming");
+                }
+              else
+                {
+                  NS_TEST_ASSERT_MSG_EQ (resident.front (), t, "the previous timesteps should be evicted, timestep=" << t);
+                  NS_TEST_ASSERT_MSG_LT_OR_EQ (resident.back (), std::min<uint64_t> (t + windows[i], numTimesteps - 1),
+                                               "the timesteps beyond the window should not be resident, timestep=" << t);
+                }
+            }
+        }
+    }
+
+  text->Dispose ();
+  for (Ptr<QdChannelModel> model : models)
+    {
+      model->Dispose ();
+    }
+  Simulator::Destroy ();
+}
+
+/**
+ * Test case for the channel matrix cache of the QdChannelModel: the channel
+ * matrices of the Indoor1 scenario are precomputed, and compared during the
+ * simulation with the ones computed by a model without cache
+ */
+class QdChannelCacheTestCase : public TestCase
+{
+public:
+  QdChannelCacheTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Compare the channel matrices of the two models
+   * \param timestep the expected timestep
+   */
+  void Check (uint64_t timestep);
+
+  Ptr<QdChannelModel> m_reference; //!< the model without cache
+  Ptr<QdChannelModel> m_cached; //!< the model with precomputed channels
+  Ptr<MobilityModel> m_aMob; //!< mobility model of the a device
+  Ptr<MobilityModel> m_bMob; //!< mobility model of the b device
+  Ptr<PhasedArrayModel> m_aAntenna; //!< antenna of the a device
+  Ptr<PhasedArrayModel> m_bAntenna; //!< antenna of the b device
+  Time m_updatePeriod; //!< the QD timestep duration
+};
+
+QdChannelCacheTestCase::QdChannelCacheTestCase ()
+  : TestCase ("Check the precomputed channel matrices of the QdChannelModel")
+{
+}
+
+void
+QdChannelCacheTestCase::Check (uint64_t timestep)
+{
+  Ptr<const MatrixBasedChannelModel::ChannelMatrix> expected = m_reference->GetChannel (m_aMob, m_bMob, m_aAntenna, m_bAntenna);
+  Ptr<const MatrixBasedChannelModel::ChannelMatrix> actual = m_cached->GetChannel (m_aMob, m_bMob, m_aAntenna, m_bAntenna);
+
+  // the precomputed matrices are generated at the beginning of the timestep
+  NS_TEST_EXPECT_MSG_EQ (actual->m_generatedTime, m_updatePeriod * timestep, "channel matrix not precomputed");
+  NS_TEST_EXPECT_MSG_EQ ((actual->m_nodeIds == expected->m_nodeIds), true, "wrong node IDs");
+
+  // reciprocal pairs share the same realization
+  Ptr<const MatrixBasedChannelModel::ChannelMatrix> reverse = m_cached->GetChannel (m_bMob, m_aMob, m_bAntenna, m_aAntenna);
+  NS_TEST_EXPECT_MSG_EQ (reverse, actual, "reciprocal pairs do not share the channel matrix");
+
+  const MatrixBasedChannelModel::ComplexTensor3D &hExpected = expected->m_channel;
+  const MatrixBasedChannelModel::ComplexTensor3D &hActual = actual->m_channel;
+  NS_TEST_ASSERT_MSG_EQ (hActual.GetNumClusters (), hExpected.GetNumClusters (), "wrong number of clusters");
+  for (size_t u = 0; u < hExpected.GetUSize (); ++u)
+    {
+      for (size_t s = 0; s < hExpected.GetSSize (); ++s)
+        {
+          for (size_t n = 0; n < hExpected.GetNumClusters (); ++n)
+            {
+              NS_TEST_EXPECT_MSG_LT (std::abs (hActual (u, s, n) - hExpected (u, s, n)), 1e-12 * std::abs (hExpected (u, s, n)) + 1e-300,
+                                     "wrong channel coefficient, timestep=" << timestep);
+            }
+        }
+    }
+}
+
+void
+QdChannelCacheTestCase::DoRun (void)
+{
+  // the nodes have to be placed in the initial positions of the ray tracer
+  NodeContainer nodes;
+  nodes.Create (2);
+  m_aMob = CreateObject<ConstantPositionMobilityModel> ();
+  m_aMob->SetPosition (Vector (5, 0.1, 2.9));
+  nodes.Get (0)->AggregateObject (m_aMob);
+  m_bMob = CreateObject<ConstantPositionMobilityModel> ();
+  m_bMob->SetPosition (Vector (5, 0.1, 1.5));
+  nodes.Get (1)->AggregateObject (m_bMob);
+
+  m_aAntenna = CreateObjectWithAttributes<UniformPlanarArray> ("NumColumns", UintegerValue (2), "NumRows", UintegerValue (2));
+  m_bAntenna = CreateObjectWithAttributes<UniformPlanarArray> ("NumColumns", UintegerValue (4), "NumRows", UintegerValue (1));
+
+  std::string qdFilesPath = std::string (NS_TEST_SOURCEDIR) + "/../model/QD/";
+  m_reference = CreateObject<QdChannelModel> (qdFilesPath, "Indoor1");
+  m_cached = CreateObject<QdChannelModel> (qdFilesPath, "Indoor1");
+  uint64_t numTimesteps = m_cached->GetNumTimesteps ();
+  NS_TEST_ASSERT_MSG_GT (numTimesteps, 100, "The Indoor1 scenario should have more than 100 timesteps");
+  m_updatePeriod = m_cached->GetQdSimTime () / numTimesteps;
+  m_cached->SetAttribute ("CacheSize", UintegerValue (numTimesteps));
+
+  // the same pair in both directions, precomputed only once
+  std::vector<QdChannelModel::PrecomputeLink> links (2);
+  links[0].aMob = m_aMob;
+  links[0].bMob = m_bMob;
+  links[0].aAntenna = m_aAntenna;
+  links[0].bAntenna = m_bAntenna;
+  links[1].aMob = m_bMob;
+  links[1].bMob = m_aMob;
+  links[1].aAntenna = m_bAntenna;
+  links[1].bAntenna = m_aAntenna;
+  m_cached->PrecomputeChannels (links, 2);
+
+  for (uint64_t timestep : std::vector<uint64_t> {0, 1, 100, numTimesteps - 1})
+    {
+      Simulator::Schedule (m_updatePeriod * timestep + MicroSeconds (100), &QdChannelCacheTestCase::Check, this, timestep);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
 // The TestSuite class names the TestSuite, identifies what type of TestSuite,
 // and enables the TestCases to be run.  Typically, only the constructor for
 // this class must be defined
@@ -61,6 +426,10 @@ QdChannelTestSuite::QdChannelTestSuite ()
 {
   // TestDuration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
   AddTestCase (new QdChannelTestCase1, TestCase::QUICK);
+  AddTestCase (new QdBinaryTraceTestCase, TestCase::QUICK);
+  AddTestCase (new QdChannelFormatTestCase, TestCase::QUICK);
+  AddTestCase (new QdChannelStreamingTestCase, TestCase::QUICK);
+  AddTestCase (new QdChannelCacheTestCase, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite
@@ -31,7 +31,11 @@ NS_LOG_COMPONENT_DEFINE ("PhasedArrayModel");
 NS_OBJECT_ENSURE_REGISTERED (PhasedArrayModel);
 
 
+uint64_t PhasedArrayModel::m_lastBeamformingVectorEpoch = 0;
+
+
 PhasedArrayModel::PhasedArrayModel ()
+  : m_beamformingVectorEpoch (++m_lastBeamformingVectorEpoch)
 {
 }
 
@@ -65,10 +69,11 @@ PhasedArrayModel::SetBeamformingVector (const ComplexVector &beamformingVector)
   NS_ASSERT_MSG (beamformingVector.size () == GetNumberOfElements (),
                  beamformingVector.size () << " != " << GetNumberOfElements ());
   m_beamformingVector = beamformingVector;
+  m_beamformingVectorEpoch = ++m_lastBeamformingVectorEpoch;
 }
 
 
-PhasedArrayModel::ComplexVector
+const PhasedArrayModel::ComplexVector &
 PhasedArrayModel::GetBeamformingVector () const
 {
   NS_LOG_FUNCTION (this);
@@ -76,6 +81,13 @@ PhasedArrayModel::GetBeamformingVector () const
 }
 
 
+uint64_t
+PhasedArrayModel::GetBeamformingVectorEpoch () const
+{
+  return m_beamformingVectorEpoch;
+}
+
+
 double
 PhasedArrayModel::ComputeNorm (const ComplexVector &vector)
 {
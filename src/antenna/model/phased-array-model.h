@@ -89,10 +89,24 @@ public:
 
 
   /**
-   * Returns the beamforming vector that is currently being used
+   * Returns the beamforming vector that is currently being used.
+   * The reference is valid until the beamforming vector is set again, use
+   * GetBeamformingVectorEpoch to detect changes without copying the vector.
    * \return the current beamforming vector
    */
-  ComplexVector GetBeamformingVector (void) const;
+  const ComplexVector &GetBeamformingVector (void) const;
+
+
+  /**
+   * Returns the epoch of the beamforming vector that is currently being used.
+   * The epoch is updated every time the beamforming vector is set, and it is
+   * unique among all the PhasedArrayModel instances, therefore two equal
+   * epochs always refer to the same beamforming vector of the same array.
+   * It can be used to check whether cached quantities depending on the
+   * beamforming vector are still valid, without comparing the vectors.
+   * \return the epoch of the current beamforming vector
+   */
+  uint64_t GetBeamformingVectorEpoch (void) const;
 
 
   /**
@@ -130,6 +144,10 @@ protected:
   ComplexVector m_beamformingVector; //!< the beamforming vector in use
   Ptr<AntennaModel> m_antennaElement; //!< the model of the antenna element in use
 
+private:
+  uint64_t m_beamformingVectorEpoch; //!< the epoch of the beamforming vector in use
+  static uint64_t m_lastBeamformingVectorEpoch; //!< the last epoch assigned to a beamforming vector
+
 };
 
 } /* namespace ns3 */
@@ -99,7 +99,7 @@ UniformPlanarArray::SetNumColumns (uint32_t n)
 {
   NS_LOG_FUNCTION (this << n);
   m_numColumns = n;
-  m_beamformingVector = ComplexVector (GetNumberOfElements (), std::complex<double> (0, 0));
+  SetBeamformingVector (ComplexVector (GetNumberOfElements (), std::complex<double> (0, 0)));
 }
 
 
@@ -115,7 +115,7 @@ UniformPlanarArray::SetNumRows (uint32_t n)
 {
   NS_LOG_FUNCTION (this << n);
   m_numRows = n;
-  m_beamformingVector = ComplexVector (GetNumberOfElements (), std::complex<double> (0, 0));
+  SetBeamformingVector (ComplexVector (GetNumberOfElements (), std::complex<double> (0, 0)));
 }
 
 
@@ -131,7 +131,7 @@ UniformPlanarArray::SetAntennaHorizontalSpacing (double s)
 {
   NS_LOG_FUNCTION (this << s);
   m_disH = s;
-  m_beamformingVector = ComplexVector (GetNumberOfElements (), std::complex<double> (0, 0));
+  SetBeamformingVector (ComplexVector (GetNumberOfElements (), std::complex<double> (0, 0)));
 }
 
 
@@ -147,7 +147,7 @@ UniformPlanarArray::SetAntennaVerticalSpacing (double s)
 {
   NS_LOG_FUNCTION (this << s);
   m_disV = s;
-  m_beamformingVector = ComplexVector (GetNumberOfElements (), std::complex<double> (0, 0));
+  SetBeamformingVector (ComplexVector (GetNumberOfElements (), std::complex<double> (0, 0)));
 }
 
 
@@ -153,6 +153,46 @@ UniformPlanarArrayTestCase::DoRun ()
 }
 
 
+/**
+ * Test case checking that the beamforming vector epoch changes every time
+ * the beamforming vector is set, and that it is unique among the arrays
+ */
+class UniformPlanarArrayEpochTestCase : public TestCase
+{
+public:
+  UniformPlanarArrayEpochTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+UniformPlanarArrayEpochTestCase::UniformPlanarArrayEpochTestCase ()
+  : TestCase ("Check the epoch of the beamforming vector")
+{
+}
+
+void
+UniformPlanarArrayEpochTestCase::DoRun ()
+{
+  Ptr<UniformPlanarArray> a = CreateObject<UniformPlanarArray> ();
+  Ptr<UniformPlanarArray> b = CreateObject<UniformPlanarArray> ();
+  NS_TEST_EXPECT_MSG_NE (a->GetBeamformingVectorEpoch (), b->GetBeamformingVectorEpoch (), "different arrays share the same epoch");
+
+  uint64_t epoch = a->GetBeamformingVectorEpoch ();
+  a->SetAttribute ("NumRows", UintegerValue (2));
+  NS_TEST_EXPECT_MSG_NE (a->GetBeamformingVectorEpoch (), epoch, "epoch not updated when resizing the array");
+
+  epoch = a->GetBeamformingVectorEpoch ();
+  PhasedArrayModel::ComplexVector bf = a->GetBeamformingVector ();
+  a->SetBeamformingVector (bf);
+  NS_TEST_EXPECT_MSG_GT (a->GetBeamformingVectorEpoch (), epoch, "epoch not increased when setting the beamforming vector");
+
+  epoch = a->GetBeamformingVectorEpoch ();
+  b->SetBeamformingVector (b->GetBeamformingVector ());
+  NS_TEST_EXPECT_MSG_EQ (a->GetBeamformingVectorEpoch (), epoch, "epoch updated by another array");
+}
+
+
 class UniformPlanarArrayTestSuite : public TestSuite
 {
 public:
@@ -187,6 +227,8 @@ UniformPlanarArrayTestSuite::UniformPlanarArrayTestSuite ()
   AddTestCase (new UniformPlanarArrayTestCase (     tgpp,   10,   10,      0.5,      0.5, DegreesToRadians   (0), DegreesToRadians   (0),  Angles(DegreesToRadians   (0), DegreesToRadians   (90)),           28.0,    TestCondition::EQUAL), TestCase::QUICK);
   AddTestCase (new UniformPlanarArrayTestCase (     tgpp,   10,   10,      0.5,      0.5, DegreesToRadians  (90), DegreesToRadians   (0),  Angles(DegreesToRadians  (90), DegreesToRadians   (90)),           28.0,    TestCondition::EQUAL), TestCase::QUICK);
   AddTestCase (new UniformPlanarArrayTestCase (     tgpp,   10,   10,      0.5,      0.5, DegreesToRadians   (0), DegreesToRadians  (45),  Angles(DegreesToRadians   (0), DegreesToRadians  (135)),           28.0,    TestCondition::EQUAL), TestCase::QUICK);
+
+  AddTestCase (new UniformPlanarArrayEpochTestCase (), TestCase::QUICK);
 };
 
 static UniformPlanarArrayTestSuite staticUniformPlanarArrayTestSuiteInstance;
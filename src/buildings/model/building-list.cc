@@ -32,6 +32,12 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("BuildingList");
 
+/**
+ * \brief counter of the modifications of the buildings, never reset so that
+ * it keeps increasing also when the list is destroyed and created again.
+ */
+static uint64_t g_buildingListModificationCount = 0;
+
 /**
  * \brief private implementation detail of the BuildingList API.
  */
@@ -96,6 +102,7 @@ BuildingListPriv::Delete (void)
   NS_LOG_FUNCTION_NOARGS ();
   Config::UnregisterRootNamespaceObject (Get ());
   (*DoGet ()) = 0;
+  g_buildingListModificationCount++;
 }
 
 
@@ -127,6 +134,7 @@ BuildingListPriv::Add (Ptr<Building> building)
 {
   uint32_t index = m_buildings.size ();
   m_buildings.push_back (building);
+  g_buildingListModificationCount++;
   Simulator::ScheduleWithContext (index, TimeStep (0), &Building::Initialize, building);
   return index;
 
@@ -189,5 +197,15 @@ BuildingList::GetNBuildings (void)
 {
   return BuildingListPriv::Get ()->GetNBuildings ();
 }
+uint64_t
+BuildingList::GetModificationCount (void)
+{
+  return g_buildingListModificationCount;
+}
+void
+BuildingList::NotifyBuildingModified (void)
+{
+  g_buildingListModificationCount++;
+}
 
 } // namespace ns3
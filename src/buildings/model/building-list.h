@@ -62,6 +62,20 @@ public:
    * \returns the number of buildings currently in the list.
    */
   static uint32_t GetNBuildings (void);
+  /**
+   * \returns a counter which is incremented every time a building is added
+   *          to the list, the boundaries of a building change or the list is
+   *          destroyed. It can be used to detect when data derived from the
+   *          buildings, e.g., a spatial index, has to be recomputed.
+   */
+  static uint64_t GetModificationCount (void);
+  /**
+   * Increment the modification counter.
+   *
+   * This method is called automatically from Building::SetBoundaries so
+   * the user has little reason to call it himself.
+   */
+  static void NotifyBuildingModified (void);
 };
 
 } // namespace ns3
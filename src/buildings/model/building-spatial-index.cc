@@ -0,0 +1,267 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2020 SIGNET Lab, Department of Information Engineering,
+ * University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/building-spatial-index.h"
+#include "ns3/building-list.h"
+#include "ns3/building.h"
+#include "ns3/log.h"
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("BuildingSpatialIndex");
+
+const uint32_t BuildingSpatialIndex::MAX_CELLS_PER_SIDE;
+
+BuildingSpatialIndex::BuildingSpatialIndex ()
+  : m_built (false),
+    m_modificationCount (0),
+    m_xMin (0),
+    m_yMin (0),
+    m_xMax (0),
+    m_yMax (0),
+    m_cellSizeX (1),
+    m_cellSizeY (1),
+    m_numCellsX (0),
+    m_numCellsY (0),
+    m_query (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+BuildingSpatialIndex::Update (void)
+{
+  if (!m_built || m_modificationCount != BuildingList::GetModificationCount ())
+    {
+      Build ();
+    }
+}
+
+void
+BuildingSpatialIndex::Build (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  m_built = true;
+  m_modificationCount = BuildingList::GetModificationCount ();
+  m_boxes.clear ();
+  for (BuildingList::Iterator bit = BuildingList::Begin (); bit != BuildingList::End (); ++bit)
+    {
+      m_boxes.push_back ((*bit)->GetBoundaries ());
+    }
+  m_lastQuery.assign (m_boxes.size (), 0);
+  m_query = 0;
+  m_cellStart.clear ();
+  m_cellBuildings.clear ();
+  m_numCellsX = 0;
+  m_numCellsY = 0;
+  if (m_boxes.empty ())
+    {
+      return;
+    }
+
+  m_xMin = m_boxes[0].xMin;
+  m_xMax = m_boxes[0].xMax;
+  m_yMin = m_boxes[0].yMin;
+  m_yMax = m_boxes[0].yMax;
+  for (const Box &box : m_boxes)
+    {
+      m_xMin = std::min (m_xMin, box.xMin);
+      m_xMax = std::max (m_xMax, box.xMax);
+      m_yMin = std::min (m_yMin, box.yMin);
+      m_yMax = std::max (m_yMax, box.yMax);
+    }
+
+  // choose square cells so that, on average, there is about one building
+  // per cell
+  double width = std::max (m_xMax - m_xMin, 1e-6);
+  double height = std::max (m_yMax - m_yMin, 1e-6);
+  double cellSize = std::sqrt (width * height / m_boxes.size ());
+  m_numCellsX = std::min<double> (std::max (std::ceil (width / cellSize), 1.0), MAX_CELLS_PER_SIDE);
+  m_numCellsY = std::min<double> (std::max (std::ceil (height / cellSize), 1.0), MAX_CELLS_PER_SIDE);
+  m_cellSizeX = width / m_numCellsX;
+  m_cellSizeY = height / m_numCellsY;
+
+  // the boxes are slightly enlarged, so that the buildings touched by a
+  // segment on the border of a cell are not missed because of rounding
+  double tolX = 1e-6 * m_cellSizeX;
+  double tolY = 1e-6 * m_cellSizeY;
+
+  // store the cells in a compressed layout: count the buildings of each
+  // cell, then fill the cells
+  m_cellStart.assign (m_numCellsX * m_numCellsY + 1, 0);
+  for (uint32_t pass = 0; pass < 2; ++pass)
+    {
+      for (uint32_t i = 0; i < m_boxes.size (); ++i)
+        {
+          const Box &box = m_boxes[i];
+          uint32_t xStart = GetCellX (box.xMin - tolX);
+          uint32_t xEnd = GetCellX (box.xMax + tolX);
+          uint32_t yStart = GetCellY (box.yMin - tolY);
+          uint32_t yEnd = GetCellY (box.yMax + tolY);
+          for (uint32_t y = yStart; y <= yEnd; ++y)
+            {
+              for (uint32_t x = xStart; x <= xEnd; ++x)
+                {
+                  uint32_t cell = y * m_numCellsX + x;
+                  if (pass == 0)
+                    {
+                      m_cellStart[cell + 1]++;
+                    }
+                  else
+                    {
+                      m_cellBuildings[m_cellStart[cell]++] = i;
+                    }
+                }
+            }
+        }
+      if (pass == 0)
+        {
+          for (uint32_t cell = 0; cell < m_numCellsX * m_numCellsY; ++cell)
+            {
+              m_cellStart[cell + 1] += m_cellStart[cell];
+            }
+          m_cellBuildings.resize (m_cellStart.back ());
+        }
+      else
+        {
+          // the fill advanced each start to the start of the next cell
+          for (uint32_t cell = m_numCellsX * m_numCellsY; cell > 0; --cell)
+            {
+              m_cellStart[cell] = m_cellStart[cell - 1];
+            }
+          m_cellStart[0] = 0;
+        }
+    }
+
+  NS_LOG_DEBUG ("Built a " << m_numCellsX << "x" << m_numCellsY << " grid for "
+                           << m_boxes.size () << " buildings, " << m_cellBuildings.size () << " entries");
+}
+
+uint32_t
+BuildingSpatialIndex::GetCellX (double x) const
+{
+  if (x <= m_xMin)
+    {
+      return 0;
+    }
+  if (x >= m_xMax)
+    {
+      return m_numCellsX - 1;
+    }
+  return std::min<uint32_t> ((x - m_xMin) / m_cellSizeX, m_numCellsX - 1);
+}
+
+uint32_t
+BuildingSpatialIndex::GetCellY (double y) const
+{
+  if (y <= m_yMin)
+    {
+      return 0;
+    }
+  if (y >= m_yMax)
+    {
+      return m_numCellsY - 1;
+    }
+  return std::min<uint32_t> ((y - m_yMin) / m_cellSizeY, m_numCellsY - 1);
+}
+
+bool
+BuildingSpatialIndex::IsIntersectCell (uint32_t cell, const Vector &l1, const Vector &l2)
+{
+  for (uint32_t j = m_cellStart[cell]; j < m_cellStart[cell + 1]; ++j)
+    {
+      uint32_t i = m_cellBuildings[j];
+      if (m_lastQuery[i] == m_query)
+        {
+          continue;
+        }
+      m_lastQuery[i] = m_query;
+      if (m_boxes[i].IsIntersect (l1, l2))
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+bool
+BuildingSpatialIndex::IsIntersect (const Vector &l1, const Vector &l2)
+{
+  Update ();
+  if (m_boxes.empty ())
+    {
+      return false;
+    }
+
+  double tolX = 1e-6 * m_cellSizeX;
+  double tolY = 1e-6 * m_cellSizeY;
+  double segXMin = std::min (l1.x, l2.x);
+  double segXMax = std::max (l1.x, l2.x);
+  double segYMin = std::min (l1.y, l2.y);
+  double segYMax = std::max (l1.y, l2.y);
+  if (segXMax < m_xMin - tolX || segXMin > m_xMax + tolX
+      || segYMax < m_yMin - tolY || segYMin > m_yMax + tolY)
+    {
+      return false;
+    }
+
+  if (++m_query == 0)
+    {
+      // the counter wrapped around, forget the previous queries
+      std::fill (m_lastQuery.begin (), m_lastQuery.end (), 0);
+      m_query = 1;
+    }
+
+  // visit the rows crossed by the segment, and in each row the columns
+  // spanned by the part of the segment in that row
+  double dy = l2.y - l1.y;
+  uint32_t yStart = GetCellY (segYMin - tolY);
+  uint32_t yEnd = GetCellY (segYMax + tolY);
+  for (uint32_t y = yStart; y <= yEnd; ++y)
+    {
+      double xLow = segXMin;
+      double xHigh = segXMax;
+      if (dy != 0 && yStart != yEnd)
+        {
+          double rowYMin = std::max (segYMin, m_yMin + y * m_cellSizeY - tolY);
+          double rowYMax = std::min (segYMax, m_yMin + (y + 1) * m_cellSizeY + tolY);
+          double t1 = std::min (std::max ((rowYMin - l1.y) / dy, 0.0), 1.0);
+          double t2 = std::min (std::max ((rowYMax - l1.y) / dy, 0.0), 1.0);
+          double x1 = l1.x + t1 * (l2.x - l1.x);
+          double x2 = l1.x + t2 * (l2.x - l1.x);
+          xLow = std::max (segXMin, std::min (x1, x2));
+          xHigh = std::min (segXMax, std::max (x1, x2));
+        }
+      uint32_t xStart = GetCellX (xLow - tolX);
+      uint32_t xEnd = GetCellX (xHigh + tolX);
+      for (uint32_t x = xStart; x <= xEnd; ++x)
+        {
+          if (IsIntersectCell (y * m_numCellsX + x, l1, l2))
+            {
+              return true;
+            }
+        }
+    }
+  return false;
+}
+
+} // namespace ns3
@@ -0,0 +1,122 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2020 SIGNET Lab, Department of Information Engineering,
+ * University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef BUILDING_SPATIAL_INDEX_H
+#define BUILDING_SPATIAL_INDEX_H
+
+#include <ns3/box.h>
+#include <ns3/vector.h>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup buildings
+ *
+ * \brief Uniform grid over the footprints of the buildings in the
+ * BuildingList, used to find the buildings crossed by a line segment
+ * without testing all of them.
+ *
+ * The grid covers the bounding rectangle of the buildings in the x-y plane,
+ * and each cell stores the indices of the buildings whose footprint overlaps
+ * it. A query visits, row by row, only the cells crossed by the projection of
+ * the segment, and tests each building found there, once, with
+ * Box::IsIntersect, hence it returns the same result of a linear scan of the
+ * list.
+ *
+ * The grid is built the first time it is used, and it is rebuilt whenever
+ * BuildingList::GetModificationCount changes, i.e., when buildings are added
+ * or moved.
+ */
+class BuildingSpatialIndex
+{
+public:
+  /**
+   * Constructor
+   */
+  BuildingSpatialIndex ();
+
+  /**
+   * \brief Checks if the line segment between l1 and l2 intersects a building
+   * in the BuildingList
+   *
+   * \param l1 position
+   * \param l2 position
+   * \return true if the segment intersects at least one building
+   */
+  bool IsIntersect (const Vector &l1, const Vector &l2);
+
+  /**
+   * Rebuild the grid if the BuildingList changed since the last build
+   */
+  void Update (void);
+
+private:
+  /**
+   * Build the grid from the BuildingList
+   */
+  void Build (void);
+
+  /**
+   * Get the index of the column of the grid containing a coordinate,
+   * clamped to the grid
+   * \param x the x coordinate
+   * \return the column index
+   */
+  uint32_t GetCellX (double x) const;
+
+  /**
+   * Get the index of the row of the grid containing a coordinate,
+   * clamped to the grid
+   * \param y the y coordinate
+   * \return the row index
+   */
+  uint32_t GetCellY (double y) const;
+
+  /**
+   * Test the buildings of a cell that were not tested yet in this query
+   * \param cell the index of the cell
+   * \param l1 position
+   * \param l2 position
+   * \return true if the segment intersects one of the buildings
+   */
+  bool IsIntersectCell (uint32_t cell, const Vector &l1, const Vector &l2);
+
+  static const uint32_t MAX_CELLS_PER_SIDE = 1024; //!< maximum number of rows and columns of the grid
+
+  bool m_built; //!< true if the grid has been built
+  uint64_t m_modificationCount; //!< BuildingList::GetModificationCount when the grid was built
+  std::vector<Box> m_boxes; //!< boundaries of the buildings, in the order of the BuildingList
+  double m_xMin; //!< minimum x of the grid
+  double m_yMin; //!< minimum y of the grid
+  double m_xMax; //!< maximum x of the grid
+  double m_yMax; //!< maximum y of the grid
+  double m_cellSizeX; //!< width of a cell along x
+  double m_cellSizeY; //!< width of a cell along y
+  uint32_t m_numCellsX; //!< number of columns of the grid
+  uint32_t m_numCellsY; //!< number of rows of the grid
+  std::vector<uint32_t> m_cellStart; //!< for each cell, offset of its first building in m_cellBuildings
+  std::vector<uint32_t> m_cellBuildings; //!< indices of the buildings overlapping each cell, one cell after the other
+  std::vector<uint32_t> m_lastQuery; //!< for each building, the last query in which it was tested
+  uint32_t m_query; //!< counter of the queries
+};
+
+} // namespace ns3
+
+#endif /* BUILDING_SPATIAL_INDEX_H */
@@ -22,7 +22,6 @@
 #include "ns3/buildings-channel-condition-model.h"
 #include "ns3/mobility-model.h"
 #include "ns3/mobility-building-info.h"
-#include "ns3/building-list.h"
 #include "ns3/log.h"
 
 namespace ns3 {
@@ -106,19 +105,10 @@ BuildingsChannelConditionModel::GetChannelCondition (Ptr<const MobilityModel> a,
 bool
 BuildingsChannelConditionModel::IsLineOfSightBlocked (const ns3::Vector &l1, const ns3::Vector &l2) const
 {
-  for (BuildingList::Iterator bit = BuildingList::Begin (); bit != BuildingList::End (); ++bit)
-    {
-      if ((*bit)->IsIntersect (l1, l2))
-        {
-          // The line of sight should be blocked if the line-segment between
-          // l1 and l2 intersects one of the buildings.
-          return true;
-        }
-    }
-
-  // The line of sight should not be blocked if the line-segment between
-  // l1 and l2 did not intersect any building.
-  return false;
+  // The line of sight should be blocked if the line-segment between
+  // l1 and l2 intersects one of the buildings. Only the buildings close to
+  // the segment are tested, the index is rebuilt if the buildings changed.
+  return m_buildingIndex.IsIntersect (l1, l2);
 }
 
 int64_t
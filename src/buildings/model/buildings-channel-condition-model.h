@@ -23,6 +23,7 @@
 #define BUILDINGS_CHANNEL_CONDITION_MODEL_H
 
 #include "ns3/channel-condition-model.h"
+#include "ns3/building-spatial-index.h"
 
 namespace ns3 {
 
@@ -87,6 +88,8 @@ private:
    * \return true if the line of sight is blocked, false otherwise
    */
   bool IsLineOfSightBlocked (const Vector &l1, const Vector &l2) const;
+
+  mutable BuildingSpatialIndex m_buildingIndex; //!< grid used to find the buildings which may block the line of sight
 };
 
 } // end ns3 namespace
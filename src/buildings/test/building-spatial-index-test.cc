@@ -0,0 +1,194 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2020 SIGNET Lab, Department of Information Engineering,
+ * University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/building.h"
+#include "ns3/building-list.h"
+#include "ns3/building-spatial-index.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("BuildingSpatialIndexTest");
+
+/**
+ * Test case for the class BuildingSpatialIndex. It checks that the index
+ * finds the same intersections of a linear scan of the BuildingList, also
+ * after the buildings are moved or new buildings are added
+ */
+class BuildingSpatialIndexTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor
+   */
+  BuildingSpatialIndexTestCase ();
+
+  /**
+   * Destructor
+   */
+  virtual ~BuildingSpatialIndexTestCase ();
+
+private:
+  /**
+   * Builds the simulation scenario and perform the tests
+   */
+  virtual void DoRun (void);
+
+  /**
+   * Check if a segment intersects a building by testing all the buildings
+   * \param l1 position
+   * \param l2 position
+   * \return true if the segment intersects a building
+   */
+  static bool IsIntersectLinear (const Vector &l1, const Vector &l2);
+
+  /**
+   * Compare the index with the linear scan on random segments
+   * \param index the index
+   * \param numSegments the number of segments to test
+   * \return the number of segments which intersect a building
+   */
+  uint32_t CheckRandomSegments (BuildingSpatialIndex &index, uint32_t numSegments);
+
+  Ptr<UniformRandomVariable> m_uniform; //!< random variable used to generate the scenario
+};
+
+BuildingSpatialIndexTestCase::BuildingSpatialIndexTestCase ()
+  : TestCase ("Test case for the BuildingSpatialIndex")
+{
+}
+
+BuildingSpatialIndexTestCase::~BuildingSpatialIndexTestCase ()
+{
+}
+
+bool
+BuildingSpatialIndexTestCase::IsIntersectLinear (const Vector &l1, const Vector &l2)
+{
+  for (BuildingList::Iterator bit = BuildingList::Begin (); bit != BuildingList::End (); ++bit)
+    {
+      if ((*bit)->IsIntersect (l1, l2))
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+uint32_t
+BuildingSpatialIndexTestCase::CheckRandomSegments (BuildingSpatialIndex &index, uint32_t numSegments)
+{
+  uint32_t numBlocked = 0;
+  for (uint32_t i = 0; i < numSegments; ++i)
+    {
+      // the segments start and end also outside the area with the buildings,
+      // and some of them are aligned with the axes
+      Vector l1 (m_uniform->GetValue (-50, 550), m_uniform->GetValue (-50, 550), m_uniform->GetValue (0, 30));
+      Vector l2 (m_uniform->GetValue (-50, 550), m_uniform->GetValue (-50, 550), m_uniform->GetValue (0, 30));
+      if (i % 10 == 1)
+        {
+          l2.x = l1.x;
+        }
+      else if (i % 10 == 2)
+        {
+          l2.y = l1.y;
+        }
+      else if (i % 10 == 3)
+        {
+          l2 = Vector (l1.x + m_uniform->GetValue (-5, 5), l1.y + m_uniform->GetValue (-5, 5), l1.z);
+        }
+
+      bool expected = IsIntersectLinear (l1, l2);
+      NS_TEST_EXPECT_MSG_EQ (index.IsIntersect (l1, l2), expected, "Unexpected intersection between " << l1 << " and " << l2);
+      numBlocked += expected;
+    }
+  return numBlocked;
+}
+
+void
+BuildingSpatialIndexTestCase::DoRun (void)
+{
+  m_uniform = CreateObject<UniformRandomVariable> ();
+  m_uniform->SetStream (1);
+
+  BuildingSpatialIndex index;
+  NS_TEST_ASSERT_MSG_EQ (index.IsIntersect (Vector (0, 0, 0), Vector (100, 100, 0)), false, "No building has been deployed");
+
+  // random buildings, with different sizes and heights
+  std::vector<Ptr<Building> > buildings;
+  for (uint32_t i = 0; i < 500; ++i)
+    {
+      double x = m_uniform->GetValue (0, 480);
+      double y = m_uniform->GetValue (0, 480);
+      Ptr<Building> building = CreateObject<Building> ();
+      building->SetBoundaries (Box (x, x + m_uniform->GetValue (1, 20), y, y + m_uniform->GetValue (1, 20), 0, m_uniform->GetValue (5, 25)));
+      buildings.push_back (building);
+    }
+
+  uint32_t numBlocked = CheckRandomSegments (index, 5000);
+  NS_TEST_ASSERT_MSG_GT (numBlocked, 0, "No segment intersects a building");
+  NS_TEST_ASSERT_MSG_LT (numBlocked, 5000, "All the segments intersect a building");
+
+  // segments touching a building on its walls and corners
+  Box box = buildings[0]->GetBoundaries ();
+  NS_TEST_EXPECT_MSG_EQ (index.IsIntersect (Vector (box.xMin - 10, box.yMin, 1), Vector (box.xMin, box.yMin, 1)),
+                         IsIntersectLinear (Vector (box.xMin - 10, box.yMin, 1), Vector (box.xMin, box.yMin, 1)),
+                         "Unexpected intersection with a corner");
+  NS_TEST_EXPECT_MSG_EQ (index.IsIntersect (Vector (box.xMax, box.yMin - 10, 1), Vector (box.xMax, box.yMax + 10, 1)),
+                         IsIntersectLinear (Vector (box.xMax, box.yMin - 10, 1), Vector (box.xMax, box.yMax + 10, 1)),
+                         "Unexpected intersection with a wall");
+
+  // move some buildings, and check that the index is updated
+  for (uint32_t i = 0; i < buildings.size (); i += 5)
+    {
+      double x = m_uniform->GetValue (0, 480);
+      double y = m_uniform->GetValue (0, 480);
+      buildings[i]->SetBoundaries (Box (x, x + 10, y, y + 10, 0, 10));
+    }
+  CheckRandomSegments (index, 2000);
+
+  // add a building outside the previous area
+  Ptr<Building> building = CreateObject<Building> ();
+  building->SetBoundaries (Box (1000, 1010, 1000, 1010, 0, 10));
+  NS_TEST_ASSERT_MSG_EQ (index.IsIntersect (Vector (990, 1005, 1), Vector (1020, 1005, 1)), true, "The new building has not been indexed");
+  CheckRandomSegments (index, 2000);
+
+  Simulator::Destroy ();
+  NS_TEST_ASSERT_MSG_EQ (index.IsIntersect (Vector (990, 1005, 1), Vector (1020, 1005, 1)), false, "The buildings have been destroyed");
+}
+
+/**
+ * Test suite for the building spatial index
+ */
+class BuildingSpatialIndexTestSuite : public TestSuite
+{
+public:
+  BuildingSpatialIndexTestSuite ();
+};
+
+BuildingSpatialIndexTestSuite::BuildingSpatialIndexTestSuite ()
+  : TestSuite ("building-spatial-index", UNIT)
+{
+  AddTestCase (new BuildingSpatialIndexTestCase, TestCase::QUICK);
+}
+
+static BuildingSpatialIndexTestSuite buildingSpatialIndexTestSuite;
@@ -748,12 +748,12 @@ UeManager::PrepareHandover (uint16_t cellId)
  * Merge 2 buffers of RlcAmPdus into 1 vector with increment order of Pdus
  */
 std::vector < LteRlcAm::RetxPdu >
-UeManager::MergeBuffers(std::vector < LteRlcAm::RetxPdu > first, std::vector < LteRlcAm::RetxPdu > second)
+UeManager::MergeBuffers(const std::vector < LteRlcAm::RetxPdu > &first, const std::vector < LteRlcAm::RetxPdu > &second)
 {
   LteRlcAmHeader rlcamHeader_1, rlcamHeader_2;
   std::vector < LteRlcAm::RetxPdu> result;
-  std::vector < LteRlcAm::RetxPdu>::iterator it_1 = first.begin();
-  std::vector < LteRlcAm::RetxPdu>::iterator it_2 = second.begin();
+  std::vector < LteRlcAm::RetxPdu>::const_iterator it_1 = first.begin();
+  std::vector < LteRlcAm::RetxPdu>::const_iterator it_2 = second.begin();
   bool end_1_reached = false;
   bool end_2_reached = false;
   while (it_1 != first.end() && it_2 != second.end()){
@@ -911,13 +911,13 @@ UeManager::ForwardRlcBuffers(Ptr<LteRlc> rlc, Ptr<LtePdcp> pdcp, uint32_t gtpTei
     //Copy lte-rlc-am.m_txOnBuffer to X2 forwarding buffer.
     Ptr<LteRlcAm> rlcAm = rlc->GetObject<LteRlcAm>();
     uint32_t txonBufferSize = rlcAm->GetTxBufferSize();
-    std::vector < Ptr<Packet> > txonBuffer = rlcAm->GetTxBuffer();
+    std::deque < Ptr<Packet> > txonBuffer = rlcAm->GetTxBuffer();
     //m_x2forwardingBufferSize =  drbIt->second->m_rlc->GetObject<LteRlcAm>()->GetTxBufferSize();
     //m_x2forwardingBuffer = drbIt->second->m_rlc->GetObject<LteRlcAm>()->GetTxBuffer();
     uint32_t txedBufferSize = rlcAm->GetTxedBufferSize();
-    std::vector < LteRlcAm::RetxPdu > txedBuffer = rlcAm->GetTxedBuffer();
+    const std::vector < LteRlcAm::RetxPdu > &txedBuffer = rlcAm->GetTxedBuffer();
     uint32_t retxBufferSize = rlcAm->GetRetxBufferSize();
-    std::vector < LteRlcAm::RetxPdu > retxBuffer = rlcAm->GetRetxBuffer();
+    const std::vector < LteRlcAm::RetxPdu > &retxBuffer = rlcAm->GetRetxBuffer();
 
     //Translate Pdus in Rlc txed/retx buffer into RLC Sdus
     //and put these Sdus into rlcAm->m_transmittingRlcSdus.
@@ -944,7 +944,7 @@ UeManager::ForwardRlcBuffers(Ptr<LteRlc> rlc, Ptr<LtePdcp> pdcp, uint32_t gtpTei
     //{
       LtePdcpHeader pdcpHeader;
       uint32_t pos = 0;
-      for (std::vector< Ptr<Packet> >::iterator it = txonBuffer.begin(); it != txonBuffer.end(); ++it)
+      for (std::deque< Ptr<Packet> >::const_iterator it = txonBuffer.begin(); it != txonBuffer.end(); ++it)
       {
         pos++;
         if((*it)->GetSize() > 3)
@@ -964,9 +964,9 @@ UeManager::ForwardRlcBuffers(Ptr<LteRlc> rlc, Ptr<LtePdcp> pdcp, uint32_t gtpTei
       { //something inside the RLC AM's transmitting buffer
         NS_LOG_DEBUG ("ADDING TRANSMITTING SDUS OF RLC AM TO X2FORWARDINGBUFFER... Size = " << rlcAm->GetTransmittingRlcSduBufferSize() );
         //copy the RlcSdu buffer (map) to forwardingBuffer.
-        std::map < uint32_t, Ptr<Packet> > rlcAmTransmittingBuffer = rlcAm->GetTransmittingRlcSduBuffer();
+        const std::map < uint32_t, Ptr<Packet> > &rlcAmTransmittingBuffer = rlcAm->GetTransmittingRlcSduBuffer();
         NS_LOG_DEBUG (" *** SIZE = " << rlcAmTransmittingBuffer.size());
-        for (std::map< uint32_t, Ptr<Packet> >::iterator it = rlcAmTransmittingBuffer.begin(); it != rlcAmTransmittingBuffer.end(); ++it)
+        for (std::map< uint32_t, Ptr<Packet> >::const_iterator it = rlcAmTransmittingBuffer.begin(); it != rlcAmTransmittingBuffer.end(); ++it)
         {
           if (it->second != 0)
           {
@@ -982,17 +982,17 @@ UeManager::ForwardRlcBuffers(Ptr<LteRlc> rlc, Ptr<LtePdcp> pdcp, uint32_t gtpTei
           segmentedRlcsdu->PeekHeader(pdcpHeader);
           NS_LOG_DEBUG(this << "SegmentedRlcSdu = " << segmentedRlcsdu->GetSize() << " SEQ = " << pdcpHeader.GetSequenceNumber());
           //insert the complete version of the fragmented SDU to the front of txonBuffer.
-          txonBuffer.insert(txonBuffer.begin(),segmentedRlcsdu);
+          txonBuffer.push_front(segmentedRlcsdu);
         }
         m_x2forwardingBuffer.insert(m_x2forwardingBuffer.end(), txonBuffer.begin(), txonBuffer.end());
         m_x2forwardingBufferSize += rlcAm->GetTransmittingRlcSduBufferSize() + txonBufferSize;
 
         //Get the rlcAm
-        std::vector < Ptr <Packet> > rlcAmTxedSduBuffer = rlcAm->GetTxedRlcSduBuffer();
+        const std::vector < Ptr <Packet> > &rlcAmTxedSduBuffer = rlcAm->GetTxedRlcSduBuffer();
         LtePdcpHeader pdcpHeader_1;
         m_x2forwardingBuffer.at(0)->PeekHeader(pdcpHeader_1);
         uint16_t i = 0;
-        for (std::vector< Ptr<Packet> >::iterator it = rlcAmTxedSduBuffer.begin(); it != rlcAmTxedSduBuffer.end(); ++it)
+        for (std::vector< Ptr<Packet> >::const_iterator it = rlcAmTxedSduBuffer.begin(); it != rlcAmTxedSduBuffer.end(); ++it)
         {
           if ((*it) != NULL)
           {
@@ -1013,7 +1013,7 @@ UeManager::ForwardRlcBuffers(Ptr<LteRlc> rlc, Ptr<LtePdcp> pdcp, uint32_t gtpTei
       else
       { //TransmittingBuffer is empty. Only copy TxonBuffer.
         NS_LOG_DEBUG(this << " ADDING TXONBUFFER OF RLC AM " << m_rnti << " Size = " << txonBufferSize) ;
-        m_x2forwardingBuffer = txonBuffer;
+        m_x2forwardingBuffer.swap (txonBuffer);
         m_x2forwardingBufferSize += txonBufferSize;
       }
     //}
@@ -1026,14 +1026,16 @@ UeManager::ForwardRlcBuffers(Ptr<LteRlc> rlc, Ptr<LtePdcp> pdcp, uint32_t gtpTei
   {
     //Copy lte-rlc-um.m_txOnBuffer to X2 forwarding buffer.
     NS_LOG_DEBUG(this << " Copying txonBuffer from RLC UM " << m_rnti);
-    m_x2forwardingBuffer = rlc->GetObject<LteRlcUm>()->GetTxBuffer();
+    const std::deque < Ptr<Packet> > &txBuffer = rlc->GetObject<LteRlcUm>()->GetTxBuffer();
+    m_x2forwardingBuffer.assign (txBuffer.begin (), txBuffer.end ());
     m_x2forwardingBufferSize =  rlc->GetObject<LteRlcUm>()->GetTxBufferSize();
   }
   else if (0 != rlc->GetObject<LteRlcUmLowLat> ())
   {
     //Copy lte-rlc-um-low-lat.m_txOnBuffer to X2 forwarding buffer.
     NS_LOG_DEBUG(this << " Copying txonBuffer from RLC UM " << m_rnti);
-    m_x2forwardingBuffer = rlc->GetObject<LteRlcUmLowLat>()->GetTxBuffer();
+    const std::deque < Ptr<Packet> > &txBuffer = rlc->GetObject<LteRlcUmLowLat>()->GetTxBuffer();
+    m_x2forwardingBuffer.assign (txBuffer.begin (), txBuffer.end ());
     m_x2forwardingBufferSize =  rlc->GetObject<LteRlcUmLowLat>()->GetTxBufferSize();
   }
   //LteRlcAm m_txBuffer stores PDCP "PDU".
@@ -1059,7 +1061,7 @@ UeManager::ForwardRlcBuffers(Ptr<LteRlc> rlc, Ptr<LtePdcp> pdcp, uint32_t gtpTei
     params.gtpTeid = gtpTeid;
     //Remove tags to get PDCP SDU from PDCP PDU.
     //Ptr<Packet> rlcSdu =  (*(m_x2forwardingBuffer.begin()))->Copy();
-    Ptr<Packet> rlcSdu =  m_x2forwardingBuffer.at(0);
+    Ptr<Packet> rlcSdu =  m_x2forwardingBuffer.front();
     //Tags to be removed from rlcSdu (from outer to inner)
     //LteRlcSduStatusTag rlcSduStatusTag;
     //RlcTag  rlcTag; //rlc layer timestamp
@@ -1137,7 +1139,7 @@ UeManager::ForwardRlcBuffers(Ptr<LteRlc> rlc, Ptr<LtePdcp> pdcp, uint32_t gtpTei
       NS_LOG_UNCOND("Too small, not forwarded");
     }
     m_x2forwardingBufferSize -= (*(m_x2forwardingBuffer.begin()))->GetSize();
-    m_x2forwardingBuffer.erase (m_x2forwardingBuffer.begin());
+    m_x2forwardingBuffer.pop_front ();
     NS_LOG_LOGIC(this << " After forwarding: buffer size = " << m_x2forwardingBufferSize );
   }
 }
@@ -56,6 +56,7 @@
 #include <ns3/lte-rlc-am.h>
 
 #include <map>
+#include <deque>
 #include <set>
 #include <ns3/component-carrier-enb.h>
 #include <vector>
@@ -446,7 +447,7 @@ public:
 
 private:
   //Lossless HO: merge 2 buffers into 1 with increment order.
-  std::vector < LteRlcAm::RetxPdu > MergeBuffers(std::vector < LteRlcAm::RetxPdu > first, std::vector < LteRlcAm::RetxPdu > second);
+  std::vector < LteRlcAm::RetxPdu > MergeBuffers(const std::vector < LteRlcAm::RetxPdu > &first, const std::vector < LteRlcAm::RetxPdu > &second);
   /**
    * Forward the content of RLC buffers. For RLC UM and UM LowLat, forward txBuffer.
    * For RLC AM, forward the merge of retx and txed buffers, and txBuffer
@@ -682,7 +683,7 @@ private:
    */
   EventId m_handoverLeavingTimeout;
 
-  std::vector < Ptr<Packet> > m_x2forwardingBuffer;
+  std::deque < Ptr<Packet> > m_x2forwardingBuffer;
   uint32_t m_x2forwardingBufferSize;
   uint32_t m_maxx2forwardingBufferSize;
 
@@ -747,7 +747,9 @@ LteRlcAm::DoNotifyTxOpportunity (LteMacSapUser::TxOpportunityParameters txOpPara
     m_txonBufferSize += tempP->GetSize ();
   }
 
-  Ptr<Packet> firstSegment = (*(m_txonBuffer.begin ()))->Copy ();
+  // The SDU is owned by the buffer only, so it is segmented in place: the
+  // fragments share the payload and only the remaining segment is given back
+  Ptr<Packet> firstSegment = m_txonBuffer.front ();
 
   // LL HO
   // tricky: store the incomplete Rlc SDU for forwarding to
@@ -757,12 +759,12 @@ LteRlcAm::DoNotifyTxOpportunity (LteMacSapUser::TxOpportunityParameters txOpPara
   // store complete the last complete SDU of the txonBuffer.
   if (!is_fragmented){
     NS_LOG_DEBUG ("Last complete SDU in txonBuffer size = " << firstSegment->GetSize() << " SEQ = " << m_vtS );
-    entireSdu = (*(m_txonBuffer.begin ()))->Copy ();
+    entireSdu = firstSegment->Copy ();
   }
 
-  m_txonBufferSize -= (*(m_txonBuffer.begin()))->GetSize ();
+  m_txonBufferSize -= firstSegment->GetSize ();
   NS_LOG_LOGIC ("txBufferSize      = " << m_txonBufferSize );
-  m_txonBuffer.erase (m_txonBuffer.begin ());
+  m_txonBuffer.pop_front ();
 
   while ( firstSegment && (firstSegment->GetSize () > 0) && (nextSegmentSize > 0) )
     {
@@ -816,18 +818,8 @@ LteRlcAm::DoNotifyTxOpportunity (LteMacSapUser::TxOpportunityParameters txOpPara
               //LL HO Mark the first SDU is txonBuffer is fragmented. This maybe not needed.
               is_fragmented = 1;
 
-              // m_txonBuffer.insert (m_txonBuffer.begin (), firstSegment);
-
-              if(m_txonBuffer.empty())
-              {
-                m_txonBuffer.push_back(firstSegment);
-              }
-              else
-              {
-                m_txonBuffer.insert (m_txonBuffer.begin (), firstSegment);
-              }
-
-              m_txonBufferSize += (*(m_txonBuffer.begin()))->GetSize ();
+              m_txonBuffer.push_front (firstSegment);
+              m_txonBufferSize += firstSegment->GetSize ();
 
               NS_LOG_LOGIC ("    Txon buffer: Give back the remaining segment");
               NS_LOG_LOGIC ("    Txon buffers = " << m_txonBuffer.size ());
@@ -939,13 +931,13 @@ LteRlcAm::DoNotifyTxOpportunity (LteMacSapUser::TxOpportunityParameters txOpPara
             m_txonBufferSize += tempP->GetSize ();
           }
 
-          firstSegment = (*(m_txonBuffer.begin ()))->Copy ();
+          firstSegment = m_txonBuffer.front ();
 
           // LL HO
           // New complete SDU is taken from txonBuffer so reset the
           // status is_fragmented.
           is_fragmented = 0;
-          m_txedRlcSduBuffer.push_back((*(m_txonBuffer.begin()))->Copy());
+          m_txedRlcSduBuffer.push_back(firstSegment->Copy());
           NS_LOG_DEBUG ("m_txedRlcSduBuffer.size() = " << m_txedRlcSduBuffer.size());
           if (m_txedRlcSduBuffer.size() > 1024){
             NS_LOG_DEBUG ("m_txedRlcSduBuffer.size() = " << m_txedRlcSduBuffer.size() << " clear and resize");
@@ -954,10 +946,10 @@ LteRlcAm::DoNotifyTxOpportunity (LteMacSapUser::TxOpportunityParameters txOpPara
             NS_LOG_DEBUG ("m_txedRlcSduBuffer.size() = " << m_txedRlcSduBuffer.size() << " after clear and resize");
           }
           // Store the last complete SDU before segmentation in txonBuffer.
-          entireSdu = (*(m_txonBuffer.begin ()))->Copy ();
+          entireSdu = firstSegment->Copy ();
 
-          m_txonBufferSize -= (*(m_txonBuffer.begin()))->GetSize ();
-          m_txonBuffer.erase (m_txonBuffer.begin ());
+          m_txonBufferSize -= firstSegment->GetSize ();
+          m_txonBuffer.pop_front ();
           NS_LOG_LOGIC ("        txBufferSize = " << m_txonBufferSize );
         }
     }
@@ -1105,14 +1097,13 @@ LteRlcAm::DoNotifyTxOpportunity (LteMacSapUser::TxOpportunityParameters txOpPara
   m_macSapProvider->TransmitPdu (params);
 }
 
-std::vector < Ptr<Packet> >
+std::deque < Ptr<Packet> >
 LteRlcAm::GetTxBuffer()
 {
-  std::vector < Ptr<Packet> > toBeReturned;
+  std::deque < Ptr<Packet> > toBeReturned;
   if(!m_enableAqm)
   {
-    toBeReturned.insert(toBeReturned.begin(), m_txonBuffer.begin(), m_txonBuffer.end());
-    m_txonBuffer.clear();
+    toBeReturned.swap (m_txonBuffer);
     m_txonBufferSize = 0;
   }
   else
@@ -1129,11 +1120,9 @@ uint32_t LteRlcAm::GetTxBufferSize()
   return m_txonBufferSize + m_txonQueue->GetNBytes();
 }
 
-std::vector < LteRlcAm::RetxPdu >
-LteRlcAm::GetTxedBuffer()
+const std::vector < LteRlcAm::RetxPdu >&
+LteRlcAm::GetTxedBuffer() const
 {
-  //std::vector < LteRlcAm::RetxPdu > toBeReturned;
-  //toBeReturned.insert(toBeReturned.begin(), m_txedBuffer.begin(), m_txedBuffer.end());
   return m_txedBuffer;
 }
 uint32_t
@@ -1142,12 +1131,10 @@ LteRlcAm::GetTxedBufferSize()
   return m_txedBufferSize;
 }
 
-std::vector < LteRlcAm::RetxPdu >
-LteRlcAm::GetRetxBuffer()
+const std::vector < LteRlcAm::RetxPdu >&
+LteRlcAm::GetRetxBuffer() const
 {
-  std::vector < LteRlcAm::RetxPdu > toBeReturned;
-  toBeReturned.insert(toBeReturned.begin(), m_retxBuffer.begin(), m_retxBuffer.end());
-  return toBeReturned;
+  return m_retxBuffer;
 }
 
 uint32_t
@@ -1156,8 +1143,8 @@ LteRlcAm::GetRetxBufferSize()
   return m_retxBufferSize;
 }
 
-std::map < uint32_t, Ptr<Packet> >
-LteRlcAm::GetTransmittingRlcSduBuffer()
+const std::map < uint32_t, Ptr<Packet> >&
+LteRlcAm::GetTransmittingRlcSduBuffer() const
 {
   return m_transmittingRlcSduBuffer;
   // TODO check if it must be emptied
@@ -34,6 +34,7 @@
 #include <ns3/lte-pdcp-header.h>
 
 #include <vector>
+#include <deque>
 #include <map>
 #include <fstream>
 #include <string>
@@ -75,16 +76,22 @@ public:
   virtual void DoSendMcPdcpSdu(EpcX2Sap::UeDataParams params);
 
   // LL HO
-  std::vector < Ptr<Packet> > GetTxBuffer();
+  /**
+   * Hand the transmission buffer over to the caller, without copying it.
+   * The buffer of the RLC entity is left empty.
+   *
+   * \return the SDUs waiting for transmission
+   */
+  std::deque < Ptr<Packet> > GetTxBuffer();
   uint32_t GetTxBufferSize();
 
-  std::vector < RetxPdu > GetTxedBuffer();
+  const std::vector < RetxPdu >& GetTxedBuffer() const;
   uint32_t GetTxedBufferSize();
 
-  std::vector < RetxPdu > GetRetxBuffer();
+  const std::vector < RetxPdu >& GetRetxBuffer() const;
   uint32_t GetRetxBufferSize();
 
-  std::map < uint32_t, Ptr<Packet> > GetTransmittingRlcSduBuffer();
+  const std::map < uint32_t, Ptr<Packet> >& GetTransmittingRlcSduBuffer() const;
   uint32_t GetTransmittingRlcSduBufferSize();
 
   Ptr<Packet> GetSegmentedRlcsdu();
@@ -92,7 +99,7 @@ public:
   ///< and put the Rlc SDUs into m_transmittingRlcSdus.
   void  RlcPdusToRlcSdus (std::vector < RetxPdu >  Pdus);
 
-  std::vector < Ptr<Packet> > GetTxedRlcSduBuffer (){
+  const std::vector < Ptr<Packet> >& GetTxedRlcSduBuffer () const {
     return m_txedRlcSduBuffer;
   }
 
@@ -176,7 +183,7 @@ private:
   void BufferSizeTrace();
 
 private:
-    std::vector < Ptr<Packet> > m_txonBuffer; ///< Transmission buffer
+    std::deque < Ptr<Packet> > m_txonBuffer; ///< Transmission buffer
 
     struct RetxSegPdu
     {
@@ -66,7 +66,10 @@ public:
   virtual void DoNotifyHarqDeliveryFailure ();
   virtual void DoReceivePdu (LteMacSapUser::ReceivePduParameters params);
 
-  std::vector < Ptr<Packet> > GetTxBuffer();
+  /**
+   * \return the SDUs waiting for transmission, without copying them
+   */
+  const std::deque < Ptr<Packet> >& GetTxBuffer() const;
   uint32_t GetTxBufferSize()
   {
     return m_txBufferSize;
@@ -89,7 +92,7 @@ private:
 private:
   uint32_t m_maxTxBufferSize;
   uint32_t m_txBufferSize;
-  std::vector < Ptr<Packet> > m_txBuffer;       // Transmission buffer
+  std::deque < Ptr<Packet> > m_txBuffer;       // Transmission buffer
   std::map <uint16_t, Ptr<Packet> > m_rxBuffer; // Reception buffer
   std::vector < Ptr<Packet> > m_reasBuffer;     // Reassembling buffer
 
@@ -586,6 +586,8 @@ main (int argc, char *argv[])
   NetDeviceContainer mmWaveEnbDevs = mmwaveHelper->InstallEnbDevice (mmWaveEnbNodes);
   NetDeviceContainer mcUeDevs;
   mcUeDevs = mmwaveHelper->InstallMcUeDevice (ueNodes);
+  // fix the streams of the noise added to the SINR samples
+  mmwaveHelper->AssignStreams (mmWaveEnbDevs, 1);
 
   // Install the IP stack on the UEs
   internet.Install (ueNodes);
@@ -0,0 +1,73 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+*   Copyright (c) 2020, University of Padova, Dep. of Information Engineering, SIGNET lab
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License version 2 as
+*   published by the Free Software Foundation;
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+/*
+ * Converts the binary traces written by MmWavePhyTrace and MmWaveMacTrace,
+ * when their BinaryFormat attribute is true, to the text traces.
+ *
+ * ./waf --run "mmwave-trace-to-text --input=RxPacketTrace.txt.bin --output=RxPacketTrace.txt"
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/mmwave-binary-trace.h"
+#include <fstream>
+#include <iostream>
+
+using namespace ns3;
+using namespace mmwave;
+
+int
+main (int argc, char *argv[])
+{
+  std::string input;
+  std::string output;
+
+  CommandLine cmd;
+  cmd.AddValue ("input", "The binary trace file", input);
+  cmd.AddValue ("output", "The text trace file, if empty the trace is written to the standard output", output);
+  cmd.Parse (argc, argv);
+
+  if (input.empty ())
+    {
+      std::cerr << "The input file is missing" << std::endl;
+      return 1;
+    }
+
+  bool success;
+  if (output.empty ())
+    {
+      success = MmWaveBinaryTraceWriter::ConvertToText (input, std::cout);
+    }
+  else
+    {
+      std::ofstream os (output.c_str ());
+      if (!os.is_open ())
+        {
+          std::cerr << "Could not open " << output << std::endl;
+          return 1;
+        }
+      success = MmWaveBinaryTraceWriter::ConvertToText (input, os);
+    }
+
+  if (!success)
+    {
+      std::cerr << "Could not convert " << input << std::endl;
+      return 1;
+    }
+  return 0;
+}
@@ -50,6 +50,7 @@ NS_OBJECT_ENSURE_REGISTERED ( MmWaveBearerStatsCalculator);
 
 MmWaveBearerStatsCalculator::MmWaveBearerStatsCalculator ()
   : m_firstWrite (true),
+    m_flushScheduled (false),
     m_pendingOutput (false),
     m_protocolType ("RLC")
 {
@@ -58,6 +59,7 @@ MmWaveBearerStatsCalculator::MmWaveBearerStatsCalculator ()
 
 MmWaveBearerStatsCalculator::MmWaveBearerStatsCalculator (std::string protocolType)
   : m_firstWrite (true),
+    m_flushScheduled (false),
     m_pendingOutput (false)
 {
   NS_LOG_FUNCTION (this);
@@ -153,37 +155,158 @@ MmWaveBearerStatsCalculator::GetEpoch () const
   return m_epochDuration;
 }
 
+MmWaveBearerStatsCalculator::BearerStats::BearerStats (ImsiLcidPair_t p)
+  : m_imsiLcid (p),
+    m_cellId (0),
+    m_txPackets (0),
+    m_rxPackets (0),
+    m_txData (0),
+    m_rxData (0)
+{
+}
+
 void
-MmWaveBearerStatsCalculator::UlTxPdu (uint16_t cellId, uint64_t imsi, uint16_t rnti, uint8_t lcid, uint32_t packetSize)
+MmWaveBearerStatsCalculator::BearerStats::Reset (void)
 {
-  NS_LOG_FUNCTION (this << "UlTxPdu" << cellId << imsi << rnti << (uint32_t) lcid << packetSize);
+  m_txPackets = 0;
+  m_rxPackets = 0;
+  m_txData = 0;
+  m_rxData = 0;
+  if (m_delay)
+    {
+      m_delay->Reset ();
+      m_pduSize->Reset ();
+    }
+}
+
+std::vector<double>
+MmWaveBearerStatsCalculator::BearerStats::GetDelayStats (void) const
+{
+  std::vector<double> stats (4, 0.0);
+  if (m_delay && m_delay->getCount () > 0)
+    {
+      stats[0] = m_delay->getMean ();
+      stats[1] = m_delay->getStddev ();
+      stats[2] = m_delay->getMin ();
+      stats[3] = m_delay->getMax ();
+    }
+  return stats;
+}
+
+std::vector<double>
+MmWaveBearerStatsCalculator::BearerStats::GetPduSizeStats (void) const
+{
+  std::vector<double> stats (4, 0.0);
+  if (m_pduSize && m_pduSize->getCount () > 0)
+    {
+      stats[0] = m_pduSize->getMean ();
+      stats[1] = m_pduSize->getStddev ();
+      stats[2] = m_pduSize->getMin ();
+      stats[3] = m_pduSize->getMax ();
+    }
+  return stats;
+}
+
+MmWaveBearerStatsCalculator::BearerStats&
+MmWaveBearerStatsCalculator::BearerStatsTable::Get (uint64_t imsi, uint8_t lcid)
+{
+  ImsiLcidPair_t p (imsi, lcid);
+  auto ret = m_index.insert (std::make_pair (p, m_stats.size ()));
+  if (ret.second)
+    {
+      m_stats.push_back (BearerStats (p));
+    }
+  return m_stats[ret.first->second];
+}
+
+const MmWaveBearerStatsCalculator::BearerStats*
+MmWaveBearerStatsCalculator::BearerStatsTable::Find (uint64_t imsi, uint8_t lcid) const
+{
+  auto it = m_index.find (ImsiLcidPair_t (imsi, lcid));
+  if (it == m_index.end ())
+    {
+      return 0;
+    }
+  return &m_stats[it->second];
+}
+
+void
+MmWaveBearerStatsCalculator::BearerStatsTable::Reset (void)
+{
+  for (auto &stats : m_stats)
+    {
+      stats.Reset ();
+    }
+}
+
+const std::vector<MmWaveBearerStatsCalculator::BearerStats>&
+MmWaveBearerStatsCalculator::BearerStatsTable::GetStats (void) const
+{
+  return m_stats;
+}
 
+bool
+MmWaveBearerStatsCalculator::OpenOutputFiles (void)
+{
   if (!m_ulOutFile.is_open ())
     {
       m_ulOutFile.open (GetUlOutputFilename ().c_str ());
+      if (!m_ulOutFile.is_open ())
+        {
+          NS_LOG_ERROR ("Can't open file " << GetUlOutputFilename ().c_str ());
+          return false;
+        }
+    }
+  if (!m_dlOutFile.is_open ())
+    {
+      m_dlOutFile.open (GetDlOutputFilename ().c_str ());
+      if (!m_dlOutFile.is_open ())
+        {
+          NS_LOG_ERROR ("Can't open file " << GetDlOutputFilename ().c_str ());
+          return false;
+        }
     }
+  if (!m_flushScheduled)
+    {
+      // the lines are not flushed one by one, flush them when the
+      // simulation ends
+      m_flushScheduled = true;
+      Simulator::ScheduleDestroy (&MmWaveBearerStatsCalculator::FlushOutputFiles,
+                                  Ptr<MmWaveBearerStatsCalculator> (this));
+    }
+  return true;
+}
+
+void
+MmWaveBearerStatsCalculator::FlushOutputFiles (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_flushScheduled = false;
+  m_ulOutFile.flush ();
+  m_dlOutFile.flush ();
+}
+
+void
+MmWaveBearerStatsCalculator::UlTxPdu (uint16_t cellId, uint64_t imsi, uint16_t rnti, uint8_t lcid, uint32_t packetSize)
+{
+  NS_LOG_FUNCTION (this << "UlTxPdu" << cellId << imsi << rnti << (uint32_t) lcid << packetSize);
 
-  // if (m_protocolType == "RLC")
-  // {
-  //    m_ulOutFile << "R ";
-  // }
-  // else
-  // {
-  //    m_ulOutFile << "P ";
-  // }
+  if (!m_flushScheduled)
+    {
+      OpenOutputFiles ();
+    }
 
   m_ulOutFile << "Tx " << Simulator::Now ().GetNanoSeconds () / 1.0e9 << " " << cellId << " "
-              << rnti << " " << (uint32_t) lcid << " " << packetSize << " " << std::endl;
+              << rnti << " " << (uint32_t) lcid << " " << packetSize << " " << "\n";
 
-  /*ImsiLcidPair_t p (imsi, lcid);
   if (Simulator::Now () >= m_startTime)
     {
-      m_ulCellId[p] = cellId;
-      m_flowId[p] = LteFlowId_t (rnti, lcid);
-      m_ulTxPackets[p]++;
-      m_ulTxData[p] += packetSize;
+      BearerStats &stats = m_ulStats.Get (imsi, lcid);
+      stats.m_cellId = cellId;
+      stats.m_flowId = LteFlowId_t (rnti, lcid);
+      stats.m_txPackets++;
+      stats.m_txData += packetSize;
     }
-  m_pendingOutput = true;*/
 }
 
 void
@@ -191,33 +314,22 @@ MmWaveBearerStatsCalculator::DlTxPdu (uint16_t cellId, uint64_t imsi, uint16_t r
 {
   NS_LOG_FUNCTION (this << "DlTxPDU" << cellId << imsi << rnti << (uint32_t) lcid << packetSize);
 
-  if (!m_dlOutFile.is_open ())
+  if (!m_flushScheduled)
     {
-      m_dlOutFile.open (GetDlOutputFilename ().c_str ());
+      OpenOutputFiles ();
     }
 
-  // if (m_protocolType == "RLC")
-  // {
-  //    m_dlOutFile << "R ";
-  // }
-  // else
-  // {
-  //    m_dlOutFile << "P ";
-  // }
-
   m_dlOutFile << "Tx " << Simulator::Now ().GetNanoSeconds () / 1.0e9 << " " << cellId << " "
-              << rnti << " " << (uint32_t) lcid << " " << packetSize << " " << std::endl;
-
+              << rnti << " " << (uint32_t) lcid << " " << packetSize << " " << "\n";
 
-  /*ImsiLcidPair_t p (imsi, lcid);
   if (Simulator::Now () >= m_startTime)
     {
-      m_dlCellId[p] = cellId;
-      m_flowId[p] = LteFlowId_t (rnti, lcid);
-      m_dlTxPackets[p]++;
-      m_dlTxData[p] += packetSize;
+      BearerStats &stats = m_dlStats.Get (imsi, lcid);
+      stats.m_cellId = cellId;
+      stats.m_flowId = LteFlowId_t (rnti, lcid);
+      stats.m_txPackets++;
+      stats.m_txData += packetSize;
     }
-  m_pendingOutput = true;*/
 }
 
 void
@@ -226,41 +338,29 @@ MmWaveBearerStatsCalculator::UlRxPdu (uint16_t cellId, uint64_t imsi, uint16_t r
 {
   NS_LOG_FUNCTION (this << "UlRxPDU" << cellId << imsi << rnti << (uint32_t) lcid << packetSize << delay);
 
-  if (!m_ulOutFile.is_open ())
+  if (!m_flushScheduled)
     {
-      m_ulOutFile.open (GetUlOutputFilename ().c_str ());
+      OpenOutputFiles ();
     }
 
-  // if (m_protocolType == "RLC")
-  // {
-  //    m_ulOutFile << "R ";
-  // }
-  // else
-  // {
-  //    m_ulOutFile << "P ";
-  // }
-
   m_ulOutFile << "Rx " << Simulator::Now ().GetNanoSeconds () / 1.0e9 << " " << cellId << " "
-              << rnti << " " << (uint32_t) lcid << " " << packetSize << " " << delay << std::endl;
+              << rnti << " " << (uint32_t) lcid << " " << packetSize << " " << delay << "\n";
 
-  /*ImsiLcidPair_t p (imsi, lcid);
   if (Simulator::Now () >= m_startTime)
     {
-      m_ulCellId[p] = cellId;
-      m_ulRxPackets[p]++;
-      m_ulRxData[p] += packetSize;
-
-      Uint64StatsMap::iterator it = m_ulDelay.find (p);
-      if (it == m_ulDelay.end ())
+      BearerStats &stats = m_ulStats.Get (imsi, lcid);
+      stats.m_cellId = cellId;
+      stats.m_rxPackets++;
+      stats.m_rxData += packetSize;
+      if (!stats.m_delay)
         {
-          NS_LOG_DEBUG (this << " Creating UL stats calculators for IMSI " << p.m_imsi << " and LCID " << (uint32_t) p.m_lcId);
-          m_ulDelay[p] = CreateObject<MinMaxAvgTotalCalculator<uint64_t> > ();
-          m_ulPduSize[p] = CreateObject<MinMaxAvgTotalCalculator<uint32_t> > ();
+          NS_LOG_DEBUG (this << " Creating UL stats calculators for IMSI " << imsi << " and LCID " << (uint32_t) lcid);
+          stats.m_delay = CreateObject<MinMaxAvgTotalCalculator<uint64_t> > ();
+          stats.m_pduSize = CreateObject<MinMaxAvgTotalCalculator<uint32_t> > ();
         }
-      m_ulDelay[p]->Update (delay);
-      m_ulPduSize[p]->Update (packetSize);
+      stats.m_delay->Update (delay);
+      stats.m_pduSize->Update (packetSize);
     }
-  m_pendingOutput = true;*/
 }
 
 void
@@ -268,41 +368,29 @@ MmWaveBearerStatsCalculator::DlRxPdu (uint16_t cellId, uint64_t imsi, uint16_t r
 {
   NS_LOG_FUNCTION (this << "DlRxPDU" << cellId << imsi << rnti << (uint32_t) lcid << packetSize << delay);
 
-  if (!m_dlOutFile.is_open ())
+  if (!m_flushScheduled)
     {
-      m_dlOutFile.open (GetDlOutputFilename ().c_str ());
+      OpenOutputFiles ();
     }
 
-  // if (m_protocolType == "RLC")
-  // {
-  //    m_dlOutFile << "R ";
-  // }
-  // else
-  // {
-  //    m_dlOutFile << "P ";
-  // }
-
   m_dlOutFile << "Rx " << Simulator::Now ().GetNanoSeconds () / 1.0e9 << " " << cellId << " "
-              << rnti << " " << (uint32_t) lcid << " " << packetSize << " " << delay << std::endl;
-
-  /* ImsiLcidPair_t p (imsi, lcid);
-   if (Simulator::Now () >= m_startTime)
-     {
-       m_dlCellId[p] = cellId;
-       m_dlRxPackets[p]++;
-       m_dlRxData[p] += packetSize;
-
-       Uint64StatsMap::iterator it = m_dlDelay.find (p);
-       if (it == m_dlDelay.end ())
-         {
-           NS_LOG_DEBUG (this << " Creating DL stats calculators for IMSI " << p.m_imsi << " and LCID " << (uint32_t) p.m_lcId);
-           m_dlDelay[p] = CreateObject<MinMaxAvgTotalCalculator<uint64_t> > ();
-           m_dlPduSize[p] = CreateObject<MinMaxAvgTotalCalculator<uint32_t> > ();
-         }
-       m_dlDelay[p]->Update (delay);
-       m_dlPduSize[p]->Update (packetSize);
-     }
-   m_pendingOutput = true;*/
+              << rnti << " " << (uint32_t) lcid << " " << packetSize << " " << delay << "\n";
+
+  if (Simulator::Now () >= m_startTime)
+    {
+      BearerStats &stats = m_dlStats.Get (imsi, lcid);
+      stats.m_cellId = cellId;
+      stats.m_rxPackets++;
+      stats.m_rxData += packetSize;
+      if (!stats.m_delay)
+        {
+          NS_LOG_DEBUG (this << " Creating DL stats calculators for IMSI " << imsi << " and LCID " << (uint32_t) lcid);
+          stats.m_delay = CreateObject<MinMaxAvgTotalCalculator<uint64_t> > ();
+          stats.m_pduSize = CreateObject<MinMaxAvgTotalCalculator<uint32_t> > ();
+        }
+      stats.m_delay->Update (delay);
+      stats.m_pduSize->Update (packetSize);
+    }
 }
 
 void
@@ -312,146 +400,63 @@ MmWaveBearerStatsCalculator::ShowResults (void)
   NS_LOG_FUNCTION (this << GetUlOutputFilename ().c_str () << GetDlOutputFilename ().c_str ());
   NS_LOG_INFO ("Write Rlc Stats in " << GetUlOutputFilename ().c_str () << " and in " << GetDlOutputFilename ().c_str ());
 
-  std::ofstream ulOutFile;
-  std::ofstream dlOutFile;
+  if (!OpenOutputFiles ())
+    {
+      return;
+    }
 
   if (m_firstWrite == true)
     {
-      ulOutFile.open (GetUlOutputFilename ().c_str ());
-      if (!ulOutFile.is_open ())
-        {
-          NS_LOG_ERROR ("Can't open file " << GetUlOutputFilename ().c_str ());
-          return;
-        }
-
-      dlOutFile.open (GetDlOutputFilename ().c_str ());
-      if (!dlOutFile.is_open ())
-        {
-          NS_LOG_ERROR ("Can't open file " << GetDlOutputFilename ().c_str ());
-          return;
-        }
       m_firstWrite = false;
-      ulOutFile << "% start\tend\tCellId\tIMSI\tRNTI\tLCID\tnTxPDUs\tTxBytes\tnRxPDUs\tRxBytes\t";
-      ulOutFile << "delay\tstdDev\tmin\tmax\t";
-      ulOutFile << "PduSize\tstdDev\tmin\tmax";
-      ulOutFile << std::endl;
-      dlOutFile << "% start\tend\tCellId\tIMSI\tRNTI\tLCID\tnTxPDUs\tTxBytes\tnRxPDUs\tRxBytes\t";
-      dlOutFile << "delay\tstdDev\tmin\tmax\t";
-      dlOutFile << "PduSize\tstdDev\tmin\tmax";
-      dlOutFile << std::endl;
-    }
-  else
-    {
-      ulOutFile.open (GetUlOutputFilename ().c_str (), std::ios_base::app);
-      if (!ulOutFile.is_open ())
-        {
-          NS_LOG_ERROR ("Can't open file " << GetUlOutputFilename ().c_str ());
-          return;
-        }
-
-      dlOutFile.open (GetDlOutputFilename ().c_str (), std::ios_base::app);
-      if (!dlOutFile.is_open ())
-        {
-          NS_LOG_ERROR ("Can't open file " << GetDlOutputFilename ().c_str ());
-          return;
-        }
+      m_ulOutFile << "% start\tend\tCellId\tIMSI\tRNTI\tLCID\tnTxPDUs\tTxBytes\tnRxPDUs\tRxBytes\t";
+      m_ulOutFile << "delay\tstdDev\tmin\tmax\t";
+      m_ulOutFile << "PduSize\tstdDev\tmin\tmax";
+      m_ulOutFile << "\n";
+      m_dlOutFile << "% start\tend\tCellId\tIMSI\tRNTI\tLCID\tnTxPDUs\tTxBytes\tnRxPDUs\tRxBytes\t";
+      m_dlOutFile << "delay\tstdDev\tmin\tmax\t";
+      m_dlOutFile << "PduSize\tstdDev\tmin\tmax";
+      m_dlOutFile << "\n";
     }
 
-  WriteUlResults (ulOutFile);
-  WriteDlResults (dlOutFile);
+  WriteResults (m_ulOutFile, m_ulStats);
+  WriteResults (m_dlOutFile, m_dlStats);
   m_pendingOutput = false;
 
 }
 
 void
-MmWaveBearerStatsCalculator::WriteUlResults (std::ofstream& outFile)
+MmWaveBearerStatsCalculator::WriteResults (std::ofstream& outFile, const BearerStatsTable &table)
 {
   NS_LOG_FUNCTION (this);
 
-  // Get the unique IMSI / LCID list
-
-  std::vector < ImsiLcidPair_t > pairVector;
-  for (Uint32Map::iterator it = m_ulTxPackets.begin (); it != m_ulTxPackets.end (); ++it)
-    {
-      if (find (pairVector.begin (), pairVector.end (), (*it).first) == pairVector.end ())
-        {
-          pairVector.push_back ((*it).first);
-        }
-    }
-
   Time endTime = m_startTime + m_epochDuration;
-  for (std::vector<ImsiLcidPair_t>::iterator it = pairVector.begin (); it != pairVector.end (); ++it)
+  for (const BearerStats &bearerStats : table.GetStats ())
     {
-      ImsiLcidPair_t p = *it;
-      outFile << m_startTime.GetNanoSeconds () / 1.0e9 << "\t";
-      outFile << endTime.GetNanoSeconds () / 1.0e9 << "\t";
-      outFile << GetUlCellId (p.m_imsi, p.m_lcId) << "\t";
-      outFile << p.m_imsi << "\t";
-      outFile << m_flowId[p].m_rnti << "\t";
-      outFile << (uint32_t) m_flowId[p].m_lcId << "\t";
-      outFile << GetUlTxPackets (p.m_imsi, p.m_lcId) << "\t";
-      outFile << GetUlTxData (p.m_imsi, p.m_lcId) << "\t";
-      outFile << GetUlRxPackets (p.m_imsi, p.m_lcId) << "\t";
-      outFile << GetUlRxData (p.m_imsi, p.m_lcId) << "\t";
-      std::vector<double> stats = GetUlDelayStats (p.m_imsi, p.m_lcId);
-      for (std::vector<double>::iterator it = stats.begin (); it != stats.end (); ++it)
-        {
-          outFile << (*it) * 1e-9 << "\t";
-        }
-      stats = GetUlPduSizeStats (p.m_imsi, p.m_lcId);
-      for (std::vector<double>::iterator it = stats.begin (); it != stats.end (); ++it)
+      // only the bearers which transmitted in this epoch are written
+      if (bearerStats.m_txPackets == 0)
         {
-          outFile << (*it) << "\t";
+          continue;
         }
-      outFile << std::endl;
-    }
-
-  outFile.close ();
-}
-
-void
-MmWaveBearerStatsCalculator::WriteDlResults (std::ofstream& outFile)
-{
-  NS_LOG_FUNCTION (this);
-
-  // Get the unique IMSI list
-  std::vector < ImsiLcidPair_t > pairVector;
-  for (Uint32Map::iterator it = m_dlTxPackets.begin (); it != m_dlTxPackets.end (); ++it)
-    {
-      if (find (pairVector.begin (), pairVector.end (), (*it).first) == pairVector.end ())
-        {
-          pairVector.push_back ((*it).first);
-        }
-    }
-
-  Time endTime = m_startTime + m_epochDuration;
-  for (std::vector<ImsiLcidPair_t>::iterator pair = pairVector.begin (); pair != pairVector.end (); ++pair)
-    {
-      ImsiLcidPair_t p = *pair;
       outFile << m_startTime.GetNanoSeconds () / 1.0e9 << "\t";
       outFile << endTime.GetNanoSeconds () / 1.0e9 << "\t";
-      outFile << GetDlCellId (p.m_imsi, p.m_lcId) << "\t";
-      outFile << p.m_imsi << "\t";
-      outFile << m_flowId[p].m_rnti << "\t";
-      outFile << (uint32_t) m_flowId[p].m_lcId << "\t";
-      outFile << GetDlTxPackets (p.m_imsi, p.m_lcId) << "\t";
-      outFile << GetDlTxData (p.m_imsi, p.m_lcId) << "\t";
-      outFile << GetDlRxPackets (p.m_imsi, p.m_lcId) << "\t";
-      outFile << GetDlRxData (p.m_imsi, p.m_lcId) << "\t";
-      std::vector<double> stats = GetDlDelayStats (p.m_imsi, p.m_lcId);
-      for (std::vector<double>::iterator it = stats.begin (); it != stats.end (); ++it)
+      outFile << bearerStats.m_cellId << "\t";
+      outFile << bearerStats.m_imsiLcid.m_imsi << "\t";
+      outFile << bearerStats.m_flowId.m_rnti << "\t";
+      outFile << (uint32_t) bearerStats.m_flowId.m_lcId << "\t";
+      outFile << bearerStats.m_txPackets << "\t";
+      outFile << bearerStats.m_txData << "\t";
+      outFile << bearerStats.m_rxPackets << "\t";
+      outFile << bearerStats.m_rxData << "\t";
+      for (double stat : bearerStats.GetDelayStats ())
         {
-          outFile << (*it) * 1e-9 << "\t";
+          outFile << stat * 1e-9 << "\t";
         }
-      stats = GetDlPduSizeStats (p.m_imsi, p.m_lcId);
-      for (std::vector<double>::iterator it = stats.begin (); it != stats.end (); ++it)
+      for (double stat : bearerStats.GetPduSizeStats ())
         {
-          outFile << (*it) << "\t";
+          outFile << stat << "\t";
         }
-      outFile << std::endl;
+      outFile << "\n";
     }
-
-  outFile.close ();
 }
 
 void
@@ -459,19 +464,8 @@ MmWaveBearerStatsCalculator::ResetResults (void)
 {
   NS_LOG_FUNCTION (this);
 
-  m_ulTxPackets.erase (m_ulTxPackets.begin (), m_ulTxPackets.end ());
-  m_ulRxPackets.erase (m_ulRxPackets.begin (), m_ulRxPackets.end ());
-  m_ulRxData.erase (m_ulRxData.begin (), m_ulRxData.end ());
-  m_ulTxData.erase (m_ulTxData.begin (), m_ulTxData.end ());
-  m_ulDelay.erase (m_ulDelay.begin (), m_ulDelay.end ());
-  m_ulPduSize.erase (m_ulPduSize.begin (), m_ulPduSize.end ());
-
-  m_dlTxPackets.erase (m_dlTxPackets.begin (), m_dlTxPackets.end ());
-  m_dlRxPackets.erase (m_dlRxPackets.begin (), m_dlRxPackets.end ());
-  m_dlRxData.erase (m_dlRxData.begin (), m_dlRxData.end ());
-  m_dlTxData.erase (m_dlTxData.begin (), m_dlTxData.end ());
-  m_dlDelay.erase (m_dlDelay.begin (), m_dlDelay.end ());
-  m_dlPduSize.erase (m_dlPduSize.begin (), m_dlPduSize.end ());
+  m_ulStats.Reset ();
+  m_dlStats.Reset ();
 }
 
 void
@@ -497,201 +491,154 @@ uint32_t
 MmWaveBearerStatsCalculator::GetUlTxPackets (uint64_t imsi, uint8_t lcid)
 {
   NS_LOG_FUNCTION (this << imsi << (uint16_t) lcid);
-  ImsiLcidPair_t p (imsi, lcid);
-  return m_ulTxPackets[p];
+  const BearerStats *stats = m_ulStats.Find (imsi, lcid);
+  return stats ? stats->m_txPackets : 0;
 }
 
 uint32_t
 MmWaveBearerStatsCalculator::GetUlRxPackets (uint64_t imsi, uint8_t lcid)
 {
   NS_LOG_FUNCTION (this << imsi << (uint16_t) lcid);
-  ImsiLcidPair_t p (imsi, lcid);
-  return m_ulRxPackets[p];
+  const BearerStats *stats = m_ulStats.Find (imsi, lcid);
+  return stats ? stats->m_rxPackets : 0;
 }
 
 uint64_t
 MmWaveBearerStatsCalculator::GetUlTxData (uint64_t imsi, uint8_t lcid)
 {
   NS_LOG_FUNCTION (this << imsi << (uint16_t) lcid);
-  ImsiLcidPair_t p (imsi, lcid);
-  return m_ulTxData[p];
+  const BearerStats *stats = m_ulStats.Find (imsi, lcid);
+  return stats ? stats->m_txData : 0;
 }
 
 uint64_t
 MmWaveBearerStatsCalculator::GetUlRxData (uint64_t imsi, uint8_t lcid)
 {
   NS_LOG_FUNCTION (this << imsi << (uint16_t) lcid);
-  ImsiLcidPair_t p (imsi, lcid);
-  return m_ulRxData[p];
+  const BearerStats *stats = m_ulStats.Find (imsi, lcid);
+  return stats ? stats->m_rxData : 0;
+}
+
+uint32_t
+MmWaveBearerStatsCalculator::GetUlCellId (uint64_t imsi, uint8_t lcid)
+{
+  NS_LOG_FUNCTION (this << imsi << (uint16_t) lcid);
+  const BearerStats *stats = m_ulStats.Find (imsi, lcid);
+  return stats ? stats->m_cellId : 0;
 }
 
 double
 MmWaveBearerStatsCalculator::GetUlDelay (uint64_t imsi, uint8_t lcid)
 {
   NS_LOG_FUNCTION (this << imsi << (uint16_t) lcid);
-  ImsiLcidPair_t p (imsi, lcid);
-  Uint64StatsMap::iterator it = m_ulDelay.find (p);
-  if (it == m_ulDelay.end ())
+  const BearerStats *stats = m_ulStats.Find (imsi, lcid);
+  if (!stats || !stats->m_delay || stats->m_delay->getCount () == 0)
     {
       NS_LOG_ERROR ("UL delay for " << imsi << " - " << (uint16_t) lcid << " not found");
       return 0;
-
     }
-  return m_ulDelay[p]->getMean ();
+  return stats->m_delay->getMean ();
 }
 
 std::vector<double>
 MmWaveBearerStatsCalculator::GetUlDelayStats (uint64_t imsi, uint8_t lcid)
 {
   NS_LOG_FUNCTION (this << imsi << (uint16_t) lcid);
-  ImsiLcidPair_t p (imsi, lcid);
-  std::vector<double> stats;
-  Uint64StatsMap::iterator it = m_ulDelay.find (p);
-  if (it == m_ulDelay.end ())
+  const BearerStats *stats = m_ulStats.Find (imsi, lcid);
+  if (!stats)
     {
-      stats.push_back (0.0);
-      stats.push_back (0.0);
-      stats.push_back (0.0);
-      stats.push_back (0.0);
-      return stats;
-
+      return std::vector<double> (4, 0.0);
     }
-  stats.push_back (m_ulDelay[p]->getMean ());
-  stats.push_back (m_ulDelay[p]->getStddev ());
-  stats.push_back (m_ulDelay[p]->getMin ());
-  stats.push_back (m_ulDelay[p]->getMax ());
-  return stats;
+  return stats->GetDelayStats ();
 }
 
 std::vector<double>
 MmWaveBearerStatsCalculator::GetUlPduSizeStats (uint64_t imsi, uint8_t lcid)
 {
   NS_LOG_FUNCTION (this << imsi << (uint16_t) lcid);
-  ImsiLcidPair_t p (imsi, lcid);
-  std::vector<double> stats;
-  Uint32StatsMap::iterator it = m_ulPduSize.find (p);
-  if (it == m_ulPduSize.end ())
+  const BearerStats *stats = m_ulStats.Find (imsi, lcid);
+  if (!stats)
     {
-      stats.push_back (0.0);
-      stats.push_back (0.0);
-      stats.push_back (0.0);
-      stats.push_back (0.0);
-      return stats;
-
+      return std::vector<double> (4, 0.0);
     }
-  stats.push_back (m_ulPduSize[p]->getMean ());
-  stats.push_back (m_ulPduSize[p]->getStddev ());
-  stats.push_back (m_ulPduSize[p]->getMin ());
-  stats.push_back (m_ulPduSize[p]->getMax ());
-  return stats;
+  return stats->GetPduSizeStats ();
 }
 
 uint32_t
 MmWaveBearerStatsCalculator::GetDlTxPackets (uint64_t imsi, uint8_t lcid)
 {
   NS_LOG_FUNCTION (this << imsi << (uint16_t) lcid);
-  ImsiLcidPair_t p (imsi, lcid);
-  return m_dlTxPackets[p];
+  const BearerStats *stats = m_dlStats.Find (imsi, lcid);
+  return stats ? stats->m_txPackets : 0;
 }
 
 uint32_t
 MmWaveBearerStatsCalculator::GetDlRxPackets (uint64_t imsi, uint8_t lcid)
 {
   NS_LOG_FUNCTION (this << imsi << (uint16_t) lcid);
-  ImsiLcidPair_t p (imsi, lcid);
-  return m_dlRxPackets[p];
+  const BearerStats *stats = m_dlStats.Find (imsi, lcid);
+  return stats ? stats->m_rxPackets : 0;
 }
 
 uint64_t
 MmWaveBearerStatsCalculator::GetDlTxData (uint64_t imsi, uint8_t lcid)
 {
   NS_LOG_FUNCTION (this << imsi << (uint16_t) lcid);
-  ImsiLcidPair_t p (imsi, lcid);
-  return m_dlTxData[p];
+  const BearerStats *stats = m_dlStats.Find (imsi, lcid);
+  return stats ? stats->m_txData : 0;
 }
 
 uint64_t
 MmWaveBearerStatsCalculator::GetDlRxData (uint64_t imsi, uint8_t lcid)
 {
   NS_LOG_FUNCTION (this << imsi << (uint16_t) lcid);
-  ImsiLcidPair_t p (imsi, lcid);
-  return m_dlRxData[p];
-}
-
-uint32_t
-MmWaveBearerStatsCalculator::GetUlCellId (uint64_t imsi, uint8_t lcid)
-{
-  NS_LOG_FUNCTION (this << imsi << (uint16_t) lcid);
-  ImsiLcidPair_t p (imsi, lcid);
-  return m_ulCellId[p];
+  const BearerStats *stats = m_dlStats.Find (imsi, lcid);
+  return stats ? stats->m_rxData : 0;
 }
 
 uint32_t
 MmWaveBearerStatsCalculator::GetDlCellId (uint64_t imsi, uint8_t lcid)
 {
   NS_LOG_FUNCTION (this << imsi << (uint16_t) lcid);
-  ImsiLcidPair_t p (imsi, lcid);
-  return m_dlCellId[p];
+  const BearerStats *stats = m_dlStats.Find (imsi, lcid);
+  return stats ? stats->m_cellId : 0;
 }
 
 double
 MmWaveBearerStatsCalculator::GetDlDelay (uint64_t imsi, uint8_t lcid)
 {
   NS_LOG_FUNCTION (this << imsi << (uint16_t) lcid);
-  ImsiLcidPair_t p (imsi, lcid);
-  Uint64StatsMap::iterator it = m_dlDelay.find (p);
-  if (it == m_dlDelay.end ())
+  const BearerStats *stats = m_dlStats.Find (imsi, lcid);
+  if (!stats || !stats->m_delay || stats->m_delay->getCount () == 0)
     {
-      NS_LOG_ERROR ("DL delay for " << imsi << " not found");
+      NS_LOG_ERROR ("DL delay for " << imsi << " - " << (uint16_t) lcid << " not found");
       return 0;
     }
-  return m_dlDelay[p]->getMean ();
+  return stats->m_delay->getMean ();
 }
 
 std::vector<double>
 MmWaveBearerStatsCalculator::GetDlDelayStats (uint64_t imsi, uint8_t lcid)
 {
   NS_LOG_FUNCTION (this << imsi << (uint16_t) lcid);
-  ImsiLcidPair_t p (imsi, lcid);
-  std::vector<double> stats;
-  Uint64StatsMap::iterator it = m_dlDelay.find (p);
-  if (it == m_dlDelay.end ())
+  const BearerStats *stats = m_dlStats.Find (imsi, lcid);
+  if (!stats)
     {
-      stats.push_back (0.0);
-      stats.push_back (0.0);
-      stats.push_back (0.0);
-      stats.push_back (0.0);
-      return stats;
-
+      return std::vector<double> (4, 0.0);
     }
-  stats.push_back (m_dlDelay[p]->getMean ());
-  stats.push_back (m_dlDelay[p]->getStddev ());
-  stats.push_back (m_dlDelay[p]->getMin ());
-  stats.push_back (m_dlDelay[p]->getMax ());
-  return stats;
+  return stats->GetDelayStats ();
 }
 
 std::vector<double>
 MmWaveBearerStatsCalculator::GetDlPduSizeStats (uint64_t imsi, uint8_t lcid)
 {
   NS_LOG_FUNCTION (this << imsi << (uint16_t) lcid);
-  ImsiLcidPair_t p (imsi, lcid);
-  std::vector<double> stats;
-  Uint32StatsMap::iterator it = m_dlPduSize.find (p);
-  if (it == m_dlPduSize.end ())
+  const BearerStats *stats = m_dlStats.Find (imsi, lcid);
+  if (!stats)
     {
-      stats.push_back (0.0);
-      stats.push_back (0.0);
-      stats.push_back (0.0);
-      stats.push_back (0.0);
-      return stats;
-
+      return std::vector<double> (4, 0.0);
     }
-  stats.push_back (m_dlPduSize[p]->getMean ());
-  stats.push_back (m_dlPduSize[p]->getStddev ());
-  stats.push_back (m_dlPduSize[p]->getMin ());
-  stats.push_back (m_dlPduSize[p]->getMax ());
-  return stats;
+  return stats->GetPduSizeStats ();
 }
 
 std::string
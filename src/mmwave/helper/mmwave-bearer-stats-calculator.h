@@ -37,6 +37,8 @@
 #include "ns3/lte-common.h"
 #include <string>
 #include <map>
+#include <unordered_map>
+#include <vector>
 #include <fstream>
 
 namespace ns3 {
@@ -56,6 +58,19 @@ typedef std::map<ImsiLcidPair_t, double> DoubleMap;
 /// Container: (IMSI, LCID) pair, LteFlowId_t
 typedef std::map<ImsiLcidPair_t, LteFlowId_t> FlowIdMap;
 
+/// Hash function of the (IMSI, LCID) pairs
+struct ImsiLcidPairHash
+{
+  /**
+   * \param p the (IMSI, LCID) pair
+   * \return the hash of the pair
+   */
+  size_t operator() (const ImsiLcidPair_t &p) const
+  {
+    return std::hash<uint64_t> () ((p.m_imsi << 8) ^ p.m_lcId);
+  }
+};
+
 /**
  * \ingroup lte
  *
@@ -357,30 +372,111 @@ public:
   GetDlPduSizeStats (uint64_t imsi, uint8_t lcid);
 
 private:
+  /**
+   * Statistics of a radio bearer in the current epoch, in one direction
+   */
+  struct BearerStats
+  {
+    /**
+     * Constructor
+     * \param p the (IMSI, LCID) pair of the bearer
+     */
+    BearerStats (ImsiLcidPair_t p);
+
+    /**
+     * Erases the statistics, keeping the identifiers of the bearer
+     */
+    void Reset (void);
+
+    /**
+     * \return the average, standard deviation, min and max of the delay
+     */
+    std::vector<double> GetDelayStats (void) const;
+
+    /**
+     * \return the average, standard deviation, min and max of the PDU size
+     */
+    std::vector<double> GetPduSizeStats (void) const;
+
+    ImsiLcidPair_t m_imsiLcid; //!< the (IMSI, LCID) pair
+    LteFlowId_t m_flowId; //!< the (RNTI, LCID) pair
+    uint32_t m_cellId; //!< the cell ID
+    uint32_t m_txPackets; //!< number of TX packets
+    uint32_t m_rxPackets; //!< number of RX packets
+    uint64_t m_txData; //!< amount of TX data
+    uint64_t m_rxData; //!< amount of RX data
+    Ptr<MinMaxAvgTotalCalculator<uint64_t> > m_delay; //!< the delay
+    Ptr<MinMaxAvgTotalCalculator<uint32_t> > m_pduSize; //!< the PDU size
+  };
+
+  /**
+   * Statistics of the radio bearers in one direction. They are stored
+   * contiguously, in the order in which the bearers are first seen, and
+   * indexed by (IMSI, LCID) pair.
+   */
+  class BearerStatsTable
+  {
+  public:
+    /**
+     * Get the statistics of a bearer, adding it if it is not in the table
+     * \param imsi the IMSI
+     * \param lcid the LCID
+     * \return the statistics of the bearer
+     */
+    BearerStats& Get (uint64_t imsi, uint8_t lcid);
+
+    /**
+     * Find the statistics of a bearer
+     * \param imsi the IMSI
+     * \param lcid the LCID
+     * \return the statistics of the bearer, or 0 if it is not in the table
+     */
+    const BearerStats* Find (uint64_t imsi, uint8_t lcid) const;
+
+    /**
+     * Erases the statistics of all the bearers, which are kept in the table
+     */
+    void Reset (void);
+
+    /**
+     * \return the statistics of the bearers
+     */
+    const std::vector<BearerStats>& GetStats (void) const;
+
+  private:
+    std::vector<BearerStats> m_stats; //!< the statistics of the bearers
+    std::unordered_map<ImsiLcidPair_t, uint32_t, ImsiLcidPairHash> m_index; //!< the index in m_stats of the bearers
+  };
+
   /**
    * Called after each epoch to write collected
    * statistics to output files. During first call
    * it opens output files and write columns descriptions.
-   * During next calls it opens output files in append mode.
+   * The files are kept open for the next calls.
    */
   void
   ShowResults (void);
 
   /**
-   * Writes collected statistics to UL output file and
-   * closes UL output file.
-   * @param outFile ofstream for UL statistics
+   * Writes collected statistics to an output file
+   * @param outFile ofstream for the statistics
+   * @param table the statistics
    */
   void
-  WriteUlResults (std::ofstream& outFile);
+  WriteResults (std::ofstream& outFile, const BearerStatsTable &table);
 
   /**
-   * Writes collected statistics to DL output file and
-   * closes DL output file.
-   * @param outFile ofstream for DL statistics
+   * Open the output files, if they are not open yet
+   * @return false if a file could not be opened
+   */
+  bool
+  OpenOutputFiles (void);
+
+  /**
+   * Flush the output files
    */
   void
-  WriteDlResults (std::ofstream& outFile);
+  FlushOutputFiles (void);
 
   /**
    * Erases collected statistics
@@ -403,23 +499,8 @@ private:
 
   EventId m_endEpochEvent; //!< Event id for next end epoch event
 
-  FlowIdMap m_flowId; //!< List of FlowIds, ie. (RNTI, LCID) by (IMSI, LCID) pair
-
-  Uint32Map m_dlCellId; //!< List of DL CellIds by (IMSI, LCID) pair
-  Uint32Map m_dlTxPackets; //!< Number of DL TX Packets by (IMSI, LCID) pair
-  Uint32Map m_dlRxPackets; //!< Number of DL RX Packets by (IMSI, LCID) pair
-  Uint64Map m_dlTxData; //!< Amount of DL TX Data by (IMSI, LCID) pair
-  Uint64Map m_dlRxData; //!< Amount of DL RX Data by (IMSI, LCID) pair
-  Uint64StatsMap m_dlDelay; //!< DL delay by (IMSI, LCID) pair
-  Uint32StatsMap m_dlPduSize; //!< DL PDU Size by (IMSI, LCID) pair
-
-  Uint32Map m_ulCellId; //!< List of UL CellIds by (IMSI, LCID) pair
-  Uint32Map m_ulTxPackets; //!< Number of UL TX Packets by (IMSI, LCID) pair
-  Uint32Map m_ulRxPackets; //!< Number of UL RX Packets by (IMSI, LCID) pair
-  Uint64Map m_ulTxData; //!< Amount of UL TX Data by (IMSI, LCID) pair
-  Uint64Map m_ulRxData; //!< Amount of UL RX Data by (IMSI, LCID) pair
-  Uint64StatsMap m_ulDelay; //!< UL delay by (IMSI, LCID) pair
-  Uint32StatsMap m_ulPduSize; //!< UL PDU Size by (IMSI, LCID) pair
+  BearerStatsTable m_dlStats; //!< DL statistics of the bearers
+  BearerStatsTable m_ulStats; //!< UL statistics of the bearers
 
   /**
    * Start time of the on going epoch
@@ -432,10 +513,16 @@ private:
   Time m_epochDuration;
 
   /**
-   * true if output files have not been opened yet
+   * true if the header of the statistics has not been written yet
    */
   bool m_firstWrite;
 
+  /**
+   * true if the flush of the output files at the end of the simulation has
+   * been scheduled
+   */
+  bool m_flushScheduled;
+
   /**
    * true if any output is pending
    */
@@ -456,8 +543,8 @@ private:
    */
   std::string m_ulPdcpOutputFilename;
 
-  std::ofstream m_dlOutFile;
-  std::ofstream m_ulOutFile;
+  std::ofstream m_dlOutFile; //!< the output file of the DL statistics
+  std::ofstream m_ulOutFile; //!< the output file of the UL statistics
 };
 
 } // namespace mmwave
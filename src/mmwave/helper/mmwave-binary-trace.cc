@@ -0,0 +1,251 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+*   Copyright (c) 2020, University of Padova, Dep. of Information Engineering, SIGNET lab
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License version 2 as
+*   published by the Free Software Foundation;
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include "mmwave-binary-trace.h"
+#include <ns3/log.h>
+#include <algorithm>
+#include <cstring>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveBinaryTrace");
+
+namespace mmwave {
+
+const uint32_t MmWaveTtiTraceRecord::TYPE;
+const uint32_t MmWaveRxPacketTraceRecord::TYPE;
+const uint32_t MmWaveBinaryTraceWriter::MAGIC;
+const uint32_t MmWaveBinaryTraceWriter::VERSION;
+
+MmWaveTtiTraceRecord::MmWaveTtiTraceRecord ()
+{
+  std::memset (this, 0, sizeof (*this));
+}
+
+const char*
+MmWaveTtiTraceRecord::GetHeader (void)
+{
+  return "frame\tsubF\tslot\trnti\tfirstSym\tnumSym\ttype\ttddMode\tretxNum\tccId";
+}
+
+void
+MmWaveTtiTraceRecord::Print (std::ostream &os) const
+{
+  os << +m_frameNum << "\t" << +m_sfNum << "\t"
+     << +m_slotNum << "\t" << +m_rnti << "\t"
+     << +m_symStart << "\t" << +m_numSym << "\t"
+     << +m_ttiType << "\t" << +m_tddMode << "\t"
+     << +m_rv << "\t" << +m_ccId << "\n";
+}
+
+MmWaveRxPacketTraceRecord::MmWaveRxPacketTraceRecord ()
+{
+  std::memset (this, 0, sizeof (*this));
+}
+
+const char*
+MmWaveRxPacketTraceRecord::GetHeader (void)
+{
+  return "DL/UL\ttime\tframe\tsubF\tslot\t1stSym\tsymbol#\tcellId\trnti\tccId\ttbSize\tmcs\trv\tSINR(dB)\tcorrupt\tTBler";
+}
+
+void
+MmWaveRxPacketTraceRecord::Print (std::ostream &os) const
+{
+  // the UL lines have always had a space after the SINR
+  os << (m_downlink ? "DL\t" : "UL\t") << m_time << "\t"
+     << m_frameNum << "\t" << +m_sfNum << "\t"
+     << +m_slotNum << "\t" << +m_symStart << "\t"
+     << +m_numSym << "\t" << m_cellId << "\t"
+     << m_rnti << "\t" << +m_ccId << "\t"
+     << m_tbSize << "\t" << +m_mcs << "\t"
+     << +m_rv << "\t" << m_sinrDb << (m_downlink ? "\t" : " \t")
+     << +m_corrupt << "\t" << m_tbler << "\n";
+}
+
+MmWaveBinaryTraceWriter::MmWaveBinaryTraceWriter (std::string fileName, uint32_t recordType,
+                                                  uint32_t recordSize, uint32_t bufferSize)
+  : m_recordType (recordType),
+    m_bufferSize (std::max (bufferSize, recordSize)),
+    m_stop (false)
+{
+  NS_LOG_FUNCTION (this << fileName << recordType << recordSize << bufferSize);
+
+  m_file.open (fileName.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!m_file.is_open ())
+    {
+      NS_FATAL_ERROR ("Could not open tracefile " << fileName);
+    }
+  uint32_t header[4] = {MAGIC, VERSION, recordType, recordSize};
+  m_file.write (reinterpret_cast<const char *> (header), sizeof (header));
+  m_buffer.reserve (m_bufferSize);
+}
+
+MmWaveBinaryTraceWriter::~MmWaveBinaryTraceWriter ()
+{
+  NS_LOG_FUNCTION (this);
+  Flush ();
+  m_file.close ();
+}
+
+void
+MmWaveBinaryTraceWriter::Dispatch (void)
+{
+  if (m_buffer.empty ())
+    {
+      return;
+    }
+
+#ifdef HAVE_PTHREAD_H
+  {
+    std::lock_guard<std::mutex> lock (m_mutex);
+    m_full.push_back (std::move (m_buffer));
+    m_buffer.clear ();
+    if (!m_free.empty ())
+      {
+        m_buffer.swap (m_free.back ());
+        m_free.pop_back ();
+      }
+  }
+  if (!m_thread)
+    {
+      m_thread = ns3::Create<SystemThread> (MakeCallback (&MmWaveBinaryTraceWriter::Run, this));
+      m_thread->Start ();
+    }
+  m_condition.notify_one ();
+#else
+  m_file.write (m_buffer.data (), m_buffer.size ());
+  m_buffer.clear ();
+#endif
+  m_buffer.reserve (m_bufferSize);
+}
+
+void
+MmWaveBinaryTraceWriter::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  Dispatch ();
+#ifdef HAVE_PTHREAD_H
+  if (m_thread)
+    {
+      {
+        std::lock_guard<std::mutex> lock (m_mutex);
+        m_stop = true;
+      }
+      m_condition.notify_one ();
+      m_thread->Join ();
+      m_thread = 0;
+      m_stop = false;
+    }
+#endif
+  m_file.flush ();
+}
+
+void
+MmWaveBinaryTraceWriter::Run (void)
+{
+#ifdef HAVE_PTHREAD_H
+  std::unique_lock<std::mutex> lock (m_mutex);
+  while (true)
+    {
+      // the queue is checked under the same mutex of the producers, hence
+      // no notification can be missed between the check and the wait
+      m_condition.wait (lock, [this] () { return !m_full.empty () || m_stop; });
+      if (m_full.empty ())
+        {
+          // the queue is drained before stopping
+          return;
+        }
+
+      std::vector<char> buffer;
+      buffer.swap (m_full.front ());
+      m_full.pop_front ();
+      lock.unlock ();
+
+      // only this thread writes to the file while it is running
+      m_file.write (buffer.data (), buffer.size ());
+      buffer.clear ();
+
+      lock.lock ();
+      m_free.push_back (std::move (buffer));
+    }
+#endif
+}
+
+/**
+ * Print the records of a binary trace file
+ * \param is the input stream, positioned after the file header
+ * \param os the output stream of the text trace
+ * \return false if the file ends with an incomplete record
+ */
+template <class T>
+static bool
+PrintRecords (std::istream &is, std::ostream &os)
+{
+  os << T::GetHeader () << "\n";
+  std::vector<T> records (4096);
+  while (is)
+    {
+      is.read (reinterpret_cast<char *> (records.data ()), records.size () * sizeof (T));
+      std::streamsize numBytes = is.gcount ();
+      for (std::streamsize i = 0; i < numBytes / static_cast<std::streamsize> (sizeof (T)); ++i)
+        {
+          records[i].Print (os);
+        }
+      if (numBytes % sizeof (T) != 0)
+        {
+          NS_LOG_WARN ("The file ends with an incomplete record");
+          return false;
+        }
+    }
+  return true;
+}
+
+bool
+MmWaveBinaryTraceWriter::ConvertToText (std::string fileName, std::ostream &os)
+{
+  NS_LOG_FUNCTION (fileName);
+
+  std::ifstream is (fileName.c_str (), std::ios::in | std::ios::binary);
+  uint32_t header[4];
+  if (!is.read (reinterpret_cast<char *> (header), sizeof (header)))
+    {
+      NS_LOG_WARN ("Could not read the header of " << fileName);
+      return false;
+    }
+  if (header[0] != MAGIC || header[1] != VERSION)
+    {
+      NS_LOG_WARN (fileName << " is not a binary trace of this version");
+      return false;
+    }
+
+  if (header[2] == MmWaveTtiTraceRecord::TYPE && header[3] == sizeof (MmWaveTtiTraceRecord))
+    {
+      return PrintRecords<MmWaveTtiTraceRecord> (is, os);
+    }
+  if (header[2] == MmWaveRxPacketTraceRecord::TYPE && header[3] == sizeof (MmWaveRxPacketTraceRecord))
+    {
+      return PrintRecords<MmWaveRxPacketTraceRecord> (is, os);
+    }
+  NS_LOG_WARN ("Unknown record type " << header[2] << " of size " << header[3]);
+  return false;
+}
+
+} // namespace mmwave
+
+} // namespace ns3
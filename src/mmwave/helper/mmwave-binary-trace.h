@@ -0,0 +1,331 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+*   Copyright (c) 2020, University of Padova, Dep. of Information Engineering, SIGNET lab
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License version 2 as
+*   published by the Free Software Foundation;
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#ifndef SRC_MMWAVE_HELPER_MMWAVE_BINARY_TRACE_H_
+#define SRC_MMWAVE_HELPER_MMWAVE_BINARY_TRACE_H_
+
+#include <ns3/simple-ref-count.h>
+#include <ns3/assert.h>
+#include <ns3/ptr.h>
+#include <ns3/fatal-error.h>
+#include <ns3/simulator.h>
+#include <deque>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <ns3/core-config.h>
+#ifdef HAVE_PTHREAD_H
+#include <ns3/system-thread.h>
+#include <condition_variable>
+#include <mutex>
+#endif
+
+namespace ns3 {
+
+namespace mmwave {
+
+/**
+ * Record of the PHY transmission traces and of the scheduling allocation
+ * trace, which share the same layout
+ */
+struct MmWaveTtiTraceRecord
+{
+  uint16_t m_frameNum; //!< frame number
+  uint16_t m_rnti; //!< the RNTI
+  uint8_t m_sfNum; //!< subframe number
+  uint8_t m_slotNum; //!< slot number
+  uint8_t m_symStart; //!< index of the first OFDM symbol
+  uint8_t m_numSym; //!< number of OFDM symbols
+  uint8_t m_ttiType; //!< TDD transmission type
+  uint8_t m_tddMode; //!< TDD mode
+  uint8_t m_rv; //!< retransmission number
+  uint8_t m_ccId; //!< the component carrier ID
+
+  static const uint32_t TYPE = 1; //!< identifies the record in the binary files
+
+  /**
+   * Constructor. Zeroes the record, including the padding, so that the
+   * binary files do not depend on uninitialized memory.
+   */
+  MmWaveTtiTraceRecord ();
+
+  /**
+   * \return the header line of the text trace
+   */
+  static const char* GetHeader (void);
+
+  /**
+   * Print the record as a line of the text trace
+   * \param os the output stream
+   */
+  void Print (std::ostream &os) const;
+};
+
+/**
+ * Record of the PHY reception trace
+ */
+struct MmWaveRxPacketTraceRecord
+{
+  double m_time; //!< the reception time, in seconds
+  double m_sinrDb; //!< the average SINR, in dB
+  double m_tbler; //!< the transport block error rate
+  uint64_t m_cellId; //!< the cell ID
+  uint32_t m_tbSize; //!< transport block size
+  uint16_t m_frameNum; //!< frame index
+  uint16_t m_rnti; //!< the RNTI
+  uint8_t m_downlink; //!< 1 if the TB has been received by a UE, 0 otherwise
+  uint8_t m_sfNum; //!< subframe index
+  uint8_t m_slotNum; //!< slot index
+  uint8_t m_symStart; //!< index of the first OFDM symbol
+  uint8_t m_numSym; //!< number of OFDM symbols
+  uint8_t m_ccId; //!< the component carrier ID
+  uint8_t m_mcs; //!< the MCS
+  uint8_t m_rv; //!< the number of retransmissions
+  uint8_t m_corrupt; //!< 1 if the TB has failed
+
+  static const uint32_t TYPE = 2; //!< identifies the record in the binary files
+
+  /**
+   * Constructor. Zeroes the record, including the padding, so that the
+   * binary files do not depend on uninitialized memory.
+   */
+  MmWaveRxPacketTraceRecord ();
+
+  /**
+   * \return the header line of the text trace
+   */
+  static const char* GetHeader (void);
+
+  /**
+   * Print the record as a line of the text trace
+   * \param os the output stream
+   */
+  void Print (std::ostream &os) const;
+};
+
+/**
+ * Writes fixed-size trace records to a binary file.
+ *
+ * The records are appended to a buffer in memory and, when the buffer is
+ * full, it is written to the file by a background thread, so that the
+ * simulation is not stalled by the I/O. The written buffers are recycled.
+ * If threads are not available, the buffers are written when they are full.
+ *
+ * The file starts with a header which stores a magic number, the format
+ * version, the type of the records and their size, followed by the records
+ * in the memory layout of the record struct. ConvertToText converts the
+ * file to the text trace.
+ */
+class MmWaveBinaryTraceWriter : public SimpleRefCount<MmWaveBinaryTraceWriter>
+{
+public:
+  /**
+   * Constructor. Opens the file and writes the header.
+   * \param fileName the name of the file
+   * \param recordType the type of the records
+   * \param recordSize the size of the records, in bytes
+   * \param bufferSize the size of the buffers, in bytes
+   */
+  MmWaveBinaryTraceWriter (std::string fileName, uint32_t recordType, uint32_t recordSize,
+                           uint32_t bufferSize = 1 << 20);
+
+  /**
+   * Destructor. Writes the buffered records and closes the file.
+   */
+  ~MmWaveBinaryTraceWriter ();
+
+  /**
+   * Create a writer for a record struct
+   * \param fileName the name of the file
+   * \return the writer
+   */
+  template <class T>
+  static Ptr<MmWaveBinaryTraceWriter> Create (std::string fileName)
+  {
+    return ns3::Create<MmWaveBinaryTraceWriter> (fileName, T::TYPE, sizeof (T));
+  }
+
+  /**
+   * Append a record
+   * \param record the record, which must have the type of the writer
+   */
+  template <class T>
+  void Write (const T &record)
+  {
+    NS_ASSERT (T::TYPE == m_recordType);
+    const char *data = reinterpret_cast<const char *> (&record);
+    m_buffer.insert (m_buffer.end (), data, data + sizeof (T));
+    if (m_buffer.size () + sizeof (T) > m_bufferSize)
+      {
+        Dispatch ();
+      }
+  }
+
+  /**
+   * Write all the records appended so far to the file, and stop the
+   * background thread. It is restarted when the next buffer is dispatched.
+   */
+  void Flush (void);
+
+  /**
+   * Convert a binary trace file to the text trace
+   * \param fileName the name of the binary file
+   * \param os the output stream of the text trace
+   * \return false if the file could not be read or is not a binary trace
+   */
+  static bool ConvertToText (std::string fileName, std::ostream &os);
+
+  static const uint32_t MAGIC = 0x4d6d5754; //!< the magic number of the binary files
+  static const uint32_t VERSION = 1; //!< the version of the binary format
+
+private:
+  /**
+   * Hand the current buffer to the background thread and get a new one
+   */
+  void Dispatch (void);
+
+  /**
+   * Body of the background thread
+   */
+  void Run (void);
+
+  std::ofstream m_file; //!< the binary file
+  uint32_t m_recordType; //!< the type of the records
+  uint32_t m_bufferSize; //!< the size of the buffers, in bytes
+  std::vector<char> m_buffer; //!< the buffer filled by the simulation
+  std::deque<std::vector<char> > m_full; //!< the buffers waiting to be written
+  std::vector<std::vector<char> > m_free; //!< the buffers already written, which can be reused
+  bool m_stop; //!< true if the background thread has to stop
+#ifdef HAVE_PTHREAD_H
+  std::mutex m_mutex; //!< protects m_full, m_free and m_stop
+  std::condition_variable m_condition; //!< signals new buffers and the stop request to the background thread
+  Ptr<SystemThread> m_thread; //!< the background thread
+#endif
+};
+
+/**
+ * Output file of a trace, which is written either as text or, through a
+ * MmWaveBinaryTraceWriter, as binary records.
+ *
+ * The file is flushed when the simulator is destroyed, but it is kept open,
+ * so that the following simulations of the same program append to it.
+ */
+template <class T>
+class MmWaveTraceFile
+{
+public:
+  /**
+   * Constructor
+   */
+  MmWaveTraceFile ()
+    : m_flushScheduled (false)
+  {
+  }
+
+  /**
+   * \return true if the file is open
+   */
+  bool IsOpen (void) const
+  {
+    return m_writer || m_text.is_open ();
+  }
+
+  /**
+   * Open the file and write the header of the trace
+   * \param fileName the name of the file
+   * \param binary if true, the records are written in binary format to the
+   *        file with the ".bin" extension appended, otherwise they are
+   *        written as text
+   */
+  void Open (std::string fileName, bool binary)
+  {
+    NS_ASSERT (!IsOpen ());
+    if (binary)
+      {
+        m_writer = MmWaveBinaryTraceWriter::Create<T> (fileName + ".bin");
+        return;
+      }
+    m_text.open (fileName.c_str ());
+    if (!m_text.is_open ())
+      {
+        NS_FATAL_ERROR ("Could not open tracefile");
+      }
+    m_text << T::GetHeader () << "\n";
+  }
+
+  /**
+   * Write a record
+   * \param record the record
+   */
+  void Write (const T &record)
+  {
+    if (!m_flushScheduled)
+      {
+        m_flushScheduled = true;
+        Simulator::ScheduleDestroy (&MmWaveTraceFile<T>::Flush, this);
+      }
+    if (m_writer)
+      {
+        m_writer->Write (record);
+      }
+    else
+      {
+        record.Print (m_text);
+      }
+  }
+
+  /**
+   * Write the buffered records to the file
+   */
+  void Flush (void)
+  {
+    m_flushScheduled = false;
+    if (m_writer)
+      {
+        m_writer->Flush ();
+      }
+    else if (m_text.is_open ())
+      {
+        m_text.flush ();
+      }
+  }
+
+  /**
+   * Close the file
+   */
+  void Close (void)
+  {
+    m_flushScheduled = false;
+    m_writer = 0;
+    if (m_text.is_open ())
+      {
+        m_text.close ();
+      }
+  }
+
+private:
+  std::ofstream m_text; //!< the text file
+  Ptr<MmWaveBinaryTraceWriter> m_writer; //!< the writer of the binary file
+  bool m_flushScheduled; //!< true if the flush at the end of the simulation has been scheduled
+};
+
+} // namespace mmwave
+
+} // namespace ns3
+
+#endif /* SRC_MMWAVE_HELPER_MMWAVE_BINARY_TRACE_H_ */
@@ -64,6 +64,7 @@
 #include <ns3/mmwave-beamforming-model.h>
 #include <ns3/uniform-planar-array.h>
 #include <ns3/file-beamforming-codebook.h>
+#include <ns3/mmwave-spectrum-transmit-filter.h>
 
 
 namespace ns3 {
@@ -419,6 +420,12 @@ MmWaveHelper::MmWaveChannelModelInitialization (void)
           NS_LOG_WARN (this << " No SpectrumPropagationLossModel!");
         }
 
+      // skip the receivers which would discard the signals before any
+      // PSD is computed for them
+      Ptr<MmWaveSpectrumTransmitFilter> filter = CreateObject<MmWaveSpectrumTransmitFilter> ();
+      filter->SetAttribute ("PropagationLossModel", PointerValue (channel->GetPropagationLossModel ()));
+      channel->AddSpectrumTransmitFilter (filter);
+
       m_channel [it->first] = channel;
     }    //end for
 }
@@ -2729,6 +2736,31 @@ MmWaveHelper::ActivateDataRadioBearer (Ptr<NetDevice> ueDevice, EpsBearer bearer
 }
 
 
+int64_t
+MmWaveHelper::AssignStreams (NetDeviceContainer c, int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  int64_t currentStream = stream;
+  for (NetDeviceContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      Ptr<MmWaveEnbNetDevice> mmWaveEnb = DynamicCast<MmWaveEnbNetDevice> (*i);
+      if (mmWaveEnb)
+        {
+          std::map<uint8_t, Ptr<MmWaveComponentCarrier> > ccMap = mmWaveEnb->GetCcMap ();
+          for (auto it = ccMap.begin (); it != ccMap.end (); ++it)
+            {
+              currentStream += mmWaveEnb->GetPhy (it->first)->AssignStreams (currentStream);
+            }
+        }
+      Ptr<MmWaveUeNetDevice> mmWaveUe = DynamicCast<MmWaveUeNetDevice> (*i);
+      if (mmWaveUe)
+        {
+          currentStream += mmWaveUe->GetMac ()->AssignStreams (currentStream);
+        }
+    }
+  return (currentStream - stream);
+}
+
 void
 MmWaveHelper::EnableTraces (void)
 {
@@ -2762,12 +2794,12 @@ MmWaveHelper::EnableDlPhyTrace (void)
                                  MakeBoundCallback (&MmWavePhyTrace::ReportDlPhyTransmissionCallback, m_phyStats));
 
   // regulare mmWave UE device
-  Config::Connect ("/NodeList/*/DeviceList/*/ComponentCarrierMap/*/MmWaveUePhy/DlSpectrumPhy/RxPacketTraceUe",
-                   MakeBoundCallback (&MmWavePhyTrace::RxPacketTraceUeCallback, m_phyStats));
+  Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/ComponentCarrierMap/*/MmWaveUePhy/DlSpectrumPhy/RxPacketTraceUe",
+                                 MakeBoundCallback (&MmWavePhyTrace::RxPacketTraceUeCallback, m_phyStats));
 
   // MC ue device
-  Config::Connect ("/NodeList/*/DeviceList/*/MmWaveComponentCarrierMapUe/*/MmWaveUePhy/DlSpectrumPhy/RxPacketTraceUe",
-                   MakeBoundCallback (&MmWavePhyTrace::RxPacketTraceUeCallback, m_phyStats));
+  Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/MmWaveComponentCarrierMapUe/*/MmWaveUePhy/DlSpectrumPhy/RxPacketTraceUe",
+                                 MakeBoundCallback (&MmWavePhyTrace::RxPacketTraceUeCallback, m_phyStats));
 }
 
 void
@@ -2778,8 +2810,8 @@ MmWaveHelper::EnableUlPhyTrace (void)
   Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/ComponentCarrierMapUe/*/MmWaveUePhy/ReportUlPhyTransmission", 
                                  MakeBoundCallback (&MmWavePhyTrace::ReportUlPhyTransmissionCallback, m_phyStats));
 
-  Config::Connect ("/NodeList/*/DeviceList/*/ComponentCarrierMap/*/MmWaveEnbPhy/DlSpectrumPhy/RxPacketTraceEnb",
-                   MakeBoundCallback (&MmWavePhyTrace::RxPacketTraceEnbCallback, m_phyStats));
+  Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/ComponentCarrierMap/*/MmWaveEnbPhy/DlSpectrumPhy/RxPacketTraceEnb",
+                                 MakeBoundCallback (&MmWavePhyTrace::RxPacketTraceEnbCallback, m_phyStats));
 }
 
 void
@@ -250,6 +250,18 @@ public:
 
   void EnableTraces ();
 
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by the mmWave eNB PHYs and the mmWave UE MACs of the given devices.
+   * The InstallEnbDevice or InstallUeDevice method should have previously
+   * been called on the devices.
+   *
+   * \param c the devices
+   * \param stream first stream index to use
+   * \return the number of stream indices (possibly zero) that have been assigned
+   */
+  int64_t AssignStreams (NetDeviceContainer c, int64_t stream);
+
   void SetSchedulerType (std::string type);
   std::string GetSchedulerType () const;
 
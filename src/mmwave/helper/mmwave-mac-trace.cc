@@ -19,6 +19,7 @@
 */
 
 #include <ns3/log.h>
+#include <ns3/boolean.h>
 #include <string>
 #include "mmwave-mac-trace.h"
 #include "envVarTaskID.h"
@@ -33,8 +34,9 @@ namespace mmwave {
 
 NS_OBJECT_ENSURE_REGISTERED (MmWaveMacTrace);
 
-std::ofstream MmWaveMacTrace::m_schedAllocTraceFile {};
+MmWaveTraceFile<MmWaveTtiTraceRecord> MmWaveMacTrace::m_schedAllocTraceFile {};
 std::string MmWaveMacTrace::m_schedAllocTraceFilename {};
+bool MmWaveMacTrace::m_binaryFormat = false;
 
 MmWaveMacTrace::MmWaveMacTrace ()
 {
@@ -42,9 +44,9 @@ MmWaveMacTrace::MmWaveMacTrace ()
 
 MmWaveMacTrace::~MmWaveMacTrace ()
 {
-  if (m_schedAllocTraceFile.is_open ())
+  if (m_schedAllocTraceFile.IsOpen ())
     {
-      m_schedAllocTraceFile.close ();
+      m_schedAllocTraceFile.Close ();
     }
 }
 /*
@@ -65,6 +67,12 @@ MmWaveMacTrace::GetTypeId (void)
                    StringValue ("EnbSchedAllocTraces" + fileNameSuffix + ".txt"),
                    MakeStringAccessor (&MmWaveMacTrace::SetOutputFilename),
                    MakeStringChecker ())
+    .AddAttribute ("BinaryFormat",
+                   "If true, the traces are written as binary records to files named after the text ones "
+                   "with the .bin extension appended. They can be converted to text with the mmwave-trace-to-text program.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&MmWaveMacTrace::SetBinaryFormat),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
@@ -73,28 +81,29 @@ void
 MmWaveMacTrace::ReportEnbSchedulingInfo (Ptr<MmWaveMacTrace> enbStats, MmWaveEnbMac::MmWaveSchedTraceInfo schedParams)
 {
     // Open the output file if it is not open yet
-    if (!m_schedAllocTraceFile.is_open ())
+    if (!m_schedAllocTraceFile.IsOpen ())
     {
-      m_schedAllocTraceFile.open (m_schedAllocTraceFilename.c_str ());
-      if (!m_schedAllocTraceFile.is_open ())
-        {
-          NS_FATAL_ERROR ("Could not open tracefile");
-        }
-      m_schedAllocTraceFile << "frame\tsubF\tslot\trnti\tfirstSym\tnumSym\ttype\ttddMode\tretxNum\tccId" << std::endl;
+      m_schedAllocTraceFile.Open (m_schedAllocTraceFilename, m_binaryFormat);
     }
     
+    const SlotAllocInfo &allocInfo = schedParams.m_indParam.m_slotAllocInfo;
+    const SfnSf &dlSfn = schedParams.m_indParam.m_sfnSf;   // Holds the intended slot, subframe and frame info
 
-    SlotAllocInfo allocInfo = schedParams.m_indParam.m_slotAllocInfo;
-    SfnSf dlSfn = schedParams.m_indParam.m_sfnSf;   // Holds the intended slot, subframe and frame info
-
-    for (auto iTti : allocInfo.m_ttiAllocInfo)
+    MmWaveTtiTraceRecord record;
+    record.m_frameNum = dlSfn.m_frameNum;
+    record.m_sfNum = dlSfn.m_sfNum;
+    record.m_slotNum = dlSfn.m_slotNum;
+    record.m_ccId = schedParams.m_ccId;
+    for (const auto &iTti : allocInfo.m_ttiAllocInfo)
     {
       // Trace the incoming alloc info
-      m_schedAllocTraceFile << +dlSfn.m_frameNum << "\t" << +dlSfn.m_sfNum << "\t"
-                            << +dlSfn.m_slotNum << "\t" << +iTti.m_dci.m_rnti << "\t" 
-                            << +iTti.m_dci.m_symStart << "\t" << +iTti.m_dci.m_numSym << "\t" 
-                            << iTti.m_ttiType << "\t" << iTti.m_tddMode << "\t" 
-                            << +iTti.m_dci.m_rv << "\t" << +schedParams.m_ccId << std::endl;
+      record.m_rnti = iTti.m_dci.m_rnti;
+      record.m_symStart = iTti.m_dci.m_symStart;
+      record.m_numSym = iTti.m_dci.m_numSym;
+      record.m_ttiType = iTti.m_ttiType;
+      record.m_tddMode = iTti.m_tddMode;
+      record.m_rv = iTti.m_dci.m_rv;
+      m_schedAllocTraceFile.Write (record);
     }   
 }
 
@@ -105,6 +114,13 @@ MmWaveMacTrace::SetOutputFilename (std::string fileName)
   m_schedAllocTraceFilename = fileName;
 }
 
+void
+MmWaveMacTrace::SetBinaryFormat (bool binary)
+{
+  NS_LOG_INFO ("Binary format: " << binary);
+  m_binaryFormat = binary;
+}
+
 } // namespace mmwave
 
 } /* namespace ns3 */
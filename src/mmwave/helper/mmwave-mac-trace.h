@@ -24,6 +24,7 @@
 #include <ns3/object.h>
 #include <ns3/mmwave-phy-mac-common.h>
 #include <ns3/mmwave-enb-mac.h>
+#include <ns3/mmwave-binary-trace.h>
 #include <fstream>
 
 namespace ns3 {
@@ -51,6 +52,13 @@ public:
   */
   void SetOutputFilename (std::string fileName);
 
+ /**
+  * Sets the format of the MAC-related traces
+  * 
+  * \param binary if true, the traces are written in binary format
+  */
+  void SetBinaryFormat (bool binary);
+
  /**
   * Callback used to trace the reception of a scheduling decision by the eNB and from the scheduler itself.
   * 
@@ -60,8 +68,9 @@ public:
   static void ReportEnbSchedulingInfo (Ptr<MmWaveMacTrace> enbStats, MmWaveEnbMac::MmWaveSchedTraceInfo schedParams);
 
 private:
-  static std::ofstream m_schedAllocTraceFile;  //!< Output stream for the scheduling allocations trace
+  static MmWaveTraceFile<MmWaveTtiTraceRecord> m_schedAllocTraceFile;  //!< Output file for the scheduling allocations trace
   static std::string m_schedAllocTraceFilename;   //!< Output filename for the scheduling allocations trace
+  static bool m_binaryFormat;   //!< If true, the traces are written in binary format
 };
 
 } // namespace mmwave
@@ -36,6 +36,7 @@
 #include <ns3/log.h>
 #include "mmwave-phy-trace.h"
 #include <ns3/simulator.h>
+#include <ns3/boolean.h>
 #include <stdio.h>
 #include <string> 
 #include "envVarTaskID.h"
@@ -50,24 +51,26 @@ namespace mmwave {
 
 NS_OBJECT_ENSURE_REGISTERED (MmWavePhyTrace);
 
-std::ofstream MmWavePhyTrace::m_rxPacketTraceFile;
+MmWaveTraceFile<MmWaveRxPacketTraceRecord> MmWavePhyTrace::m_rxPacketTraceFile;
 std::string MmWavePhyTrace::m_rxPacketTraceFilename;
 
-std::ofstream MmWavePhyTrace::m_ulPhyTraceFile {};
+MmWaveTraceFile<MmWaveTtiTraceRecord> MmWavePhyTrace::m_ulPhyTraceFile {};
 std::string MmWavePhyTrace::m_ulPhyTraceFilename {};
 
-std::ofstream MmWavePhyTrace::m_dlPhyTraceFile {};
+MmWaveTraceFile<MmWaveTtiTraceRecord> MmWavePhyTrace::m_dlPhyTraceFile {};
 std::string MmWavePhyTrace::m_dlPhyTraceFilename {};
 
+bool MmWavePhyTrace::m_binaryFormat = false;
+
 MmWavePhyTrace::MmWavePhyTrace ()
 {
 }
 
 MmWavePhyTrace::~MmWavePhyTrace ()
 {
-  if (m_rxPacketTraceFile.is_open ())
+  if (m_rxPacketTraceFile.IsOpen ())
     {
-      m_rxPacketTraceFile.close ();
+      m_rxPacketTraceFile.Close ();
     }
 }
 /*
@@ -99,6 +102,13 @@ MmWavePhyTrace::GetTypeId (void)
                    StringValue ("DlPhyTransmissionTrace"+fileNameSuffix+".txt"),
                    MakeStringAccessor (&MmWavePhyTrace::SetDlPhyTxOutputFilename),
                    MakeStringChecker ())
+    .AddAttribute ("BinaryFormat",
+                   "If true, the traces are written as binary records, buffered and written by a background thread, "
+                   "to files named after the text ones with the .bin extension appended. "
+                   "They can be converted to text with the mmwave-trace-to-text program.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&MmWavePhyTrace::SetBinaryFormat),
+                   MakeBooleanChecker ())
           
   ;
   return tid;
@@ -125,6 +135,13 @@ MmWavePhyTrace::SetDlPhyTxOutputFilename (std::string fileName)
   m_dlPhyTraceFilename = fileName;
 }
 
+void
+MmWavePhyTrace::SetBinaryFormat (bool binary)
+{
+  NS_LOG_INFO ("Binary format: " << binary);
+  m_binaryFormat = binary;
+}
+
 void
 MmWavePhyTrace::ReportCurrentCellRsrpSinrCallback (Ptr<MmWavePhyTrace> phyStats, std::string path,
                                                      uint64_t imsi, SpectrumValue& sinr, SpectrumValue& power)
@@ -199,68 +216,75 @@ MmWavePhyTrace::ReportDLTbSize (uint64_t imsi, uint64_t tbSize)
         fclose(log_file);
 }
 */
-void 
-MmWavePhyTrace::ReportUlPhyTransmissionCallback (Ptr<MmWavePhyTrace> phyStats, PhyTransmissionTraceParams param)
+void
+MmWavePhyTrace::WritePhyTransmission (MmWaveTraceFile<MmWaveTtiTraceRecord> &file, std::string fileName,
+                                      const PhyTransmissionTraceParams &param)
 {
-  if (!m_ulPhyTraceFile.is_open ())
+  if (!file.IsOpen ())
     {
-      m_ulPhyTraceFile.open (m_ulPhyTraceFilename.c_str ());
-      if (!m_ulPhyTraceFile.is_open ())
-        {
-          NS_FATAL_ERROR ("Could not open tracefile");
-        }
-      m_ulPhyTraceFile << "frame\tsubF\tslot\trnti\tfirstSym\tnumSym\ttype\ttddMode\tretxNum\tccId" << std::endl;
+      file.Open (fileName, m_binaryFormat);
     }
 
+  MmWaveTtiTraceRecord record;
+  record.m_frameNum = param.m_frameNum;
+  record.m_sfNum = param.m_sfNum;
+  record.m_slotNum = param.m_slotNum;
+  record.m_rnti = param.m_rnti;
+  record.m_symStart = param.m_symStart;
+  record.m_numSym = param.m_numSym;
+  record.m_ttiType = param.m_ttiType;
+  record.m_tddMode = param.m_tddMode;
+  record.m_rv = param.m_rv;
+  record.m_ccId = param.m_ccId;
+  file.Write (record);
+}
+
+void 
+MmWavePhyTrace::ReportUlPhyTransmissionCallback (Ptr<MmWavePhyTrace> phyStats, PhyTransmissionTraceParams param)
+{
   // Trace the UL PHY transmission info
-  m_ulPhyTraceFile << +param.m_frameNum << "\t" << +param.m_sfNum << "\t"
-                   << +param.m_slotNum << "\t" << +param.m_rnti << "\t" 
-                   << +param.m_symStart << "\t" << +param.m_numSym << "\t" 
-                   << +param.m_ttiType << "\t" << +param.m_tddMode << "\t" 
-                   << +param.m_rv << "\t" << +param.m_ccId << std::endl;
+  WritePhyTransmission (m_ulPhyTraceFile, m_ulPhyTraceFilename, param);
 }
 
 void 
 MmWavePhyTrace::ReportDlPhyTransmissionCallback (Ptr<MmWavePhyTrace> phyStats, PhyTransmissionTraceParams param)
 {
-  if (!m_dlPhyTraceFile.is_open ())
-    {
-      m_dlPhyTraceFile.open (m_dlPhyTraceFilename.c_str ());
-      if (!m_dlPhyTraceFile.is_open ())
-        {
-          NS_FATAL_ERROR ("Could not open tracefile");
-        }
-      m_dlPhyTraceFile << "frame\tsubF\tslot\trnti\tfirstSym\tnumSym\ttype\ttddMode\tretxNum\tccId" << std::endl;
-    }
-
   // Trace the DL PHY transmission info
-  m_dlPhyTraceFile << +param.m_frameNum << "\t" << +param.m_sfNum << "\t"
-                   << +param.m_slotNum << "\t" << +param.m_rnti << "\t" 
-                   << +param.m_symStart << "\t" << +param.m_numSym << "\t" 
-                   << +param.m_ttiType << "\t" << +param.m_tddMode << "\t" 
-                   << +param.m_rv << "\t" << +param.m_ccId << std::endl;
+  WritePhyTransmission (m_dlPhyTraceFile, m_dlPhyTraceFilename, param);
 }
 
 void
-MmWavePhyTrace::RxPacketTraceUeCallback (Ptr<MmWavePhyTrace> phyStats, std::string path, RxPacketTraceParams params)
+MmWavePhyTrace::WriteRxPacket (bool downlink, const RxPacketTraceParams &params)
 {
-  if (!m_rxPacketTraceFile.is_open ())
+  if (!m_rxPacketTraceFile.IsOpen ())
     {
-      m_rxPacketTraceFile.open (m_rxPacketTraceFilename.c_str ());
-      m_rxPacketTraceFile << "DL/UL\ttime\tframe\tsubF\tslot\t1stSym\tsymbol#\tcellId\trnti\tccId\ttbSize\tmcs\trv\tSINR(dB)\tcorrupt\tTBler" << std::endl;
-      if (!m_rxPacketTraceFile.is_open ())
-        {
-          NS_FATAL_ERROR ("Could not open tracefile");
-        }
+      m_rxPacketTraceFile.Open (m_rxPacketTraceFilename, m_binaryFormat);
     }
-  m_rxPacketTraceFile << "DL\t" << Simulator::Now ().GetSeconds () << "\t" 
-                      << params.m_frameNum << "\t" << +params.m_sfNum << "\t" 
-                      << +params.m_slotNum << "\t" << +params.m_symStart << "\t" 
-                      << +params.m_numSym << "\t" << params.m_cellId << "\t" 
-                      << params.m_rnti << "\t" << +params.m_ccId << "\t" 
-                      << params.m_tbSize << "\t" << +params.m_mcs << "\t" 
-                      << +params.m_rv << "\t" << 10 * std::log10 (params.m_sinr) << "\t" 
-                      << params.m_corrupt << "\t" <<  params.m_tbler << std::endl;
+
+  MmWaveRxPacketTraceRecord record;
+  record.m_downlink = downlink;
+  record.m_time = Simulator::Now ().GetSeconds ();
+  record.m_frameNum = params.m_frameNum;
+  record.m_sfNum = params.m_sfNum;
+  record.m_slotNum = params.m_slotNum;
+  record.m_symStart = params.m_symStart;
+  record.m_numSym = params.m_numSym;
+  record.m_cellId = params.m_cellId;
+  record.m_rnti = params.m_rnti;
+  record.m_ccId = params.m_ccId;
+  record.m_tbSize = params.m_tbSize;
+  record.m_mcs = params.m_mcs;
+  record.m_rv = params.m_rv;
+  record.m_sinrDb = 10 * std::log10 (params.m_sinr);
+  record.m_corrupt = params.m_corrupt;
+  record.m_tbler = params.m_tbler;
+  m_rxPacketTraceFile.Write (record);
+}
+
+void
+MmWavePhyTrace::RxPacketTraceUeCallback (Ptr<MmWavePhyTrace> phyStats, RxPacketTraceParams params)
+{
+  WriteRxPacket (true, params);
 
   if (params.m_corrupt)
     {
@@ -274,25 +298,9 @@ MmWavePhyTrace::RxPacketTraceUeCallback (Ptr<MmWavePhyTrace> phyStats, std::stri
     }
 }
 void
-MmWavePhyTrace::RxPacketTraceEnbCallback (Ptr<MmWavePhyTrace> phyStats, std::string path, RxPacketTraceParams params)
+MmWavePhyTrace::RxPacketTraceEnbCallback (Ptr<MmWavePhyTrace> phyStats, RxPacketTraceParams params)
 {
-  if (!m_rxPacketTraceFile.is_open ())
-    {
-      m_rxPacketTraceFile.open (m_rxPacketTraceFilename.c_str ());
-      m_rxPacketTraceFile << "DL/UL\ttime\tframe\tsubF\tslot\t1stSym\tsymbol#\tcellId\trnti\tccId\ttbSize\tmcs\trv\tSINR(dB)\tcorrupt\tTBler" << std::endl;
-      if (!m_rxPacketTraceFile.is_open ())
-        {
-          NS_FATAL_ERROR ("Could not open tracefile");
-        }
-    }
-  m_rxPacketTraceFile << "UL\t" << Simulator::Now ().GetSeconds () << "\t" 
-                      << params.m_frameNum << "\t" << +params.m_sfNum << "\t" 
-                      << +params.m_slotNum << "\t" << +params.m_symStart << "\t" 
-                      << +params.m_numSym << "\t" << params.m_cellId << "\t" 
-                      << params.m_rnti << "\t" << +params.m_ccId << "\t" 
-                      << params.m_tbSize << "\t" << +params.m_mcs << "\t" 
-                      << +params.m_rv << "\t" << 10 * std::log10 (params.m_sinr) << " \t" 
-                      << params.m_corrupt << "\t" << params.m_tbler << std::endl;
+  WriteRxPacket (false, params);
 
   if (params.m_corrupt)
     {
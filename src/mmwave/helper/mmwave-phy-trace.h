@@ -36,6 +36,7 @@
 #include <ns3/object.h>
 #include <ns3/spectrum-value.h>
 #include <ns3/mmwave-phy-mac-common.h>
+#include <ns3/mmwave-binary-trace.h>
 #include <fstream>
 #include <iostream>
 
@@ -53,8 +54,8 @@ public:
                                                  uint64_t imsi, SpectrumValue& sinr, SpectrumValue& power);
   static void ReportDownLinkTBSize (Ptr<MmWavePhyTrace> phyStats, std::string path,
                                     uint64_t imsi, uint64_t tbSize);
-  static void RxPacketTraceUeCallback (Ptr<MmWavePhyTrace> phyStats, std::string path, RxPacketTraceParams param);
-  static void RxPacketTraceEnbCallback (Ptr<MmWavePhyTrace> phyStats, std::string path, RxPacketTraceParams param);
+  static void RxPacketTraceUeCallback (Ptr<MmWavePhyTrace> phyStats, RxPacketTraceParams param);
+  static void RxPacketTraceEnbCallback (Ptr<MmWavePhyTrace> phyStats, RxPacketTraceParams param);
 
  /**
   * Callback used to trace an UL PHY tranmission 
@@ -84,17 +85,41 @@ public:
   */
   void SetDlPhyTxOutputFilename (std::string fileName);
 
+ /**
+  * Sets the format of the traces
+  * \param binary if true, the traces are written in binary format
+  */
+  void SetBinaryFormat (bool binary);
+
 private:
+ /**
+  * Write a PHY transmission record
+  * \param file the trace file
+  * \param fileName the name of the trace file, used if it is not open yet
+  * \param param the PHY transmission info
+  */
+  static void WritePhyTransmission (MmWaveTraceFile<MmWaveTtiTraceRecord> &file, std::string fileName,
+                                    const PhyTransmissionTraceParams &param);
+
+ /**
+  * Write a PHY reception record
+  * \param downlink true if the TB has been received by a UE
+  * \param params the PHY reception info
+  */
+  static void WriteRxPacket (bool downlink, const RxPacketTraceParams &params);
+
   //void ReportInterferenceTrace (uint64_t imsi, SpectrumValue& sinr);
   //void ReportDLTbSize (uint64_t imsi, uint64_t tbSize);
-  static std::ofstream m_rxPacketTraceFile;   //!< Output stream for the PHY reception trace
+  static MmWaveTraceFile<MmWaveRxPacketTraceRecord> m_rxPacketTraceFile;   //!< Output file for the PHY reception trace
   static std::string m_rxPacketTraceFilename;   //!< Output filename for the PHY reception trace
 
-  static std::ofstream m_ulPhyTraceFile;    //!< Output stream for the UL PHY transmission trace
+  static MmWaveTraceFile<MmWaveTtiTraceRecord> m_ulPhyTraceFile;    //!< Output file for the UL PHY transmission trace
   static std::string m_ulPhyTraceFilename;    //!< Output filename for the UL PHY transmission trace
   
-  static std::ofstream m_dlPhyTraceFile;    //!< Output stream for the DL PHY transmission trace
+  static MmWaveTraceFile<MmWaveTtiTraceRecord> m_dlPhyTraceFile;    //!< Output file for the DL PHY transmission trace
   static std::string m_dlPhyTraceFilename;    //!< Output filename for the DL PHY transmission trace
+
+  static bool m_binaryFormat;    //!< If true, the traces are written in binary format
   
 };
 
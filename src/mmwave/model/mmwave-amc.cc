@@ -483,18 +483,33 @@ MmWaveAmc::CreateCqiFeedbackWbTdma (const SpectrumValue& sinr, uint8_t numSym, u
         }
       sinrAvg /= chunkId;
 
-      mcs = 0;
-      MmWaveTbStats_t tbStats;
-      while (mcs <= 28)
+      // the MI depends only on the modulation and the code block segmentation
+      // only on the TB size, hence compute them once per report. Since the
+      // BLER increases with the MCS, the first MCS which cannot guarantee the
+      // 10 % of BLER is found with a bisection, instead of testing all of them
+      MmWaveCodeBlockSegmentation_t segmentation = MmWaveMiErrorModel::GetCodeBlockSegmentation (tbSize);
+      double mi[3] = {-1.0, -1.0, -1.0};       // QPSK, 16-QAM and 64-QAM
+      int firstFailingMcs = 0;
+      int maxMcs = 29;       // 29 means that all the MCSs guarantee the 10 % of BLER
+      while (firstFailingMcs < maxMcs)
         {
-          MmWaveHarqProcessInfoList_t harqInfoList;
-          tbStats = MmWaveMiErrorModel::GetTbDecodificationStats (sinr, chunkMap, tbSize, mcs, harqInfoList);
-          if (tbStats.tbler > 0.1)
+          int midMcs = (firstFailingMcs + maxMcs) / 2;
+          int modulation = (midMcs <= MMWAVE_MI_QPSK_MAX_ID) ? 0 : ((midMcs <= MMWAVE_MI_16QAM_MAX_ID) ? 1 : 2);
+          if (mi[modulation] < 0)
             {
-              break;
+              mi[modulation] = MmWaveMiErrorModel::Mib (sinr, chunkMap, midMcs);
+            }
+          double tbler = MmWaveMiErrorModel::MappingMiTbler (mi[modulation], McsEcrBlerTableMapping[midMcs], segmentation);
+          if (tbler > 0.1)
+            {
+              maxMcs = midMcs;
+            }
+          else
+            {
+              firstFailingMcs = midMcs + 1;
             }
-          mcs++;
         }
+      mcs = firstFailingMcs;
       if (mcs > 0)
         {
           mcs--;
@@ -504,7 +519,7 @@ MmWaveAmc::CreateCqiFeedbackWbTdma (const SpectrumValue& sinr, uint8_t numSym, u
 //		NS_LOG_UNCOND ("TBLER " << tbStatsFinal.tbler << " for chunks " << chunkMap.size () << " numSym "
 //		               << (unsigned)numSym << " tbSize " << tbSize << " mcs " << (unsigned)mcs << " sinr " << sinrAvg);
 //		NS_LOG_UNCOND (sinr);
-      if ((tbStats.tbler > 0.1)&&(mcs == 0))
+      if (firstFailingMcs <= 1)
         {
           cqi = 0;
         }
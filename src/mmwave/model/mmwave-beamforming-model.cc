@@ -35,6 +35,7 @@
 #include "ns3/log.h"
 #include <fstream>
 #include <algorithm>
+#include <limits>
 
 
 namespace ns3 {
@@ -180,12 +181,12 @@ MmWaveSvdBeamforming::GetTypeId ()
                    MakePointerAccessor (&MmWaveSvdBeamforming::m_channel),
                    MakePointerChecker<MatrixBasedChannelModel> ())
     .AddAttribute ("MaxIterations",
-                   "Maximum number of iterations to numerically approximate the SVD decomposition",
+                   "Maximum number of Lanczos iterations to numerically approximate the SVD decomposition",
                    UintegerValue (30),
                    MakeUintegerAccessor (&MmWaveSvdBeamforming::m_maxIterations),
                    MakeUintegerChecker<uint32_t> ())
     .AddAttribute ("Tolerance",
-                   "Tolerance to numerically approximate the SVD decomposition",
+                   "Relative residual of the dominant eigenpair below which the Lanczos iterations stop",
                    DoubleValue (1e-8),
                    MakeDoubleAccessor (&MmWaveSvdBeamforming::m_tolerance),
                    MakeDoubleChecker<double> ())
@@ -213,6 +214,7 @@ MmWaveSvdBeamforming::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
   m_channel = 0;
+  m_cache.clear ();
   MmWaveBeamformingModel::DoDispose ();
 }
 
@@ -229,51 +231,73 @@ MmWaveSvdBeamforming::SetBeamformingVectorForDevice (Ptr<NetDevice> otherDevice,
   // this will trigger a new computation (if needed)
   auto channelMatrix = m_channel->GetChannel (thisMob, otherMob, m_antenna, otherAntenna);
 
-  std::pair<PhasedArrayModel::ComplexVector, PhasedArrayModel::ComplexVector> bfVectors;
-
-  bool toCache {false};
-
+  // the bf vectors computed for the previous channel, if any
+  const CacheEntry *previous = nullptr;
   if (m_useCache)
     {
-      auto entry {m_cacheChannelMap.find (otherDevice)};
-      if (entry != m_cacheChannelMap.end () && entry->second == channelMatrix) // hit: the channel was already cached
+      auto entry = m_cache.find (otherDevice);
+      if (entry != m_cache.end ())
         {
-          NS_LOG_DEBUG ("channel cached " << channelMatrix);
-          bfVectors = m_cacheBfVectors.find (otherDevice)->second;
+          previous = &entry->second;
         }
-      else
+      if (entry != m_cache.end () && entry->second.channel == channelMatrix) // hit: the channel was already cached
         {
-          NS_LOG_DEBUG ("new channel " << channelMatrix);
-          toCache = true;
+          NS_LOG_DEBUG ("channel cached " << channelMatrix);
+          if (m_antenna->GetBeamformingVectorEpoch () != entry->second.thisEpoch
+              || otherAntenna->GetBeamformingVectorEpoch () != entry->second.otherEpoch)
+            {
+              // the antennas have been reconfigured in the meantime, restore
+              // the cached bf vectors
+              m_antenna->SetBeamformingVector (entry->second.bfVectors.first);
+              otherAntenna->SetBeamformingVector (entry->second.bfVectors.second);
+              entry->second.thisEpoch = m_antenna->GetBeamformingVectorEpoch ();
+              entry->second.otherEpoch = otherAntenna->GetBeamformingVectorEpoch ();
+            }
+          else
+            {
+              NS_LOG_LOGIC ("antennas already configured with the cached bf vectors");
+            }
+          return;
         }
+      NS_LOG_DEBUG ("new channel " << channelMatrix);
     }
 
-  if (!m_useCache || toCache)
+  std::pair<PhasedArrayModel::ComplexVector, PhasedArrayModel::ComplexVector> bfVectors;
+  if (channelMatrix->m_channel.GetNumClusters () == 0)
     {
-      if (channelMatrix->m_channel[0][0].size () == 0)
-        {
-          NS_LOG_LOGIC ("Channel has no MPCs");
+      NS_LOG_LOGIC ("Channel has no MPCs");
 
-          uint64_t thisAntennaNumElements = m_antenna->GetNumberOfElements ();
-          uint64_t otherAntennaNumElements = otherAntenna->GetNumberOfElements ();
-          PhasedArrayModel::ComplexVector thisBf;
-          thisBf.resize (thisAntennaNumElements);
-          PhasedArrayModel::ComplexVector otherBf;
-          otherBf.resize (otherAntennaNumElements);
+      uint64_t thisAntennaNumElements = m_antenna->GetNumberOfElements ();
+      uint64_t otherAntennaNumElements = otherAntenna->GetNumberOfElements ();
+      PhasedArrayModel::ComplexVector thisBf;
+      thisBf.resize (thisAntennaNumElements);
+      PhasedArrayModel::ComplexVector otherBf;
+      otherBf.resize (otherAntennaNumElements);
 
-          bfVectors = std::make_pair (thisBf, otherBf);
-        }
-      else
+      bfVectors = std::make_pair (thisBf, otherBf);
+    }
+  else
+    {
+      uint32_t thisDeviceId = m_device->GetNode ()->GetId ();
+      uint32_t otherDeviceId = otherDevice->GetNode ()->GetId ();
+      bool reverse = channelMatrix->IsReverse (thisDeviceId, otherDeviceId);
+
+      // start the iterations from the bf vectors of the previous channel,
+      // which change little between consecutive channel realizations
+      static const PhasedArrayModel::ComplexVector noWarmStart;
+      const PhasedArrayModel::ComplexVector *sWarmStart = &noWarmStart;
+      const PhasedArrayModel::ComplexVector *uWarmStart = &noWarmStart;
+      if (previous != nullptr)
         {
-          bfVectors = ComputeBeamformingVectors (channelMatrix);
+          sWarmStart = reverse ? &previous->bfVectors.second : &previous->bfVectors.first;
+          uWarmStart = reverse ? &previous->bfVectors.first : &previous->bfVectors.second;
+        }
+      bfVectors = ComputeBeamformingVectors (channelMatrix, *sWarmStart, *uWarmStart);
 
-          uint32_t thisDeviceId = m_device->GetNode ()->GetId ();
-          uint32_t otherDeviceId = otherDevice->GetNode ()->GetId ();
-          if (channelMatrix->IsReverse (thisDeviceId, otherDeviceId))
-            {
-              // reverse BF vectors
-              bfVectors = std::make_pair (std::get<1> (bfVectors), std::get<0> (bfVectors));
-            }
+      if (reverse)
+        {
+          // reverse BF vectors
+          std::swap (bfVectors.first, bfVectors.second);
         }
     }
 
@@ -291,159 +315,402 @@ MmWaveSvdBeamforming::SetBeamformingVectorForDevice (Ptr<NetDevice> otherDevice,
                            << " this device ID=" << otherDevice->GetNode ()->GetId ()
                            << " otherDevice ID=" << m_device->GetNode ()->GetId ());
 
-  if (toCache)
+  if (m_useCache)
+    {
+      CacheEntry &entry = m_cache[otherDevice];
+      entry.channel = channelMatrix;
+      entry.bfVectors = std::move (bfVectors);
+      entry.thisEpoch = m_antenna->GetBeamformingVectorEpoch ();
+      entry.otherEpoch = otherAntenna->GetBeamformingVectorEpoch ();
+    }
+}
+
+/**
+ * Compute the largest eigenvalue of a real symmetric tridiagonal matrix by
+ * bisection, and the related eigenvector by inverse iteration
+ * \param alpha the n diagonal elements
+ * \param beta the n - 1 off-diagonal elements
+ * \param n the size of the matrix
+ * \param y the n elements of the eigenvector, with unit norm
+ * \param buffer buffer of 5 n elements, used for the factorization
+ * \return the largest eigenvalue
+ */
+static double
+GetLargestTridiagonalEigenpair (const double *alpha, const double *beta, size_t n, double *y, double *buffer)
+{
+  if (n == 1)
+    {
+      y[0] = 1.0;
+      return alpha[0];
+    }
+
+  // the eigenvalues lie in the Gershgorin interval
+  double lower = alpha[0];
+  double upper = alpha[0];
+  for (size_t i = 0; i < n; ++i)
     {
-      auto entry {m_cacheChannelMap.find (otherDevice)};
-      if (entry != m_cacheChannelMap.end ())
+      double radius = (i > 0 ? std::abs (beta[i - 1]) : 0.0) + (i + 1 < n ? std::abs (beta[i]) : 0.0);
+      lower = std::min (lower, alpha[i] - radius);
+      upper = std::max (upper, alpha[i] + radius);
+    }
+  double scale = std::max (std::abs (lower), std::abs (upper));
+  if (scale == 0.0)
+    {
+      std::fill (y, y + n, 0.0);
+      y[0] = 1.0;
+      return 0.0;
+    }
+  double tiny = std::numeric_limits<double>::epsilon () * scale;
+
+  // bisection: the number of eigenvalues smaller than x is the number of
+  // negative pivots of the LDL^T factorization of T - x I
+  while (upper - lower > 2 * tiny)
+    {
+      double mid = 0.5 * (lower + upper);
+      if (mid <= lower || mid >= upper)
         {
-          entry->second = channelMatrix;
-          // this means there is also an entry for the bf vector
-          m_cacheBfVectors.find (otherDevice)->second = bfVectors;
+          break;
+        }
+      size_t count = 0;
+      double d = 1.0;
+      for (size_t i = 0; i < n; ++i)
+        {
+          d = alpha[i] - mid - (i > 0 ? beta[i - 1] * beta[i - 1] / d : 0.0);
+          if (std::abs (d) < tiny * std::numeric_limits<double>::epsilon ())
+            {
+              d = -tiny * std::numeric_limits<double>::epsilon ();
+            }
+          if (d < 0)
+            {
+              count++;
+            }
+        }
+      if (count == n)
+        {
+          upper = mid;
         }
       else
         {
-          m_cacheChannelMap.insert (std::make_pair (otherDevice, channelMatrix));
-          m_cacheBfVectors.insert (std::make_pair (otherDevice, bfVectors));
+          lower = mid;
+        }
+    }
+  double lambda = 0.5 * (lower + upper);
+
+  // LU factorization of T - lambda I with partial pivoting
+  double *d = buffer;
+  double *dl = buffer + n;
+  double *du = buffer + 2 * n;
+  double *du2 = buffer + 3 * n;
+  double *swapped = buffer + 4 * n;
+  for (size_t i = 0; i < n; ++i)
+    {
+      d[i] = alpha[i] - lambda;
+      y[i] = 1.0 / std::sqrt (n);
+    }
+  for (size_t i = 0; i + 1 < n; ++i)
+    {
+      dl[i] = beta[i];
+      du[i] = beta[i];
+      du2[i] = 0.0;
+    }
+  for (size_t i = 0; i + 1 < n; ++i)
+    {
+      if (std::abs (d[i]) >= std::abs (dl[i]))
+        {
+          swapped[i] = 0.0;
+          double fact = (d[i] != 0.0) ? dl[i] / d[i] : 0.0;
+          dl[i] = fact;
+          d[i + 1] -= fact * du[i];
+        }
+      else
+        {
+          swapped[i] = 1.0;
+          double fact = d[i] / dl[i];
+          d[i] = dl[i];
+          dl[i] = fact;
+          double temp = du[i];
+          du[i] = d[i + 1];
+          d[i + 1] = temp - fact * d[i + 1];
+          if (i + 2 < n)
+            {
+              du2[i] = du[i + 1];
+              du[i + 1] = -fact * du[i + 1];
+            }
+        }
+    }
+  for (size_t i = 0; i < n; ++i)
+    {
+      if (std::abs (d[i]) < tiny)
+        {
+          d[i] = (d[i] < 0) ? -tiny : tiny;
         }
     }
-}
 
-std::pair<PhasedArrayModel::ComplexVector, PhasedArrayModel::ComplexVector>
-MmWaveSvdBeamforming::ComputeBeamformingVectors (Ptr<const MatrixBasedChannelModel::ChannelMatrix> params) const
-{
-  //generate transmitter side spatial correlation matrix
-  uint16_t aSize = params->m_channel.size ();
-  uint16_t bSize = params->m_channel[0].size ();
-  uint16_t clusterSize = params->m_channel[0][0].size ();
+  // inverse iteration, lambda is accurate so that two solutions are enough
+  for (uint32_t iter = 0; iter < 2; ++iter)
+    {
+      for (size_t i = 0; i + 1 < n; ++i)
+        {
+          if (swapped[i] == 0.0)
+            {
+              y[i + 1] -= dl[i] * y[i];
+            }
+          else
+            {
+              double temp = y[i] - dl[i] * y[i + 1];
+              y[i] = y[i + 1];
+              y[i + 1] = temp;
+            }
+        }
+      y[n - 1] /= d[n - 1];
+      y[n - 2] = (y[n - 2] - du[n - 2] * y[n - 1]) / d[n - 2];
+      for (size_t i = n - 2; i-- > 0; )
+        {
+          y[i] = (y[i] - du[i] * y[i + 1] - du2[i] * y[i + 2]) / d[i];
+        }
 
-  // compute narrowband channel by summing over the cluster index
-  MatrixBasedChannelModel::Complex2DVector narrowbandChannel;
-  narrowbandChannel.resize (aSize);
+      double norm = 0.0;
+      for (size_t i = 0; i < n; ++i)
+        {
+          norm += y[i] * y[i];
+        }
+      norm = std::sqrt (norm);
+      for (size_t i = 0; i < n; ++i)
+        {
+          y[i] /= norm;
+        }
+    }
+  return lambda;
+}
 
-  for (uint16_t aIndex = 0; aIndex < aSize; aIndex++)
+/**
+ * Normalize a complex vector
+ * \param x the vector
+ * \return the norm of the vector before the normalization
+ */
+static double
+NormalizeVector (PhasedArrayModel::ComplexVector &x)
+{
+  double norm = 0.0;
+  for (const std::complex<double> &xi : x)
     {
-      narrowbandChannel[aIndex].resize (bSize);
+      norm += std::norm (xi);
     }
+  norm = std::sqrt (norm);
+  if (norm > 0.0)
+    {
+      for (std::complex<double> &xi : x)
+        {
+          xi /= norm;
+        }
+    }
+  return norm;
+}
+
+std::pair<PhasedArrayModel::ComplexVector, PhasedArrayModel::ComplexVector>
+MmWaveSvdBeamforming::ComputeBeamformingVectors (Ptr<const MatrixBasedChannelModel::ChannelMatrix> params,
+                                                 const PhasedArrayModel::ComplexVector &sWarmStart,
+                                                 const PhasedArrayModel::ComplexVector &uWarmStart)
+{
+  const MatrixBasedChannelModel::ComplexTensor3D &channel = params->m_channel;
+  uint16_t uSize = channel.GetUSize ();
+  uint16_t sSize = channel.GetSSize ();
+  uint16_t clusterSize = channel.GetNumClusters ();
 
-  for (uint16_t aIndex = 0; aIndex < aSize; aIndex++)
+  // compute narrowband channel by summing over the cluster index
+  Workspace &ws = m_workspace;
+  ws.uSize = uSize;
+  ws.sSize = sSize;
+  ws.channel.resize (static_cast<size_t> (uSize) * sSize);
+  for (uint16_t uIndex = 0; uIndex < uSize; uIndex++)
     {
-      for (uint16_t bIndex = 0; bIndex < bSize; bIndex++)
+      for (uint16_t sIndex = 0; sIndex < sSize; sIndex++)
         {
           std::complex<double> cSum (0, 0);
           for (uint16_t cIndex = 0; cIndex < clusterSize; cIndex++)
             {
-              cSum += params->m_channel[aIndex][bIndex][cIndex];
+              cSum += channel (uIndex, sIndex, cIndex);
             }
-          narrowbandChannel[aIndex][bIndex] = cSum;
+          ws.channel[static_cast<size_t> (uIndex) * sSize + sIndex] = cSum;
         }
     }
 
-  //compute the transmitter side spatial correlation matrix bQ = H*H, where H is the sum of H_n over n clusters.
-  MatrixBasedChannelModel::Complex2DVector bQ;
-  bQ.resize (bSize);
-
-  for (uint16_t bIndex = 0; bIndex < bSize; bIndex++)
+  // the dominant singular vectors are the eigenvectors related to the highest
+  // eigenvalue of the spatial correlation matrices H^H H and H H^H. Only the
+  // one of the smaller side is computed, the other is obtained by
+  // multiplying it by H, which spares half of the iterations.
+  bool leftSide = uSize < sSize;
+  PhasedArrayModel::ComplexVector sW (sSize);
+  PhasedArrayModel::ComplexVector uW (uSize);
+  PhasedArrayModel::ComplexVector &x = leftSide ? uW : sW;
+  if (!leftSide && sWarmStart.size () == sSize)
     {
-      bQ[bIndex].resize (bSize);
+      x = sWarmStart;
     }
-
-  for (uint16_t b1Index = 0; b1Index < bSize; b1Index++)
+  else if (leftSide && uWarmStart.size () == uSize)
     {
-      for (uint16_t b2Index = 0; b2Index < bSize; b2Index++)
+      // the bf vector of the u side is the conjugate of the singular vector
+      for (uint16_t i = 0; i < uSize; i++)
         {
-          std::complex<double> aSum (0,0);
-          for (uint16_t aIndex = 0; aIndex < aSize; aIndex++)
-            {
-              aSum += std::conj (narrowbandChannel[aIndex][b1Index]) * narrowbandChannel[aIndex][b2Index];
-            }
-          bQ[b1Index][b2Index] += aSum;
+          x[i] = std::conj (uWarmStart[i]);
         }
     }
+  else
+    {
+      // start from the first column of the spatial correlation matrix
+      ws.product.resize (leftSide ? sSize : uSize);
+      PhasedArrayModel::ComplexVector e0 (x.size ());
+      e0[0] = 1.0;
+      MultiplyChannel (leftSide, e0.data (), ws.product.data ());
+      MultiplyChannel (!leftSide, ws.product.data (), x.data ());
+    }
 
-  //calculate beamforming vector from spatial correlation matrix
-  PhasedArrayModel::ComplexVector bW = GetFirstEigenvector (bQ);
+  GetFirstEigenvector (leftSide, x);
 
-  //compute the receiver side spatial correlation matrix aQ = HH*, where H is the sum of H_n over n clusters.
-  MatrixBasedChannelModel::Complex2DVector aQ;
-  aQ.resize (aSize);
+  if (leftSide)
+    {
+      MultiplyChannel (true, uW.data (), sW.data ());
+      NormalizeVector (sW);
+    }
+  else
+    {
+      MultiplyChannel (false, sW.data (), uW.data ());
+      NormalizeVector (uW);
+    }
 
-  for (uint16_t aIndex = 0; aIndex < aSize; aIndex++)
+  for (size_t i = 0; i < uW.size (); ++i)
     {
-      aQ[aIndex].resize (aSize);
+      uW[i] = std::conj (uW[i]);
     }
 
-  for (uint16_t a1Index = 0; a1Index < aSize; a1Index++)
+  return std::make_pair (sW, uW);
+}
+
+void
+MmWaveSvdBeamforming::MultiplyChannel (bool hermitian, const std::complex<double> *x, std::complex<double> *y)
+{
+  const Workspace &ws = m_workspace;
+  if (!hermitian)
     {
-      for (uint16_t a2Index = 0; a2Index < aSize; a2Index++)
+      for (uint16_t uIndex = 0; uIndex < ws.uSize; uIndex++)
         {
-          std::complex<double> bSum (0,0);
-          for (uint16_t bIndex = 0; bIndex < bSize; bIndex++)
+          const std::complex<double> *row = &ws.channel[static_cast<size_t> (uIndex) * ws.sSize];
+          std::complex<double> sum (0, 0);
+          for (uint16_t sIndex = 0; sIndex < ws.sSize; sIndex++)
             {
-              bSum += narrowbandChannel[a1Index][bIndex] * std::conj (narrowbandChannel[a2Index][bIndex]);
+              sum += row[sIndex] * x[sIndex];
             }
-          aQ[a1Index][a2Index] += bSum;
+          y[uIndex] = sum;
         }
     }
-
-  //calculate beamforming vector from spatial correlation matrix.
-  PhasedArrayModel::ComplexVector aW = GetFirstEigenvector (aQ);
-
-  for (size_t i = 0; i < aW.size (); ++i)
+  else
     {
-      aW[i] = std::conj (aW[i]);
+      std::fill (y, y + ws.sSize, std::complex<double> (0, 0));
+      for (uint16_t uIndex = 0; uIndex < ws.uSize; uIndex++)
+        {
+          const std::complex<double> *row = &ws.channel[static_cast<size_t> (uIndex) * ws.sSize];
+          for (uint16_t sIndex = 0; sIndex < ws.sSize; sIndex++)
+            {
+              y[sIndex] += std::conj (row[sIndex]) * x[uIndex];
+            }
+        }
     }
-
-  return std::make_pair (bW, aW);
 }
 
-PhasedArrayModel::ComplexVector
-MmWaveSvdBeamforming::GetFirstEigenvector (MatrixBasedChannelModel::Complex2DVector A) const
+uint32_t
+MmWaveSvdBeamforming::GetFirstEigenvector (bool leftSide, PhasedArrayModel::ComplexVector &x)
 {
-  PhasedArrayModel::ComplexVector antennaWeights;
-  uint16_t arraySize = A.size ();
-  for (uint16_t eIndex = 0; eIndex < arraySize; eIndex++)
+  Workspace &ws = m_workspace;
+  size_t n = x.size ();
+  size_t maxSteps = std::max<size_t> (1, std::min<size_t> (m_maxIterations, n));
+  ws.product.resize (leftSide ? ws.sSize : ws.uSize);
+  ws.basis.resize (maxSteps * n);
+  ws.alpha.resize (maxSteps);
+  ws.beta.resize (maxSteps);
+  ws.ritz.resize (maxSteps);
+  ws.tridiagonal.resize (5 * maxSteps);
+
+  if (NormalizeVector (x) == 0.0)
     {
-      antennaWeights.push_back (A[0][eIndex]);
+      std::fill (x.begin (), x.end (), std::complex<double> (1.0 / std::sqrt (n), 0));
     }
+  std::copy (x.begin (), x.end (), ws.basis.begin ());
 
-
-  uint32_t iter = 0;
-  double diff = 1;
-  while (iter < m_maxIterations && diff > m_tolerance)
+  size_t steps = 0;
+  double theta = 0.0;
+  for (size_t j = 0; j < maxSteps; ++j)
     {
-      PhasedArrayModel::ComplexVector antennaWeightsNew;
+      const std::complex<double> *q = &ws.basis[j * n];
+      // the next Lanczos vector, x is used as scratch space after the last one
+      std::complex<double> *w = (j + 1 < maxSteps) ? &ws.basis[(j + 1) * n] : x.data ();
 
-      for (uint16_t row = 0; row < arraySize; row++)
+      // w = A q, with A = H^H H or A = H H^H
+      MultiplyChannel (leftSide, q, ws.product.data ());
+      MultiplyChannel (!leftSide, ws.product.data (), w);
+
+      double alpha = 0.0;
+      for (size_t i = 0; i < n; ++i)
         {
-          std::complex<double> sum (0,0);
-          for (uint16_t col = 0; col < arraySize; col++)
+          alpha += std::real (std::conj (q[i]) * w[i]);
+        }
+      ws.alpha[j] = alpha;
+
+      // full reorthogonalization against the previous Lanczos vectors, which
+      // is cheap for the sizes of the antenna arrays and keeps the basis
+      // orthonormal in finite precision
+      for (size_t k = 0; k <= j; ++k)
+        {
+          const std::complex<double> *qk = &ws.basis[k * n];
+          std::complex<double> c (0, 0);
+          for (size_t i = 0; i < n; ++i)
             {
-              sum += A[row][col] * antennaWeights[col];
+              c += std::conj (qk[i]) * w[i];
+            }
+          for (size_t i = 0; i < n; ++i)
+            {
+              w[i] -= c * qk[i];
             }
-
-          antennaWeightsNew.push_back (sum);
         }
-      //normalize antennaWeights;
-      double weighbSum = 0;
-      for (uint16_t i = 0; i < arraySize; i++)
+      double beta = 0.0;
+      for (size_t i = 0; i < n; ++i)
         {
-          weighbSum += norm (antennaWeightsNew[i]);
+          beta += std::norm (w[i]);
         }
-      for (uint16_t i = 0; i < arraySize; i++)
+      beta = std::sqrt (beta);
+      ws.beta[j] = beta;
+
+      steps = j + 1;
+      theta = GetLargestTridiagonalEigenpair (ws.alpha.data (), ws.beta.data (), steps,
+                                              ws.ritz.data (), ws.tridiagonal.data ());
+
+      // the residual of the Ritz pair is |beta_j y_j|, and it vanishes when
+      // the Krylov subspace is invariant
+      double residual = beta * std::abs (ws.ritz[j]);
+      if (residual <= m_tolerance * theta
+          || beta <= 10 * n * std::numeric_limits<double>::epsilon () * theta
+          || steps == maxSteps)
         {
-          antennaWeightsNew[i] = antennaWeightsNew[i] / sqrt (weighbSum);
+          break;
         }
-      diff = 0;
-      for (uint16_t i = 0; i < arraySize; i++)
+      for (size_t i = 0; i < n; ++i)
         {
-          diff += std::norm (antennaWeightsNew[i] - antennaWeights[i]);
+          w[i] /= beta;
         }
-      iter++;
-      antennaWeights = antennaWeightsNew;
     }
-  NS_LOG_DEBUG ("antennaWeigths stopped after " << iter << " iterations with diff=" << diff << std::endl);
+  NS_LOG_DEBUG ("Lanczos iterations stopped after " << steps << " iterations with eigenvalue " << theta);
 
-  return antennaWeights;
+  // the Ritz vector
+  std::fill (x.begin (), x.end (), std::complex<double> (0, 0));
+  for (size_t k = 0; k < steps; ++k)
+    {
+      const std::complex<double> *qk = &ws.basis[k * n];
+      for (size_t i = 0; i < n; ++i)
+        {
+          x[i] += ws.ritz[k] * qk[i];
+        }
+    }
+  NormalizeVector (x);
+  return steps;
 }
 
 /*----------------------------------------------------------------------------*/
@@ -474,12 +741,25 @@ MmWaveCodebookBeamforming::GetTypeId ()
                    TimeValue (MilliSeconds (0.0)),
                    MakeTimeAccessor (&MmWaveCodebookBeamforming::m_updatePeriod),
                    MakeTimeChecker ())
+    .AddAttribute ("ChannelModel",
+                   "Pointer to the MatrixBasedChannelModel object used in the simulation scenario",
+                   PointerValue (),
+                   MakePointerAccessor (&MmWaveCodebookBeamforming::m_channel),
+                   MakePointerChecker<MatrixBasedChannelModel> ())
+    .AddAttribute ("BatchedSearch",
+                   "If true and the ChannelModel is set, all the beam pairs are scored at once "
+                   "directly on the channel matrix, using the frequency-flat power summed over the clusters. "
+                   "Otherwise, each beam pair is evaluated through the SpectrumPropagationLossModel",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&MmWaveCodebookBeamforming::m_batchedSearch),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
 
 
 MmWaveCodebookBeamforming::MmWaveCodebookBeamforming ()
+  : m_batchedSearch {true}
 {
   NS_LOG_FUNCTION (this);
 }
@@ -490,6 +770,18 @@ MmWaveCodebookBeamforming::~MmWaveCodebookBeamforming ()
 }
 
 
+void
+MmWaveCodebookBeamforming::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_splm = 0;
+  m_channel = 0;
+  m_txPsd = 0;
+  m_codebookIdsCache.clear ();
+  MmWaveBeamformingModel::DoDispose ();
+}
+
+
 void
 MmWaveCodebookBeamforming::SetBeamformingCodebookFactory (ObjectFactory factory)
 {
@@ -566,6 +858,15 @@ MmWaveCodebookBeamforming::SetBeamformingVectorForDevice (Ptr<NetDevice> otherDe
     NS_LOG_DEBUG ("Now " << Simulator::Now ().GetSeconds () << ", update? " << update);
   }
   
+  if (!notFound && !update
+      && m_antenna->GetBeamformingVectorEpoch () == it->second.thisEpoch
+      && otherAntenna->GetBeamformingVectorEpoch () == it->second.otherEpoch)
+  {
+    // the antennas are still configured with the selected codewords
+    NS_LOG_LOGIC ("antennas already configured with the cached codewords");
+    return;
+  }
+
   if (notFound || update)
   {
     MmWaveCodebookBeamforming::Matrix2D powerMatrix = ComputeBeamformingCodebookMatrix (otherDevice, otherAntenna);
@@ -595,18 +896,20 @@ MmWaveCodebookBeamforming::SetBeamformingVectorForDevice (Ptr<NetDevice> otherDe
     newEntry.thisCbIdx = thisCbIdx;
     newEntry.otherCbIdx = otherCbIdx;
     newEntry.lastUpdate = Simulator::Now ();
-    m_codebookIdsCache [otherAntenna] = newEntry;    
+    it = m_codebookIdsCache.insert (std::make_pair (otherAntenna, newEntry)).first;
+    it->second = newEntry;
   }
 
   // set best BF codewords for both devices
   Ptr<BeamformingCodebook> thisCodebook = m_antenna->GetObject<BeamformingCodebook> ();
   Ptr<BeamformingCodebook> otherCodebook = otherAntenna->GetObject<BeamformingCodebook> ();
   
-  PhasedArrayModel::ComplexVector thisAntennaWeights = thisCodebook->GetCodeword (thisCbIdx);
-  PhasedArrayModel::ComplexVector otherAntennaWeights = otherCodebook->GetCodeword (otherCbIdx);
+  m_antenna->SetBeamformingVector (thisCodebook->GetCodeword (thisCbIdx));
+  otherAntenna->SetBeamformingVector (otherCodebook->GetCodeword (otherCbIdx));
 
-  m_antenna->SetBeamformingVector (thisAntennaWeights);
-  otherAntenna->SetBeamformingVector (otherAntennaWeights);
+  // store the epochs to detect whether the antennas are reconfigured
+  it->second.thisEpoch = m_antenna->GetBeamformingVectorEpoch ();
+  it->second.otherEpoch = otherAntenna->GetBeamformingVectorEpoch ();
 }
 
 
@@ -615,6 +918,11 @@ MmWaveCodebookBeamforming::ComputeBeamformingCodebookMatrix (Ptr<NetDevice> othe
 {
   NS_LOG_FUNCTION (this << otherDevice << otherAntenna);
 
+  if (m_batchedSearch && m_channel)
+    {
+      return ComputeBeamformingCodebookMatrixBatched (otherDevice, otherAntenna);
+    }
+
   Ptr<BeamformingCodebook> thisCodebook = m_antenna->GetObject<BeamformingCodebook> ();
   Ptr<BeamformingCodebook> otherCodebook = otherAntenna->GetObject<BeamformingCodebook> ();
 
@@ -657,5 +965,142 @@ MmWaveCodebookBeamforming::ComputeBeamformingCodebookMatrix (Ptr<NetDevice> othe
 }
 
 
+/**
+ * Stacks the codewords of a codebook in a dense element-major matrix,
+ * i.e., W[eIndex * cbSize + cwIndex], so that the loops over the codewords
+ * access contiguous memory
+ * \param codebook the codebook
+ * \param numElements the number of antenna elements
+ * \return the stacked codewords
+ */
+static PhasedArrayModel::ComplexVector
+StackCodewords (Ptr<const BeamformingCodebook> codebook, size_t numElements)
+{
+  uint32_t cbSize = codebook->GetCodebookSize ();
+  PhasedArrayModel::ComplexVector stacked (numElements * cbSize);
+  for (uint32_t cwIndex = 0; cwIndex < cbSize; cwIndex++)
+    {
+      PhasedArrayModel::ComplexVector codeword = codebook->GetCodeword (cwIndex);
+      NS_ASSERT_MSG (codeword.size () == numElements, "Codeword size does not match the channel matrix");
+      for (size_t eIndex = 0; eIndex < numElements; eIndex++)
+        {
+          stacked[eIndex * cbSize + cwIndex] = codeword[eIndex];
+        }
+    }
+  return stacked;
+}
+
+
+MmWaveCodebookBeamforming::Matrix2D
+MmWaveCodebookBeamforming::ComputeBeamformingCodebookMatrixBatched (Ptr<NetDevice> otherDevice, Ptr<PhasedArrayModel> otherAntenna) const
+{
+  NS_LOG_FUNCTION (this << otherDevice << otherAntenna);
+
+  Ptr<BeamformingCodebook> thisCodebook = m_antenna->GetObject<BeamformingCodebook> ();
+  Ptr<BeamformingCodebook> otherCodebook = otherAntenna->GetObject<BeamformingCodebook> ();
+
+  Ptr<MobilityModel> thisMob = m_device->GetNode ()->GetObject<MobilityModel> ();
+  Ptr<MobilityModel> otherMob = otherDevice->GetNode ()->GetObject<MobilityModel> ();
+
+  // init matrix
+  MmWaveCodebookBeamforming::Matrix2D matrix (thisCodebook->GetCodebookSize (),
+                                              std::vector<double> (otherCodebook->GetCodebookSize (), 0.0));
+
+  // retrieve the channel matrix, only once for the whole beam sweep
+  Ptr<const MatrixBasedChannelModel::ChannelMatrix> channelMatrix = m_channel->GetChannel (thisMob, otherMob, m_antenna, otherAntenna);
+  const MatrixBasedChannelModel::ComplexTensor3D &channel = channelMatrix->m_channel;
+
+  size_t uSize = channel.GetUSize ();
+  size_t sSize = channel.GetSSize ();
+  size_t numClusters = channel.GetNumClusters ();
+  if (numClusters == 0)
+    {
+      NS_LOG_LOGIC ("Channel has no MPCs");
+      return matrix;
+    }
+
+  // check if this device is the s-node or the u-node of the channel matrix
+  bool thisIsU = channelMatrix->IsReverse (m_device->GetNode ()->GetId (),
+                                           otherDevice->GetNode ()->GetId ());
+  Ptr<const BeamformingCodebook> sCodebook = thisIsU ? otherCodebook : thisCodebook;
+  Ptr<const BeamformingCodebook> uCodebook = thisIsU ? thisCodebook : otherCodebook;
+  uint32_t sCbSize = sCodebook->GetCodebookSize ();
+  uint32_t uCbSize = uCodebook->GetCodebookSize ();
+
+  PhasedArrayModel::ComplexVector sW = StackCodewords (sCodebook, sSize); // sW[sIndex * sCbSize + sCwIndex]
+  PhasedArrayModel::ComplexVector uW = StackCodewords (uCodebook, uSize); // uW[uIndex * uCbSize + uCwIndex]
+
+  std::vector<double> power (uCbSize * sCbSize, 0.0); // power[uCwIndex * sCbSize + sCwIndex]
+  PhasedArrayModel::ComplexVector proj (uSize * sCbSize); // proj[uIndex * sCbSize + sCwIndex], H_n * W_s
+  PhasedArrayModel::ComplexVector gain (sCbSize); // w_u^T H_n W_s for a single u-codeword
+
+  for (size_t cIndex = 0; cIndex < numClusters; cIndex++)
+    {
+      // project all the s-codewords on the cluster matrix H_n
+      std::fill (proj.begin (), proj.end (), std::complex<double> (0.0, 0.0));
+      for (size_t uIndex = 0; uIndex < uSize; uIndex++)
+        {
+          std::complex<double> *projRow = &proj[uIndex * sCbSize];
+          for (size_t sIndex = 0; sIndex < sSize; sIndex++)
+            {
+              std::complex<double> h = channel (uIndex, sIndex, cIndex);
+              const std::complex<double> *sRow = &sW[sIndex * sCbSize];
+              for (uint32_t sCwIndex = 0; sCwIndex < sCbSize; sCwIndex++)
+                {
+                  projRow[sCwIndex] += h * sRow[sCwIndex];
+                }
+            }
+        }
+
+      // combine with all the u-codewords and accumulate the power of the cluster
+      for (uint32_t uCwIndex = 0; uCwIndex < uCbSize; uCwIndex++)
+        {
+          std::fill (gain.begin (), gain.end (), std::complex<double> (0.0, 0.0));
+          for (size_t uIndex = 0; uIndex < uSize; uIndex++)
+            {
+              std::complex<double> w = uW[uIndex * uCbSize + uCwIndex];
+              const std::complex<double> *projRow = &proj[uIndex * sCbSize];
+              for (uint32_t sCwIndex = 0; sCwIndex < sCbSize; sCwIndex++)
+                {
+                  gain[sCwIndex] += w * projRow[sCwIndex];
+                }
+            }
+          double *powerRow = &power[uCwIndex * sCbSize];
+          for (uint32_t sCwIndex = 0; sCwIndex < sCbSize; sCwIndex++)
+            {
+              powerRow[sCwIndex] += std::norm (gain[sCwIndex]);
+            }
+        }
+    }
+
+  // scale by the average tx PSD, to obtain the average rx PSD as in the
+  // non-batched search
+  double avgTxPsd = 1.0;
+  if (m_txPsd)
+    {
+      avgTxPsd = Sum (*m_txPsd) / m_txPsd->GetSpectrumModel ()->GetNumBands ();
+    }
+
+  for (uint32_t uCwIndex = 0; uCwIndex < uCbSize; uCwIndex++)
+    {
+      for (uint32_t sCwIndex = 0; sCwIndex < sCbSize; sCwIndex++)
+        {
+          double avgRxPsd = avgTxPsd * power[uCwIndex * sCbSize + sCwIndex];
+          if (thisIsU)
+            {
+              matrix[uCwIndex][sCwIndex] = avgRxPsd;
+            }
+          else
+            {
+              matrix[sCwIndex][uCwIndex] = avgRxPsd;
+            }
+        }
+    }
+  NS_LOG_DEBUG ("Matrix of size " << matrix.size () << "x" << matrix[0].size ());
+
+  return matrix;
+}
+
+
 } // namespace mmwave
 } // namespace ns3
@@ -174,26 +174,67 @@ private:
   /**
    * Compute the beamforming vectors using SVD
    * \param params the channel matrix
+   * \param sWarmStart the bf vector previously computed for the s side of the
+   *        channel, or an empty vector
+   * \param uWarmStart the bf vector previously computed for the u side of the
+   *        channel, or an empty vector
    * \return a pair with the beamforming vectors
    */
-  std::pair<PhasedArrayModel::ComplexVector, PhasedArrayModel::ComplexVector> ComputeBeamformingVectors (Ptr<const MatrixBasedChannelModel::ChannelMatrix> params) const;
+  std::pair<PhasedArrayModel::ComplexVector, PhasedArrayModel::ComplexVector> ComputeBeamformingVectors (Ptr<const MatrixBasedChannelModel::ChannelMatrix> params,
+                                                                                                         const PhasedArrayModel::ComplexVector &sWarmStart,
+                                                                                                         const PhasedArrayModel::ComplexVector &uWarmStart);
 
   /**
-   * Compute eigenvector related to highest eigenvalue
-   * \param A spatial correlation matrix (complex, hermitian)
-   * \param nIter maximum number of iterations
-   * \param threshold if norm of two consecutive vectors is below this threshold, stop computation before nIter iterations
-   * \return eigenvector
+   * Multiply the narrowband channel H stored in the workspace by a vector
+   * \param hermitian if true, the vector is multiplied by the conjugate
+   *        transpose of H
+   * \param x the vector, of the size of the s side of the channel, or of the
+   *        u side if hermitian is true
+   * \param y the product
    */
-  PhasedArrayModel::ComplexVector GetFirstEigenvector (MatrixBasedChannelModel::Complex2DVector A) const;
+  void MultiplyChannel (bool hermitian, const std::complex<double> *x, std::complex<double> *y);
+
+  /**
+   * Compute the eigenvector related to the highest eigenvalue of the spatial
+   * correlation matrix H^H H, or H H^H if leftSide is true, where H is the
+   * narrowband channel stored in the workspace.
+   * The eigenvector is approximated with the Lanczos algorithm, which
+   * multiplies the vectors by H and H^H without forming the correlation matrix.
+   * \param leftSide if true, the eigenvector of H H^H is computed
+   * \param x the initial vector, which is replaced by the eigenvector
+   * \return the number of Lanczos iterations
+   */
+  uint32_t GetFirstEigenvector (bool leftSide, PhasedArrayModel::ComplexVector &x);
 
 
   Ptr<MatrixBasedChannelModel> m_channel; //!< pointer to the MatrixChannel, to retrieve the matrix on which the SVD should be computed
 
-  std::map<Ptr<NetDevice>, Ptr<const MatrixBasedChannelModel::ChannelMatrix> > m_cacheChannelMap; //!< map that stores the channel previously computed
-  std::map<Ptr<NetDevice>, std::pair<PhasedArrayModel::ComplexVector, PhasedArrayModel::ComplexVector> > m_cacheBfVectors; //!< map that stores the previous bf vectors
-  uint32_t m_maxIterations; //!< Maximum number of iterations to numerically approximate the SVD decomposition
-  double m_tolerance; //!< Tolerance to numerically approximate the SVD decomposition
+  /* struct used to store the beamforming vectors computed for a target device */
+  struct CacheEntry
+  {
+    Ptr<const MatrixBasedChannelModel::ChannelMatrix> channel; //!< the channel used to compute the bf vectors
+    std::pair<PhasedArrayModel::ComplexVector, PhasedArrayModel::ComplexVector> bfVectors; //!< the bf vectors of this and of the other antenna
+    uint64_t thisEpoch; //!< the epoch of the bf vector of this antenna after it has been configured
+    uint64_t otherEpoch; //!< the epoch of the bf vector of the other antenna after it has been configured
+  };
+  std::map<Ptr<NetDevice>, CacheEntry> m_cache; //!< map that stores the channel and the bf vectors previously computed
+
+  /* buffers used to compute the bf vectors, kept to avoid reallocating them for every channel */
+  struct Workspace
+  {
+    uint16_t uSize; //!< the size of the u side of the channel
+    uint16_t sSize; //!< the size of the s side of the channel
+    std::vector<std::complex<double> > channel; //!< the narrowband channel H, stored by rows of the u side
+    std::vector<std::complex<double> > product; //!< intermediate product by H or H^H
+    std::vector<std::complex<double> > basis; //!< the orthonormal Lanczos vectors, one after the other
+    std::vector<double> alpha; //!< the diagonal of the Lanczos tridiagonal matrix
+    std::vector<double> beta; //!< the off-diagonal of the Lanczos tridiagonal matrix
+    std::vector<double> ritz; //!< the largest eigenvector of the tridiagonal matrix
+    std::vector<double> tridiagonal; //!< the factorization of the tridiagonal matrix
+  };
+  Workspace m_workspace; //!< the buffers used to compute the bf vectors
+  uint32_t m_maxIterations; //!< Maximum number of Lanczos iterations to numerically approximate the SVD decomposition
+  double m_tolerance; //!< Relative residual below which the Lanczos iterations stop
   bool m_useCache; //!< Cache the channel matrix whenever possible. NOTE: the SVD decomposition can be extremely computationally expensive, caching is suggested.
 };
 
@@ -253,14 +294,37 @@ public:
   void SetBeamformingVectorForDevice (Ptr<NetDevice> otherDevice, Ptr<PhasedArrayModel> otherAntenna) override;
 
 private:
+  void DoDispose (void) override;
+
   using Matrix2D = std::vector<std::vector<double> >;
   /**
-   *
+   * Computes the average received power for each pair of codewords.
+   * If a channel model is available and the batched search is enabled, the
+   * computation is delegated to ComputeBeamformingCodebookMatrixBatched,
+   * otherwise each pair is evaluated through the SpectrumPropagationLossModel.
+   * \param otherDevice the target device
+   * \param otherAntenna the target antenna of otherDevice
+   * \return matrix[thisIdx][otherIdx] with the average received PSD
    */
   Matrix2D ComputeBeamformingCodebookMatrix (Ptr<NetDevice> otherDevice, Ptr<PhasedArrayModel> otherAntenna) const;
 
+  /**
+   * Batched beam-pair search.
+   * The channel matrix is retrieved once, the codewords of both codebooks are
+   * stacked into dense matrices and, for each cluster n, the projections
+   * H_n * W_s are computed for all the s-codewords at once. The score of each
+   * pair is then obtained as the frequency-flat power sum over the clusters,
+   * sum_n |w_u^T H_n w_s|^2, scaled by the average tx PSD.
+   * \param otherDevice the target device
+   * \param otherAntenna the target antenna of otherDevice
+   * \return matrix[thisIdx][otherIdx] with the average received PSD
+   */
+  Matrix2D ComputeBeamformingCodebookMatrixBatched (Ptr<NetDevice> otherDevice, Ptr<PhasedArrayModel> otherAntenna) const;
+
   ObjectFactory m_beamformingCodebookFactory;
   Ptr<SpectrumPropagationLossModel> m_splm; //!<
+  Ptr<MatrixBasedChannelModel> m_channel; //!< pointer to the MatrixChannel, used by the batched beam-pair search
+  bool m_batchedSearch; //!< if true and m_channel is set, use the batched beam-pair search
   Ptr<SpectrumValue> m_txPsd;
   
   /* struct used to store the selected beam pairs */
@@ -269,6 +333,8 @@ private:
     uint32_t thisCbIdx; //!< index of the codeword for this antenna  
     uint32_t otherCbIdx; //!< index of the codeword for the other antenna
     Time lastUpdate; //!< time stamp
+    uint64_t thisEpoch; //!< the epoch of the bf vector of this antenna after it has been configured
+    uint64_t otherEpoch; //!< the epoch of the bf vector of the other antenna after it has been configured
   };
   std::map<Ptr<PhasedArrayModel>, Entry> m_codebookIdsCache; //!< stores the selected beam pairs 
   Time m_updatePeriod; //!< defines the refresh period for updating the beam pairs
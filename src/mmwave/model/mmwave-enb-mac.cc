@@ -810,8 +810,7 @@ MmWaveEnbMac::DoDlHarqFeedback (DlHarqInfo params)
   if (params.m_harqStatus == DlHarqInfo::ACK)
     {
       // discard buffer
-      Ptr<PacketBurst> emptyBuf = CreateObject <PacketBurst> ();
-      (*it).second.at (params.m_harqProcessId).m_pktBurst = emptyBuf;
+      (*it).second.at (params.m_harqProcessId).m_pdu = 0;
       NS_LOG_DEBUG (this << " HARQ-ACK UE " << params.m_rnti << " harqId " << (uint16_t)params.m_harqProcessId);
     }
   else if (params.m_harqStatus == DlHarqInfo::NACK)
@@ -866,27 +865,19 @@ void
 MmWaveEnbMac::DoTransmitPdu (LteMacSapProvider::TransmitPduParameters params)
 {
   // TB UID passed back along with RLC data as HARQ process ID
-  uint32_t tbMapKey = ((params.rnti & 0xFFFF) << 8) | (params.harqProcessId & 0xFF);
   NS_LOG_LOGIC ("Tx RLC PDU for rnti " << params.rnti << " lcid " << (uint32_t) params.lcid);
-  std::map<uint32_t, struct MacPduInfo>::iterator it = m_macPduMap.find (tbMapKey);
-  if (it == m_macPduMap.end ())
+  std::map <uint16_t, MmWaveDlHarqProcessesBuffer_t>::iterator harqIt = m_miDlHarqProcessesPackets.find (params.rnti);
+  if (harqIt == m_miDlHarqProcessesPackets.end ()
+      || params.harqProcessId >= harqIt->second.size ()
+      || !harqIt->second[params.harqProcessId].m_building)
     {
       NS_FATAL_ERROR ("No MAC PDU storage element found for this TB UID/RNTI");
     }
-  else
-    {
-      if (it->second.m_pdu == 0)
-        {
-          it->second.m_pdu = params.pdu;
-        }
-      else
-        {
-          it->second.m_pdu->AddAtEnd (params.pdu);               // append to MAC PDU
-        }
-      MacSubheader subheader (params.lcid, params.pdu->GetSize ());
-      it->second.m_macHeader.AddSubheader (subheader);           // add RLC PDU sub-header into MAC header
-      it->second.m_numRlcPdu++;
-    }
+  MmWaveDlHarqProcessInfo &harqProcess = harqIt->second[params.harqProcessId];
+  harqProcess.m_pdu->AddAtEnd (params.pdu);                      // append to MAC PDU
+  MacSubheader subheader (params.lcid, params.pdu->GetSize ());
+  harqProcess.m_macHeader.AddSubheader (subheader);              // add RLC PDU sub-header into MAC header
+  harqProcess.m_numRlcPdu++;
 }
 
 void
@@ -926,25 +917,25 @@ MmWaveEnbMac::DoSchedConfigIndication (MmWaveMacSchedSapUser::SchedConfigIndPara
                   NS_ASSERT (rlcPduInfo.size () > 0);
                   SfnSf pduSfn = ind.m_sfnSf;
                   pduSfn.m_symStart = ttiAllocInfo.m_dci.m_symStart;
-                  MacPduInfo macPduInfo (pduSfn, ttiAllocInfo.m_dci.m_tbSize, rlcPduInfo.size (), dciElem);
-                  // insert into MAC PDU map
-                  uint32_t tbMapKey = ((rnti & 0xFFFF) << 8) | (tbUid & 0xFF);
-                  std::pair <std::map<uint32_t, struct MacPduInfo>::iterator, bool> mapRet =
-                    m_macPduMap.insert (std::pair<uint32_t, struct MacPduInfo> (tbMapKey, macPduInfo));
-                  if (!mapRet.second)
-                    {
-                      NS_FATAL_ERROR ("MAC PDU map element exists");
-                    }
 
-                  // new data -> force emptying correspondent harq pkt buffer
+                  // new data -> the TB of the HARQ process replaces the previous one,
+                  // and is filled with the RLC PDUs by DoTransmitPdu
                   std::map <uint16_t, MmWaveDlHarqProcessesBuffer_t>::iterator harqIt = m_miDlHarqProcessesPackets.find (rnti);
                   NS_ASSERT (harqIt != m_miDlHarqProcessesPackets.end ());
-                  Ptr<PacketBurst> pb = CreateObject <PacketBurst> ();
-                  harqIt->second.at (tbUid).m_pktBurst = pb;
-                  harqIt->second.at (tbUid).m_lcidList.clear ();
+                  MmWaveDlHarqProcessInfo &harqProcess = harqIt->second.at (tbUid);
+                  if (harqProcess.m_building)
+                    {
+                      NS_FATAL_ERROR ("MAC PDU map element exists");
+                    }
+                  harqProcess.m_pdu = Create<Packet> ();
+                  // TODO: set dci.m_symStart in SfnSf
+                  MmWaveMacPduTag pduTag (pduSfn, dciElem.m_numSym);
+                  harqProcess.m_pdu->AddPacketTag (pduTag);
+                  harqProcess.m_macHeader.Clear ();
+                  harqProcess.m_numRlcPdu = 0;
+                  harqProcess.m_lcidList.clear ();
+                  harqProcess.m_building = true;
 
-                  std::map<uint32_t, struct MacPduInfo>::iterator pduMapIt = mapRet.first;
-                  pduMapIt->second.m_numRlcPdu = 0;
                   for (unsigned int ipdu = 0; ipdu < rlcPduInfo.size (); ipdu++)
                     {
                       NS_ASSERT_MSG (rntiIt != m_rlcAttached.end (), "could not find RNTI" << rnti);
@@ -960,33 +951,36 @@ MmWaveEnbMac::DoSchedConfigIndication (MmWaveMacSchedSapUser::SchedConfigIndPara
                       txOpParams.rnti = rnti;
                       txOpParams.lcid = rlcPduInfo[ipdu].m_lcid;
                       (*lcidIt).second->NotifyTxOpportunity (txOpParams);
-                      harqIt->second.at (tbUid).m_lcidList.push_back (rlcPduInfo[ipdu].m_lcid);
+                      harqProcess.m_lcidList.push_back (rlcPduInfo[ipdu].m_lcid);
                     }
+                  harqProcess.m_building = false;
 
-                  if (pduMapIt->second.m_numRlcPdu == 0)
+                  if (harqProcess.m_numRlcPdu == 0)
                     {
                       MacSubheader subheader (3, 0);                            // add subheader for empty packet
-                      pduMapIt->second.m_macHeader.AddSubheader (subheader);
+                      harqProcess.m_macHeader.AddSubheader (subheader);
                     }
-                  pduMapIt->second.m_pdu->AddHeader (pduMapIt->second.m_macHeader);
+                  // the header is serialized once, in the headroom of the packet buffer
+                  harqProcess.m_pdu->AddHeader (harqProcess.m_macHeader);
 
+#ifdef NS3_ASSERT_ENABLE
                   MmWaveMacPduHeader hdrTst;
-                  pduMapIt->second.m_pdu->PeekHeader (hdrTst);
-
-                  NS_ASSERT (pduMapIt->second.m_pdu->GetSize () > 0);
-                  LteRadioBearerTag bearerTag (rnti, pduMapIt->second.m_size, 0);
-                  pduMapIt->second.m_pdu->AddPacketTag (bearerTag);
-                  NS_LOG_DEBUG ("eNB sending MAC pdu size " << pduMapIt->second.m_pdu->GetSize ());
-                  for (unsigned i = 0; i < pduMapIt->second.m_macHeader.GetSubheaders ().size (); i++)
+                  harqProcess.m_pdu->PeekHeader (hdrTst);
+                  NS_ASSERT (hdrTst.GetSerializedSize () == harqProcess.m_macHeader.GetSerializedSize ());
+#endif
+
+                  NS_ASSERT (harqProcess.m_pdu->GetSize () > 0);
+                  LteRadioBearerTag bearerTag (rnti, dciElem.m_tbSize, 0);
+                  harqProcess.m_pdu->AddPacketTag (bearerTag);
+                  NS_LOG_DEBUG ("eNB sending MAC pdu size " << harqProcess.m_pdu->GetSize ());
+                  for (unsigned i = 0; i < harqProcess.m_macHeader.GetSubheaders ().size (); i++)
                     {
-                      NS_LOG_DEBUG ("Subheader " << i << " size " << pduMapIt->second.m_macHeader.GetSubheaders ().at (i).m_size);
+                      NS_LOG_DEBUG ("Subheader " << i << " size " << harqProcess.m_macHeader.GetSubheaders ().at (i).m_size);
                     }
-                  NS_LOG_DEBUG ("Total MAC PDU size " << pduMapIt->second.m_pdu->GetSize ());
-                  harqIt->second.at (tbUid).m_pktBurst->AddPacket (pduMapIt->second.m_pdu);
+                  NS_LOG_DEBUG ("Total MAC PDU size " << harqProcess.m_pdu->GetSize ());
 
-                  m_txMacPacketTraceEnb (rnti, m_componentCarrierId, pduMapIt->second.m_pdu->GetSize ());
-                  m_phySapProvider->SendMacPdu (pduMapIt->second.m_pdu);
-                  m_macPduMap.erase (pduMapIt);                        // delete map entry
+                  m_txMacPacketTraceEnb (rnti, m_componentCarrierId, harqProcess.m_pdu->GetSize ());
+                  m_phySapProvider->SendMacPdu (harqProcess.m_pdu);
                 }
               else
                 {
@@ -996,10 +990,10 @@ MmWaveEnbMac::DoSchedConfigIndication (MmWaveMacSchedSapUser::SchedConfigIndPara
                       // HARQ retransmission -> retrieve TB from HARQ buffer
                       std::map <uint16_t, MmWaveDlHarqProcessesBuffer_t>::iterator it = m_miDlHarqProcessesPackets.find (rnti);
                       NS_ASSERT (it != m_miDlHarqProcessesPackets.end ());
-                      Ptr<PacketBurst> pb = it->second.at (tbUid).m_pktBurst;
-                      for (std::list<Ptr<Packet> >::const_iterator j = pb->Begin (); j != pb->End (); ++j)
+                      Ptr<Packet> pdu = it->second.at (tbUid).m_pdu;
+                      if (pdu != 0)
                         {
-                          Ptr<Packet> pkt = (*j)->Copy ();
+                          Ptr<Packet> pkt = pdu->Copy ();
                           MmWaveMacPduTag tag;                                                                          // update PDU tag for retransmission
                           if (!pkt->RemovePacketTag (tag))
                             {
@@ -1069,13 +1063,7 @@ MmWaveEnbMac::DoAddUe (uint16_t rnti)
 
   // Create DL transmission HARQ buffers
   MmWaveDlHarqProcessesBuffer_t buf;
-  uint16_t harqNum = m_phyMacConfig->GetNumHarqProcess ();
-  buf.resize (harqNum);
-  for (uint8_t i = 0; i < harqNum; i++)
-    {
-      Ptr<PacketBurst> pb = CreateObject <PacketBurst> ();
-      buf.at (i).m_pktBurst = pb;
-    }
+  buf.resize (m_phyMacConfig->GetNumHarqProcess ());
   m_miDlHarqProcessesPackets.insert (std::pair <uint16_t, MmWaveDlHarqProcessesBuffer_t> (rnti, buf));
 
 }
@@ -47,12 +47,26 @@ namespace ns3 {
 
 namespace mmwave {
 
+/**
+ * State of a DL HARQ process. The TB of a new transmission is built in place
+ * while the RLC entities fill it, and is then kept for the retransmissions,
+ * so that no storage is allocated for each scheduled TB.
+ */
 struct MmWaveDlHarqProcessInfo
 {
-  Ptr<PacketBurst> m_pktBurst;
+  MmWaveDlHarqProcessInfo ()
+    : m_numRlcPdu (0),
+      m_building (false)
+  {
+  }
+
+  Ptr<Packet> m_pdu; //!< the TB, 0 if there is nothing to retransmit
   // maintain list of LCs contained in this TB
   // used to signal HARQ failure to RLC handlers
   std::vector<uint8_t> m_lcidList;
+  MmWaveMacPduHeader m_macHeader; //!< the MAC header of the TB being built
+  uint8_t m_numRlcPdu; //!< the number of RLC PDUs added to the TB being built
+  bool m_building; //!< true while the RLC PDUs are added to the TB
 };
 
 typedef std::vector <MmWaveDlHarqProcessInfo> MmWaveDlHarqProcessesBuffer_t;
@@ -228,7 +242,6 @@ private:
   uint8_t m_slotNum;
 
   uint8_t m_tbUid;
-  std::map<uint32_t, struct MacPduInfo> m_macPduMap;
 
   std::list <uint16_t> m_associatedUe;
 
@@ -40,6 +40,8 @@
 #include <ns3/simulator.h>
 #include <ns3/attribute-accessor-helper.h>
 #include <ns3/double.h>
+#include <ns3/uinteger.h>
+#include <ns3/three-gpp-spectrum-propagation-loss-model.h>
 
 #include "mmwave-enb-phy.h"
 #include "mmwave-ue-phy.h"
@@ -60,7 +62,6 @@
 #include <fstream>
 #include <ns3/average.h>
 #include <algorithm>
-#include <array>
 #include <ns3/antenna-model.h>
 
 namespace ns3 {
@@ -85,6 +86,7 @@ MmWaveEnbPhy::MmWaveEnbPhy (Ptr<MmWaveSpectrumPhy> dlPhy, Ptr<MmWaveSpectrumPhy>
 {
   m_enbCphySapProvider = new MemberLteEnbCphySapProvider<MmWaveEnbPhy> (this);
   m_roundFromLastUeSinrUpdate = 0;
+  m_sinrNoise = CreateObject<NormalRandomVariable> ();
   Simulator::ScheduleNow (&MmWaveEnbPhy::StartSlot, this);
 }
 
@@ -115,6 +117,15 @@ MmWaveEnbPhy::GetTypeId (void)
                    IntegerValue (1600),     //TODO considering refactoring in MmWavePhyMacCommon
                    MakeIntegerAccessor (&MmWaveEnbPhy::m_updateSinrPeriod),
                    MakeIntegerChecker<int> ())
+    .AddAttribute ("UpdateSinrEstimateThreads",
+                   "Number of threads used to compute the received PSDs of the UEs in the update of the SINR estimate. "
+                   "If 0, the PSDs are computed one at a time. Otherwise, the beamforming vectors of each UE are "
+                   "copied when the beams are configured, and the PSDs are computed in parallel, with the same "
+                   "result for any number of threads. Only a ThreeGppSpectrumPropagationLossModel supports the "
+                   "parallel computation, with other models the PSDs are computed one at a time.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&MmWaveEnbPhy::m_updateSinrThreads),
+                   MakeUintegerChecker<uint32_t> ())
     .AddAttribute ("UpdateUeSinrEstimatePeriod",
                    "Period (in ms) of reporting of SINR estimate of all the UE",
                    DoubleValue (25.6),
@@ -206,42 +217,13 @@ MmWaveEnbPhy::DoDispose (void)
 }
 
 
-// TODO remove these methods
-//Function for average
-double
-MmWaveEnbPhy::MakeAvg ( std::vector<double> v )
+int64_t
+MmWaveEnbPhy::AssignStreams (int64_t stream)
 {
-  double return_value = 0.0;
-  int n = v.size ();
-
-  for ( int i = 0; i < n; i++)
-    {
-      return_value += v.at (i);
-    }
-
-  return ( return_value / v.size ());
+  NS_LOG_FUNCTION (this << stream);
+  m_sinrNoise->SetStream (stream);
+  return 1;
 }
-//****************End of average funtion****************
-
-
-//Function for variance
-double
-MmWaveEnbPhy::MakeVar ( std::vector<double> v, double mean )
-{
-  double sum = 0.0;
-  double temp = 0.0;
-  double var = 0.0;
-  int n = v.size ();
-
-  for ( int j = 0; j < n; j++)
-    {
-      temp = std::pow ((v.at (j) - mean),2);
-      sum += temp;
-    }
-
-  return var = sum / (v.size ());
-}
-//****************End of variance funtion****************
 
 double
 MmWaveEnbPhy::AddGaussianNoise (double LastSinrValue)
@@ -251,9 +233,8 @@ MmWaveEnbPhy::AddGaussianNoise (double LastSinrValue)
   double signalEnergy;
   double noisySample;
 
-  Ptr<NormalRandomVariable> randomVariable = CreateObject<NormalRandomVariable> ();
-  double gaussianSampleRe = randomVariable->GetValue ();
-  double gaussianSampleIm = randomVariable->GetValue ();
+  double gaussianSampleRe = m_sinrNoise->GetValue ();
+  double gaussianSampleIm = m_sinrNoise->GetValue ();
   gaussianNoise = std::complex<double> (sqrt (0.5) * sqrt (N0) * gaussianSampleRe, sqrt (0.5) * sqrt (N0) * gaussianSampleIm);
 
   signalEnergy = LastSinrValue * N0;
@@ -265,241 +246,6 @@ MmWaveEnbPhy::AddGaussianNoise (double LastSinrValue)
 
 
 
-std::pair<uint64_t, uint64_t>
-MmWaveEnbPhy::ApplyFilter (std::vector<double> noisySinr)
-{
-  std::vector<double> noisySinrdB;
-  for (uint64_t i = 0; i < noisySinr.size (); ++i)
-    {
-      noisySinrdB.push_back (10 * std::log10 (noisySinr.at (i)));
-    }
-
-  std::vector<double> vectorVar;
-  NS_LOG_DEBUG ("noisySinrdBSize() " << noisySinrdB.size ());
-  for (uint64_t i = 0; i < noisySinrdB.size () - 1; ++i)
-    {
-      std::vector<double> partialSamples;
-      partialSamples.push_back (noisySinrdB.at (i));
-      partialSamples.push_back (noisySinrdB.at (i + 1));
-      double meanValue = MakeAvg (partialSamples);
-      double varValue = MakeVar (partialSamples,meanValue);
-      vectorVar.push_back (varValue);
-      partialSamples.clear ();
-    }
-
-  uint64_t startFilter = 1e6;
-  uint64_t endFilter = 1e6;
-
-  bool flagStartFilter = true;
-  bool flagEndFilter = true;
-
-  uint64_t noisySinrIndex = 0;
-
-  for (uint64_t varIndex = vectorVar.size () - 1; varIndex > 0; varIndex--)      // start filter when variance of the noisy trace is high
-    {
-      NS_LOG_DEBUG ("varIndex " << varIndex);
-      noisySinrIndex = varIndex + 1;
-      NS_LOG_DEBUG ("vectorVar[i] " << vectorVar.at (varIndex));
-      NS_LOG_DEBUG ("vectorVar[i] == NaN " << (std::isnan (vectorVar.at (varIndex))));
-      bool highVariance = (vectorVar.at (varIndex) > 5 || std::isnan (vectorVar.at (varIndex)));
-      bool lowSinr = noisySinr.at (noisySinrIndex) < 10;
-
-      if (highVariance || (lowSinr && !highVariance))            // filter is applied only for low-SINR regimes [dB]
-        {
-          endFilter = noisySinrIndex;
-          flagEndFilter = false;               // a "start" sample has been identified
-          break;
-        }
-    }
-
-  if (flagEndFilter)       // in this case, we can avoid the filtering
-    {
-      endFilter = 0;
-    }
-
-  /* in this case, consider at least a window of 15 samples, after which we can consider
-  * as we are leaving the blockage phase and we start coming back to LOS PL regimes
-  */
-  uint64_t varIndex = 0;
-  uint64_t numberOfVarWindow = 16;
-  NS_LOG_DEBUG ("VectorVarSize() " << vectorVar.size ());
-  for (uint64_t noisySinrIndex = endFilter; noisySinrIndex > numberOfVarWindow; --noisySinrIndex)       // must be at least after the beginnning of the blocakge
-    {
-      NS_LOG_DEBUG ("noisySinrIndex " << noisySinrIndex);
-      varIndex = noisySinrIndex - 1;
-
-      std::vector<double>::const_iterator first = vectorVar.begin () + varIndex;
-      std::vector<double>::const_iterator last = vectorVar.begin () + varIndex - (numberOfVarWindow - 1);          // vectorVar has one sample less than noisySinrdB
-      std::vector<double> prov (last,first);
-
-      std::vector<double>::const_iterator firstNoisy = noisySinrdB.begin () + noisySinrIndex;
-      std::vector<double>::const_iterator lastNoisy = noisySinrdB.begin () + noisySinrIndex - numberOfVarWindow;
-      std::vector<double> provNoisy (lastNoisy,firstNoisy);
-
-      NS_LOG_INFO ("provNoisy.size " << provNoisy.size ());
-      for (std::vector<double>::const_iterator h = provNoisy.begin (); h != provNoisy.end (); h++)
-        {
-          NS_LOG_INFO ("h " << *h);
-          NS_LOG_INFO ("i " << noisySinrIndex  );
-          NS_LOG_INFO ("hh " << *(noisySinrdB.begin () + noisySinrIndex - numberOfVarWindow));
-        }
-
-
-      /* the filtering ends when the variance of the noisy trace is almost the same, so when
-      * the SINR is on sufficiently high values
-      */
-
-      if (Simulator::Now () > Seconds (2.1) && Simulator::Now () < Seconds (2.3))
-        {
-          NS_LOG_DEBUG ("(std::all_of(prov.begin(),prov.end(), [](double j){return j < 1;})) " << (std::all_of (prov.begin (),prov.end (), [] (double j){
-            return j < 1;
-          })));
-          NS_LOG_DEBUG ("(std::all_of(prov.begin(),prov.end(), [](double j){nan;})) " << (std::all_of (prov.begin (),prov.end (), [] (double k){
-            return !std::isnan (k);
-          })));
-          NS_LOG_DEBUG ("(std::all_of(provNoisy.begin(),provNoisy.end(), [](double p){return p > 10;})) " << (std::all_of (provNoisy.begin (),provNoisy.end (), [] (double p){
-            return p > 10;
-          })));
-        }
-
-      if (((std::all_of (prov.begin (),prov.end (), [] (double j){
-          return j < 1;
-        }))
-           && (std::all_of (prov.begin (),prov.end (), [] (double k){
-          return !std::isnan (k);
-        })))
-          || (std::all_of (provNoisy.begin (),provNoisy.end (), [] (double p){
-          return p > 10;
-        })))
-        {
-          startFilter = noisySinrIndex;
-          flagStartFilter = false;               // a "end" sample has been identified
-          break;
-        }
-
-      // bool lowVariance = (vectorVar.at(varIndex) < 1 && !std::isnan(vectorVar.at(varIndex)));
-      // bool highSinr = noisySinr.at(noisySinrIndex) > 10;
-
-      // if (highSinr && lowVariance)  // filter is applied only for low-SINR regimes [dB]
-      // {
-      //        startFilter = noisySinrIndex;
-      //        flagStartFilter = false; // a "start" sample has been identified
-      //        break;
-      // }
-
-    }
-
-  if (flagStartFilter)       // in this case, filter till the end of the trace
-    {
-      startFilter = 0;
-    }
-
-
-  std::pair< uint64_t, uint64_t > pairFiltering = std::make_pair (startFilter,endFilter);
-
-  return pairFiltering;
-}
-
-std::vector<double>
-MmWaveEnbPhy::MakeFilter (std::vector<double> noisySinr, std::vector<double> realSinr, std::pair <uint64_t, uint64_t > pairFiltering)
-{
-
-  for (uint64_t i = 0; i < noisySinr.size (); ++i)
-    {
-      NS_LOG_DEBUG ("() " << noisySinr.at (i));
-    }
-  //const uint64_t lengthFiltering  = (std::get<1>(pairFiltering) - std::get<0>(pairFiltering));
-  /* find best alpha parameter for the Kalman estimation */
-  int rep = 0;
-  std::array<double,100> meanError;
-  for (double alpha = 0; alpha < 1; alpha = alpha + 0.01 )
-    {
-
-      std::vector<double>  x;
-      x.push_back (0);           // initialization of array
-      int counter = 0;
-
-      for (uint64_t i = std::get<0> (pairFiltering); i < std::get<1> (pairFiltering); i++)
-        {
-          x.push_back ((1 - alpha) * x.at (counter) + alpha * (noisySinr.at (i)));
-          counter++;
-        }
-
-      std::vector<double> errorEstimation;
-      counter = 0;
-      for (uint64_t i = std::get<0> (pairFiltering); i < std::get<1> (pairFiltering); i++)
-        {
-          errorEstimation.push_back (std::abs (x.at (counter + 1) - realSinr.at (i)));
-          counter++;
-        }
-
-      meanError.at (rep) = MakeAvg ( errorEstimation );
-      if (Simulator::Now () > Seconds (2.1) && Simulator::Now () < Seconds (2.3))
-        {
-          NS_LOG_DEBUG ("meanError " << meanError.at (rep) << " rep " << rep);
-        }
-      rep++;
-    }
-
-  int posMinAlpha = std::distance (meanError.begin (),std::min_element (meanError.begin (),meanError.end ()));
-  double minAlpha = (posMinAlpha + 1) * 0.01;
-  if (minAlpha > 0.5)
-    {
-      minAlpha = 0.2;
-    }
-  NS_LOG_DEBUG ("! " << minAlpha);
-
-  std::vector<double> blockageTrace;
-  blockageTrace.push_back (0);
-  int counter = 0;
-  for (uint64_t i = std::get<0> (pairFiltering); i < std::get<1> (pairFiltering); i++)
-    {
-      NS_LOG_DEBUG (noisySinr.at (i));
-      blockageTrace.push_back ((1 - minAlpha) * blockageTrace.at (counter) + minAlpha * (noisySinr.at (i)));
-      NS_LOG_DEBUG ("fff " << blockageTrace.at (counter));
-      counter++;
-    }
-
-  std::vector<double> retFinalTrace;
-  /* first piece */
-  std::vector<double>::const_iterator firstPieceStart = noisySinr.begin ();
-  std::vector<double>::const_iterator firstPieceEnd = noisySinr.begin () +  std::get<0> (pairFiltering) + 1;
-  std::vector<double> firstPiece;
-  firstPiece.insert (firstPiece.begin (),firstPieceStart,firstPieceEnd);
-  for (std::vector<double>::const_iterator i = firstPiece.begin (); i != firstPiece.end (); i++)
-    {
-      NS_LOG_DEBUG ("/ " << *i);
-    }
-
-  /*last piece*/
-  std::vector<double>::const_iterator lastPieceStart = noisySinr.begin () + std::get<1> (pairFiltering) + 1;
-  std::vector<double>::const_iterator lastPieceEnd = noisySinr.end ();
-  std::vector<double> lastPiece;
-
-  firstPiece.insert (firstPiece.end (),blockageTrace.begin () + 1,blockageTrace.end () - 1);
-  for (std::vector<double>::const_iterator i = firstPiece.begin (); i != firstPiece.end (); i++)
-    {
-      NS_LOG_DEBUG ("// " << *i);
-    }
-
-  firstPiece.insert (firstPiece.end (),lastPieceStart, lastPieceEnd);
-  for (std::vector<double>::const_iterator i = firstPiece.begin (); i != firstPiece.end (); i++)
-    {
-      NS_LOG_DEBUG ("/// " << *i);
-    }
-
-
-
-  /* insert blockageTrace (from begin + 1, in order to AVOID THE TRANSIENT, to end) in the noisySinr trace,
-  * after std::get<0>(pairFiltering) +1 samples,
-  * which are the samples in which we estimate that a blockage occurs and the Kalmn filter is applied
-  */
-  //std::copy(blockageTrace.begin(),blockageTrace.end(),noisySinr.begin()+std::get<0>(pairFiltering) );
-  //std::copy(blockageTrace.begin()+1,blockageTrace.end(),noisySinr.begin()+std::get<0>(pairFiltering)+1 ); // AVOID TRANSIENT
-
-  return firstPiece;       // this noisySinr trace has already been updated with the filtered samples, where applied.
-}
-
 void
 MmWaveEnbPhy::SetMmWaveEnbCphySapUser (LteEnbCphySapUser* s)
 {
@@ -589,6 +335,16 @@ MmWaveEnbPhy::UpdateUeSinrEstimate ()
   Ptr<SpectrumValue> noisePsd = MmWaveSpectrumValueHelper::CreateNoisePowerSpectralDensity (m_phyMacConfig, m_noiseFigure);
   Ptr<SpectrumValue> totalReceivedPsd = Create <SpectrumValue> (SpectrumValue (noisePsd->GetSpectrumModel ()));
 
+  // with the parallel computation, the rx PSDs are prepared in the loop and
+  // computed after it, in the order of m_ueAttachedImsiMap
+  Ptr<ThreeGppSpectrumPropagationLossModel> threeGppSplm;
+  if (m_updateSinrThreads > 0)
+    {
+      threeGppSplm = DynamicCast<ThreeGppSpectrumPropagationLossModel> (m_spectrumPropagationLossModel);
+    }
+  std::vector<ThreeGppSpectrumPropagationLossModel::RxPsdTask> rxPsdTasks;
+  std::vector<uint64_t> rxPsdImsis;
+
   for (std::map<uint64_t, Ptr<NetDevice> >::iterator ue = m_ueAttachedImsiMap.begin (); ue != m_ueAttachedImsiMap.end (); ++ue)
     {
       // distinguish between MC and MmWaveNetDevice
@@ -664,14 +420,23 @@ MmWaveEnbPhy::UpdateUeSinrEstimate ()
       //NS_LOG_DEBUG ("total pathLoss = " << pathLossDb << " dB");
 
       double pathGainLinear = std::pow (10.0, (-pathLossDb) / 10.0);
-      Ptr<SpectrumValue> rxPsd = txPsd->Copy ();
+      // the tx PSD has been created for this UE, hence scale it in place
+      Ptr<SpectrumValue> rxPsd = txPsd;
       *(rxPsd) *= pathGainLinear;
 
-      rxPsd = m_spectrumPropagationLossModel->CalcRxPowerSpectralDensity (rxPsd, ueMob, enbMob);
-      NS_LOG_LOGIC ("RxPsd " << *rxPsd);
+      if (threeGppSplm != 0)
+        {
+          rxPsdTasks.push_back (threeGppSplm->PrepareRxPsd (rxPsd, ueMob, enbMob));
+          rxPsdImsis.push_back (ue->first);
+        }
+      else
+        {
+          rxPsd = m_spectrumPropagationLossModel->CalcRxPowerSpectralDensity (rxPsd, ueMob, enbMob);
+          NS_LOG_LOGIC ("RxPsd " << *rxPsd);
 
-      m_rxPsdMap[ue->first] = rxPsd;
-      *totalReceivedPsd += *rxPsd;
+          m_rxPsdMap[ue->first] = rxPsd;
+          *totalReceivedPsd += *rxPsd;
+        }
 
       // set back the bf vector to the main eNB
       if (ueNetDevice != 0)
@@ -695,168 +460,52 @@ MmWaveEnbPhy::UpdateUeSinrEstimate ()
 
     }
 
+  if (!rxPsdTasks.empty ())
+    {
+      threeGppSplm->CalcRxPsds (rxPsdTasks, m_updateSinrThreads);
+      for (size_t i = 0; i < rxPsdTasks.size (); ++i)
+        {
+          NS_LOG_LOGIC ("RxPsd " << *rxPsdTasks[i].m_psd);
+          m_rxPsdMap[rxPsdImsis[i]] = rxPsdTasks[i].m_psd;
+          *totalReceivedPsd += *rxPsdTasks[i].m_psd;
+        }
+    }
+
   for (std::map<uint64_t, Ptr<SpectrumValue> >::iterator ue = m_rxPsdMap.begin (); ue != m_rxPsdMap.end (); ++ue)
     {
-      SpectrumValue interference = *totalReceivedPsd - *(ue->second);
-      NS_LOG_LOGIC ("interference " << interference);
-      SpectrumValue sinr = *(ue->second) / (*noisePsd);           // + interference);
+      NS_LOG_LOGIC ("interference " << *totalReceivedPsd - *(ue->second));
       // we consider the SNR only!
-      NS_LOG_LOGIC ("sinr " << sinr);
-      double sinrAvg = Sum (sinr) / (sinr.GetSpectrumModel ()->GetNumBands ());
+      NS_LOG_LOGIC ("sinr " << *(ue->second) / (*noisePsd));
+      double sinrAvg = SumOfRatio (*(ue->second), *noisePsd) / (noisePsd->GetSpectrumModel ()->GetNumBands ());
       NS_LOG_DEBUG ("Time " << Simulator::Now ().GetSeconds () << " CellId " << m_cellId << " UE " << ue->first << "Average SINR " << 10 * std::log10 (sinrAvg));
 
       if (m_noiseAndFilter)
         {
           pairDevices_t pairDevices = std::make_pair (ue->first, m_cellId);              // this is the current pair (UE-eNB)
-          std::map< pairDevices_t, std::vector<double> >::iterator iteratorSinr =
-            m_sinrVector.find (pairDevices);                                                     // pair [pairDevices,Sinrvalue]
-
-          if (iteratorSinr != m_sinrVector.end ())              // this map has already been initialized, so I can add a new element for the SINR collection
-            {
-              if (Now ().GetMicroSeconds () <= m_transient )
-                {
-                  m_sinrVector.at (pairDevices).push_back (sinrAvg);                     // before transient, so just collect SINR values
-                }
-              else
-                {
-                  m_sinrVector.at (pairDevices).erase (m_sinrVector.at (pairDevices).begin ());
-                  m_sinrVector.at (pairDevices).push_back (sinrAvg);                     // before transient, so just collect SINR values
-                }
-
-              NS_LOG_DEBUG ("At time " << Now ().GetMicroSeconds () << " push back the REAL SINR " << 10 * std::log10 (sinrAvg) <<
-                            " for pair with CellId " << m_cellId << " and UE " << ue->first);
-            }
-          else               // vector is not initialized, so it means that we are still in the initial transient phase, for that pair
+          std::map<pairDevices_t, MmWaveSinrFilter>::iterator filterIt = m_sinrFilters.find (pairDevices);
+          if (filterIt == m_sinrFilters.end ())
             {
-              m_sinrVector.insert (std::pair<pairDevices_t, std::vector<double> > (pairDevices,std::vector<double> ()));
-              m_sinrVector.at (pairDevices).push_back (sinrAvg);                 // push back a new SINR value
-              NS_LOG_DEBUG ("At time " << Now ().GetMicroSeconds () << " first initializazion and push back the SINR " << 10 * std::log10 (sinrAvg) <<
+              // the window contains the samples collected during the transient
+              uint32_t windowSize = m_transient / m_updateSinrPeriod + 1;
+              filterIt = m_sinrFilters.insert (std::make_pair (pairDevices, MmWaveSinrFilter (windowSize))).first;
+              NS_LOG_DEBUG ("At time " << Now ().GetMicroSeconds () << " first initialization of the SINR filter " <<
                             " for pair with CellId " << m_cellId << " and UE " << ue->first);
             }
 
+          /* generate Gaussian noise for the current SINR value, and filter it if
+           * the transient is over and the UE is in a blockage */
+          double sinrNoisy = AddGaussianNoise (sinrAvg);
+          bool transient = Now ().GetMicroSeconds () <= m_transient;
+          double sampleToForward = filterIt->second.Update (sinrAvg, sinrNoisy, transient);
+          NS_LOG_DEBUG ("At time " << Now ().GetMicroSeconds () << " push back the REAL SINR " << 10 * std::log10 (sinrAvg) <<
+                        " and the noisy SINR " << 10 * std::log10 (sinrNoisy) << " for pair with CellId " << m_cellId << " and UE " << ue->first);
 
-
-
-          std::map< pairDevices_t, std::vector<double> >::iterator iteratorFinalTrace =
-            m_finalSinrVector.find (pairDevices);                                             // pair [pairDevices,Sinrvalue]
-          /* INITIALIZATION OF VECTORS */
-          if (iteratorFinalTrace == m_finalSinrVector.end ())
-            {
-              m_samplesFilter.insert (std::pair<pairDevices_t,std::pair<uint64_t,uint64_t> > (pairDevices,std::pair<uint64_t,uint64_t> ()));
-              m_finalSinrVector.insert (std::pair<pairDevices_t,std::vector<double> > (pairDevices,std::vector<double> ()) );
-            }
-
-
-          std::map< pairDevices_t, std::vector<double> >::iterator iteratorSinrToFilter =
-            m_sinrVectorToFilter.find (pairDevices);                                             // pair [pairDevices,Sinrvalue]
-          /* INITIALIZATION OF VECTORS */
-          if (iteratorSinrToFilter == m_sinrVectorToFilter.end ())
+          if (sampleToForward < 0)                   // this would be converted in NaN, in the log scale
             {
-              m_sinrVectorToFilter.insert (std::pair<pairDevices_t,std::vector<double> > (pairDevices,std::vector<double> ()));
-              m_sinrVectorNoisy.insert (std::pair<pairDevices_t,std::vector<double> > (pairDevices,std::vector<double> ()));
+              sampleToForward = 1e-20;
             }
-
-          /* generate Gaussian noise for the last SINR value (that is the current one) */
-          double sinrNoisy = AddGaussianNoise (m_sinrVector.at (pairDevices).back ());
-
-
-          /* UPDATE TRACE TO BE FILTERED */
-          if (Now ().GetMicroSeconds () <= m_transient)
-            {
-              m_sinrVectorNoisy.at (pairDevices).push_back (sinrNoisy);
-
-              // if (sinrNoisy < 0)
-              // {
-              //        NS_LOG_DEBUG("Old SINR value was " << 10*std::log10(sinrNoisy) << " while now is " << 10*std::log10(0.1));
-              //        sinrNoisy = 0.1;
-              // }
-              m_sinrVectorToFilter.at (pairDevices).push_back (sinrNoisy);
-
-            }
-          else
-            {
-              m_sinrVectorNoisy.at (pairDevices).erase (m_sinrVectorNoisy.at (pairDevices).begin ());
-              m_sinrVectorNoisy.at (pairDevices).push_back (sinrNoisy);
-
-              // if (sinrNoisy < 0)
-              // {
-              //        NS_LOG_DEBUG("Old SINR value was " << 10*std::log10(sinrNoisy) << " while now is " << 10*std::log10(0.1));
-              //        sinrNoisy = 0.1;
-              // }
-
-              double toPlot = *m_sinrVectorToFilter.at (pairDevices).begin ();
-              double toPlotbis = sinrNoisy;
-              NS_LOG_DEBUG ("(Remove SINR)  " << toPlot);
-              NS_LOG_DEBUG ("(Add SINR)  " << toPlotbis);
-
-              m_sinrVectorToFilter.at (pairDevices).erase (m_sinrVectorToFilter.at (pairDevices).begin ());
-              m_sinrVectorToFilter.at (pairDevices).push_back (sinrNoisy);
-
-
-            }
-
-
-          if (Now ().GetMicroSeconds () > m_transient)             // apply filter only when I have a sufficiently large set of SINR samples
-            {
-              std::vector<double> vectorNoisy = m_sinrVectorNoisy.at (pairDevices);
-              std::pair <uint64_t, uint64_t > pairFiltering = ApplyFilter (vectorNoisy);                   // find where to apply the filter, according to the variance
-              m_samplesFilter.at (pairDevices) = pairFiltering;                  // where to apply the linear filter
-              NS_LOG_DEBUG ("£££££££££££££££ start at sample " << std::get<0> (pairFiltering) );
-              NS_LOG_DEBUG ("£££££££££££££££ end at sample " << std::get<1> (pairFiltering) );
-
-              /* just apply filter where the SINR is too low and we are in a blockage situation */
-              if (std::get<0> (m_samplesFilter.at (pairDevices)) == std::get<1> (m_samplesFilter.at (pairDevices)) )                 // if start = end
-                {
-                  m_finalSinrVector.at (pairDevices) = m_sinrVectorToFilter.at (pairDevices);                     // no need to apply the filter
-                  NS_LOG_DEBUG ("At time " << Now ().GetMicroSeconds () << " there is no need to apply the Kalman filter for mmWave eNB "
-                                           << m_cellId << " and UE " << ue->first);
-                }
-              else
-                {
-                  std::vector<double> vectorToFilter = m_sinrVectorToFilter.at (pairDevices);
-                  std::vector<double> sinrVector = m_sinrVector.at (pairDevices);
-                  std::pair<uint64_t, uint64_t> filterPair = m_samplesFilter.at (pairDevices);
-                  std::vector<double> finalTrace;
-                  finalTrace = MakeFilter (vectorNoisy, sinrVector, filterPair);
-                  NS_LOG_DEBUG ("finaltrace " << finalTrace.back ());
-                  m_finalSinrVector.at (pairDevices) = finalTrace;
-                  finalTrace.clear ();
-                }
-
-
-              /* the last sample in the filtered sequence is referred to the current time instant,
-              * referred to the uplink reference signal that is used to build the RT in the LteEnbRrc class */
-              double sampleToForward = m_finalSinrVector.at (pairDevices).back ();
-              if (sampleToForward < 0)                   // this would be converted in NaN, in the log scale
-                {
-                  sampleToForward = 1e-20;
-                }
-              NS_LOG_DEBUG (" mmWave eNB " << m_cellId << " reports the SINR " << 10 * std::log10 (sampleToForward) << " for UE " << ue->first);
-              m_sinrMap[ue->first] = sampleToForward;                   // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<< in order to FORWARD to LteEnbRrc the value of SINR for the RT
-
-              //m_sinrVectorToFilter.at(pairDevices).erase(m_sinrVectorToFilter.at(pairDevices).begin());
-              //m_sinrVectorToFilter.at(pairDevices).push_back(m_finalSinrVector.at(pairDevices).back());
-              m_sinrVectorToFilter.at (pairDevices).pop_back ();
-              m_sinrVectorToFilter.at (pairDevices).push_back (m_finalSinrVector.at (pairDevices).back ());
-            }
-          else               // before the transient is over, just forwart the (last) noisy sample, without having filtered
-            {
-              double sampleToForward = m_sinrVectorToFilter.at (pairDevices).back ();
-              if (sampleToForward < 0)                   // this would be converted in NaN, in the log scale
-                {
-                  sampleToForward = 1e-20;
-                }
-              NS_LOG_DEBUG (" mmWave eNB " << m_cellId << " FIRST reports the SINR " << 10 * std::log10 (sampleToForward) << " for UE " << ue->first);
-              m_sinrMap[ue->first] = sampleToForward;                   // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<< in order to FORWARD to LteEnbRrc the value of SINR for the RT
-            }
-
-          /* after the SINR sample is forwarded, I need to REFRESH all the maps, so that
-          * a new SINR sequence can be created, to generate a new SINR sample
-          * for the next RT
-          */
-          m_finalSinrVector.erase (pairDevices);
-          m_samplesFilter.erase (pairDevices);
-          NS_LOG_DEBUG ("ERASE MAPS FOR RT");
+          NS_LOG_DEBUG (" mmWave eNB " << m_cellId << " reports the SINR " << 10 * std::log10 (sampleToForward) << " for UE " << ue->first);
+          m_sinrMap[ue->first] = sampleToForward;                   // in order to FORWARD to LteEnbRrc the value of SINR for the RT
         }
       else           // noise and filtering processes are not applied!
         {
@@ -1074,22 +723,12 @@ MmWaveEnbPhy::StartTti (void)
                                             currTti.m_dci.m_mcs, m_channelChunks, currTti.m_dci.m_harqProcess, currTti.m_dci.m_rv, false,
                                             currTti.m_dci.m_symStart, currTti.m_dci.m_numSym);
 
-      for (uint8_t i = 0; i < m_deviceMap.size (); i++)
+      Ptr<NetDevice> ueDevice = GetUeDevice (currTti.m_rnti);
+      NS_LOG_DEBUG ("Scheduled rnti: " << currTti.m_rnti << " ue device " << ueDevice << " this eNB " << m_netDevice);
+      if (ueDevice != 0)
         {
-          Ptr<mmwave::MmWaveUeNetDevice> ueDev = DynamicCast<mmwave::MmWaveUeNetDevice> (m_deviceMap.at (i));
-          Ptr<McUeNetDevice> mcUeDev = DynamicCast<McUeNetDevice> (m_deviceMap.at (i));
-          uint64_t ueRnti = (ueDev != 0) ? (ueDev->GetPhy ()->GetRnti ()) : (mcUeDev->GetMmWavePhy ()->GetRnti ());
-          Ptr<NetDevice> associatedEnb = (ueDev != 0) ? (ueDev->GetTargetEnb ()) : (mcUeDev->GetMmWaveTargetEnb ());
-
-          NS_LOG_DEBUG ("Scheduled rnti: " << currTti.m_rnti << " ue rnti: " << ueRnti
-                                           << " target eNB " << associatedEnb << " this eNB " << m_netDevice);
-
-          if (currTti.m_rnti == ueRnti && m_netDevice == associatedEnb)
-            {
-              // point the beam towards the user
-              m_downlinkSpectrumPhy->ConfigureBeamforming (m_deviceMap.at (i));
-              break;
-            }
+          // point the beam towards the user
+          m_downlinkSpectrumPhy->ConfigureBeamforming (ueDevice);
         }
 
       NS_LOG_DEBUG ("ENB " << m_cellId << " RXing UL DATA frame " << m_frameNum << " subframe " << (unsigned)m_sfNum << " slot "
@@ -1170,32 +809,12 @@ MmWaveEnbPhy::SendDataChannels (Ptr<PacketBurst> pb, Time slotPrd, TtiAllocInfo&
     {     // update beamforming vectors (currently supports 1 user only)
       //std::map<uint16_t, std::vector<unsigned> >::iterator ueRbIt = slotInfo.m_ueRbMap.begin();
       //uint16_t rnti = ueRbIt->first;
-      for (uint8_t i = 0; i < m_deviceMap.size (); i++)
+      Ptr<NetDevice> ueDevice = GetUeDevice (slotInfo.m_dci.m_rnti);
+      NS_LOG_DEBUG ("Scheduled rnti: " << slotInfo.m_dci.m_rnti << " ue device " << ueDevice << " this eNB " << m_netDevice);
+      if (ueDevice != 0)
         {
-          uint64_t ueRnti = 0;
-          Ptr<mmwave::MmWaveUeNetDevice> ueDev = m_deviceMap.at (i)->GetObject<mmwave::MmWaveUeNetDevice> ();
-          Ptr<NetDevice> associatedEnb = 0;
-          if (ueDev != 0)
-            {
-              ueRnti = ueDev->GetPhy ()->GetRnti ();
-              associatedEnb = ueDev->GetTargetEnb ();
-            }
-          else
-            {
-              Ptr<McUeNetDevice> ueMcDev = m_deviceMap.at (i)->GetObject<McUeNetDevice> ();
-              ueRnti = ueMcDev->GetMmWavePhy ()->GetRnti ();
-              associatedEnb = ueMcDev->GetMmWaveTargetEnb ();
-            }
-
-          NS_LOG_DEBUG ("Scheduled rnti: " << slotInfo.m_dci.m_rnti << " ue rnti: " << ueRnti
-                                           << " target eNB " << associatedEnb << " this eNB " << m_netDevice);
-          if (slotInfo.m_dci.m_rnti == ueRnti && m_netDevice == associatedEnb)
-            {
-              NS_LOG_DEBUG ("Change Beamforming Vector");
-              m_downlinkSpectrumPhy->ConfigureBeamforming (m_deviceMap.at (i));
-              break;
-            }
-
+          NS_LOG_DEBUG ("Change Beamforming Vector");
+          m_downlinkSpectrumPhy->ConfigureBeamforming (ueDevice);
         }
     }
 
@@ -1222,7 +841,12 @@ MmWaveEnbPhy::AddUePhy (uint64_t imsi, Ptr<NetDevice> ueDevice)
   if (it == m_ueAttached.end ())
     {
       m_ueAttached.insert (imsi);
-      m_deviceMap.push_back (ueDevice);
+      UeDeviceInfo info;
+      info.m_device = ueDevice;
+      info.m_ueDevice = DynamicCast<MmWaveUeNetDevice> (ueDevice);
+      info.m_mcUeDevice = DynamicCast<McUeNetDevice> (ueDevice);
+      info.m_uePhy = (info.m_ueDevice != 0) ? info.m_ueDevice->GetPhy () : info.m_mcUeDevice->GetMmWavePhy ();
+      m_deviceMap.push_back (info);
       m_ueAttachedImsiMap[imsi] = ueDevice;
       return (true);
     }
@@ -1233,6 +857,34 @@ MmWaveEnbPhy::AddUePhy (uint64_t imsi, Ptr<NetDevice> ueDevice)
     }
 }
 
+bool
+MmWaveEnbPhy::IsAssociatedUe (const UeDeviceInfo &info, uint16_t rnti) const
+{
+  Ptr<NetDevice> associatedEnb = (info.m_ueDevice != 0) ? info.m_ueDevice->GetTargetEnb () : info.m_mcUeDevice->GetMmWaveTargetEnb ();
+  return info.m_uePhy->GetRnti () == rnti && associatedEnb == m_netDevice;
+}
+
+Ptr<NetDevice>
+MmWaveEnbPhy::GetUeDevice (uint16_t rnti)
+{
+  std::unordered_map<uint16_t, uint32_t>::const_iterator it = m_rntiDeviceIndex.find (rnti);
+  if (it != m_rntiDeviceIndex.end () && IsAssociatedUe (m_deviceMap[it->second], rnti))
+    {
+      return m_deviceMap[it->second].m_device;
+    }
+
+  for (uint32_t i = 0; i < m_deviceMap.size (); i++)
+    {
+      if (IsAssociatedUe (m_deviceMap[i], rnti))
+        {
+          m_rntiDeviceIndex[rnti] = i;
+          return m_deviceMap[i].m_device;
+        }
+    }
+  m_rntiDeviceIndex.erase (rnti);
+  return 0;
+}
+
 void
 MmWaveEnbPhy::PhyDataPacketReceived (Ptr<Packet> p)
 {
@@ -1374,6 +1026,8 @@ MmWaveEnbPhy::AddUePhy (uint16_t rnti)
   if (it == m_ueAttachedRnti.end ())
     {
       m_ueAttachedRnti.insert (rnti);
+      // the RNTI may have been used by another UE
+      m_rntiDeviceIndex.erase (rnti);
       return (true);
     }
   else
@@ -1390,6 +1044,7 @@ MmWaveEnbPhy::DoRemoveUe (uint16_t rnti)
   if (it != m_ueAttachedRnti.end ())
     {
       m_ueAttachedRnti.erase (it);
+      m_rntiDeviceIndex.erase (rnti);
     }
   else
     {
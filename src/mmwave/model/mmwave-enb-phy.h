@@ -40,9 +40,12 @@
 #include "mmwave-phy-mac-common.h"
 #include "mmwave-control-messages.h"
 #include "mmwave-mac.h"
+#include "mmwave-sinr-filter.h"
 #include <ns3/lte-enb-phy-sap.h>
 #include <ns3/lte-enb-cphy-sap.h>
 #include <ns3/mmwave-harq-phy.h>
+#include <ns3/random-variable-stream.h>
+#include <unordered_map>
 
 namespace ns3 {
 
@@ -55,6 +58,8 @@ namespace mmwave {
 class MmWaveNetDevice;
 class MmWaveUePhy;
 class MmWaveEnbMac;
+class MmWaveUeNetDevice;
+class McUeNetDevice;
 
 class MmWaveEnbPhy : public MmWavePhy
 {
@@ -158,17 +163,49 @@ public:
 
   double AddGaussianNoise (double sample);
 
-  std::pair <uint64_t,uint64_t> ApplyFilter (std::vector<double>);
+  /**
+  * Assign a fixed random variable stream number to the random variables
+  * used by this model.  Return the number of streams (possibly zero) that
+  * have been assigned.
+  *
+  * \param stream first stream index to use
+  * \return the number of stream indices assigned by this model
+  */
+  int64_t AssignStreams (int64_t stream);
 
-  double MakeAvg (std::vector<double>);
 
-  double MakeVar (std::vector<double>, double);
 
-  std::vector<double> MakeFilter (std::vector<double>, std::vector<double>, std::pair <uint64_t, uint64_t > );
+private:
+  /**
+   * A UE device registered with AddUePhy, with the objects needed to check
+   * its RNTI and its target eNB without casts
+   */
+  struct UeDeviceInfo
+  {
+    Ptr<NetDevice> m_device; //!< the UE device
+    Ptr<MmWaveUeNetDevice> m_ueDevice; //!< the device, if it is a mmWave UE
+    Ptr<McUeNetDevice> m_mcUeDevice; //!< the device, if it is a multi-connectivity UE
+    Ptr<MmWaveUePhy> m_uePhy; //!< the mmWave PHY of the UE
+  };
 
+  /**
+   * Check whether a UE device has an RNTI and is associated to this eNB
+   * \param info the UE device
+   * \param rnti the RNTI
+   * \return true if the device is the UE with the RNTI in this cell
+   */
+  bool IsAssociatedUe (const UeDeviceInfo &info, uint16_t rnti) const;
 
+  /**
+   * Find the device of the UE which has an RNTI in this cell. The result is
+   * kept in an index, which is checked in O(1) at the next call, and the
+   * UE devices are scanned only when the RNTI is new or has moved to
+   * another device, e.g., after a handover.
+   * \param rnti the RNTI
+   * \return the UE device, or 0 if no UE associated to this eNB has the RNTI
+   */
+  Ptr<NetDevice> GetUeDevice (uint16_t rnti);
 
-private:
   bool AddUePhy (uint16_t rnti);
   // LteEnbCphySapProvider forwarded methods
   void DoSetBandwidth (uint8_t ulBandwidth, uint8_t dlBandwidth);
@@ -204,7 +241,8 @@ private:
 
   TtiAllocInfo::TddMode m_prevTtiDir;      //!< Previous TTI TDD mode; 0->Unspecified, 1->DL, 2->UL
 
-  std::vector< Ptr<NetDevice> > m_deviceMap;
+  std::vector<UeDeviceInfo> m_deviceMap; //!< the UE devices registered with AddUePhy
+  std::unordered_map<uint16_t, uint32_t> m_rntiDeviceIndex; //!< index of the device of each RNTI in m_deviceMap
 
   MmWaveEnbPhySapUser* m_phySapUser;
 
@@ -215,13 +253,11 @@ private:
   std::map <uint64_t, Ptr<NetDevice> > m_ueAttachedImsiMap;
   std::map <uint64_t, double > m_sinrMap;
   std::map <uint64_t, Ptr<SpectrumValue> > m_rxPsdMap;
-  std::map <pairDevices_t, std::vector<double> > m_sinrVector;        // array containing all SINR values for a specific pair (UE-eNB)
-  std::map <pairDevices_t, std::vector<double> > m_sinrVectorToFilter;        // array containing the  SINR values that must be filtered
-  std::map <pairDevices_t, std::vector<double> > m_sinrVectorNoisy;        // array containing the  noisy SINR values that must be filteredF
-  std::map <pairDevices_t, std::vector<double> > m_finalSinrVector;        // array containing all  SINR values after the filtering for a specific pair (UE-eNB)
-  std::map <pairDevices_t, std::pair <uint64_t,uint64_t> > m_samplesFilter;       // array containing all noisy SINR values for a specific pair (UE-eNB)
+  std::map <pairDevices_t, MmWaveSinrFilter> m_sinrFilters;        // filter of the noisy SINR samples for a specific pair (UE-eNB)
+  Ptr<NormalRandomVariable> m_sinrNoise;       // generator of the noise added to the SINR samples
 
   int m_updateSinrPeriod;       // the period of SINR update for eNBs
+  uint32_t m_updateSinrThreads;       // the number of threads used to compute the rx PSDs of the SINR update, 0 to compute them one at a time
   double m_ueUpdateSinrPeriod;       // the period of SINR reporting to the UEs
   double m_updateSinrCollect;       // the period of SINR collection, for a pair (UE-eNB)
   uint16_t m_roundFromLastUeSinrUpdate;       // the ratio between the two above
@@ -0,0 +1,1667 @@
+/*
+ * mmwave-flex-tti-policy-mac-scheduler.cc
+ *
+ *  Created on: Jan 11, 2015
+ *      Author: sourjya
+ */
+
+#include <ns3/log.h>
+#include <ns3/abort.h>
+#include "mmwave-flex-tti-policy-mac-scheduler.h"
+#include <ns3/lte-common.h>
+#include <ns3/boolean.h>
+#include <ns3/uinteger.h>
+#include <stdlib.h>     /* abs */
+#include "mmwave-mac-pdu-header.h"
+#include "mmwave-mac-pdu-tag.h"
+#include "mmwave-spectrum-value-helper.h"
+#include <cmath>
+#include <algorithm>
+#include <ns3/eps-bearer.h>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveFlexTtiPolicyMacScheduler");
+
+namespace mmwave {
+
+template <class Policy>
+class MmWaveFlexTtiPolicyMacCschedSapProvider : public MmWaveMacCschedSapProvider
+{
+public:
+  MmWaveFlexTtiPolicyMacCschedSapProvider (MmWaveFlexTtiPolicyMacScheduler<Policy>* scheduler)
+    : m_scheduler (scheduler)
+  {
+  }
+
+  // inherited from MmWaveMacCschedSapProvider
+  virtual void CschedCellConfigReq (const struct MmWaveMacCschedSapProvider::CschedCellConfigReqParameters& params)
+  {
+    m_scheduler->DoCschedCellConfigReq (params);
+  }
+
+  virtual void CschedUeConfigReq (const struct MmWaveMacCschedSapProvider::CschedUeConfigReqParameters& params)
+  {
+    m_scheduler->DoCschedUeConfigReq (params);
+  }
+
+  virtual void CschedLcConfigReq (const struct MmWaveMacCschedSapProvider::CschedLcConfigReqParameters& params)
+  {
+    m_scheduler->DoCschedLcConfigReq (params);
+  }
+
+  virtual void CschedLcReleaseReq (const struct MmWaveMacCschedSapProvider::CschedLcReleaseReqParameters& params)
+  {
+    m_scheduler->DoCschedLcReleaseReq (params);
+  }
+
+  virtual void CschedUeReleaseReq (const struct MmWaveMacCschedSapProvider::CschedUeReleaseReqParameters& params)
+  {
+    m_scheduler->DoCschedUeReleaseReq (params);
+  }
+
+private:
+  MmWaveFlexTtiPolicyMacCschedSapProvider ();
+  MmWaveFlexTtiPolicyMacScheduler<Policy>* m_scheduler;
+};
+
+template <class Policy>
+class MmWaveFlexTtiPolicyMacSchedSapProvider : public MmWaveMacSchedSapProvider
+{
+public:
+  MmWaveFlexTtiPolicyMacSchedSapProvider (MmWaveFlexTtiPolicyMacScheduler<Policy>* sched)
+    : m_scheduler (sched)
+  {
+  }
+
+  virtual void SchedDlRlcBufferReq (const struct MmWaveMacSchedSapProvider::SchedDlRlcBufferReqParameters& params)
+  {
+    m_scheduler->DoSchedDlRlcBufferReq (params);
+  }
+
+  virtual void SchedTriggerReq (const struct MmWaveMacSchedSapProvider::SchedTriggerReqParameters& params)
+  {
+    m_scheduler->DoSchedTriggerReq (params);
+  }
+
+  virtual void SchedDlCqiInfoReq (const struct MmWaveMacSchedSapProvider::SchedDlCqiInfoReqParameters& params)
+  {
+    m_scheduler->DoSchedDlCqiInfoReq (params);
+  }
+
+  virtual void SchedUlCqiInfoReq (const struct MmWaveMacSchedSapProvider::SchedUlCqiInfoReqParameters& params)
+  {
+    m_scheduler->DoSchedUlCqiInfoReq (params);
+  }
+
+  virtual void SchedUlMacCtrlInfoReq (const struct MmWaveMacSchedSapProvider::SchedUlMacCtrlInfoReqParameters& params)
+  {
+    m_scheduler->DoSchedUlMacCtrlInfoReq (params);
+  }
+
+  virtual void SchedSetMcs (int mcs)
+  {
+    m_scheduler->DoSchedSetMcs (mcs);
+  }
+
+private:
+  MmWaveFlexTtiPolicyMacSchedSapProvider ();
+  MmWaveFlexTtiPolicyMacScheduler<Policy>* m_scheduler;
+};
+
+template <class Policy>
+const unsigned MmWaveFlexTtiPolicyMacScheduler<Policy>::m_macHdrSize = 0;
+template <class Policy>
+const unsigned MmWaveFlexTtiPolicyMacScheduler<Policy>::m_subHdrSize = 4;
+template <class Policy>
+const unsigned MmWaveFlexTtiPolicyMacScheduler<Policy>::m_rlcHdrSize = 3;
+template <class Policy>
+const uint32_t MmWaveFlexTtiPolicyMacScheduler<Policy>::NO_UE_INDEX;
+
+
+template <class Policy>
+MmWaveFlexTtiPolicyMacScheduler<Policy>::MmWaveFlexTtiPolicyMacScheduler ()
+  : m_nextRnti (0),
+    m_tbUid (0),
+    m_macSchedSapUser (0),
+    m_macCschedSapUser (0),
+    m_timeWindow (99.0)
+{
+  NS_LOG_FUNCTION (this);
+  m_macSchedSapProvider = new MmWaveFlexTtiPolicyMacSchedSapProvider<Policy> (this);
+  m_macCschedSapProvider = new MmWaveFlexTtiPolicyMacCschedSapProvider<Policy> (this);
+}
+
+template <class Policy>
+MmWaveFlexTtiPolicyMacScheduler<Policy>::~MmWaveFlexTtiPolicyMacScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+template <class Policy>
+void
+MmWaveFlexTtiPolicyMacScheduler<Policy>::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_ueTable.clear ();
+  m_rntiToUeIndex.clear ();
+  m_dlHarqInfoList.clear ();
+  delete m_macCschedSapProvider;
+  delete m_macSchedSapProvider;
+}
+
+template <class Policy>
+TypeId
+MmWaveFlexTtiPolicyMacScheduler<Policy>::AddSchedulerAttributes (TypeId tid)
+{
+  tid
+    .AddAttribute ("CqiTimerThreshold",
+                   "The number of TTIs a CQI is valid (default 1000 - 1 sec.)",
+                   UintegerValue (100),
+                   MakeUintegerAccessor (&MmWaveFlexTtiPolicyMacScheduler<Policy>::m_cqiTimersThreshold),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("HarqEnabled",
+                   "Activate/Deactivate the HARQ [by default is active].",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&MmWaveFlexTtiPolicyMacScheduler<Policy>::m_harqOn),
+                   MakeBooleanChecker ())
+    .AddAttribute ("FixedMcsDl",
+                   "Fix MCS to value set in McsDlDefault",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&MmWaveFlexTtiPolicyMacScheduler<Policy>::m_fixedMcsDl),
+                   MakeBooleanChecker ())
+    .AddAttribute ("McsDefaultDl",
+                   "Fixed DL MCS",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&MmWaveFlexTtiPolicyMacScheduler<Policy>::m_mcsDefaultDl),
+                   MakeUintegerChecker<uint8_t> ())
+    .AddAttribute ("FixedMcsUl",
+                   "Fix MCS to value set in McsUlDefault (for testing)",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&MmWaveFlexTtiPolicyMacScheduler<Policy>::m_fixedMcsUl),
+                   MakeBooleanChecker ())
+    .AddAttribute ("McsDefaultUl",
+                   "Fixed UL MCS (for testing)",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&MmWaveFlexTtiPolicyMacScheduler<Policy>::m_mcsDefaultUl),
+                   MakeUintegerChecker<uint8_t> ())
+    .AddAttribute ("DlSchedOnly",
+                   "Only schedule downlink traffic (for testing)",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&MmWaveFlexTtiPolicyMacScheduler<Policy>::m_dlOnly),
+                   MakeBooleanChecker ())
+    .AddAttribute ("UlSchedOnly",
+                   "Only schedule uplink traffic (for testing)",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&MmWaveFlexTtiPolicyMacScheduler<Policy>::m_ulOnly),
+                   MakeBooleanChecker ())
+    .AddAttribute ("FixedTti",
+                   "Fix slot size",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&MmWaveFlexTtiPolicyMacScheduler<Policy>::m_fixedTti),
+                   MakeBooleanChecker ())
+    .AddAttribute ("SymPerSlot",
+                   "Number of symbols per slot in Fixed TTI mode",
+                   UintegerValue (6),
+                   MakeUintegerAccessor (&MmWaveFlexTtiPolicyMacScheduler<Policy>::m_symPerSlot),
+                   MakeUintegerChecker<uint8_t> ())
+  ;
+
+  return tid;
+}
+
+template <class Policy>
+void
+MmWaveFlexTtiPolicyMacScheduler<Policy>::SetMacSchedSapUser (MmWaveMacSchedSapUser* sap)
+{
+  m_macSchedSapUser = sap;
+}
+
+template <class Policy>
+void
+MmWaveFlexTtiPolicyMacScheduler<Policy>::SetMacCschedSapUser (MmWaveMacCschedSapUser* sap)
+{
+  m_macCschedSapUser = sap;
+}
+
+
+template <class Policy>
+MmWaveMacSchedSapProvider*
+MmWaveFlexTtiPolicyMacScheduler<Policy>::GetMacSchedSapProvider ()
+{
+  return m_macSchedSapProvider;
+}
+
+template <class Policy>
+MmWaveMacCschedSapProvider*
+MmWaveFlexTtiPolicyMacScheduler<Policy>::GetMacCschedSapProvider ()
+{
+  return m_macCschedSapProvider;
+}
+
+template <class Policy>
+typename MmWaveFlexTtiPolicyMacScheduler<Policy>::UeSchedInfo*
+MmWaveFlexTtiPolicyMacScheduler<Policy>::GetUeSchedInfo (uint16_t rnti)
+{
+  if (rnti >= m_rntiToUeIndex.size () || m_rntiToUeIndex[rnti] == NO_UE_INDEX)
+    {
+      return 0;
+    }
+  return &m_ueTable[m_rntiToUeIndex[rnti]];
+}
+
+template <class Policy>
+void
+MmWaveFlexTtiPolicyMacScheduler<Policy>::AddToAllocList (UeSchedInfo* ueInfo)
+{
+  if (!ueInfo->m_allocated)
+    {
+      ueInfo->m_allocated = true;
+      m_ueAllocList.push_back (ueInfo);
+    }
+}
+
+template <class Policy>
+void
+MmWaveFlexTtiPolicyMacScheduler<Policy>::ConfigureCommonParameters (Ptr<MmWavePhyMacCommon> config)
+{
+  m_phyMacConfig = config;
+  m_amc = CreateObject <MmWaveAmc> (m_phyMacConfig);
+  m_numHarqProcess = m_phyMacConfig->GetNumHarqProcess ();
+  m_harqTimeout = m_phyMacConfig->GetHarqTimeout ();
+  m_numDataSymbols = m_phyMacConfig->GetSymbPerSlot () -
+    m_phyMacConfig->GetDlCtrlSymbols () - m_phyMacConfig->GetUlCtrlSymbols ();
+
+  for (unsigned i = 0; i < m_phyMacConfig->GetUlSchedDelay (); i++)
+    {
+      m_ulSfAllocInfo.push_back (SlotAllocInfo (SfnSf (0, i, 0)));
+    }
+}
+
+template <class Policy>
+void
+MmWaveFlexTtiPolicyMacScheduler<Policy>::DoSchedDlRlcBufferReq (const struct MmWaveMacSchedSapProvider::SchedDlRlcBufferReqParameters& params)
+{
+  NS_LOG_FUNCTION (this << params.m_rnti << (uint32_t) params.m_logicalChannelIdentity);
+  UeSchedInfo* ueInfo = GetUeSchedInfo (params.m_rnti);
+  if (ueInfo == 0)
+    {
+      NS_LOG_ERROR ("UE entry not found in sched info map");
+    }
+  else
+    {
+      uint8_t lcid = params.m_logicalChannelIdentity;
+      if ((unsigned)lcid >= ueInfo->m_flowStatsDl.size ())
+        {
+          NS_LOG_ERROR ("LC not registered");
+        }
+      else
+        {
+          if (params.m_txPacketSizes.size () > 0)
+            {
+              ueInfo->m_flowStatsDl[lcid].m_txPacketSizes.clear ();
+              ueInfo->m_flowStatsDl[lcid].m_txPacketDelays.clear ();
+              // add the new DL PDCP packet sizes and their delays
+              uint32_t totalSize = 0;
+              double maxDelay = 0.0;
+              std::list<uint32_t>::const_iterator itSize = params.m_txPacketSizes.begin ();
+              std::list<double>::const_iterator itDelay = params.m_txPacketDelays.begin ();
+              while (itSize != params.m_txPacketSizes.end () && itDelay != params.m_txPacketDelays.end ())
+                {
+                  totalSize += *itSize;
+                  if (totalSize > ueInfo->m_flowStatsDl[lcid].m_totalSchedSize)
+                    {
+//                                      uint32_t diff = totalSize - ueInfo->m_flowStatsDl[lcid].m_totalSchedSize;
+//                                      if (diff > *itSize)
+//                                      {
+//                                              ueInfo->m_flowStatsDl[lcid].m_txPacketSizes.push_back (*itSize);
+//                                              ueInfo->m_flowStatsDl[lcid].m_totalBufSize += *itSize;
+//                                      }
+//                                      else
+//                                      {
+//                                              ueInfo->m_flowStatsDl[lcid].m_txPacketSizes.push_back (diff);
+//                                              ueInfo->m_flowStatsDl[lcid].m_totalBufSize += diff;
+//                                      }
+                      ueInfo->m_flowStatsDl[lcid].m_totalBufSize = params.m_rlcTransmissionQueueSize;
+                      ueInfo->m_flowStatsDl[lcid].m_txPacketSizes.push_back (*itSize);
+                      ueInfo->m_flowStatsDl[lcid].m_txPacketDelays.push_back (*itDelay);
+                      if (*itDelay > maxDelay)
+                        {
+                          maxDelay = *itDelay;
+                        }
+                    }
+                  itSize++;
+                  itDelay++;
+                }
+              ueInfo->m_flowStatsDl[lcid].m_txQueueHolDelay = maxDelay;
+            }
+          else if (params.m_rlcTransmissionQueueSize > 0)        // case for RlcSm
+            {
+              ueInfo->m_flowStatsDl[lcid].m_totalBufSize = params.m_rlcTransmissionQueueSize;
+            }
+        }
+    }
+}
+
+
+template <class Policy>
+void
+MmWaveFlexTtiPolicyMacScheduler<Policy>::DoSchedUlMacCtrlInfoReq (const struct MmWaveMacSchedSapProvider::SchedUlMacCtrlInfoReqParameters& params)
+{
+  NS_LOG_FUNCTION (this);
+
+  for (unsigned int i = 0; i < params.m_macCeList.size (); i++)
+    {
+      if ( params.m_macCeList.at (i).m_macCeType == MacCeElement::BSR )
+        {
+          // buffer status report
+          // note that this scheduler does not differentiate the
+          // allocation according to which LCGs have more/less bytes
+          // to send.
+          // Hence the BSR of different LCGs are just summed up to get
+          // a total queue size that is used for allocation purposes.
+          uint16_t rnti = params.m_macCeList.at (i).m_rnti;
+          UeSchedInfo* ueInfo = GetUeSchedInfo (rnti);
+
+          uint32_t buffer = 0;
+          for (uint8_t lcg = 1; lcg <= 3; ++lcg)
+            {
+              uint8_t bsrId = params.m_macCeList.at (i).m_macCeValue.m_bufferStatus.at (lcg - 1);
+              uint32_t bufSize = BsrId2BufferSize (bsrId);
+              if (bufSize > 0)
+                {
+                  buffer += bufSize;
+
+                  if (ueInfo == 0)
+                    {
+                      NS_LOG_ERROR ("UE entry not found in sched info map");
+                    }
+                  else
+                    {
+                      int diff = bufSize - (ueInfo->m_flowStatsUl[lcg].m_totalBufSize + ueInfo->m_flowStatsUl[lcg].m_totalSchedSize);
+                      if (diff > 0)
+                        {                               // estimate additional packet sizes
+                          ueInfo->m_flowStatsUl[lcg].m_totalBufSize += diff;
+                          ueInfo->m_flowStatsUl[lcg].m_txPacketSizes.push_back (diff);
+                          // since we expect the BSR to be generated following a packet arrival and sent at least by the end of the prev. subframe,
+                          // the maximum delay is one SF (in microseconds)
+                          ueInfo->m_flowStatsUl[lcg].m_txPacketDelays.push_back (m_phyMacConfig->GetSlotPeriod ().GetMicroSeconds());
+                          if (ueInfo->m_flowStatsUl[lcg].m_txQueueHolDelay == 0)
+                            {
+                              ueInfo->m_flowStatsUl[lcg].m_txQueueHolDelay = m_phyMacConfig->GetSlotPeriod ().GetMicroSeconds();
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+  return;
+}
+
+template <class Policy>
+void
+MmWaveFlexTtiPolicyMacScheduler<Policy>::DoSchedDlCqiInfoReq (const struct MmWaveMacSchedSapProvider::SchedDlCqiInfoReqParameters& params)
+{
+  NS_LOG_FUNCTION (this);
+
+  for (unsigned int i = 0; i < params.m_cqiList.size (); i++)
+    {
+      if ( params.m_cqiList.at (i).m_cqiType == DlCqiInfo::WB )
+        {
+          // wideband CQI reporting
+          uint16_t rnti = params.m_cqiList.at (i).m_rnti;
+          UeSchedInfo* ueInfo = GetUeSchedInfo (rnti);
+          if (ueInfo == 0)
+            {
+              NS_LOG_INFO (this << " DL-CQI of UE " << rnti << " which is not configured, ignore it");
+              continue;
+            }
+          // update the CQI value (only codeword 0 at this stage (SISO))
+          ueInfo->m_wbCqiValid = true;
+          ueInfo->m_wbCqi = params.m_cqiList.at (i).m_wbCqi;
+          // update correspondent timer
+          ueInfo->m_wbCqiTimer = m_cqiTimersThreshold;
+        }
+      else if ( params.m_cqiList.at (i).m_cqiType == DlCqiInfo::SB )
+        {
+          // subband CQI reporting high layer configured
+          // Not used by RR Scheduler
+        }
+      else
+        {
+          NS_LOG_ERROR (this << " CQI type unknown");
+        }
+    }
+}
+
+
+template <class Policy>
+void
+MmWaveFlexTtiPolicyMacScheduler<Policy>::DoSchedUlCqiInfoReq (const struct MmWaveMacSchedSapProvider::SchedUlCqiInfoReqParameters& params)
+{
+  NS_LOG_FUNCTION (this);
+
+  uint16_t frameNum = params.m_sfnSf.m_frameNum;
+  uint8_t subframeNum =  params.m_sfnSf.m_sfNum;
+  uint8_t slotNum = params.m_sfnSf.m_slotNum;
+  uint8_t symNum =  params.m_sfnSf.m_symStart;
+
+  switch (params.m_ulCqi.m_type)
+    {
+    case UlCqiInfo::PUSCH:
+      {
+        typename std::map <uint32_t, struct AllocMapElem>::iterator itMap;
+        itMap = m_ulAllocationMap.find (params.m_sfnSf.Encode ());
+        if (itMap == m_ulAllocationMap.end ())
+          {
+            NS_LOG_INFO (this << " Does not find info on allocation, size : " << m_ulAllocationMap.size ());
+            return;
+          }
+        NS_ASSERT_MSG (itMap->second.m_rntiPerChunk.size () == m_phyMacConfig->GetNumChunks (), "SINR chunk map must cover full BW in TDMA mode");
+        for (unsigned i = 0; i < itMap->second.m_rntiPerChunk.size (); i++)
+          {
+            // convert from fixed point notation Sxxxxxxxxxxx.xxx to double
+            //double sinr = LteFfConverter::fpS11dot3toDouble (params.m_ulCqi.m_sinr.at (i));
+            UeSchedInfo* ueInfo = GetUeSchedInfo (itMap->second.m_rntiPerChunk.at (i));
+            if (ueInfo == 0)
+              {
+                NS_LOG_INFO (this << " UL-CQI of UE " << itMap->second.m_rntiPerChunk.at (i) << " which is not configured, ignore it");
+                continue;
+              }
+            if (!ueInfo->m_ulCqiValid)
+              {
+                // create a new entry, initialized with NO_SINR value
+                ueInfo->m_ulCqiValid = true;
+                ueInfo->m_ulCqi.m_ueUlCqi.assign (m_phyMacConfig->GetNumChunks (), 30.0);
+              }
+            // update the value
+            ueInfo->m_ulCqi.m_ueUlCqi.at (i) = params.m_ulCqi.m_sinr.at (i);
+            ueInfo->m_ulCqi.m_numSym = itMap->second.m_numSym;
+            ueInfo->m_ulCqi.m_tbSize = itMap->second.m_tbSize;
+            // update correspondent timer
+            ueInfo->m_ulCqiTimer = m_cqiTimersThreshold;
+
+            NS_LOG_INFO ("UL CQI report for RNTI " << itMap->second.m_rntiPerChunk.at (i) << " chunk " << i << " SINR " << params.m_ulCqi.m_sinr.at (i) << \
+                         " frame " << frameNum << " subframe " << (unsigned)subframeNum << " slot " << (unsigned)slotNum << " startSym " << (unsigned)symNum);
+          }
+        // remove obsolete info on allocation
+        m_ulAllocationMap.erase (itMap);
+      }
+      break;
+    default:
+      NS_FATAL_ERROR ("Unknown type of UL-CQI");
+    }
+  return;
+}
+
+template <class Policy>
+void
+MmWaveFlexTtiPolicyMacScheduler<Policy>::DoSchedSetMcs (int mcs)
+{
+  if (mcs >= 0 && mcs <= 28)
+    {
+      m_mcsDefaultDl = mcs;
+      m_mcsDefaultUl = mcs;
+    }
+}
+
+template <class Policy>
+void
+MmWaveFlexTtiPolicyMacScheduler<Policy>::RefreshHarqProcesses ()
+{
+  NS_LOG_FUNCTION (this);
+
+  for (UeSchedInfo &ueInfo : m_ueTable)
+    {
+      for (uint16_t i = 0; i < m_phyMacConfig->GetNumHarqProcess (); i++)
+        {
+          if (ueInfo.m_dlHarqProcessesTimer[i] == m_phyMacConfig->GetHarqTimeout ())
+            {             // reset HARQ process
+              NS_LOG_INFO (this << " Reset HARQ proc " << i << " for RNTI " << ueInfo.m_rnti);
+              ueInfo.m_dlHarqProcessesStatus[i] = 0;
+              ueInfo.m_dlHarqProcessesTimer[i] = 0;
+            }
+          else
+            {
+              ueInfo.m_dlHarqProcessesTimer[i]++;
+            }
+
+          if (ueInfo.m_ulHarqProcessesTimer[i] == m_phyMacConfig->GetHarqTimeout ())
+            {             // reset HARQ process
+              NS_LOG_INFO (this << " Reset HARQ proc " << i << " for RNTI " << ueInfo.m_rnti);
+              ueInfo.m_ulHarqProcessesStatus[i] = 0;
+              ueInfo.m_ulHarqProcessesTimer[i] = 0;
+            }
+          else
+            {
+              ueInfo.m_ulHarqProcessesTimer[i]++;
+            }
+        }
+    }
+}
+
+template <class Policy>
+uint8_t
+MmWaveFlexTtiPolicyMacScheduler<Policy>::UpdateDlHarqProcessId (uint16_t rnti)
+{
+  NS_LOG_FUNCTION (this << rnti);
+
+
+  if (m_harqOn == false)
+    {
+      uint8_t tbUid = m_tbUid;
+      m_tbUid = (m_tbUid + 1) % m_phyMacConfig->GetNumHarqProcess ();
+      return tbUid;
+    }
+
+//	std::map <uint16_t, uint8_t>::iterator it = m_dlHarqCurrentProcessId.find (rnti);
+//	if (it == m_dlHarqCurrentProcessId.end ())
+//	{
+//		NS_FATAL_ERROR ("No Process Id found for this RNTI " << rnti);
+//	}
+  UeSchedInfo* ueInfo = GetUeSchedInfo (rnti);
+  if (ueInfo == 0)
+    {
+      NS_FATAL_ERROR ("No Process Id Statusfound for this RNTI " << rnti);
+    }
+
+  // search for available process ID, if none available return numHarqProcess
+  uint8_t harqId = m_phyMacConfig->GetNumHarqProcess ();
+  for (unsigned i = 0; i < m_phyMacConfig->GetNumHarqProcess (); i++)
+    {
+      if (ueInfo->m_dlHarqProcessesStatus[i] == 0)
+        {
+          ueInfo->m_dlHarqProcessesStatus[i] = 1;
+          harqId = i;
+          break;
+        }
+    }
+  return harqId;
+
+//	uint8_t i = (*it).second;
+//	do
+//	{
+//		i = (i + 1) % m_phyMacConfig->GetNumHarqProcess ();
+//	}
+//	while ( ((*itStat).second.at (i) != 0)&&(i != (*it).second));
+//	if ((*itStat).second.at (i) == 0)
+//	{
+//		(*it).second = i;
+//		(*itStat).second.at (i) = 1;
+//	}
+//	else
+//	{
+//		return (m_phyMacConfig->GetNumHarqProcess () + 1); // return a not valid harq proc id
+//	}
+//
+//	return ((*it).second);
+}
+
+template <class Policy>
+uint8_t
+MmWaveFlexTtiPolicyMacScheduler<Policy>::UpdateUlHarqProcessId (uint16_t rnti)
+{
+  NS_LOG_FUNCTION (this << rnti);
+
+  if (m_harqOn == false)
+    {
+      uint8_t tbUid = m_tbUid;
+      m_tbUid = (m_tbUid + 1) % m_phyMacConfig->GetNumHarqProcess ();
+      return tbUid;
+    }
+
+//	std::map <uint16_t, uint8_t>::iterator it = m_ulHarqCurrentProcessId.find (rnti);
+//	if (it == m_ulHarqCurrentProcessId.end ())
+//	{
+//		NS_FATAL_ERROR ("No Process Id found for this RNTI " << rnti);
+//	}
+  UeSchedInfo* ueInfo = GetUeSchedInfo (rnti);
+  if (ueInfo == 0)
+    {
+      NS_FATAL_ERROR ("No Process Id Statusfound for this RNTI " << rnti);
+    }
+
+  // search for available process ID, if none available return numHarqProcess+1
+  uint8_t harqId = m_phyMacConfig->GetNumHarqProcess ();
+  for (unsigned i = 0; i < m_phyMacConfig->GetNumHarqProcess (); i++)
+    {
+      if (ueInfo->m_ulHarqProcessesStatus[i] == 0)
+        {
+          ueInfo->m_ulHarqProcessesStatus[i] = 1;
+          harqId = i;
+          break;
+        }
+    }
+  return harqId;
+//	uint8_t i = (*it).second;
+//	do
+//	{
+//		i = (i + 1) % m_phyMacConfig->GetNumHarqProcess ();
+//	}
+//	while ( ((*itStat).second.at (i) != 0)&&(i != (*it).second));
+//	if ((*itStat).second.at (i) == 0)
+//	{
+//		(*it).second = i;
+//		(*itStat).second.at (i) = 1;
+//	}
+//	else
+//	{
+//		return (m_phyMacConfig->GetNumHarqProcess () + 1); // return a not valid harq proc id
+//	}
+//	return ((*it).second);
+}
+
+template <class Policy>
+unsigned
+MmWaveFlexTtiPolicyMacScheduler<Policy>::CalcMinTbSizeNumSym (unsigned mcs, unsigned bufSize, unsigned &tbSize)
+{
+  // Bisection line search is used to find the minimum number of slots (OFDM symbols)
+  // needed to encode entire buffer.
+  MmWaveMacPduHeader dummyMacHeader;
+  //unsigned macHdrSize = 10; //dummyMacHeader.GetSerializedSize ();
+  int numSymLow = 0;
+  int numSymHigh = m_phyMacConfig->GetSymbPerSlot();
+
+  int diff = 0;
+  tbSize = (m_amc->GetTbSizeFromMcsSymbols (mcs, numSymHigh) / 8); // start with max value, in number of bytes
+  while ((unsigned)tbSize > bufSize)
+  {
+      diff = abs(numSymHigh-numSymLow)/2;
+      if (diff == 0)
+      {
+          tbSize = (m_amc->GetTbSizeFromMcsSymbols (mcs, numSymHigh) / 8);
+          return numSymHigh;
+      }
+      tbSize = (m_amc->GetTbSizeFromMcsSymbols (mcs, numSymHigh - diff) / 8);
+      if ((unsigned)tbSize >= bufSize)
+      {
+          numSymHigh -= diff;
+      }
+      if ((unsigned) tbSize == bufSize)
+      {
+          return numSymHigh;
+      }
+      while ((unsigned)tbSize < bufSize)
+      {
+          diff = abs(numSymHigh-numSymLow)/2;
+          if (diff == 0)
+          {
+              tbSize = (m_amc->GetTbSizeFromMcsSymbols (mcs, numSymHigh) / 8);
+              return numSymHigh;
+          }
+          tbSize = (m_amc->GetTbSizeFromMcsSymbols (mcs, numSymLow + diff) / 8);
+          if ((unsigned)tbSize <= bufSize)
+          {
+              numSymLow += diff;
+          }
+          if ((unsigned) tbSize == bufSize)
+          {
+              return numSymLow;
+          }
+      }
+  }
+  tbSize = (m_amc->GetTbSizeFromMcsSymbols (mcs, numSymHigh) / 8);
+  return (unsigned)numSymHigh;
+}
+
+template <class Policy>
+void
+MmWaveFlexTtiPolicyMacScheduler<Policy>::DoSchedTriggerReq (const struct MmWaveMacSchedSapProvider::SchedTriggerReqParameters& params)
+{
+  uint16_t frameNum = params.m_snfSf.m_frameNum;
+  uint8_t sfNum = params.m_snfSf.m_sfNum;
+  uint8_t slotNum = params.m_snfSf.m_slotNum;
+
+  MmWaveMacSchedSapUser::SchedConfigIndParameters ret;
+  ret.m_sfnSf = params.m_snfSf;
+  ret.m_slotAllocInfo.m_sfnSf = ret.m_sfnSf;
+
+  NS_LOG_DEBUG ("Creating scheduling allocation info for: frame " << frameNum << " subframe " 
+                << (unsigned)sfNum << " slot " << (unsigned)slotNum);
+
+  // Add TTI for DL control at the beginning of the slot
+  TtiAllocInfo dlCtrlSlot (0, TtiAllocInfo::DL_slotAllocInfo, TtiAllocInfo::CTRL, 0);
+  dlCtrlSlot.m_dci.m_numSym = 1;
+  dlCtrlSlot.m_dci.m_symStart = 0;
+  ret.m_slotAllocInfo.m_ttiAllocInfo.push_back (dlCtrlSlot);
+  int resvCtrl = m_phyMacConfig->GetDlCtrlSymbols () + m_phyMacConfig->GetUlCtrlSymbols ();
+  int symAvail = m_phyMacConfig->GetSymbPerSlot () - resvCtrl;
+  uint8_t ttiIdx = 1;
+  uint8_t symIdx = m_phyMacConfig->GetDlCtrlSymbols ();      // symbols reserved for control at beginning of subframe
+
+  // process received CQIs
+  RefreshDlCqiMaps ();
+  RefreshUlCqiMaps ();
+
+  // Process DL HARQ feedback
+  RefreshHarqProcesses ();
+
+  //m_rlcBufferReq.sort (SortRlcBufferReq);     // sort list by RNTI
+  // number of DL/UL flows for new transmissions (not HARQ RETX)
+  // UEs allocated in this slot are collected in m_ueAllocList
+  NS_ASSERT (m_ueAllocList.empty ());
+
+  // retrieve past HARQ retx buffered
+  if (m_dlHarqInfoList.size () > 0 && params.m_dlHarqInfoList.size () > 0)
+    {
+      m_dlHarqInfoList.insert (m_dlHarqInfoList.end (), params.m_dlHarqInfoList.begin (), params.m_dlHarqInfoList.end ());
+    }
+  else if (params.m_dlHarqInfoList.size () > 0)
+    {
+      m_dlHarqInfoList = params.m_dlHarqInfoList;
+    }
+  if (m_ulHarqInfoList.size () > 0 && params.m_ulHarqInfoList.size () > 0)
+    {
+      m_ulHarqInfoList.insert (m_ulHarqInfoList.end (), params.m_ulHarqInfoList.begin (), params.m_ulHarqInfoList.end ());
+    }
+  else if (params.m_ulHarqInfoList.size () > 0)
+    {
+      m_ulHarqInfoList = params.m_ulHarqInfoList;
+    }
+
+  if (m_harqOn == false)                // Ignore HARQ feedback
+    {
+      m_dlHarqInfoList.clear ();
+    }
+  else
+    {
+      // Process DL HARQ feedback and assign slots for RETX if resources available
+      std::vector <struct DlHarqInfo> dlInfoListUntxed;            // TBs not able to be retransmitted in this sf
+      std::vector <struct UlHarqInfo> ulInfoListUntxed;
+
+      for (unsigned i = 0; i < m_dlHarqInfoList.size (); i++)
+        {
+          if (symAvail == 0)
+            {
+              break;                    // no symbols left to allocate
+            }
+          uint8_t harqId = m_dlHarqInfoList.at (i).m_harqProcessId;
+          uint16_t rnti = m_dlHarqInfoList.at (i).m_rnti;
+          UeSchedInfo* ueInfo = GetUeSchedInfo (rnti);
+          if (ueInfo == 0)
+            {
+              NS_LOG_INFO ("No info found in HARQ buffer for UE (might have changed eNB) " << rnti);
+              continue;
+            }
+          DlHarqProcessesStatus_t &harqStatus = ueInfo->m_dlHarqProcessesStatus;
+          DlHarqRlcPduList_t &harqRlcPdu = ueInfo->m_dlHarqProcessesRlcPdu;
+          if (m_dlHarqInfoList.at (i).m_harqStatus == DlHarqInfo::ACK || harqStatus.at (harqId) == 0)
+            {             // acknowledgment or process timeout, reset process
+              //NS_LOG_DEBUG ("UE" << rnti << " DL harqId " << (unsigned)harqId << " HARQ-ACK received");
+              harqStatus.at (harqId) = 0;                      // release process ID
+              harqRlcPdu.at (harqId).clear ();                 // clear RLC buffers
+              continue;
+            }
+          else if (m_dlHarqInfoList.at (i).m_harqStatus == DlHarqInfo::NACK)
+            {
+              DciInfoElementTdma dciInfoReTx = ueInfo->m_dlHarqProcessesDciInfo.at (harqId);
+              //NS_LOG_DEBUG ("UE" << rnti << " DL harqId " << (unsigned)harqId << " HARQ-NACK received, rv " << (unsigned)dciInfoReTx.m_rv);
+              NS_ASSERT (harqId == dciInfoReTx.m_harqProcess);
+              //NS_ASSERT(itStat->second.at (harqId) > 0);
+              NS_ASSERT (harqStatus.at (harqId) - 1 == dciInfoReTx.m_rv);
+              if (dciInfoReTx.m_rv == 3)                   // maximum number of retx reached -> drop process
+                {
+                  NS_LOG_INFO ("Max number of retransmissions reached -> drop process");
+                  harqStatus.at (harqId) = 0;
+                  harqRlcPdu.at (harqId).clear ();
+                  continue;
+                }
+              // allocate retx if enough symbols are available
+              if (symAvail >= dciInfoReTx.m_numSym)
+                {
+                  symAvail -= dciInfoReTx.m_numSym;
+                  dciInfoReTx.m_symStart = symIdx;
+                  symIdx += dciInfoReTx.m_numSym;
+                  NS_ASSERT (symIdx <= m_phyMacConfig->GetSymbPerSlot () - m_phyMacConfig->GetUlCtrlSymbols ());
+                  dciInfoReTx.m_rv++;
+                  dciInfoReTx.m_ndi = 0;
+                  ueInfo->m_dlHarqProcessesDciInfo.at (harqId) = dciInfoReTx;
+                  harqStatus.at (harqId) = harqStatus.at (harqId) + 1;
+                  TtiAllocInfo ttiInfo (ttiIdx++, TtiAllocInfo::DL_slotAllocInfo, TtiAllocInfo::CTRL_DATA, rnti);
+                  ttiInfo.m_dci = dciInfoReTx;
+                  NS_LOG_DEBUG ("UE" << dciInfoReTx.m_rnti << " gets DL slots " << (unsigned)dciInfoReTx.m_symStart << "-" << (unsigned)(dciInfoReTx.m_symStart + dciInfoReTx.m_numSym - 1) <<
+                                " tbs " << dciInfoReTx.m_tbSize << " harqId " << (unsigned)dciInfoReTx.m_harqProcess << " harqId " << (unsigned)dciInfoReTx.m_harqProcess <<
+                                " rv " << (unsigned)dciInfoReTx.m_rv << " in frame " << ret.m_sfnSf.m_frameNum << " subframe " << (unsigned)ret.m_sfnSf.m_sfNum << " RETX");
+                  for (uint16_t k = 0; k < harqRlcPdu.at (dciInfoReTx.m_harqProcess).size (); k++)
+                    {
+                      ttiInfo.m_rlcPduInfo.push_back (harqRlcPdu.at (dciInfoReTx.m_harqProcess).at (k));
+                    }
+                  ret.m_slotAllocInfo.m_ttiAllocInfo.push_back (ttiInfo);
+                  ret.m_slotAllocInfo.m_numSymAlloc += dciInfoReTx.m_numSym;
+
+                  ueInfo->m_dlSymbolsRetx = dciInfoReTx.m_numSym;
+                  AddToAllocList (ueInfo);
+                }
+              else
+                {
+                  NS_LOG_INFO ("No resource for this retx -> buffer it");
+                  dlInfoListUntxed.push_back (m_dlHarqInfoList.at (i));
+                }
+            }
+        }
+
+      m_dlHarqInfoList.clear ();
+      m_dlHarqInfoList = dlInfoListUntxed;
+
+      // Process UL HARQ feedback
+      for (uint16_t i = 0; i < m_ulHarqInfoList.size (); i++)
+        {
+          if (symAvail == 0)
+            {
+              break;                    // no symbols left to allocate
+            }
+          UlHarqInfo harqInfo = m_ulHarqInfoList.at (i);
+          uint8_t harqId = harqInfo.m_harqProcessId;
+          uint16_t rnti = harqInfo.m_rnti;
+          UeSchedInfo* ueInfo = GetUeSchedInfo (rnti);
+          if (ueInfo == 0)
+            {
+              NS_LOG_INFO ("No info found in HARQ buffer for UE (might have changed eNB) " << rnti);
+              continue;
+            }
+          UlHarqProcessesStatus_t &harqStatus = ueInfo->m_ulHarqProcessesStatus;
+          if (harqInfo.m_receptionStatus == UlHarqInfo::Ok || harqStatus.at (harqId) == 0)
+            {
+              //NS_LOG_DEBUG ("UE" << rnti << " UL harqId " << (unsigned)harqInfo.m_harqProcessId << " HARQ-ACK received");
+              harqStatus.at (harqId) = 0;                        // release process ID
+            }
+          else if (harqInfo.m_receptionStatus == UlHarqInfo::NotOk)
+            {
+              // retx correspondent block: retrieve the UL-DCI
+              DciInfoElementTdma dciInfoReTx = ueInfo->m_ulHarqProcessesDciInfo.at (harqId);
+              //NS_LOG_DEBUG ("UE" << rnti << " UL harqId " << (unsigned)harqInfo.m_harqProcessId << " HARQ-NACK received, rv " << (unsigned)dciInfoReTx.m_rv);
+              NS_ASSERT (harqId == dciInfoReTx.m_harqProcess);
+              NS_ASSERT (harqStatus.at (harqId) > 0);
+              NS_ASSERT (harqStatus.at (harqId) - 1 == dciInfoReTx.m_rv);
+              if (dciInfoReTx.m_rv == 3)
+                {
+                  NS_LOG_INFO ("Max number of retransmissions reached (UL)-> drop process");
+                  harqStatus.at (harqId) = 0;
+                  continue;
+                }
+
+              if (symAvail >= dciInfoReTx.m_numSym)
+                {
+                  symAvail -= dciInfoReTx.m_numSym;
+                  dciInfoReTx.m_symStart = symIdx;
+                  symIdx += dciInfoReTx.m_numSym;
+                  NS_ASSERT (symIdx <= m_phyMacConfig->GetSymbPerSlot () - m_phyMacConfig->GetUlCtrlSymbols ());
+                  dciInfoReTx.m_rv++;
+                  dciInfoReTx.m_ndi = 0;
+                  harqStatus.at (harqId) = harqStatus.at (harqId) + 1;
+                  ueInfo->m_ulHarqProcessesDciInfo.at (harqId) = dciInfoReTx;
+                  TtiAllocInfo ttiInfo (ttiIdx++, TtiAllocInfo::UL_slotAllocInfo, TtiAllocInfo::CTRL_DATA, rnti);
+                  ttiInfo.m_dci = dciInfoReTx;
+                  NS_LOG_DEBUG ("UE" << dciInfoReTx.m_rnti << " gets DL OFDM symbols " << (unsigned)dciInfoReTx.m_symStart << "-" << (unsigned)(dciInfoReTx.m_symStart + dciInfoReTx.m_numSym - 1) <<
+                                " tbs " << dciInfoReTx.m_tbSize << " harqId " << (unsigned)dciInfoReTx.m_harqProcess << " harqId " << (unsigned)dciInfoReTx.m_harqProcess <<
+                                " rv " << (unsigned)dciInfoReTx.m_rv << " in frame " << ret.m_sfnSf.m_frameNum << " subframe " << (unsigned)ret.m_sfnSf.m_sfNum << " slot " <<
+                                (unsigned)ret.m_sfnSf.m_slotNum << " RETX");
+                                
+                  ret.m_slotAllocInfo.m_ttiAllocInfo.push_back (ttiInfo);
+                  ret.m_slotAllocInfo.m_numSymAlloc += dciInfoReTx.m_numSym;
+
+                  ueInfo->m_ulSymbolsRetx = dciInfoReTx.m_numSym;
+                  AddToAllocList (ueInfo);
+                }
+              else
+                {
+                  ulInfoListUntxed.push_back (m_ulHarqInfoList.at (i));
+                }
+            }
+        }
+
+      m_ulHarqInfoList.clear ();
+      m_ulHarqInfoList = ulInfoListUntxed;
+    }
+
+  // no further allocations
+  if (symAvail == 0)
+    {
+      // add slot for UL control
+      TtiAllocInfo ulCtrlSlot (0xFF, TtiAllocInfo::UL_slotAllocInfo, TtiAllocInfo::CTRL, 0);
+      ulCtrlSlot.m_dci.m_numSym = 1;
+      ulCtrlSlot.m_dci.m_symStart = m_phyMacConfig->GetSymbPerSlot () - 1;
+      //ret.m_ulSfAllocInfo.m_ttiAllocInfo.push_back (ulCtrlSlot);
+      ret.m_slotAllocInfo.m_ttiAllocInfo.push_back (ulCtrlSlot);
+      //m_ulSfAllocInfo.push_back (ret.m_ulSfAllocInfo); // add UL SF info for later calls to scheduler
+      m_macSchedSapUser->SchedConfigInd (ret);
+
+      // reset the alloc info for the next scheduler call
+      for (UeSchedInfo* ueInfo : m_ueAllocList)
+        {
+          ueInfo->m_dlSymbolsRetx = 0;
+          ueInfo->m_ulSymbolsRetx = 0;
+          ueInfo->m_allocated = false;
+        }
+      m_ueAllocList.clear ();
+      return;
+    }
+
+  // ********************* END OF HARQ SECTION, START OF NEW DATA SCHEDULING ********************* //
+
+  // compute achievable rates in current subframe
+  unsigned hdrOverhead = Policy::m_addHdrOverhead ? m_subHdrSize + m_rlcHdrSize : 0;
+  for (UeSchedInfo &ue : m_ueTable)
+    {
+      UeSchedInfo* ueInfo = &ue;
+      ueInfo->m_maxMcs = 0;
+
+      // get DL-CQI and compute DL rate per symbol
+      bool dlAdded = false;
+      uint8_t cqi = 0;
+      if (ueInfo->m_wbCqiValid)
+        {
+          cqi = ueInfo->m_wbCqi;
+        }
+      else           // no CQI available
+        {
+          NS_LOG_INFO (this << " UE " << ueInfo->m_rnti << " does not have DL-CQI");
+          cqi = 1;               // lowest value for trying a transmission
+        }
+      if (cqi != 0)
+        {
+          ueInfo->m_dlMcs = m_amc->GetMcsFromCqi (cqi);                // update MCS
+          ueInfo->m_maxMcs = ueInfo->m_dlMcs;
+          // compute total DL and UL bytes buffered
+          for (unsigned iflow = 0; iflow < ueInfo->m_flowStatsDl.size (); iflow++)
+            {
+              if (ueInfo->m_flowStatsDl[iflow].m_totalBufSize > 0)
+                {
+                  ueInfo->m_totBufDl += ueInfo->m_flowStatsDl[iflow].m_totalBufSize;
+                  RlcPduInfo newRlcEl;
+                  newRlcEl.m_lcid = ueInfo->m_flowStatsDl[iflow].m_lcid;
+                  newRlcEl.m_size = ueInfo->m_flowStatsDl[iflow].m_totalBufSize + hdrOverhead;
+                  ueInfo->m_rlcPduInfo.push_back (newRlcEl);
+                }
+            }
+          if (ueInfo->m_totBufDl > 0)
+            {
+              uint32_t tbSizeMax = m_amc->GetTbSizeFromMcsSymbols (ueInfo->m_dlMcs, 1);
+              ueInfo->m_currTputDl = std::min (ueInfo->m_totBufDl,tbSizeMax) / (m_phyMacConfig->GetSlotPeriod ().GetSeconds());
+              AddToAllocList (ueInfo);
+
+              dlAdded = true;
+            }
+        }
+
+      // get UL-CQI and compute UL rate per symbol
+      bool ulAdded = false;
+      int mcs = 0;
+      if (ueInfo->m_ulCqiValid)
+        {
+          // translate vector of doubles to SpectrumValue's
+          SpectrumValue specVals (MmWaveSpectrumValueHelper::GetSpectrumModel (m_phyMacConfig));
+          Values::iterator specIt = specVals.ValuesBegin ();
+          for (uint32_t ichunk = 0; ichunk < m_phyMacConfig->GetNumChunks (); ichunk++)
+            {
+              NS_ASSERT (specIt != specVals.ValuesEnd ());
+              *specIt = ueInfo->m_ulCqi.m_ueUlCqi.at (ichunk);                   //sinrLin;
+              specIt++;
+            }
+          // for UL CQI, we need to know the TB size previously allocated to accurately compute CQI/MCS
+          cqi = m_amc->CreateCqiFeedbackWbTdma (specVals, ueInfo->m_ulCqi.m_numSym, ueInfo->m_ulCqi.m_tbSize, mcs);
+        }
+      else
+        {
+          NS_LOG_INFO (this << " UE " << ueInfo->m_rnti << " does not have UL-CQI");
+          cqi = 1;
+          mcs = 0;
+        }
+      if (cqi != 0)
+        {
+          ueInfo->m_ulMcs = mcs;
+          ueInfo->m_maxMcs = std::max (ueInfo->m_maxMcs, ueInfo->m_ulMcs);
+          for (unsigned iflow = 0; iflow < ueInfo->m_flowStatsUl.size (); iflow++)
+            {
+              ueInfo->m_totBufUl += ueInfo->m_flowStatsUl[iflow].m_totalBufSize + hdrOverhead;
+            }
+          if (ueInfo->m_totBufUl > 0)
+            {
+              uint32_t tbSizeMax = m_amc->GetTbSizeFromMcsSymbols (ueInfo->m_ulMcs, 1);
+              ueInfo->m_currTputUl = std::min (ueInfo->m_totBufUl,tbSizeMax) / (m_phyMacConfig->GetSlotPeriod ().GetSeconds());
+              AddToAllocList (ueInfo);
+              ulAdded = true;
+            }
+        }
+
+      // rank the UE once both its DL and UL rates are known
+      if (dlAdded || ulAdded)
+        {
+          m_ueRank.push_back (UeRankEntry (Policy::GetMetric (*ueInfo), ueInfo));
+        }
+    }
+
+  // allocate each symbol to the backlogged UE with the highest metric, then
+  // update the metric of that UE. The backlogged UEs are kept in a binary
+  // heap, so that only the UE that got the symbol has to be ranked again.
+  std::make_heap (m_ueRank.begin (), m_ueRank.end (), CompareUeRank);
+  while (symAvail > 0 && !m_ueRank.empty ())
+    {
+      std::pop_heap (m_ueRank.begin (), m_ueRank.end (), CompareUeRank);
+      UeSchedInfo* ueInfo = m_ueRank.back ().m_ueSchedInfo;
+      m_ueRank.pop_back ();
+
+      if (ueInfo->m_totBufDl == 0)
+        {
+          ueInfo->m_dlAllocDone = true;
+        }
+      if (ueInfo->m_totBufUl == 0)
+        {
+          ueInfo->m_ulAllocDone = true;
+        }
+
+      // evenly distribute symbols between DL and UL flows of same UE
+      if ((ueInfo->m_allocUlLast || ueInfo->m_dlAllocDone) && !ueInfo->m_ulAllocDone)
+        {
+          ueInfo->m_ulSymbols++;
+          symAvail--;
+          ueInfo->m_ulTbSize = m_amc->GetTbSizeFromMcsSymbols (ueInfo->m_ulMcs, ueInfo->m_ulSymbols) / 8;
+          if (ueInfo->m_ulTbSize >= ueInfo->m_totBufUl)
+            {
+              ueInfo->m_ulAllocDone = true;
+              ueInfo->m_lastAvgTputUl = ueInfo->m_avgTputUl;
+            }
+          ueInfo->m_allocUlLast = true;
+
+          uint32_t tbSize = m_amc->GetTbSizeFromMcsSymbols (ueInfo->m_ulMcs, ueInfo->m_ulSymbols);
+          ueInfo->m_currTputUl = std::min (ueInfo->m_totBufUl,tbSize) / (m_phyMacConfig->GetSlotPeriod ().GetSeconds());
+          ueInfo->m_avgTputUl = ((1.0 - (1.0 / m_timeWindow)) * ueInfo->m_lastAvgTputUl) +
+            ((1.0 / m_timeWindow) * ((double)ueInfo->m_ulTbSize / (m_phyMacConfig->GetSlotPeriod ().GetSeconds())));
+        }
+      else if (!ueInfo->m_dlAllocDone)
+        {
+          ueInfo->m_dlSymbols++;
+          symAvail--;
+          ueInfo->m_dlTbSize = m_amc->GetTbSizeFromMcsSymbols (ueInfo->m_dlMcs, ueInfo->m_dlSymbols) / 8;
+          if (ueInfo->m_dlTbSize >= ueInfo->m_totBufDl)
+            {
+              ueInfo->m_dlAllocDone = true;
+              ueInfo->m_lastAvgTputDl = ueInfo->m_avgTputDl;
+            }
+          ueInfo->m_allocUlLast = false;
+
+          uint32_t tbSize = m_amc->GetTbSizeFromMcsSymbols (ueInfo->m_dlMcs, ueInfo->m_dlSymbols);
+          ueInfo->m_currTputDl = std::min (ueInfo->m_totBufDl,tbSize) / (m_phyMacConfig->GetSlotPeriod ().GetSeconds());
+          ueInfo->m_avgTputDl = ((1.0 - (1.0 / m_timeWindow)) * ueInfo->m_lastAvgTputDl) +
+            ((1.0 / m_timeWindow) * ((double)ueInfo->m_dlTbSize / (m_phyMacConfig->GetSlotPeriod ().GetSeconds())));
+        }
+
+      if (!ueInfo->m_dlAllocDone || !ueInfo->m_ulAllocDone)
+        {
+          m_ueRank.push_back (UeRankEntry (Policy::GetMetric (*ueInfo), ueInfo));
+          std::push_heap (m_ueRank.begin (), m_ueRank.end (), CompareUeRank);
+        }
+    }
+  m_ueRank.clear ();
+
+  // no further allocations
+  if (m_ueAllocList.empty ())
+    {
+      // add slot for UL control
+      TtiAllocInfo ulCtrlSlot (0xFF, TtiAllocInfo::UL_slotAllocInfo, TtiAllocInfo::CTRL, 0);
+      ulCtrlSlot.m_dci.m_numSym = 1;
+      ulCtrlSlot.m_dci.m_symStart = m_phyMacConfig->GetSymbPerSlot () - 1;
+      //ret.m_ulSfAllocInfo.m_ttiAllocInfo.push_back (ulCtrlSlot);
+      ret.m_slotAllocInfo.m_ttiAllocInfo.push_back (ulCtrlSlot);
+      //m_ulSfAllocInfo.push_back (ret.m_ulSfAllocInfo); // add UL SF info for later calls to scheduler
+      m_macSchedSapUser->SchedConfigInd (ret);
+      return;
+    }
+
+//	itUeAllocMap = ueAllocMap.find (10);
+//	if (itUeAllocMap != ueAllocMap.end())
+//	{
+//		std::cout << frameNum << " " << sfNum << " " << itUeAllocMap->second->m_rlcPduInfo.size () << std::endl;
+//	}
+
+  // iterate through the allocated UEs, in RNTI order, assign TDMA symbol indices and create DCIs
+  std::sort (m_ueAllocList.begin (), m_ueAllocList.end (), CompareUeRnti);
+  //unsigned numSymAllocPrev = ret.m_dlSfAllocInfo.m_numSymAlloc; // allocated in prev sched request
+  for (UeSchedInfo* ueInfo : m_ueAllocList)
+    {
+      if (ueInfo->m_dlSymbols > 0)
+        {
+          DciInfoElementTdma dci;
+          dci.m_rnti = ueInfo->m_rnti;
+          dci.m_format = 0;
+          dci.m_symStart = symIdx;
+          dci.m_numSym = ueInfo->m_dlSymbols;
+          symIdx += ueInfo->m_dlSymbols;
+          NS_ASSERT (symIdx <= m_phyMacConfig->GetSymbPerSlot () - m_phyMacConfig->GetUlCtrlSymbols ());
+          dci.m_mcs = ueInfo->m_dlMcs;
+          dci.m_rv = 0;
+          dci.m_ndi = 1;
+          dci.m_tbSize = m_amc->GetTbSizeFromMcsSymbols (dci.m_mcs, dci.m_numSym) / 8;
+          dci.m_harqProcess = UpdateDlHarqProcessId (ueInfo->m_rnti);
+          NS_ASSERT (dci.m_harqProcess < m_phyMacConfig->GetNumHarqProcess ());
+          //NS_LOG_DEBUG ("UE" << ueInfo->m_rnti << " DL harqId " << (unsigned)dci.m_harqProcess << " HARQ process assigned");
+          TtiAllocInfo ttiInfo (ttiIdx++, TtiAllocInfo::DL_slotAllocInfo, TtiAllocInfo::CTRL_DATA, ueInfo->m_rnti);
+          ttiInfo.m_dci = dci;
+          NS_LOG_DEBUG ("UE" << dci.m_rnti << " gets DL symbols " << (unsigned)dci.m_symStart << "-" << (unsigned)(dci.m_symStart + dci.m_numSym - 1) <<
+                        " tbs " << dci.m_tbSize << " mcs " << (unsigned)dci.m_mcs << " harqId " << (unsigned)dci.m_harqProcess << " rv " << (unsigned)dci.m_rv << " in frame " << ret.m_sfnSf.m_frameNum << " subframe " << (unsigned)ret.m_sfnSf.m_sfNum);
+
+          if (m_harqOn == true)
+            {                   // store DCI for HARQ buffer
+              ueInfo->m_dlHarqProcessesDciInfo.at (dci.m_harqProcess) = dci;
+              // refresh timer
+              ueInfo->m_dlHarqProcessesTimer.at (dci.m_harqProcess) = 0;
+            }
+
+          // distribute bytes between active RLC queues
+          unsigned numLc = ueInfo->m_rlcPduInfo.size ();
+          unsigned bytesRem = dci.m_tbSize;
+          unsigned numFulfilled = 0;
+          uint16_t avgPduSize = bytesRem / numLc;
+          // first for loop computes extra to add to average if some flows are less than average
+          for (unsigned i = 0; i < ueInfo->m_rlcPduInfo.size (); i++)
+            {
+              if (ueInfo->m_rlcPduInfo[i].m_size < avgPduSize)
+                {
+                  bytesRem -= ueInfo->m_rlcPduInfo[i].m_size;
+                  numFulfilled++;
+                }
+            }
+
+          if (numFulfilled < ueInfo->m_rlcPduInfo.size ())
+            {
+              avgPduSize = bytesRem / (ueInfo->m_rlcPduInfo.size () - numFulfilled);
+            }
+
+          for (unsigned i = 0; i < ueInfo->m_rlcPduInfo.size (); i++)
+            {
+              if (ueInfo->m_rlcPduInfo[i].m_size > avgPduSize)
+                {
+                  ueInfo->m_rlcPduInfo[i].m_size = avgPduSize;
+                }
+              // else tbSize equals RLC queue size
+              NS_ASSERT (ueInfo->m_rlcPduInfo[i].m_size > 0);
+              /*for (itRlcBuf = m_rlcBufferReq.begin (); itRlcBuf != m_rlcBufferReq.end (); itRlcBuf++)
+                                              {
+                                                      if(itRlcBuf->m_rnti == itUeInfo->first)
+                                                      {
+                                                              if(itRlcBuf->m_rlcTransmissionQueueSize == 0)
+                                                              {
+                                                                      NS_FATAL_ERROR ("LC is scheduled but RLC buffer == 0");
+                                                              }
+                                                      }
+                                              }*/
+              // update RLC buffer info with expected queue size after scheduling
+              UpdateDlRlcBufferInfo (ueInfo->m_rnti, ueInfo->m_rlcPduInfo[i].m_lcid, ueInfo->m_rlcPduInfo[i].m_size - m_subHdrSize);
+              ttiInfo.m_rlcPduInfo.push_back (ueInfo->m_rlcPduInfo[i]);
+              if (m_harqOn == true)
+                {
+                  // store RLC PDU list for HARQ
+                  ueInfo->m_dlHarqProcessesRlcPdu.at (dci.m_harqProcess).push_back (ueInfo->m_rlcPduInfo[i]);
+                }
+            }
+
+          for (unsigned i = 0; i < ueInfo->m_rlcPduInfo.size (); i++)
+            {
+              // update RLC buffer info with expected queue size after scheduling
+              ttiInfo.m_rlcPduInfo.push_back (ueInfo->m_rlcPduInfo[i]);
+              if (m_harqOn == true)
+                {
+                  // store RLC PDU list for HARQ
+                  ueInfo->m_dlHarqProcessesRlcPdu.at (dci.m_harqProcess).push_back (ueInfo->m_rlcPduInfo[i]);
+                }
+            }
+
+          if (m_harqOn == true)
+            {
+              // reorder/reindex slots to maintain DL before UL slot order
+              bool reordered = false;
+              std::deque <TtiAllocInfo>::iterator itTti = ret.m_slotAllocInfo.m_ttiAllocInfo.begin ();
+              for (unsigned iTti = 0; iTti < ret.m_slotAllocInfo.m_ttiAllocInfo.size (); iTti++)
+                {
+                  if (ret.m_slotAllocInfo.m_ttiAllocInfo [iTti].m_tddMode == TtiAllocInfo::UL_slotAllocInfo)
+                    {
+                      ttiInfo.m_ttiIdx = ret.m_slotAllocInfo.m_ttiAllocInfo [iTti].m_ttiIdx;
+                      ttiInfo.m_dci.m_symStart = ret.m_slotAllocInfo.m_ttiAllocInfo [iTti].m_dci.m_symStart;
+                      ret.m_slotAllocInfo.m_ttiAllocInfo.insert (itTti, ttiInfo);
+                      for (unsigned jTti = iTti + 1; jTti < ret.m_slotAllocInfo.m_ttiAllocInfo.size (); jTti++)
+                        {
+                          ret.m_slotAllocInfo.m_ttiAllocInfo[jTti].m_ttiIdx++;                                 // increase indices of UL slots
+                          ret.m_slotAllocInfo.m_ttiAllocInfo[jTti].m_dci.m_symStart =
+                            ret.m_slotAllocInfo.m_ttiAllocInfo[jTti - 1].m_dci.m_symStart +
+                            ret.m_slotAllocInfo.m_ttiAllocInfo[jTti - 1].m_dci.m_numSym;
+                        }
+                      reordered = true;
+                      break;
+                    }
+                  itTti++;
+                }
+              if (!reordered)
+                {
+                  ret.m_slotAllocInfo.m_ttiAllocInfo.push_back (ttiInfo);
+                }
+            }
+          else
+            {
+              ret.m_slotAllocInfo.m_ttiAllocInfo.push_back (ttiInfo);
+            }
+          ret.m_slotAllocInfo.m_numSymAlloc += dci.m_numSym;
+        }
+    }
+  ttiIdx = ret.m_slotAllocInfo.m_ttiAllocInfo.back ().m_ttiIdx + 1;
+  symIdx = ret.m_slotAllocInfo.m_ttiAllocInfo.back ().m_dci.m_symStart + ret.m_slotAllocInfo.m_ttiAllocInfo.back ().m_dci.m_numSym;
+
+  for (UeSchedInfo* ueInfo : m_ueAllocList)
+    {
+      // Note: UL-DCI applies to subframe i+Tsched
+      if (ueInfo->m_ulSymbols > 0)
+        {
+          DciInfoElementTdma dci;
+          dci.m_rnti = ueInfo->m_rnti;
+          dci.m_format = 1;
+          dci.m_symStart = symIdx;
+          dci.m_numSym = ueInfo->m_ulSymbols;
+          symIdx += ueInfo->m_ulSymbols;
+          NS_ASSERT (symIdx <= m_phyMacConfig->GetSymbPerSlot () - m_phyMacConfig->GetUlCtrlSymbols ());
+          dci.m_mcs = ueInfo->m_ulMcs;
+          dci.m_ndi = 1;
+          dci.m_tbSize = m_amc->GetTbSizeFromMcsSymbols (dci.m_mcs, dci.m_numSym) / 8;
+          dci.m_harqProcess = UpdateUlHarqProcessId (ueInfo->m_rnti);
+          //NS_LOG_DEBUG ("UE" << ueInfo->m_rnti << " UL harqId " << (unsigned)dci.m_harqProcess << " HARQ process assigned");
+          NS_ASSERT (dci.m_harqProcess < m_phyMacConfig->GetNumHarqProcess ());
+          TtiAllocInfo ttiInfo (ttiIdx++, TtiAllocInfo::UL_slotAllocInfo, TtiAllocInfo::CTRL_DATA, ueInfo->m_rnti);
+          ttiInfo.m_dci = dci;
+          NS_LOG_DEBUG ("UE" << dci.m_rnti << " gets UL symbols " << (unsigned)dci.m_symStart << "-" << (unsigned)(dci.m_symStart + dci.m_numSym - 1) <<
+                        " tbs " << dci.m_tbSize << " mcs " << (unsigned)dci.m_mcs << " harqId " << (unsigned)dci.m_harqProcess << " rv " << (unsigned)dci.m_rv << " in frame " << ret.m_sfnSf.m_frameNum << " subframe " << (unsigned)ret.m_sfnSf.m_sfNum);
+          //UpdateUlRlcBufferInfo (ueInfo->m_rnti, dci.m_tbSize - m_subHdrSize);
+          ret.m_slotAllocInfo.m_ttiAllocInfo.push_back (ttiInfo);
+          ret.m_slotAllocInfo.m_numSymAlloc += dci.m_numSym;
+          std::vector<uint16_t> ueChunkMap;
+          for (uint32_t i = 0; i < m_phyMacConfig->GetNumChunks (); i++)
+            {
+              ueChunkMap.push_back (dci.m_rnti);
+            }
+          //SfnSf slotSfn = ret.m_ulSfAllocInfo.m_sfnSf;
+          SfnSf slotSfn = ret.m_slotAllocInfo.m_sfnSf;
+          slotSfn.m_slotNum = dci.m_symStart;                // use the start symbol index of the slot because the absolute UL slot index depends on the future DL allocation
+          // insert into allocation map to recall previous allocations upon receiving UL-CQI
+          m_ulAllocationMap.insert ( std::pair<uint32_t, struct AllocMapElem> (slotSfn.Encode (), AllocMapElem (ueChunkMap, dci.m_numSym, dci.m_tbSize)) );
+
+          if (m_harqOn == true)
+            {
+              uint8_t harqId = dci.m_harqProcess;
+              ueInfo->m_ulHarqProcessesDciInfo.at (harqId) = dci;
+              // Update HARQ process status (RV 0)
+              NS_ASSERT (ueInfo->m_ulHarqProcessesStatus[dci.m_harqProcess] > 0);
+              // refresh timer
+              ueInfo->m_ulHarqProcessesTimer.at (dci.m_harqProcess) = 0;
+            }
+        }
+    }
+
+  // reset the alloc info for the next scheduler call
+  for (UeSchedInfo* ueInfo : m_ueAllocList)
+    {
+      ueInfo->m_dlSymbols = 0;
+      ueInfo->m_ulSymbols = 0;
+      ueInfo->m_dlTbSize = 0;
+      ueInfo->m_ulTbSize = 0;
+      ueInfo->m_dlSymbolsRetx = 0;
+      ueInfo->m_ulSymbolsRetx = 0;
+      ueInfo->m_currTputDl = 0;
+      ueInfo->m_currTputUl = 0;
+      ueInfo->m_avgTputDl = 0;
+      ueInfo->m_avgTputUl = 0;
+      ueInfo->m_totBufDl = 0;
+      ueInfo->m_totBufUl = 0;
+      ueInfo->m_dlAllocDone = false;
+      ueInfo->m_ulAllocDone = false;
+      ueInfo->m_rlcPduInfo.clear ();
+      ueInfo->m_allocated = false;
+    }
+  m_ueAllocList.clear ();
+
+  // add slot for UL control
+  TtiAllocInfo ulCtrlSlot (0xFF, TtiAllocInfo::UL_slotAllocInfo, TtiAllocInfo::CTRL, 0);
+  ulCtrlSlot.m_dci.m_numSym = 1;
+  ulCtrlSlot.m_dci.m_symStart = m_phyMacConfig->GetSymbPerSlot () - 1;
+  //ret.m_ulSfAllocInfo.m_ttiAllocInfo.push_back (ulCtrlSlot);
+  ret.m_slotAllocInfo.m_ttiAllocInfo.push_back (ulCtrlSlot);
+
+  //m_ulSfAllocInfo.push_back (ret.m_ulSfAllocInfo); // add UL SF info for later calls to scheduler
+
+  m_macSchedSapUser->SchedConfigInd (ret);
+  return;
+}
+
+template <class Policy>
+bool
+MmWaveFlexTtiPolicyMacScheduler<Policy>::SortRlcBufferReq (MmWaveMacSchedSapProvider::SchedDlRlcBufferReqParameters i, MmWaveMacSchedSapProvider::SchedDlRlcBufferReqParameters j)
+{
+  return (i.m_rnti < j.m_rnti);
+}
+
+
+template <class Policy>
+void
+MmWaveFlexTtiPolicyMacScheduler<Policy>::RefreshDlCqiMaps (void)
+{
+  NS_LOG_FUNCTION (this);
+  // refresh DL CQI P01 Map
+  for (UeSchedInfo &ueInfo : m_ueTable)
+    {
+      if (!ueInfo.m_wbCqiValid)
+        {
+          continue;
+        }
+      NS_LOG_INFO (this << " P10-CQI for user " << ueInfo.m_rnti << " is " << ueInfo.m_wbCqiTimer << " thr " << (uint32_t)m_cqiTimersThreshold);
+      if (ueInfo.m_wbCqiTimer == 0)
+        {
+          // delete correspondent entries
+          NS_LOG_INFO (this << " P10-CQI exired for user " << ueInfo.m_rnti);
+          ueInfo.m_wbCqiValid = false;
+        }
+      else
+        {
+          ueInfo.m_wbCqiTimer--;
+        }
+    }
+
+  return;
+}
+
+
+template <class Policy>
+void
+MmWaveFlexTtiPolicyMacScheduler<Policy>::RefreshUlCqiMaps (void)
+{
+  // refresh UL CQI  Map
+  for (UeSchedInfo &ueInfo : m_ueTable)
+    {
+      if (!ueInfo.m_ulCqiValid)
+        {
+          continue;
+        }
+      NS_LOG_INFO (this << " UL-CQI for user " << ueInfo.m_rnti << " is " << ueInfo.m_ulCqiTimer << " thr " << (uint32_t)m_cqiTimersThreshold);
+      if (ueInfo.m_ulCqiTimer == 0)
+        {
+          // delete correspondent entries
+          NS_LOG_INFO (this << " UL-CQI expired for user " << ueInfo.m_rnti);
+          ueInfo.m_ulCqi.m_ueUlCqi.clear ();
+          ueInfo.m_ulCqiValid = false;
+        }
+      else
+        {
+          ueInfo.m_ulCqiTimer--;
+        }
+    }
+
+  return;
+}
+
+template <class Policy>
+void
+MmWaveFlexTtiPolicyMacScheduler<Policy>::UpdateDlRlcBufferInfo (uint16_t rnti, uint8_t lcid, uint16_t size)
+{
+  NS_LOG_FUNCTION (this);
+  std::list<MmWaveMacSchedSapProvider::SchedDlRlcBufferReqParameters>::iterator it;
+  for (it = m_rlcBufferReq.begin (); it != m_rlcBufferReq.end (); it++)
+    {
+      if (((*it).m_rnti == rnti) && ((*it).m_logicalChannelIdentity == lcid))
+        {
+          NS_LOG_INFO (this << " UE " << rnti << " LC " << (uint16_t)lcid << " txqueue " << (*it).m_rlcTransmissionQueueSize << " retxqueue " << (*it).m_rlcRetransmissionQueueSize << " status " << (*it).m_rlcStatusPduSize << " decrease " << size);
+          // Update queues: RLC tx order Status, ReTx, Tx
+          // Update status queue
+          if (((*it).m_rlcStatusPduSize > 0) && (size >= (*it).m_rlcStatusPduSize))
+            {
+              (*it).m_rlcStatusPduSize = 0;
+            }
+          else if (((*it).m_rlcRetransmissionQueueSize > 0) && (size >= (*it).m_rlcRetransmissionQueueSize))
+            {
+              (*it).m_rlcRetransmissionQueueSize = 0;
+            }
+          else if ((*it).m_rlcTransmissionQueueSize > 0)
+            {
+              uint32_t rlcOverhead;
+              if (lcid == 1)
+                {
+                  // for SRB1 (using RLC AM) it's better to
+                  // overestimate RLC overhead rather than
+                  // underestimate it and risk unneeded
+                  // segmentation which increases delay
+                  rlcOverhead = 4;
+                }
+              else
+                {
+                  // minimum RLC overhead due to header
+                  rlcOverhead = 2;
+                }
+              // update transmission queue
+              if ((*it).m_rlcTransmissionQueueSize <= size - rlcOverhead)
+                {
+                  (*it).m_rlcTransmissionQueueSize = 0;
+                }
+              else
+                {
+                  (*it).m_rlcTransmissionQueueSize -= size - rlcOverhead;
+                }
+            }
+          return;
+        }
+    }
+}
+
+template <class Policy>
+void
+MmWaveFlexTtiPolicyMacScheduler<Policy>::UpdateUlRlcBufferInfo (uint16_t rnti, uint16_t size)
+{
+
+  size = size - 2; // remove the minimum RLC overhead
+  UeSchedInfo* ueInfo = GetUeSchedInfo (rnti);
+  if (ueInfo != 0)
+    {
+      NS_LOG_INFO (this << " Update RLC BSR UE " << rnti << " size " << size << " BSR " << ueInfo->m_ceBsrRxed);
+      if (ueInfo->m_ceBsrRxed >= size)
+        {
+          ueInfo->m_ceBsrRxed -= size;
+        }
+      else
+        {
+          ueInfo->m_ceBsrRxed = 0;
+        }
+    }
+  else
+    {
+      NS_LOG_ERROR (this << " Does not find BSR report info of UE " << rnti);
+    }
+
+}
+
+
+template <class Policy>
+void
+MmWaveFlexTtiPolicyMacScheduler<Policy>::DoCschedCellConfigReq (const struct MmWaveMacCschedSapProvider::CschedCellConfigReqParameters& params)
+{
+  NS_LOG_FUNCTION (this);
+  // Read the subset of parameters used
+  m_cschedCellConfig = params;
+  //m_rachAllocationMap.resize (m_cschedCellConfig.m_ulBandwidth, 0);
+  MmWaveMacCschedSapUser::CschedUeConfigCnfParameters cnf;
+  cnf.m_result = SUCCESS;
+  m_macCschedSapUser->CschedUeConfigCnf (cnf);
+  return;
+}
+
+template <class Policy>
+void
+MmWaveFlexTtiPolicyMacScheduler<Policy>::DoCschedUeConfigReq (const struct MmWaveMacCschedSapProvider::CschedUeConfigReqParameters& params)
+{
+  NS_LOG_FUNCTION (this << " RNTI " << params.m_rnti << " txMode " << (uint16_t)params.m_transmissionMode);
+
+  if (GetUeSchedInfo (params.m_rnti) != 0)
+    {
+      return;
+    }
+
+  // assign the next UE index
+  if (params.m_rnti >= m_rntiToUeIndex.size ())
+    {
+      m_rntiToUeIndex.resize (params.m_rnti + 1, NO_UE_INDEX);
+    }
+  m_rntiToUeIndex[params.m_rnti] = m_ueTable.size ();
+  m_ueTable.push_back (UeSchedInfo (params.m_rnti));
+  UeSchedInfo &ueInfo = m_ueTable.back ();
+  for (unsigned i = 0; i <= 3; i++)
+    {
+      ueInfo.m_flowStatsDl.push_back (FlowStats (false, params.m_rnti, i));
+      ueInfo.m_flowStatsUl.push_back (FlowStats (true, params.m_rnti, i));
+    }
+
+  uint8_t numHarqProcess = m_phyMacConfig->GetNumHarqProcess ();
+  ueInfo.m_dlHarqProcessesStatus.resize (numHarqProcess, 0);
+  ueInfo.m_dlHarqProcessesTimer.resize (numHarqProcess, 0);
+  ueInfo.m_dlHarqProcessesDciInfo.resize (numHarqProcess);
+  ueInfo.m_dlHarqProcessesRlcPdu.resize (numHarqProcess);
+  ueInfo.m_ulHarqProcessesStatus.resize (numHarqProcess, 0);
+  ueInfo.m_ulHarqProcessesTimer.resize (numHarqProcess, 0);
+  ueInfo.m_ulHarqProcessesDciInfo.resize (numHarqProcess);
+}
+
+template <class Policy>
+void
+MmWaveFlexTtiPolicyMacScheduler<Policy>::DoCschedLcConfigReq (const struct MmWaveMacCschedSapProvider::CschedLcConfigReqParameters& params)
+{
+  NS_LOG_FUNCTION (this);
+  UeSchedInfo* ueInfo = GetUeSchedInfo (params.m_rnti);
+  if (ueInfo != 0)
+    {
+      for (uint16_t i = 0; i < params.m_logicalChannelConfigList.size (); i++)
+        {
+          if (params.m_logicalChannelConfigList[i].m_direction ==
+              LogicalChannelConfigListElement_s::DIR_DL)
+            {
+              uint8_t lcid = params.m_logicalChannelConfigList[i].m_logicalChannelIdentity;
+              for (unsigned j = ueInfo->m_flowStatsDl.size (); j <= lcid; j++)
+                {
+                  ueInfo->m_flowStatsDl.push_back (FlowStats (false, params.m_rnti, j));
+                }
+              ueInfo->m_flowStatsDl[lcid].m_qci = params.m_logicalChannelConfigList[i].m_qci;
+              if (params.m_logicalChannelConfigList[i].m_qci == EpsBearer::NGBR_LOW_LAT_EMBB_AR)
+                {
+                  EpsBearer lowLatBearer (EpsBearer::NGBR_LOW_LAT_EMBB_AR);
+                  ueInfo->m_flowStatsDl[lcid].m_deadlineUs = lowLatBearer.GetPacketDelayBudgetMs () * 1000;
+                }
+            }
+          else if (params.m_logicalChannelConfigList[i].m_direction ==
+                   LogicalChannelConfigListElement_s::DIR_UL)
+            {
+              uint8_t lcid = params.m_logicalChannelConfigList[i].m_logicalChannelGroup;   // use LCG ID instead of LCID
+              for (unsigned j = ueInfo->m_flowStatsUl.size (); j <= lcid; j++)
+                {
+                  ueInfo->m_flowStatsUl.push_back (FlowStats (true, params.m_rnti, j));
+                }
+              ueInfo->m_flowStatsUl[lcid].m_isUplink = true;
+              ueInfo->m_flowStatsUl[lcid].m_qci = params.m_logicalChannelConfigList[i].m_qci;
+              if (params.m_logicalChannelConfigList[i].m_qci == EpsBearer::NGBR_LOW_LAT_EMBB_AR)
+                {
+                  EpsBearer lowLatBearer (EpsBearer::NGBR_LOW_LAT_EMBB_AR);
+                  ueInfo->m_flowStatsUl[lcid].m_deadlineUs = lowLatBearer.GetPacketDelayBudgetMs () * 1000;
+                }
+            }
+          else if (params.m_logicalChannelConfigList[i].m_direction ==
+                   LogicalChannelConfigListElement_s::DIR_BOTH)
+            {
+              uint8_t lcid = params.m_logicalChannelConfigList[i].m_logicalChannelIdentity;
+              for (unsigned j = ueInfo->m_flowStatsDl.size (); j <= lcid; j++)
+                {
+                  ueInfo->m_flowStatsDl.push_back (FlowStats (false, params.m_rnti, j));
+                  ueInfo->m_flowStatsUl.push_back (FlowStats (true, params.m_rnti, j));
+                }
+              ueInfo->m_flowStatsDl[lcid].m_qci = params.m_logicalChannelConfigList[i].m_qci;
+              ueInfo->m_flowStatsUl[lcid].m_qci = params.m_logicalChannelConfigList[i].m_qci;
+
+              if (1 || params.m_logicalChannelConfigList[i].m_qci == EpsBearer::NGBR_LOW_LAT_EMBB_AR)
+                {
+                  EpsBearer lowLatBearer (EpsBearer::NGBR_LOW_LAT_EMBB_AR);
+                  ueInfo->m_flowStatsDl[lcid].m_deadlineUs = lowLatBearer.GetPacketDelayBudgetMs () * 1000;
+                  ueInfo->m_flowStatsUl[lcid].m_deadlineUs = lowLatBearer.GetPacketDelayBudgetMs () * 1000;
+                }
+            }
+        }
+    }
+  else
+    {
+      NS_LOG_ERROR ("Cannot find UE info entry");
+    }
+  return;
+}
+
+template <class Policy>
+void
+MmWaveFlexTtiPolicyMacScheduler<Policy>::DoCschedLcReleaseReq (const struct MmWaveMacCschedSapProvider::CschedLcReleaseReqParameters& params)
+{
+  NS_LOG_FUNCTION (this);
+  for (uint16_t i = 0; i < params.m_logicalChannelIdentity.size (); i++)
+    {
+      std::list<MmWaveMacSchedSapProvider::SchedDlRlcBufferReqParameters>::iterator it = m_rlcBufferReq.begin ();
+      while (it != m_rlcBufferReq.end ())
+        {
+          if (((*it).m_rnti == params.m_rnti)&&((*it).m_logicalChannelIdentity == params.m_logicalChannelIdentity.at (i)))
+            {
+              it = m_rlcBufferReq.erase (it);
+            }
+          else
+            {
+              it++;
+            }
+        }
+    }
+  return;
+}
+
+template <class Policy>
+void
+MmWaveFlexTtiPolicyMacScheduler<Policy>::DoCschedUeReleaseReq (const struct MmWaveMacCschedSapProvider::CschedUeReleaseReqParameters& params)
+{
+  NS_LOG_FUNCTION (this << " Release RNTI " << params.m_rnti);
+
+  if (GetUeSchedInfo (params.m_rnti) != 0)
+    {
+      // move the last UE in the place of the released one
+      uint32_t ueIndex = m_rntiToUeIndex[params.m_rnti];
+      if (ueIndex != m_ueTable.size () - 1)
+        {
+          m_ueTable[ueIndex] = m_ueTable.back ();
+          m_rntiToUeIndex[m_ueTable[ueIndex].m_rnti] = ueIndex;
+        }
+      m_ueTable.pop_back ();
+      m_rntiToUeIndex[params.m_rnti] = NO_UE_INDEX;
+    }
+  std::list<MmWaveMacSchedSapProvider::SchedDlRlcBufferReqParameters>::iterator it = m_rlcBufferReq.begin ();
+  while (it != m_rlcBufferReq.end ())
+    {
+      if ((*it).m_rnti == params.m_rnti)
+        {
+          NS_LOG_INFO (this << " Erase RNTI " << (*it).m_rnti << " LC " << (uint16_t)(*it).m_logicalChannelIdentity);
+          it = m_rlcBufferReq.erase (it);
+        }
+      else
+        {
+          it++;
+        }
+    }
+  if (m_nextRntiUl == params.m_rnti)
+    {
+      m_nextRntiUl = 0;
+    }
+
+  if (m_nextRntiDl == params.m_rnti)
+    {
+      m_nextRntiDl = 0;
+    }
+
+  return;
+}
+
+template class MmWaveFlexTtiPolicyMacScheduler<MmWaveFlexTtiPfPolicy>;
+template class MmWaveFlexTtiPolicyMacScheduler<MmWaveFlexTtiMaxRatePolicy>;
+
+} // namespace mmwave
+
+} // namespace ns3
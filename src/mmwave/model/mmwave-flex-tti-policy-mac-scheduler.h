@@ -0,0 +1,528 @@
+/*
+ * mmwave-flex-tti-policy-mac-scheduler.h
+ *
+ *  Created on: Jan 10, 2015
+ *      Author: sourjya
+ */
+
+#ifndef SRC_MMWAVE_MODEL_MMWAVE_FLEX_TTI_POLICY_MAC_SCHEDULER_H_
+#define SRC_MMWAVE_MODEL_MMWAVE_FLEX_TTI_POLICY_MAC_SCHEDULER_H_
+
+
+#include "mmwave-mac-sched-sap.h"
+#include "mmwave-mac-csched-sap.h"
+#include "mmwave-mac-scheduler.h"
+#include "mmwave-amc.h"
+#include "string"
+#include <vector>
+#include <set>
+#include <queue>
+#include <functional>
+#include <algorithm>
+
+namespace ns3 {
+
+namespace mmwave {
+
+/**
+ * \ingroup mmwave
+ *
+ * Proportional fair metric: the achievable rate of the UE in the current
+ * slot, normalized by its average rate.
+ */
+struct MmWaveFlexTtiPfPolicy
+{
+  static const bool m_addHdrOverhead = true; //!< add the MAC and RLC headers to the buffer sizes
+
+  template <class UeInfo>
+  static double GetMetric (const UeInfo &ue)
+  {
+    return std::max (ue.m_currTputDl, ue.m_currTputUl) / std::max (1E-9, (ue.m_avgTputDl + ue.m_avgTputDl));
+  }
+};
+
+/**
+ * \ingroup mmwave
+ *
+ * Maximum rate metric: the UEs are served by decreasing MCS, i.e., the
+ * highest among the DL and UL MCS of the links with a CQI, and in round robin
+ * among the UEs with the same MCS, one symbol per UE at each round.
+ */
+struct MmWaveFlexTtiMaxRatePolicy
+{
+  static const bool m_addHdrOverhead = false; //!< add the MAC and RLC headers to the buffer sizes
+
+  template <class UeInfo>
+  static double GetMetric (const UeInfo &ue)
+  {
+    // the symbols of the slot, fewer than 256, are the round robin turn
+    // within the same MCS
+    return ue.m_maxMcs * 256.0 - (ue.m_dlSymbols + ue.m_ulSymbols);
+  }
+};
+
+template <class Policy>
+class MmWaveFlexTtiPolicyMacSchedSapProvider;
+template <class Policy>
+class MmWaveFlexTtiPolicyMacCschedSapProvider;
+
+/**
+ * \ingroup mmwave
+ *
+ * Flex-TTI MAC scheduler which, after serving the HARQ retransmissions,
+ * allocates the OFDM symbols of the slot one at a time to the backlogged UE
+ * with the highest metric, alternating DL and UL for the same UE.
+ *
+ * The metric is given by the Policy class, which must provide a static
+ * method double GetMetric (const UeInfo &ue), where ue exposes the current
+ * (m_currTputDl, m_currTputUl) and average (m_avgTputDl, m_avgTputUl) rates
+ * of the UE, its buffers (m_totBufDl, m_totBufUl), the symbols allocated in
+ * the slot (m_dlSymbols, m_ulSymbols) and the highest MCS of its links
+ * (m_maxMcs). The Policy also sets with the static constant m_addHdrOverhead
+ * whether the MAC and RLC headers are added to the buffer sizes. The scheduler is
+ * explicitly instantiated for the policies in this file, a new policy has to
+ * be added to the instantiations in mmwave-flex-tti-policy-mac-scheduler.cc.
+ *
+ * The backlogged UEs are ranked in a binary heap rebuilt in each slot, so
+ * that only the UE that got the last symbol is ranked again.
+ */
+template <class Policy>
+class MmWaveFlexTtiPolicyMacScheduler : public MmWaveMacScheduler
+{
+public:
+  typedef std::vector < uint8_t > DlHarqProcessesStatus_t;
+  typedef std::vector < uint8_t > DlHarqProcessesTimer_t;
+  typedef std::vector < DciInfoElementTdma > DlHarqProcessesDciInfoList_t;
+  typedef std::vector < std::vector <struct RlcPduInfo> > DlHarqRlcPduList_t;       // vector of the LCs per per UE HARQ process
+  //	typedef std::vector < RlcPduElement > DlHarqRlcPduList_t; // vector of the 8 HARQ processes per UE
+
+  typedef std::vector < uint8_t > UlHarqProcessesTimer_t;
+  typedef std::vector < DciInfoElementTdma > UlHarqProcessesDciInfoList_t;
+  typedef std::vector < uint8_t > UlHarqProcessesStatus_t;
+
+
+  MmWaveFlexTtiPolicyMacScheduler ();
+
+  virtual ~MmWaveFlexTtiPolicyMacScheduler ();
+  virtual void DoDispose (void) override;
+
+  virtual void SetMacSchedSapUser (MmWaveMacSchedSapUser* sap) override;
+  virtual void SetMacCschedSapUser (MmWaveMacCschedSapUser* s) override;
+
+  virtual MmWaveMacSchedSapProvider* GetMacSchedSapProvider () override;
+  virtual MmWaveMacCschedSapProvider* GetMacCschedSapProvider () override;
+
+  virtual void ConfigureCommonParameters (Ptr<MmWavePhyMacCommon> config) override;
+
+  static bool SortRlcBufferReq (MmWaveMacSchedSapProvider::SchedDlRlcBufferReqParameters i, MmWaveMacSchedSapProvider::SchedDlRlcBufferReqParameters j);
+
+  void RefreshDlCqiMaps (void);
+  void RefreshUlCqiMaps (void);
+
+  void UpdateDlRlcBufferInfo (uint16_t rnti, uint8_t lcid, uint16_t size);
+  void UpdateUlRlcBufferInfo (uint16_t rnti, uint16_t size);
+
+  friend class MmWaveFlexTtiPolicyMacSchedSapProvider<Policy>;
+  friend class MmWaveFlexTtiPolicyMacCschedSapProvider<Policy>;
+
+protected:
+  /**
+   * Add the attributes of the scheduler to the TypeId of a concrete scheduler.
+   * The attributes are registered by each concrete scheduler, so that they
+   * can be configured with its own TypeId name.
+   * \param tid the TypeId of the concrete scheduler
+   * \return the TypeId with the attributes
+   */
+  static TypeId AddSchedulerAttributes (TypeId tid);
+
+private:
+  struct FlowStats
+  {
+    FlowStats (bool uplink, uint16_t rnti, uint8_t lcid)
+      : m_isUplink (uplink),
+        m_rnti (rnti),
+        m_lcid (lcid),
+        m_arrivalRate (0.0),
+        m_grantedRate (0.0),
+        m_qci (0),
+        m_txQueueHolDelay (0),
+        m_reTxQueueHolDelay (0),
+        m_probErr (0.0),
+        m_deadlineUs (0),
+        m_totalBufSize (0),
+        m_totalSchedSize (0)
+    {
+    }
+
+    bool                    m_isUplink;                                                         // is uplink?
+    uint16_t        m_rnti;                                                             // RNTI of the parent UE
+    uint8_t         m_lcid;                                                             // LCID (for DL) or LC Group ID (for UL)
+    double          m_arrivalRate;                              // Mbps
+    double          m_grantedRate;                              // Mbps
+    uint8_t         m_qci;                                                              // We interpret QCI 69 as delay critical
+    //uint32_t	m_deliveryDebt;
+    double  m_txQueueHolDelay;
+    uint32_t        m_reTxQueueHolDelay;
+    double          m_probErr;                                                  // expected probability of each HARQ TX/reTX failure (i.e. 1/E[num TX to success])
+    double  m_deadlineUs;                                       // relative deadline
+    std::list<uint32_t> m_txPacketSizes;                                // estimated packet sizes from consecutive BSRs
+    uint32_t        m_totalBufSize;
+    std::list<uint32_t> m_retxPacketSizes;
+    std::list<double> m_txPacketDelays;                                 // estimated delays for each packet
+    std::list<double> m_retxPacketDelays;
+
+    // We maintain a queue of PDU sizes scheduled in the last M subframes.
+    // M = delay between scheduling and transmission (default DL = 1, UL = 2)
+    // The sum of these M elements is subtracted from the BSR to account for
+    // data that has been scheduled but not yet extracted from the DL or UL queue.
+    std::list<uint32_t> m_schedPacketSizes;
+    uint32_t        m_totalSchedSize;                                   // total of last M elements in list
+  };
+
+  /*
+   * Map of UEs' UL-CQI per RBG
+   */
+  struct UlCqiMapElem
+  {
+    UlCqiMapElem ()
+      : m_numSym (0),
+        m_tbSize (0)
+    {
+    }
+    UlCqiMapElem (std::vector<double> ulCqi, uint8_t nSym, uint32_t tbs)
+      : m_ueUlCqi (ulCqi),
+        m_numSym (nSym),
+        m_tbSize (tbs)
+    {
+    }
+    std::vector <double> m_ueUlCqi;
+    uint8_t         m_numSym;
+    uint32_t        m_tbSize;
+  };
+
+  /*
+   * State of a UE, stored in the dense UE table
+   */
+  struct UeSchedInfo
+  {
+    UeSchedInfo (uint16_t rnti)
+      : m_rnti (rnti),
+        m_dlMcs (0),
+        m_ulMcs (0),
+        m_maxMcs (0),
+        m_maxDlBufSize (0),
+        m_maxUlBufSize (0),
+        m_maxDlSymbols (0),
+        m_maxUlSymbols (0),
+        m_dlSymbols (0),
+        m_ulSymbols (0),
+        m_dlSymbolsRetx (0),
+        m_ulSymbolsRetx (0),
+        m_dlTbSize (0),
+        m_ulTbSize (0),
+        m_dlAllocDone (false),
+        m_ulAllocDone (false),
+        m_avgTputDl (0.0),
+        m_avgTputUl (0.0),
+        m_lastAvgTputDl (0.0),
+        m_lastAvgTputUl (0.0),
+        m_currTputDl (0.0),
+        m_currTputUl (0.0),
+        m_totBufDl (0),
+        m_totBufUl (0),
+        m_allocUlLast (false),
+        m_allocated (false),
+        m_wbCqiValid (false),
+        m_wbCqi (0),
+        m_wbCqiTimer (0),
+        m_ulCqiValid (false),
+        m_ulCqiTimer (0),
+        m_ceBsrRxed (0)
+    {
+    }
+
+    uint16_t        m_rnti;
+    uint8_t         m_dlMcs;
+    uint8_t         m_ulMcs;
+    uint8_t         m_maxMcs;               // highest MCS of the links with a CQI in the current slot
+    uint32_t        m_maxDlBufSize;
+    uint32_t        m_maxUlBufSize;
+    uint8_t         m_maxDlSymbols;
+    uint8_t         m_maxUlSymbols;
+    uint8_t         m_dlSymbols;
+    uint8_t         m_ulSymbols;
+    uint8_t         m_dlSymbolsRetx;
+    uint8_t         m_ulSymbolsRetx;
+    uint32_t        m_dlTbSize;
+    uint32_t        m_ulTbSize;
+    std::vector <struct RlcPduInfo> m_rlcPduInfo;
+    bool                    m_dlAllocDone;
+    bool                    m_ulAllocDone;
+    std::vector<FlowStats> m_flowStatsDl;                               // for each LC
+    std::vector<FlowStats> m_flowStatsUl;
+    double          m_avgTputDl;
+    double          m_avgTputUl;
+    double          m_lastAvgTputDl;
+    double          m_lastAvgTputUl;
+    double          m_currTputDl;
+    double          m_currTputUl;
+    uint32_t        m_totBufDl;
+    uint32_t        m_totBufUl;
+    bool                    m_allocUlLast;
+    bool                    m_allocated;                // allocated in the current slot
+
+    // DL CQI WB received, and its timer
+    bool                    m_wbCqiValid;
+    uint8_t         m_wbCqi;
+    uint32_t        m_wbCqiTimer;
+
+    // UL-CQI per RBG received, and its timer
+    bool                    m_ulCqiValid;
+    UlCqiMapElem    m_ulCqi;
+    uint32_t        m_ulCqiTimer;
+
+    // buffer status report received
+    uint32_t        m_ceBsrRxed;
+
+    // HARQ state, one element per HARQ process
+    // status 0: process Id available
+    // x>0: process Id equal to `x` trasmission count
+    DlHarqProcessesStatus_t m_dlHarqProcessesStatus;
+    DlHarqProcessesTimer_t m_dlHarqProcessesTimer;
+    DlHarqProcessesDciInfoList_t m_dlHarqProcessesDciInfo;
+    DlHarqRlcPduList_t m_dlHarqProcessesRlcPdu;
+    UlHarqProcessesStatus_t m_ulHarqProcessesStatus;
+    UlHarqProcessesTimer_t m_ulHarqProcessesTimer;
+    UlHarqProcessesDciInfoList_t m_ulHarqProcessesDciInfo;
+  };
+
+  /**
+   * Entry of the ranking of the UEs backlogged in the current slot
+   */
+  struct UeRankEntry
+  {
+    UeRankEntry (double metric, UeSchedInfo* ueSchedInfo)
+      : m_metric (metric),
+        m_ueSchedInfo (ueSchedInfo)
+    {
+    }
+
+    double m_metric; //!< the metric of the UE, given by the policy
+    UeSchedInfo* m_ueSchedInfo; //!< the UE
+  };
+
+  /**
+   * Order the ranking so that the heap keeps on top the UE with the highest
+   * metric, and the one with the lowest RNTI among those with the same metric
+   */
+  static bool CompareUeRank (const UeRankEntry &lhs, const UeRankEntry &rhs)
+  {
+    if (lhs.m_metric != rhs.m_metric)
+      {
+        return lhs.m_metric < rhs.m_metric;
+      }
+    return lhs.m_ueSchedInfo->m_rnti > rhs.m_ueSchedInfo->m_rnti;
+  }
+
+  /**
+   * Order the allocated UEs by RNTI
+   */
+  static bool CompareUeRnti (const UeSchedInfo* lhs, const UeSchedInfo* rhs)
+  {
+    return lhs->m_rnti < rhs->m_rnti;
+  }
+
+
+  unsigned CalcMinTbSizeNumSym (unsigned mcs, unsigned bufSize, unsigned &tbSize);
+
+  uint32_t
+  BsrId2BufferSize (uint8_t val)
+  {
+    NS_ABORT_MSG_UNLESS (val < 64, "val = " << val << " is out of range");
+    return BufferSizeLevelBsrTable[val];
+  }
+
+  uint8_t
+  BufferSize2BsrId (uint32_t val)
+  {
+    int index = 0;
+    if (BufferSizeLevelBsrTable[63] < val)
+      {
+        index = 63;
+      }
+    else
+      {
+        while (BufferSizeLevelBsrTable[index] < val)
+          {
+            NS_ASSERT (index < 64);
+            index++;
+          }
+      }
+
+    return (index);
+  }
+
+  uint8_t UpdateDlHarqProcessId (uint16_t rnti);
+  uint8_t UpdateUlHarqProcessId (uint16_t rnti);
+
+  //
+  // Implementation of the CSCHED API primitives
+  // (See 4.1 for description of the primitives)
+  //
+
+  void DoCschedCellConfigReq (const struct MmWaveMacCschedSapProvider::CschedCellConfigReqParameters& params);
+
+  void DoCschedUeConfigReq (const struct MmWaveMacCschedSapProvider::CschedUeConfigReqParameters& params);
+
+  void DoCschedLcConfigReq (const struct MmWaveMacCschedSapProvider::CschedLcConfigReqParameters& params);
+
+  void DoCschedLcReleaseReq (const struct MmWaveMacCschedSapProvider::CschedLcReleaseReqParameters& params);
+
+  void DoCschedUeReleaseReq (const struct MmWaveMacCschedSapProvider::CschedUeReleaseReqParameters& params);
+
+  //
+  // Implementation of the SCHED API primitives
+  // (See 4.2 for description of the primitives)
+  //
+
+  void DoSchedDlRlcBufferReq (const struct MmWaveMacSchedSapProvider::SchedDlRlcBufferReqParameters& params);
+
+  void DoSchedDlCqiInfoReq (const MmWaveMacSchedSapProvider::SchedDlCqiInfoReqParameters& params);       // Put in UML
+
+  void DoSchedUlCqiInfoReq (const struct MmWaveMacSchedSapProvider::SchedUlCqiInfoReqParameters& params);
+
+  void DoSchedUlMacCtrlInfoReq (const struct MmWaveMacSchedSapProvider::SchedUlMacCtrlInfoReqParameters& params);
+
+  void DoSchedTriggerReq (const struct MmWaveMacSchedSapProvider::SchedTriggerReqParameters& params);
+
+  bool DoSchedDlTriggerReq (const struct MmWaveMacSchedSapProvider::SchedTriggerReqParameters& params,
+                            MmWaveMacSchedSapUser::SchedConfigIndParameters& ret,
+                            unsigned int frameNum,
+                            unsigned int sfNum,
+                            unsigned int islot);
+
+  bool DoSchedUlTriggerReq (const struct MmWaveMacSchedSapProvider::SchedTriggerReqParameters& params,
+                            MmWaveMacSchedSapUser::SchedConfigIndParameters& ret,
+                            unsigned int frameNum,
+                            unsigned int sfNum,
+                            unsigned int islot);
+
+  void DoSchedSetMcs (int mcs);
+  /**
+   * \brief Refresh HARQ processes according to the timers
+   *
+   */
+  void RefreshHarqProcesses ();
+
+  Ptr<MmWaveAmc> m_amc;
+
+  /*
+   * Vectors of UE's RLC info
+   */
+  std::list <MmWaveMacSchedSapProvider::SchedDlRlcBufferReqParameters> m_rlcBufferReq;
+
+  uint32_t m_cqiTimersThreshold;       // # of TTIs for which a CQI can be considered valid
+
+  uint16_t m_nextRnti;
+  uint64_t m_nextRntiDl;
+  uint64_t m_nextRntiUl;
+
+  uint32_t m_frameNo;
+  uint8_t m_tbUid;
+  uint32_t m_numChunks;
+  uint32_t m_numDataSymbols;
+
+  MmWaveMacSchedSapProvider* m_macSchedSapProvider;
+  MmWaveMacSchedSapUser* m_macSchedSapUser;
+  MmWaveMacCschedSapUser* m_macCschedSapUser;
+  MmWaveMacCschedSapProvider* m_macCschedSapProvider;
+
+  MmWaveMacCschedSapProvider::CschedCellConfigReqParameters m_cschedCellConfig;
+
+  struct AllocMapElem
+  {
+    AllocMapElem (std::vector<uint16_t> rntiMap, uint8_t nSym, uint32_t tbs)
+      : m_rntiPerChunk (rntiMap),
+        m_numSym (nSym),
+        m_tbSize (tbs)
+    {
+    }
+
+    std::vector <uint16_t> m_rntiPerChunk;
+    uint8_t m_numSym;
+    uint32_t m_tbSize;
+  };
+  /*
+   * Map of previous allocated UE per RBG
+   * (used to retrieve info from UL-CQI)
+   */
+  std::map <uint32_t, struct AllocMapElem> m_ulAllocationMap;
+
+  // HARQ attributes
+  /**
+   * m_harqOn when false inhibit te HARQ mechanisms (by default active)
+   */
+  bool m_harqOn;
+  uint8_t m_numHarqProcess;
+  uint8_t m_harqTimeout;
+
+  std::vector <DlHarqInfo> m_dlHarqInfoList;       // HARQ retx buffered
+  std::vector <UlHarqInfo> m_ulHarqInfoList;       // HARQ retx buffered
+
+  // needed to keep track of uplink allocations in later slots
+  std::list <struct SlotAllocInfo> m_ulSfAllocInfo;
+
+  static const unsigned m_macHdrSize;
+  static const unsigned m_subHdrSize;
+  static const unsigned m_rlcHdrSize;
+
+  double m_berDl;               // used for	SNR-based AMC model
+
+  //for testing
+  bool            m_fixedMcsDl;
+  bool            m_fixedMcsUl;
+  uint8_t m_mcsDefaultDl;
+  uint8_t m_mcsDefaultUl;
+  bool m_dlOnly;
+  bool m_ulOnly;
+
+
+  //typedef std::priority_queue <FlowStats, std::vector<FlowStats*>, CompareWeightDesc> flowQueue_t;
+  //flowQueue_t m_flowQueue;
+
+  /**
+   * Get the state of a UE
+   * \param rnti the RNTI of the UE
+   * \return the state of the UE, or 0 if the UE is not configured
+   */
+  UeSchedInfo* GetUeSchedInfo (uint16_t rnti);
+
+  /**
+   * Add a UE to the UEs allocated in the current slot, if not already there
+   * \param ueInfo the state of the UE
+   */
+  void AddToAllocList (UeSchedInfo* ueInfo);
+
+  // dense table of the state of the configured UEs, indexed by the UE index
+  // assigned in DoCschedUeConfigReq. Releasing a UE moves the last entry in
+  // its place, so that the table has no holes.
+  std::vector<UeSchedInfo> m_ueTable;
+  std::vector<uint32_t> m_rntiToUeIndex;       // UE index of each RNTI, NO_UE_INDEX if not configured
+  static const uint32_t NO_UE_INDEX = 0xFFFFFFFF;
+
+  std::vector<UeSchedInfo*> m_ueAllocList;       // UEs allocated in the current slot
+
+  bool m_fixedTti;                      // one slot per TTI
+  uint8_t m_symPerSlot;       // symbols per slot
+
+  double m_timeWindow;
+
+  std::vector <UeRankEntry> m_ueRank;       // heap of the UEs backlogged in the current slot
+};
+
+} // namespace mmwave
+
+} // namespace ns3
+
+
+#endif /* SRC_MMWAVE_MODEL_MMWAVE_FLEX_TTI_POLICY_MAC_SCHEDULER_H_ */
@@ -64,6 +64,8 @@ mmWaveInterference::DoDispose ()
   m_rxSignal = 0;
   m_allSignals = 0;
   m_noise = 0;
+  m_sinr = 0;
+  m_pendingSignals.clear ();
   Object::DoDispose ();
 }
 
@@ -85,7 +87,15 @@ mmWaveInterference::StartRx (Ptr<const SpectrumValue> rxPsd)
   if (m_receiving == false)
     {
       NS_LOG_LOGIC ("first signal");
-      m_rxSignal = rxPsd->Copy ();
+      if (m_rxSignal == 0)
+        {
+          m_rxSignal = rxPsd->Copy ();
+        }
+      else
+        {
+          // reuse the buffer of the previous reception
+          (*m_rxSignal) = (*rxPsd);
+        }
       m_lastChangeTime = Now ();
       m_receiving = true;
       for (std::list<Ptr<mmWaveChunkProcessor> >::const_iterator it = m_PowerChunkProcessorList.begin (); it != m_PowerChunkProcessorList.end (); ++it)
@@ -103,7 +113,7 @@ mmWaveInterference::StartRx (Ptr<const SpectrumValue> rxPsd)
       // receiving multiple simultaneous signals, make sure they are synchronized
       NS_ASSERT (m_lastChangeTime == Now ());
       // make sure they use orthogonal resource blocks
-      NS_ASSERT (Sum ((*rxPsd) * (*m_rxSignal)) == 0.0);
+      NS_ASSERT (SumOfProduct (*rxPsd, *m_rxSignal) == 0.0);
       (*m_rxSignal) += (*rxPsd);
     }
 }
@@ -148,7 +158,15 @@ mmWaveInterference::AddSignal (Ptr<const SpectrumValue> spd, const Time duration
       // boundary further.
       m_lastSignalIdBeforeReset += 0x10000000;
     }
-  Simulator::Schedule (duration, &mmWaveInterference::DoSubtractSignal, this, spd, signalId);
+  PendingSignal signal;
+  signal.m_psd = spd;
+  signal.m_signalId = signalId;
+  std::vector<PendingSignal> &pendingSignals = m_pendingSignals[Now () + duration];
+  if (pendingSignals.empty ())
+    {
+      Simulator::Schedule (duration, &mmWaveInterference::DoSubtractSignals, this);
+    }
+  pendingSignals.push_back (signal);
 }
 
 
@@ -161,22 +179,31 @@ mmWaveInterference::DoAddSignal (Ptr<const SpectrumValue> spd)
 }
 
 void
-mmWaveInterference::DoSubtractSignal  (Ptr<const SpectrumValue> spd, uint32_t signalId)
+mmWaveInterference::DoSubtractSignals ()
 {
-  NS_LOG_FUNCTION (this << *spd);
+  NS_LOG_FUNCTION (this);
   ConditionallyEvaluateChunk ();
-  int32_t deltaSignalId = signalId - m_lastSignalIdBeforeReset;
-  if (deltaSignalId > 0)
+  std::map<Time, std::vector<PendingSignal> >::iterator it = m_pendingSignals.find (Now ());
+  if (it == m_pendingSignals.end ())
     {
-      (*m_allSignals) -= (*spd);
+      NS_LOG_INFO ("the pending signals have been discarded");
+      return;
     }
-  else
+  for (std::vector<PendingSignal>::const_iterator sit = it->second.begin (); sit != it->second.end (); ++sit)
     {
-      NS_LOG_INFO ("ignoring signal scheduled for subtraction before last reset");
+      int32_t deltaSignalId = sit->m_signalId - m_lastSignalIdBeforeReset;
+      if (deltaSignalId > 0)
+        {
+          (*m_allSignals) -= (*sit->m_psd);
+        }
+      else
+        {
+          NS_LOG_INFO ("ignoring signal scheduled for subtraction before last reset");
+        }
     }
+  m_pendingSignals.erase (it);
 }
 
-
 void
 mmWaveInterference::ConditionallyEvaluateChunk ()
 {
@@ -189,8 +216,20 @@ mmWaveInterference::ConditionallyEvaluateChunk ()
   if (m_receiving && (Now () > m_lastChangeTime))
     {
       NS_LOG_LOGIC (this << " signal = " << *m_rxSignal << " allSignals = " << *m_allSignals << " noise = " << *m_noise);
-      SpectrumValue interf =  (*m_allSignals) - (*m_rxSignal) + (*m_noise);
-      SpectrumValue sinr = (*m_rxSignal) / interf;
+      // compute the SINR in place, with the same operations of
+      // rxSignal / (allSignals - rxSignal + noise)
+      if (m_sinr == 0 || m_sinr->GetSpectrumModel () != m_rxSignal->GetSpectrumModel ())
+        {
+          m_sinr = Create<SpectrumValue> (m_rxSignal->GetSpectrumModel ());
+        }
+      Values::const_iterator allIt = m_allSignals->ConstValuesBegin ();
+      Values::const_iterator rxIt = m_rxSignal->ConstValuesBegin ();
+      Values::const_iterator noiseIt = m_noise->ConstValuesBegin ();
+      for (Values::iterator sinrIt = m_sinr->ValuesBegin (); sinrIt != m_sinr->ValuesEnd (); ++sinrIt, ++allIt, ++rxIt, ++noiseIt)
+        {
+          (*sinrIt) = (*rxIt) / ((*allIt) - (*rxIt) + (*noiseIt));
+        }
+      const SpectrumValue &sinr = *m_sinr;
       Time duration = Now () - m_lastChangeTime;
       for (std::list<Ptr<mmWaveChunkProcessor> >::const_iterator it = m_PowerChunkProcessorList.begin (); it != m_PowerChunkProcessorList.end (); ++it)
         {
@@ -36,6 +36,8 @@
 #include <ns3/spectrum-value.h>
 #include <string.h>
 #include <ns3/mmwave-chunk-processor.h>
+#include <map>
+#include <vector>
 
 
 namespace ns3 {
@@ -59,7 +61,19 @@ public:
 private:
   void ConditionallyEvaluateChunk ();
   void DoAddSignal (Ptr<const SpectrumValue> spd);
-  void DoSubtractSignal  (Ptr<const SpectrumValue> spd, uint32_t signalId);
+  /**
+   * Subtract all the signals which end at the current time
+   */
+  void DoSubtractSignals ();
+
+  /**
+   * A signal which will be subtracted when it ends
+   */
+  struct PendingSignal
+  {
+    Ptr<const SpectrumValue> m_psd; //!< the PSD of the signal
+    uint32_t m_signalId; //!< the ID of the signal
+  };
   std::list<Ptr<mmWaveChunkProcessor> > m_PowerChunkProcessorList;
   std::list<Ptr<mmWaveChunkProcessor> > m_sinrChunkProcessorList;
 
@@ -69,6 +83,11 @@ private:
   Ptr<SpectrumValue> m_rxSignal;
   Ptr<SpectrumValue> m_allSignals;
   Ptr<const SpectrumValue> m_noise;
+  Ptr<SpectrumValue> m_sinr; //!< scratch buffer for the SINR of a chunk
+
+  // the signals to subtract, grouped by their end time, so that a single
+  // event subtracts all the signals which end together
+  std::map<Time, std::vector<PendingSignal> > m_pendingSignals;
 
   Time m_lastChangeTime;
 
@@ -93,11 +93,21 @@ public:
     m_subheaderList = macSubheaderList;
   }
 
-  std::vector<MacSubheader> GetSubheaders (void)
+  const std::vector<MacSubheader>& GetSubheaders (void) const
   {
     return m_subheaderList;
   }
 
+  /**
+   * Remove all the subheaders, keeping the storage of the list, so that the
+   * header can be reused for the next PDU
+   */
+  void Clear (void)
+  {
+    m_subheaderList.clear ();
+    m_headerSize = 0;
+  }
+
 protected:
   std::vector<MacSubheader> m_subheaderList;
   uint32_t m_headerSize;
@@ -57,11 +57,10 @@ MmWaveMiErrorModel::Mib (const SpectrumValue& sinr, const std::vector<int>& map,
 
   double MI;
   double MIsum = 0.0;
-  SpectrumValue sinrCopy = sinr;
 
   for (uint32_t i = 0; i < map.size (); i++)
     {
-      double sinrLin = sinrCopy[map.at (i)];
+      double sinrLin = sinr[map.at (i)];
       if (mcs <= MMWAVE_MI_QPSK_MAX_ID) // QPSK
         {
 
@@ -179,36 +178,11 @@ MmWaveMiErrorModel::MappingMiBler (double mib, uint8_t ecrId, uint32_t cbSize)
   return bler;
 }
 
-MmWaveTbStats_t
-MmWaveMiErrorModel::GetTbDecodificationStats (const SpectrumValue& sinr, const std::vector<int>& map, uint32_t size, uint8_t mcs, MmWaveHarqProcessInfoList_t miHistory)
+MmWaveCodeBlockSegmentation_t
+MmWaveMiErrorModel::GetCodeBlockSegmentation (uint32_t size)
 {
-  NS_LOG_FUNCTION (sinr << &map << (uint32_t) size << (uint32_t) mcs);
+  NS_LOG_FUNCTION (size);
 
-  double tbMi = Mib (sinr, map, mcs);
-  double MI = 0.0;
-  double Reff = 0.0;
-  NS_ASSERT (mcs < 29);
-  if (miHistory.size () > 0)
-    {
-      // evaluate R_eff and MI_eff
-      uint32_t codeBitsSum = 0;
-      double miSum = 0.0;
-      for (uint16_t i = 0; i < miHistory.size (); i++)
-        {
-          NS_LOG_DEBUG (" Sum MI " << miHistory.at (i).m_mi << " Ci " << miHistory.at (i).m_codeBits);
-          codeBitsSum += miHistory.at (i).m_codeBits;
-          miSum += (miHistory.at (i).m_mi * miHistory.at (i).m_codeBits);
-        }
-      codeBitsSum += (((double)size * 8.0) / McsEcrTable [mcs]);
-      miSum += (tbMi * (((double)size * 8.0) / McsEcrTable [mcs]));
-      Reff = miHistory.at (0).m_infoBits / (double)codeBitsSum; // information bits are the size of the first TB
-      MI = miSum / (double)codeBitsSum;
-    }
-  else
-    {
-      MI = tbMi;
-    }
-  NS_LOG_DEBUG (" MI " << MI << " Reff " << Reff << " HARQ " << miHistory.size ());
   // estimate CB size (according to sec 5.1.2 of TS 36.212)
   uint16_t Z = 6144; // max size of a codeblock (including CRC)
   uint32_t B = size * 8;
@@ -302,7 +276,69 @@ MmWaveMiErrorModel::GetTbDecodificationStats (const SpectrumValue& sinr, const s
     }
   NS_LOG_INFO ("--------------------LteMiErrorModel: TB size of " << B << " needs of " << B1 << " bits reparted in " << C << " CBs as " << Cplus << " block(s) of " << Kplus << " and " << Cminus << " of " << Kminus);
 
+  MmWaveCodeBlockSegmentation_t segmentation;
+  segmentation.C = C;
+  segmentation.Cplus = Cplus;
+  segmentation.Kplus = Kplus;
+  segmentation.Cminus = Cminus;
+  segmentation.Kminus = Kminus;
+  return segmentation;
+}
+
+double
+MmWaveMiErrorModel::MappingMiTbler (double mib, uint8_t ecrId, const MmWaveCodeBlockSegmentation_t &segmentation)
+{
+  NS_LOG_FUNCTION (mib << (uint32_t) ecrId << segmentation.C);
+
   double errorRate = 1.0;
+  if (segmentation.C != 1)
+    {
+      double cbler = MappingMiBler (mib, ecrId, segmentation.Kplus);
+      errorRate *= pow (1.0 - cbler, segmentation.Cplus);
+      cbler = MappingMiBler (mib, ecrId, segmentation.Kminus);
+      errorRate *= pow (1.0 - cbler, segmentation.Cminus);
+      errorRate = 1.0 - errorRate;
+    }
+  else
+    {
+      errorRate = MappingMiBler (mib, ecrId, segmentation.Kplus);
+    }
+
+  return errorRate;
+}
+
+MmWaveTbStats_t
+MmWaveMiErrorModel::GetTbDecodificationStats (const SpectrumValue& sinr, const std::vector<int>& map, uint32_t size, uint8_t mcs, MmWaveHarqProcessInfoList_t miHistory)
+{
+  NS_LOG_FUNCTION (sinr << &map << (uint32_t) size << (uint32_t) mcs);
+
+  double tbMi = Mib (sinr, map, mcs);
+  double MI = 0.0;
+  double Reff = 0.0;
+  NS_ASSERT (mcs < 29);
+  if (miHistory.size () > 0)
+    {
+      // evaluate R_eff and MI_eff
+      uint32_t codeBitsSum = 0;
+      double miSum = 0.0;
+      for (uint16_t i = 0; i < miHistory.size (); i++)
+        {
+          NS_LOG_DEBUG (" Sum MI " << miHistory.at (i).m_mi << " Ci " << miHistory.at (i).m_codeBits);
+          codeBitsSum += miHistory.at (i).m_codeBits;
+          miSum += (miHistory.at (i).m_mi * miHistory.at (i).m_codeBits);
+        }
+      codeBitsSum += (((double)size * 8.0) / McsEcrTable [mcs]);
+      miSum += (tbMi * (((double)size * 8.0) / McsEcrTable [mcs]));
+      Reff = miHistory.at (0).m_infoBits / (double)codeBitsSum; // information bits are the size of the first TB
+      MI = miSum / (double)codeBitsSum;
+    }
+  else
+    {
+      MI = tbMi;
+    }
+  NS_LOG_DEBUG (" MI " << MI << " Reff " << Reff << " HARQ " << miHistory.size ());
+  MmWaveCodeBlockSegmentation_t segmentation = GetCodeBlockSegmentation (size);
+
   uint8_t ecrId = 0;
   if (miHistory.size () == 0)
     {
@@ -347,19 +383,7 @@ MmWaveMiErrorModel::GetTbDecodificationStats (const SpectrumValue& sinr, const s
       NS_LOG_DEBUG ("HARQ ECR " << (uint16_t)ecrId);
     }
 
-  if (C != 1)
-    {
-      double cbler = MappingMiBler (MI, ecrId, Kplus);
-      errorRate *= pow (1.0 - cbler, Cplus);
-      cbler = MappingMiBler (MI, ecrId, Kminus);
-      errorRate *= pow (1.0 - cbler, Cminus);
-      errorRate = 1.0 - errorRate;
-    }
-  else
-    {
-      errorRate = MappingMiBler (MI, ecrId, Kplus);
-    }
-
+  double errorRate = MappingMiTbler (MI, ecrId, segmentation);
   NS_LOG_LOGIC (" Error rate " << errorRate);
   MmWaveTbStats_t ret;
   ret.tbler = errorRate;
@@ -65,6 +65,18 @@ struct MmWaveTbStats_t
   double miTotal;
 };
 
+/**
+ * Code block segmentation of a TB, according to sec 5.1.2 of TS 36.212
+ */
+struct MmWaveCodeBlockSegmentation_t
+{
+  uint32_t C;       // no. of codeblocks
+  uint32_t Cplus;   // no. of codeblocks with size K+
+  uint32_t Kplus;   // size of the codeblocks K+
+  uint32_t Cminus;  // no. of codeblocks with size K-
+  uint32_t Kminus;  // size of the codeblocks K-
+};
+
 // global table of the effective code rates (ECR)s that have BLER performance curves
 static const double BlerCurvesEcrMap[38] = {
   // QPSK (M=2)
@@ -355,6 +367,24 @@ public:
    */
   static MmWaveTbStats_t GetTbDecodificationStats (const SpectrumValue& sinr, const std::vector<int>& map, uint32_t size, uint8_t mcs, MmWaveHarqProcessInfoList_t miHistory);
 
+  /**
+   * \brief estimate the code block segmentation of a TB, which depends only
+   * on its size
+   * \param size the size in bytes of the TB
+   * \return the code block segmentation
+   */
+  static MmWaveCodeBlockSegmentation_t GetCodeBlockSegmentation (uint32_t size);
+
+  /**
+   * \brief map the mmib (mean mutual information per bit) of a TB to its
+   * error rate
+   * \param mib mean mutual information per bit of the TB
+   * \param ecrId Effective Code Rate ID
+   * \param segmentation the code block segmentation of the TB
+   * \return the TB error rate
+   */
+  static double MappingMiTbler (double mib, uint8_t ecrId, const MmWaveCodeBlockSegmentation_t &segmentation);
+
 
 //private:
 
@@ -0,0 +1,206 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+*   Copyright (c) 2016, University of Padova, Dep. of Information Engineering, SIGNET lab.
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License version 2 as
+*   published by the Free Software Foundation;
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "mmwave-sinr-filter.h"
+#include <ns3/log.h>
+#include <ns3/abort.h>
+#include <ns3/assert.h>
+#include <cmath>
+#include <limits>
+
+namespace ns3 {
+
+namespace mmwave {
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveSinrFilter");
+
+const uint32_t MmWaveSinrFilter::NUM_ALPHA;
+const uint32_t MmWaveSinrFilter::STABLE_WINDOW;
+
+MmWaveSinrFilter::MmWaveSinrFilter (uint32_t capacity)
+  : m_capacity (capacity),
+    m_windowLength (0),
+    m_size (0),
+    m_numSamples (0),
+    m_realSinr (capacity),
+    m_noisySinr (capacity),
+    m_lastNoisySinrDb (0),
+    m_lowVarRun (0),
+    m_highSinrRun (0),
+    m_hasStableSample (false),
+    m_stableSample (0),
+    m_filtersActive (false),
+    m_filtersStart (0),
+    m_alphaStates (NUM_ALPHA)
+{
+  NS_LOG_FUNCTION (this << capacity);
+  NS_ABORT_MSG_IF (capacity == 0, "The window must contain at least one sample");
+}
+
+uint32_t
+MmWaveSinrFilter::GetWindowSize (void) const
+{
+  return m_size;
+}
+
+double
+MmWaveSinrFilter::Update (double realSinr, double noisySinr, bool transient)
+{
+  NS_LOG_FUNCTION (this << realSinr << noisySinr << transient);
+
+  if (!transient && m_windowLength == 0)
+    {
+      // the window stops growing at the end of the transient, while the
+      // pairs that appear after the transient use the whole capacity
+      m_windowLength = (m_size > 0) ? m_size : m_capacity;
+    }
+
+  uint64_t current = m_numSamples++;
+  bool hasPrevious = m_size > 0;
+  double noisySinrDb = 10 * std::log10 (noisySinr);
+  // variance of the last two samples, i.e., the square of half their difference
+  double var = hasPrevious ? std::pow ((noisySinrDb - m_lastNoisySinrDb) / 2, 2) : std::numeric_limits<double>::quiet_NaN ();
+
+  uint32_t maxSize = (m_windowLength > 0) ? m_windowLength : m_capacity;
+  if (m_size < maxSize)
+    {
+      m_size++;
+    }
+  m_realSinr[current % m_capacity] = realSinr;
+  m_noisySinr[current % m_capacity] = noisySinr;
+
+  // the filtering can stop at the current sample if the STABLE_WINDOW samples
+  // before it (in the window) have a low variance or a high SINR
+  if ((m_lowVarRun >= STABLE_WINDOW - 1 || m_highSinrRun >= STABLE_WINDOW)
+      && m_size - 1 > STABLE_WINDOW)
+    {
+      m_hasStableSample = true;
+      m_stableSample = current;
+      ResetFilters (current, current);
+    }
+
+  m_lowVarRun = (hasPrevious && var < 1) ? m_lowVarRun + 1 : 0;
+  m_highSinrRun = (noisySinrDb > 10) ? m_highSinrRun + 1 : 0;
+  m_lastNoisySinrDb = noisySinrDb;
+
+  double sinr = noisySinr;
+  if (!transient && m_size > 2)
+    {
+      // the filter is applied only in a blockage, i.e., if the variance
+      // is high or the SINR is low
+      bool blockage = var > 5 || std::isnan (var) || noisySinr < 10;
+      if (blockage)
+        {
+          uint64_t windowStart = current + 1 - m_size;
+          bool fromWindowStart = !m_hasStableSample || m_stableSample <= windowStart + STABLE_WINDOW;
+          uint64_t start = fromWindowStart ? windowStart : m_stableSample;
+          NS_LOG_DEBUG ("Blockage at sample " << current << ", filter from sample " << start);
+
+          if (start < current)
+            {
+              // the filters are kept while the interval starts from the same
+              // sample. When the interval starts with the window, they are
+              // restarted as the window slides, so that the samples before
+              // the window are never considered.
+              if (!m_filtersActive || m_filtersStart != start)
+                {
+                  ResetFilters (start, current);
+                }
+
+              if (current - start >= 2)
+                {
+                  // the reported sample is the output of the filter up to the
+                  // second-last sample
+                  sinr = m_alphaStates[GetBestAlpha ()].xPrev;
+                }
+              else
+                {
+                  sinr = m_noisySinr[(current - 1) % m_capacity];
+                }
+            }
+        }
+    }
+
+  if (m_filtersActive)
+    {
+      UpdateFilters (realSinr, noisySinr);
+    }
+
+  return sinr;
+}
+
+void
+MmWaveSinrFilter::ResetFilters (uint64_t start, uint64_t end)
+{
+  NS_LOG_FUNCTION (this << start << end);
+  NS_ASSERT (end >= start && end - start < m_size);
+
+  m_filtersActive = true;
+  m_filtersStart = start;
+  for (AlphaState &state : m_alphaStates)
+    {
+      state.x = 0;
+      state.xPrev = 0;
+      state.error = 0;
+    }
+  for (uint64_t i = start; i < end; ++i)
+    {
+      UpdateFilters (m_realSinr[i % m_capacity], m_noisySinr[i % m_capacity]);
+    }
+}
+
+void
+MmWaveSinrFilter::UpdateFilters (double realSinr, double noisySinr)
+{
+  for (uint32_t i = 0; i < NUM_ALPHA; ++i)
+    {
+      double alpha = i * 0.01;
+      AlphaState &state = m_alphaStates[i];
+      state.xPrev = state.x;
+      state.x = (1 - alpha) * state.x + alpha * noisySinr;
+      state.error += std::abs (state.x - realSinr);
+    }
+}
+
+uint32_t
+MmWaveSinrFilter::GetBestAlpha (void) const
+{
+  uint32_t best = 0;
+  for (uint32_t i = 1; i < NUM_ALPHA; ++i)
+    {
+      if (m_alphaStates[i].error < m_alphaStates[best].error)
+        {
+          best = i;
+        }
+    }
+
+  // the alpha following the one with the minimum error is used, and
+  // alphas higher than 0.5 are replaced by 0.2
+  best++;
+  if (best > NUM_ALPHA / 2)
+    {
+      best = 20;
+    }
+  NS_LOG_DEBUG ("Best alpha " << best * 0.01);
+  return best;
+}
+
+} // namespace mmwave
+
+} // namespace ns3
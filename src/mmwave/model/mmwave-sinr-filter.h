@@ -0,0 +1,133 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+*   Copyright (c) 2016, University of Padova, Dep. of Information Engineering, SIGNET lab.
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License version 2 as
+*   published by the Free Software Foundation;
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#ifndef SRC_MMWAVE_MODEL_MMWAVE_SINR_FILTER_H_
+#define SRC_MMWAVE_MODEL_MMWAVE_SINR_FILTER_H_
+
+#include <stdint.h>
+#include <vector>
+
+namespace ns3 {
+
+namespace mmwave {
+
+/**
+ * \ingroup mmwave
+ *
+ * Streaming filter of the noisy SINR samples collected by the eNB for a
+ * (UE, eNB) pair, used when MmWaveEnbPhy::NoiseAndFilter is enabled.
+ *
+ * The last samples are kept in a window, which grows during the transient
+ * and then slides. When the newest sample shows a blockage (i.e., a high
+ * two-sample variance of the noisy SINR in dB, or a low SINR), the samples
+ * collected since the channel was last stable are smoothed with a linear
+ * (exponential) filter, whose coefficient alpha is the one that best tracks
+ * the real SINR in that interval. Otherwise, the noisy sample is reported.
+ *
+ * Every quantity is maintained incrementally: the two-sample variance and
+ * the stability conditions are updated with run lengths, and the filters and
+ * errors of all the candidate alphas are updated with each new sample, so
+ * that the cost of an update does not depend on the size of the window.
+ * The only exception is an interval which starts with the window after the
+ * transient: since the window slides, the filters are recomputed over the
+ * whole window at each sample, which gives the same output of filtering the
+ * window from scratch.
+ */
+class MmWaveSinrFilter
+{
+public:
+  /**
+   * Constructor
+   * \param capacity the maximum number of samples in the window
+   */
+  MmWaveSinrFilter (uint32_t capacity);
+
+  /**
+   * Add a new sample and get the SINR to report
+   * \param realSinr the real SINR (linear)
+   * \param noisySinr the noisy SINR (linear)
+   * \param transient true if the samples are still collected without filtering
+   * \return the (possibly filtered) SINR to report, in linear scale
+   */
+  double Update (double realSinr, double noisySinr, bool transient);
+
+  /**
+   * Get the number of samples currently in the window
+   * \return the number of samples in the window
+   */
+  uint32_t GetWindowSize (void) const;
+
+  static const uint32_t NUM_ALPHA = 100; //!< number of candidate alphas, i.e., 0, 0.01, ..., 0.99
+  static const uint32_t STABLE_WINDOW = 16; //!< number of samples in which the channel has to be stable to stop filtering
+
+private:
+  /**
+   * State of the linear filter for a candidate alpha
+   */
+  struct AlphaState
+  {
+    double x; //!< the filtered SINR, after the last sample
+    double xPrev; //!< the filtered SINR, before the last sample
+    double error; //!< the sum of the absolute estimation errors
+  };
+
+  /**
+   * Restart the estimation of the best alpha from a given sample, and
+   * update the filters with the samples in [start, end) of the window
+   * \param start the index of the first sample of the filtered interval
+   * \param end the index of the current sample, excluded
+   */
+  void ResetFilters (uint64_t start, uint64_t end);
+
+  /**
+   * Update the filters of all the candidate alphas with a sample
+   * \param realSinr the real SINR (linear)
+   * \param noisySinr the noisy SINR (linear)
+   */
+  void UpdateFilters (double realSinr, double noisySinr);
+
+  /**
+   * Get the index of the alpha that minimizes the estimation error
+   * \return the index of the best alpha in m_alphaStates
+   */
+  uint32_t GetBestAlpha (void) const;
+
+  uint32_t m_capacity; //!< maximum number of samples in the window
+  uint32_t m_windowLength; //!< length of the window after the transient, 0 if still in the transient
+  uint32_t m_size; //!< number of samples in the window
+  uint64_t m_numSamples; //!< number of samples added so far
+  std::vector<double> m_realSinr; //!< ring buffer of the real SINR samples
+  std::vector<double> m_noisySinr; //!< ring buffer of the noisy SINR samples
+
+  double m_lastNoisySinrDb; //!< the last noisy SINR sample, in dB
+  uint32_t m_lowVarRun; //!< number of consecutive two-sample variances lower than 1
+  uint32_t m_highSinrRun; //!< number of consecutive noisy SINR samples higher than 10 dB
+  bool m_hasStableSample; //!< true if m_stableSample is valid
+  uint64_t m_stableSample; //!< index of the last sample preceded by a stable window
+
+  bool m_filtersActive; //!< true if the filters are being updated
+  uint64_t m_filtersStart; //!< index of the sample from which the filters started
+  std::vector<AlphaState> m_alphaStates; //!< the state of the filter of each candidate alpha
+};
+
+} // namespace mmwave
+
+} // namespace ns3
+
+#endif /* SRC_MMWAVE_MODEL_MMWAVE_SINR_FILTER_H_ */
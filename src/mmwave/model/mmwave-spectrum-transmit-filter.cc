@@ -0,0 +1,121 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+*   Copyright (c) 2020 University of Padova, Dep. of Information Engineering, SIGNET lab.
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License version 2 as
+*   published by the Free Software Foundation;
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include "ns3/mmwave-spectrum-transmit-filter.h"
+#include "ns3/mmwave-spectrum-phy.h"
+#include "ns3/mmwave-enb-net-device.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/spectrum-signal-parameters.h"
+#include "ns3/double.h"
+#include "ns3/pointer.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+
+namespace mmwave {
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveSpectrumTransmitFilter");
+
+NS_OBJECT_ENSURE_REGISTERED (MmWaveSpectrumTransmitFilter);
+
+TypeId
+MmWaveSpectrumTransmitFilter::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MmWaveSpectrumTransmitFilter")
+    .SetParent<SpectrumTransmitFilter> ()
+    .AddConstructor<MmWaveSpectrumTransmitFilter> ()
+    .AddAttribute ("MinPathGainDb",
+                   "The minimum path gain in dB, as given by the PropagationLossModel, "
+                   "for which the signals are passed to the receiving PHY. "
+                   "The antenna and beamforming gains are not considered. "
+                   "The path gain is computed again by the channel for the receivers "
+                   "which are not filtered, hence the check should be used only with "
+                   "deterministic propagation loss models. "
+                   "Values lower than or equal to -1e9, as the default one, "
+                   "disable the check, i.e., all the receivers are considered.",
+                   DoubleValue (-1.0e9),
+                   MakeDoubleAccessor (&MmWaveSpectrumTransmitFilter::m_minPathGainDb),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("PropagationLossModel",
+                   "The propagation loss model used to compute the path gain",
+                   PointerValue (0),
+                   MakePointerAccessor (&MmWaveSpectrumTransmitFilter::m_propagationLoss),
+                   MakePointerChecker<PropagationLossModel> ())
+  ;
+  return tid;
+}
+
+MmWaveSpectrumTransmitFilter::MmWaveSpectrumTransmitFilter ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+MmWaveSpectrumTransmitFilter::~MmWaveSpectrumTransmitFilter ()
+{
+}
+
+void
+MmWaveSpectrumTransmitFilter::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_propagationLoss = 0;
+  SpectrumTransmitFilter::DoDispose ();
+}
+
+bool
+MmWaveSpectrumTransmitFilter::DoFilter (Ptr<const SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiverPhy) const
+{
+  NS_LOG_FUNCTION (this << params << receiverPhy);
+
+  if (DynamicCast<MmWaveSpectrumPhy> (receiverPhy) == 0)
+    {
+      return false;
+    }
+
+  // same check of MmWaveSpectrumPhy::StartRx
+  bool enbTx = DynamicCast<MmWaveEnbNetDevice> (params->txPhy->GetDevice ()) != 0;
+  bool enbRx = DynamicCast<MmWaveEnbNetDevice> (receiverPhy->GetDevice ()) != 0;
+  if (enbTx == enbRx)
+    {
+      NS_LOG_LOGIC ("BS to BS or UE to UE transmission filtered");
+      return true;
+    }
+
+  if (m_minPathGainDb > -1.0e9 && m_propagationLoss != 0)
+    {
+      Ptr<MobilityModel> txMobility = params->txPhy->GetMobility ();
+      Ptr<MobilityModel> rxMobility = receiverPhy->GetMobility ();
+      if (txMobility != 0 && rxMobility != 0)
+        {
+          // this evaluation is not reused by the channel, which computes the
+          // path gain again if the signal is not filtered
+          double pathGainDb = m_propagationLoss->CalcRxPower (0, txMobility, rxMobility);
+          if (pathGainDb < m_minPathGainDb)
+            {
+              NS_LOG_LOGIC ("Path gain " << pathGainDb << " dB below the threshold, transmission filtered");
+              return true;
+            }
+        }
+    }
+
+  return false;
+}
+
+} // namespace mmwave
+
+} // namespace ns3
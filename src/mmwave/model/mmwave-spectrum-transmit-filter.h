@@ -0,0 +1,75 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+*   Copyright (c) 2020 University of Padova, Dep. of Information Engineering, SIGNET lab.
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License version 2 as
+*   published by the Free Software Foundation;
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#ifndef SRC_MMWAVE_MODEL_MMWAVE_SPECTRUM_TRANSMIT_FILTER_H_
+#define SRC_MMWAVE_MODEL_MMWAVE_SPECTRUM_TRANSMIT_FILTER_H_
+
+#include <ns3/spectrum-transmit-filter.h>
+
+namespace ns3 {
+
+class PropagationLossModel;
+
+namespace mmwave {
+
+/**
+ * \ingroup mmwave
+ *
+ * Transmit filter for the mmWave channels. It skips, before the channel
+ * copies the signal and computes the propagation and beamforming gains:
+ * - the signals between devices with the same role (eNB to eNB and UE to
+ *   UE), which MmWaveSpectrumPhy::StartRx would discard anyway;
+ * - optionally, the signals towards receivers whose path gain, as given by
+ *   the PropagationLossModel, is lower than MinPathGainDb.
+ *
+ * Receivers which are not MmWaveSpectrumPhy instances are never filtered.
+ *
+ * The path gain of the threshold check is computed by the filter itself,
+ * and the channel computes it again for the receivers which are not
+ * filtered: the check therefore adds one PropagationLossModel evaluation
+ * per receiver, and it should be used with deterministic models only, since
+ * the two evaluations of a stochastic model (e.g., with shadowing or
+ * fading) use different random draws.
+ */
+class MmWaveSpectrumTransmitFilter : public SpectrumTransmitFilter
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  MmWaveSpectrumTransmitFilter ();
+  virtual ~MmWaveSpectrumTransmitFilter ();
+
+protected:
+  virtual void DoDispose (void) override;
+
+private:
+  virtual bool DoFilter (Ptr<const SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiverPhy) const override;
+
+  double m_minPathGainDb; //!< receivers with a lower path gain [dB] are filtered
+  Ptr<PropagationLossModel> m_propagationLoss; //!< the model used to compute the path gain
+};
+
+} // namespace mmwave
+
+} // namespace ns3
+
+#endif /* SRC_MMWAVE_MODEL_MMWAVE_SPECTRUM_TRANSMIT_FILTER_H_ */
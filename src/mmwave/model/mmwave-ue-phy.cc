@@ -744,7 +744,6 @@ MmWaveUePhy::CreateDlCqiFeedbackMessage (const SpectrumValue& sinr)
       m_amc = CreateObject <MmWaveAmc> (m_phyMacConfig);
     }
   NS_LOG_FUNCTION (this);
-  SpectrumValue newSinr = sinr;
   // CREATE DlCqiLteControlMessage
   Ptr<MmWaveDlCqiMessage> msg = Create<MmWaveDlCqiMessage> ();
   DlCqiInfo dlcqi;
@@ -758,7 +757,7 @@ MmWaveUePhy::CreateDlCqiFeedbackMessage (const SpectrumValue& sinr)
 
   NS_ASSERT (m_currTti.m_dci.m_format == 0);
   int mcs;
-  dlcqi.m_wbCqi = m_amc->CreateCqiFeedbackWbTdma (newSinr, m_currTti.m_dci.m_numSym, m_currTti.m_dci.m_tbSize, mcs);
+  dlcqi.m_wbCqi = m_amc->CreateCqiFeedbackWbTdma (sinr, m_currTti.m_dci.m_numSym, m_currTti.m_dci.m_tbSize, mcs);
 
 //	int activeSubChannels = newSinr.GetSpectrumModel()->GetNumBands ();
   /*cqi = m_amc->CreateCqiFeedbacksTdma (newSinr, m_currNumSym);
@@ -794,13 +793,14 @@ MmWaveUePhy::GenerateDlCqiReport (const SpectrumValue& sinr)
     {
       if (Simulator::Now () > m_wbCqiLast + m_wbCqiPeriod)
         {
-          SpectrumValue newSinr = sinr;
-          Ptr<MmWaveDlCqiMessage> msg = CreateDlCqiFeedbackMessage (newSinr);
+          Ptr<MmWaveDlCqiMessage> msg = CreateDlCqiFeedbackMessage (sinr);
 
           if (msg)
             {
               DoSendControlMessage (msg);
             }
+          // the trace needs a non const SINR
+          SpectrumValue newSinr = sinr;
           m_reportCurrentCellRsrpSinrTrace (m_imsi, newSinr, newSinr);
         }
     }
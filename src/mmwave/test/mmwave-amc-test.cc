@@ -0,0 +1,170 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License version 2 as
+*   published by the Free Software Foundation;
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "ns3/mmwave-amc.h"
+#include "ns3/mmwave-mi-error-model.h"
+#include "ns3/log.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/test.h"
+#include <cmath>
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveAmcTest");
+
+using namespace ns3;
+using namespace mmwave;
+
+/**
+* This test case checks that the bisection search of the wideband MCS
+* selects the same MCS of the linear search over all the MCSs
+*/
+class MmWaveAmcTestCase : public TestCase
+{
+public:
+  /**
+  * Constructor
+  */
+  MmWaveAmcTestCase ();
+
+  /**
+  * Destructor
+  */
+  virtual ~MmWaveAmcTestCase ();
+
+private:
+  /**
+  * Run the test
+  */
+  virtual void DoRun (void);
+
+  /**
+  * Select the MCS by testing all the MCSs, from the lowest one, until the
+  * TBLER exceeds 10 %. This is the reference implementation.
+  * \param sinr the SINR of the chunks
+  * \param tbSize the size of the TB, in bytes
+  * \param mcs the selected MCS
+  * \return true if no MCS guarantees the 10 % of TBLER
+  */
+  static bool GetMcsLinear (const SpectrumValue &sinr, uint32_t tbSize, int &mcs);
+};
+
+MmWaveAmcTestCase::MmWaveAmcTestCase ()
+  : TestCase ("Checks the bisection search of the wideband MCS against the linear search")
+{
+}
+
+MmWaveAmcTestCase::~MmWaveAmcTestCase ()
+{
+}
+
+bool
+MmWaveAmcTestCase::GetMcsLinear (const SpectrumValue &sinr, uint32_t tbSize, int &mcs)
+{
+  std::vector<int> chunkMap;
+  for (uint32_t i = 0; i < sinr.GetSpectrumModel ()->GetNumBands (); ++i)
+    {
+      chunkMap.push_back (i);
+    }
+
+  mcs = 0;
+  MmWaveTbStats_t tbStats;
+  while (mcs <= 28)
+    {
+      MmWaveHarqProcessInfoList_t harqInfoList;
+      tbStats = MmWaveMiErrorModel::GetTbDecodificationStats (sinr, chunkMap, tbSize, mcs, harqInfoList);
+      if (tbStats.tbler > 0.1)
+        {
+          break;
+        }
+      mcs++;
+    }
+  if (mcs > 0)
+    {
+      mcs--;
+    }
+  return (tbStats.tbler > 0.1) && (mcs == 0);
+}
+
+void
+MmWaveAmcTestCase::DoRun (void)
+{
+  Ptr<MmWavePhyMacCommon> phyMacConfig = CreateObject<MmWavePhyMacCommon> ();
+  Ptr<MmWaveAmc> amc = CreateObject<MmWaveAmc> (phyMacConfig);
+
+  std::vector<double> centerFrequencies;
+  for (uint32_t i = 0; i < 72; ++i)
+    {
+      centerFrequencies.push_back (28e9 + i * 1e6);
+    }
+  Ptr<SpectrumModel> model = Create<SpectrumModel> (centerFrequencies);
+
+  Ptr<UniformRandomVariable> uniform = CreateObject<UniformRandomVariable> ();
+  uniform->SetStream (1);
+
+  // frequency selective SINRs from -10 to 30 dB, and TBs which need one or
+  // more code blocks
+  std::vector<uint32_t> mcsCount (29, 0);
+  for (uint32_t i = 0; i < 2000; ++i)
+    {
+      double meanSinrDb = uniform->GetValue (-10, 30);
+      SpectrumValue sinr (model);
+      for (uint32_t j = 0; j < model->GetNumBands (); ++j)
+        {
+          sinr[j] = std::pow (10, (meanSinrDb + uniform->GetValue (-3, 3)) / 10);
+        }
+      uint32_t tbSize = uniform->GetInteger (10, 20000);
+
+      int expectedMcs = 0;
+      bool noMcs = GetMcsLinear (sinr, tbSize, expectedMcs);
+      int mcs = -1;
+      int cqi = amc->CreateCqiFeedbackWbTdma (sinr, 0, tbSize, mcs);
+      NS_TEST_ASSERT_MSG_EQ (mcs, expectedMcs, "Unexpected MCS for SINR " << meanSinrDb << " dB and TB size " << tbSize);
+      if (noMcs)
+        {
+          NS_TEST_ASSERT_MSG_EQ (cqi, 0, "The CQI should be 0 if no MCS guarantees the 10 % of TBLER");
+        }
+      else if (mcs == 28)
+        {
+          NS_TEST_ASSERT_MSG_EQ (cqi, 15, "The CQI should be 15 if all the MCSs guarantee the 10 % of TBLER");
+        }
+      else
+        {
+          NS_TEST_ASSERT_MSG_GT (cqi, 0, "The CQI should be positive if an MCS guarantees the 10 % of TBLER");
+        }
+      mcsCount[mcs]++;
+    }
+  NS_TEST_ASSERT_MSG_GT (mcsCount[0], 0, "The lowest MCS has never been selected");
+  NS_TEST_ASSERT_MSG_GT (mcsCount[28], 0, "The highest MCS has never been selected");
+}
+
+/**
+* This suite tests the adaptive modulation and coding
+*/
+class MmWaveAmcTest : public TestSuite
+{
+public:
+  MmWaveAmcTest ();
+};
+
+MmWaveAmcTest::MmWaveAmcTest ()
+  : TestSuite ("mmwave-amc-test", UNIT)
+{
+  // TestDuration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
+  AddTestCase (new MmWaveAmcTestCase, TestCase::QUICK);
+}
+
+// Do not forget to allocate an instance of this TestSuite
+static MmWaveAmcTest mmwaveAmcTestSuite;
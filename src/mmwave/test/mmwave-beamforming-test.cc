@@ -28,6 +28,10 @@
 #include "ns3/isotropic-antenna-model.h"
 #include "ns3/object-factory.h"
 #include "ns3/node.h"
+#include "ns3/string.h"
+#include "ns3/file-beamforming-codebook.h"
+#include "ns3/mmwave-phy-mac-common.h"
+#include "ns3/three-gpp-spectrum-propagation-loss-model.h"
 #include "simple-matrix-based-channel-model.h"
 
 NS_LOG_COMPONENT_DEFINE ("MmWaveBeamformingTest");
@@ -322,6 +326,406 @@ MmWaveSvdBeamformingTestCase::DoRun (void)
     }
 }
 
+/**
+* This test case checks that the bf vectors computed by MmWaveSvdBeamforming
+* with the default attributes are the dominant singular vectors of a
+* multipath channel, also when the computation starts from the bf vectors of
+* the previous channel
+*/
+class MmWaveSvdMultipathBeamformingTestCase : public TestCase
+{
+public:
+  /**
+  * Constructor
+  */
+  MmWaveSvdMultipathBeamformingTestCase ();
+
+  /**
+  * Destructor
+  */
+  virtual ~MmWaveSvdMultipathBeamformingTestCase ();
+
+private:
+  /**
+  * Run the test
+  */
+  virtual void DoRun (void);
+
+  /**
+  * Check the bf vectors of a device pair with antenna arrays of the given sizes
+  * \param txSize the number of rows and columns of the tx array
+  * \param rxSize the number of rows and columns of the rx array
+  */
+  void CheckBeamforming (uint32_t txSize, uint32_t rxSize);
+
+  /**
+  * Compute the dominant right singular vector of the narrowband channel
+  * with many iterations of the power method on H^H H
+  * \param channel the channel matrix
+  * \return the singular vector
+  */
+  static PhasedArrayModel::ComplexVector GetReferenceVector (Ptr<const MatrixBasedChannelModel::ChannelMatrix> channel);
+};
+
+MmWaveSvdMultipathBeamformingTestCase::MmWaveSvdMultipathBeamformingTestCase ()
+  : TestCase ("Checks the MmWaveSvdBeamforming bf vectors of multipath channels")
+{
+}
+
+MmWaveSvdMultipathBeamformingTestCase::~MmWaveSvdMultipathBeamformingTestCase ()
+{
+}
+
+PhasedArrayModel::ComplexVector
+MmWaveSvdMultipathBeamformingTestCase::GetReferenceVector (Ptr<const MatrixBasedChannelModel::ChannelMatrix> channel)
+{
+  uint32_t uSize = channel->m_channel.GetUSize ();
+  uint32_t sSize = channel->m_channel.GetSSize ();
+  MatrixBasedChannelModel::Complex2DVector h (uSize, PhasedArrayModel::ComplexVector (sSize));
+  for (uint32_t u = 0; u < uSize; ++u)
+    {
+      for (uint32_t s = 0; s < sSize; ++s)
+        {
+          for (uint32_t c = 0; c < channel->m_channel.GetNumClusters (); ++c)
+            {
+              h[u][s] += channel->m_channel (u, s, c);
+            }
+        }
+    }
+
+  PhasedArrayModel::ComplexVector v (sSize, 1.0);
+  for (uint32_t iter = 0; iter < 2000; ++iter)
+    {
+      PhasedArrayModel::ComplexVector hv (uSize);
+      for (uint32_t u = 0; u < uSize; ++u)
+        {
+          for (uint32_t s = 0; s < sSize; ++s)
+            {
+              hv[u] += h[u][s] * v[s];
+            }
+        }
+      double norm = 0;
+      for (uint32_t s = 0; s < sSize; ++s)
+        {
+          v[s] = 0;
+          for (uint32_t u = 0; u < uSize; ++u)
+            {
+              v[s] += std::conj (h[u][s]) * hv[u];
+            }
+          norm += std::norm (v[s]);
+        }
+      for (uint32_t s = 0; s < sSize; ++s)
+        {
+          v[s] /= std::sqrt (norm);
+        }
+    }
+  return v;
+}
+
+void
+MmWaveSvdMultipathBeamformingTestCase::CheckBeamforming (uint32_t txSize, uint32_t rxSize)
+{
+  Ptr<MobilityModel> txMob = CreateObject<ConstantPositionMobilityModel> ();
+  txMob->SetPosition (Vector (0, 0, 0));
+  Ptr<Node> txNode = CreateObject<Node> ();
+  txNode->AggregateObject (txMob);
+  Ptr<NetDevice> txDevice = CreateObject<SimpleNetDevice> ();
+  txDevice->SetNode (txNode);
+  txNode->AddDevice (txDevice);
+  Ptr<PhasedArrayModel> txAntenna = CreateObjectWithAttributes<UniformPlanarArray> ("NumRows", UintegerValue (txSize),
+                                                                                    "NumColumns", UintegerValue (txSize),
+                                                                                    "AntennaElement", PointerValue (CreateObject<IsotropicAntennaModel> ()));
+
+  Ptr<MobilityModel> rxMob = CreateObject<ConstantPositionMobilityModel> ();
+  rxMob->SetPosition (Vector (10, 0, 0));
+  Ptr<Node> rxNode = CreateObject<Node> ();
+  rxNode->AggregateObject (rxMob);
+  Ptr<NetDevice> rxDevice = CreateObject<SimpleNetDevice> ();
+  rxDevice->SetNode (rxNode);
+  rxNode->AddDevice (rxDevice);
+  Ptr<PhasedArrayModel> rxAntenna = CreateObjectWithAttributes<UniformPlanarArray> ("NumRows", UintegerValue (rxSize),
+                                                                                    "NumColumns", UintegerValue (rxSize),
+                                                                                    "AntennaElement", PointerValue (CreateObject<IsotropicAntennaModel> ()));
+
+  // four paths, the strongest ones have similar powers
+  Ptr<SimpleMatrixBasedChannelModel> channelModel = CreateObject<SimpleMatrixBasedChannelModel> ();
+  channelModel->SetAodAzimuth ({10, -30, 50, 80});
+  channelModel->SetAodElevation ({90, 80, 100, 70});
+  channelModel->SetAoaAzimuth ({170, -150, 120, 30});
+  channelModel->SetAoaElevation ({90, 100, 80, 60});
+  channelModel->SetPhaseShift ({0, 1, 2, 3});
+  channelModel->SetPathLoss ({0, 1, 6, 10});
+  channelModel->SetDelay ({0, 1e-8, 2e-8, 3e-8});
+
+  Ptr<MmWaveSvdBeamforming> bfModule = CreateObjectWithAttributes<MmWaveSvdBeamforming> ("Device", PointerValue (txDevice),
+                                                                                         "Antenna", PointerValue (txAntenna),
+                                                                                         "ChannelModel", PointerValue (channelModel));
+
+  // the second channel is a small perturbation of the first one, its bf
+  // vectors are computed starting from the previous ones
+  for (uint32_t realization = 0; realization < 2; ++realization)
+    {
+      if (realization == 1)
+        {
+          channelModel->SetAodAzimuth ({12, -31, 50, 80});
+          channelModel->SetAoaAzimuth ({168, -151, 120, 30});
+          channelModel->SetPhaseShift ({0.3, 1.2, 2, 3});
+        }
+
+      bfModule->SetBeamformingVectorForDevice (rxDevice, rxAntenna);
+      PhasedArrayModel::ComplexVector txBfVector = txAntenna->GetBeamformingVector ();
+      PhasedArrayModel::ComplexVector rxBfVector = rxAntenna->GetBeamformingVector ();
+
+      Ptr<const MatrixBasedChannelModel::ChannelMatrix> channel = channelModel->GetChannel (txMob, rxMob, txAntenna, rxAntenna);
+      PhasedArrayModel::ComplexVector v = GetReferenceVector (channel);
+
+      // u = H v / |H v|, the rx bf vector is its conjugate
+      PhasedArrayModel::ComplexVector u (rxBfVector.size ());
+      double uNorm = 0;
+      for (uint32_t i = 0; i < u.size (); ++i)
+        {
+          for (uint32_t j = 0; j < v.size (); ++j)
+            {
+              for (uint32_t c = 0; c < channel->m_channel.GetNumClusters (); ++c)
+                {
+                  u[i] += channel->m_channel (i, j, c) * v[j];
+                }
+            }
+          uNorm += std::norm (u[i]);
+        }
+
+      // the bf vectors are equal to the reference ones minus a constant phase
+      std::complex<double> txProduct (0, 0);
+      for (uint32_t j = 0; j < v.size (); ++j)
+        {
+          txProduct += std::conj (v[j]) * txBfVector[j];
+        }
+      std::complex<double> rxProduct (0, 0);
+      for (uint32_t i = 0; i < u.size (); ++i)
+        {
+          rxProduct += u[i] * rxBfVector[i];
+        }
+      NS_TEST_ASSERT_MSG_EQ_TOL (std::abs (txProduct), 1, 1e-6, "TX beamforming vector different from the dominant singular vector");
+      NS_TEST_ASSERT_MSG_EQ_TOL (std::abs (rxProduct) / std::sqrt (uNorm), 1, 1e-6, "RX beamforming vector different from the dominant singular vector");
+    }
+}
+
+void
+MmWaveSvdMultipathBeamformingTestCase::DoRun (void)
+{
+  // the eigenvector is computed for the smaller array, on either side of the channel
+  CheckBeamforming (8, 4);
+  CheckBeamforming (4, 8);
+}
+
+/**
+* This test case checks if the batched beam-pair search of
+* MmWaveCodebookBeamforming selects the same beam pair as the search based on
+* the SpectrumPropagationLossModel
+*/
+class MmWaveCodebookBeamformingTestCase : public TestCase
+{
+public:
+  /**
+  * Constructor
+  */
+  MmWaveCodebookBeamformingTestCase ();
+
+  /**
+  * Destructor
+  */
+  virtual ~MmWaveCodebookBeamformingTestCase ();
+
+private:
+  /**
+  * Run the test
+  */
+  virtual void DoRun (void);
+
+  /**
+  * Runs the codebook-based beamforming and returns the gain of the selected beam pair
+  * \param batched if true, use the batched beam-pair search
+  * \param multipath if true, the channel has several clusters with different
+  *        delays, otherwise it has a single cluster
+  * \param bestGain the highest gain among all the pairs of codewords
+  * \return the gain sum_n |w_rx^T H_n w_tx|^2 of the selected beam pair
+  */
+  double GetSelectedBeamPairGain (bool batched, bool multipath, double &bestGain) const;
+
+  /**
+  * Compute the gain of a beam pair
+  * \param channel the channel matrix, H[rx][tx][cluster]
+  * \param rxBfVector the rx bf vector
+  * \param txBfVector the tx bf vector
+  * \return the gain sum_n |w_rx^T H_n w_tx|^2
+  */
+  static double GetBeamPairGain (Ptr<const MatrixBasedChannelModel::ChannelMatrix> channel,
+                                 const PhasedArrayModel::ComplexVector &rxBfVector,
+                                 const PhasedArrayModel::ComplexVector &txBfVector);
+};
+
+MmWaveCodebookBeamformingTestCase::MmWaveCodebookBeamformingTestCase ()
+  : TestCase ("Checks if the batched search of MmWaveCodebookBeamforming works as expected")
+{
+}
+
+MmWaveCodebookBeamformingTestCase::~MmWaveCodebookBeamformingTestCase ()
+{
+}
+
+double
+MmWaveCodebookBeamformingTestCase::GetBeamPairGain (Ptr<const MatrixBasedChannelModel::ChannelMatrix> channel,
+                                                    const PhasedArrayModel::ComplexVector &rxBfVector,
+                                                    const PhasedArrayModel::ComplexVector &txBfVector)
+{
+  double gain = 0;
+  for (uint32_t cIndex = 0; cIndex < channel->m_channel.GetNumClusters (); cIndex++)
+    {
+      std::complex<double> clusterGain (0, 0);
+      for (uint32_t rxIndex = 0; rxIndex < rxBfVector.size (); rxIndex++)
+        {
+          for (uint32_t txIndex = 0; txIndex < txBfVector.size (); txIndex++)
+            {
+              clusterGain += rxBfVector[rxIndex] * channel->m_channel (rxIndex, txIndex, cIndex) * txBfVector[txIndex];
+            }
+        }
+      gain += std::norm (clusterGain);
+    }
+  return gain;
+}
+
+double
+MmWaveCodebookBeamformingTestCase::GetSelectedBeamPairGain (bool batched, bool multipath, double &bestGain) const
+{
+  // Create the tx and rx nodes
+  Ptr<MobilityModel> txMob = CreateObject<ConstantPositionMobilityModel> ();
+  txMob->SetPosition (Vector (0, 0, 0));
+  Ptr<Node> txNode = CreateObject<Node> ();
+  txNode->AggregateObject (txMob);
+  Ptr<NetDevice> txDevice = CreateObject<SimpleNetDevice> ();
+  txDevice->SetNode (txNode);
+  txNode->AddDevice (txDevice);
+
+  Ptr<MobilityModel> rxMob = CreateObject<ConstantPositionMobilityModel> ();
+  rxMob->SetPosition (Vector (10, 0, 0));
+  Ptr<Node> rxNode = CreateObject<Node> ();
+  rxNode->AggregateObject (rxMob);
+  Ptr<NetDevice> rxDevice = CreateObject<SimpleNetDevice> ();
+  rxDevice->SetNode (rxNode);
+  rxNode->AddDevice (rxDevice);
+
+  // Create the antennas
+  Ptr<PhasedArrayModel> txAntenna = CreateObjectWithAttributes<UniformPlanarArray> ("NumRows", UintegerValue (4),
+                                                                                    "NumColumns", UintegerValue (4),
+                                                                                    "AntennaElement", PointerValue (CreateObject<IsotropicAntennaModel> ()));
+  Ptr<PhasedArrayModel> rxAntenna = CreateObjectWithAttributes<UniformPlanarArray> ("NumRows", UintegerValue (2),
+                                                                                    "NumColumns", UintegerValue (2),
+                                                                                    "AntennaElement", PointerValue (CreateObject<IsotropicAntennaModel> ()));
+
+  // With a single cluster the two searches are expected to select a beam
+  // pair with the same gain. With many clusters, the frequency-selective
+  // rx PSD of the non-batched search differs from the per-cluster power sum
+  // of the batched search. The first two clusters have the same angles and
+  // opposite phases, so that the strongest pair for the power sum is the
+  // weakest one for the coherent sum of the clusters.
+  Ptr<SimpleMatrixBasedChannelModel> channelModel = CreateObject<SimpleMatrixBasedChannelModel> ();
+  if (multipath)
+    {
+      channelModel->SetAodAzimuth ({30, 30, -40, 100});
+      channelModel->SetAodElevation ({70, 70, 95, 80});
+      channelModel->SetAoaAzimuth ({200, 200, 150, -20});
+      channelModel->SetAoaElevation ({100, 100, 85, 70});
+      channelModel->SetPhaseShift ({0, M_PI, 0.7, 4.2});
+      channelModel->SetPathLoss ({0, 0, 1, 6});
+      channelModel->SetDelay ({0, 5e-8, 2e-8, 1.3e-7});
+    }
+  else
+    {
+      channelModel->SetAodAzimuth ({30});
+      channelModel->SetAodElevation ({70});
+      channelModel->SetAoaAzimuth ({200});
+      channelModel->SetAoaElevation ({100});
+      channelModel->SetPhaseShift ({0});
+      channelModel->SetPathLoss ({0});
+      channelModel->SetDelay ({0});
+    }
+
+  // set the channel model at construction, so that the default one is not
+  // created
+  Ptr<ThreeGppSpectrumPropagationLossModel> splm = CreateObjectWithAttributes<ThreeGppSpectrumPropagationLossModel> ("ChannelModel", PointerValue (channelModel));
+  splm->AddDevice (txDevice, txAntenna);
+  splm->AddDevice (rxDevice, rxAntenna);
+
+  Ptr<MmWavePhyMacCommon> phyMacCommon = CreateObject<MmWavePhyMacCommon> ();
+
+  ObjectFactory txCbFactory (FileBeamformingCodebook::GetTypeId ().GetName ());
+  txCbFactory.Set ("CodebookFilename", StringValue ("src/mmwave/model/Codebooks/4x4.txt"));
+  ObjectFactory rxCbFactory (FileBeamformingCodebook::GetTypeId ().GetName ());
+  rxCbFactory.Set ("CodebookFilename", StringValue ("src/mmwave/model/Codebooks/2x2.txt"));
+
+  Ptr<MmWaveCodebookBeamforming> txBfModule = CreateObjectWithAttributes<MmWaveCodebookBeamforming> ("Device", PointerValue (txDevice),
+                                                                                                      "Antenna", PointerValue (txAntenna),
+                                                                                                      "SpectrumPropagationLossModel", PointerValue (splm),
+                                                                                                      "MmWavePhyMacCommon", PointerValue (phyMacCommon),
+                                                                                                      "ChannelModel", PointerValue (channelModel),
+                                                                                                      "BatchedSearch", BooleanValue (batched));
+  txBfModule->SetBeamformingCodebookFactory (txCbFactory);
+  txBfModule->Initialize ();
+
+  // the rx module is only needed to attach the codebook to the rx antenna
+  Ptr<MmWaveCodebookBeamforming> rxBfModule = CreateObjectWithAttributes<MmWaveCodebookBeamforming> ("Device", PointerValue (rxDevice),
+                                                                                                      "Antenna", PointerValue (rxAntenna));
+  rxBfModule->SetBeamformingCodebookFactory (rxCbFactory);
+  rxBfModule->Initialize ();
+
+  txBfModule->SetBeamformingVectorForDevice (rxDevice, rxAntenna);
+  PhasedArrayModel::ComplexVector txBfVector = txAntenna->GetBeamformingVector ();
+  PhasedArrayModel::ComplexVector rxBfVector = rxAntenna->GetBeamformingVector ();
+
+  // compute the gain of the selected beam pair and of all the pairs of
+  // codewords, H[rx][tx][cluster]
+  Ptr<const MatrixBasedChannelModel::ChannelMatrix> channelMatrix = channelModel->GetChannel (txMob, rxMob, txAntenna, rxAntenna);
+  double gain = GetBeamPairGain (channelMatrix, rxBfVector, txBfVector);
+
+  Ptr<BeamformingCodebook> txCodebook = txAntenna->GetObject<BeamformingCodebook> ();
+  Ptr<BeamformingCodebook> rxCodebook = rxAntenna->GetObject<BeamformingCodebook> ();
+  bestGain = 0;
+  for (uint32_t txCwIndex = 0; txCwIndex < txCodebook->GetCodebookSize (); txCwIndex++)
+    {
+      for (uint32_t rxCwIndex = 0; rxCwIndex < rxCodebook->GetCodebookSize (); rxCwIndex++)
+        {
+          bestGain = std::max (bestGain, GetBeamPairGain (channelMatrix,
+                                                          rxCodebook->GetCodeword (rxCwIndex),
+                                                          txCodebook->GetCodeword (txCwIndex)));
+        }
+    }
+
+  splm->Dispose ();
+  return gain;
+}
+
+void
+MmWaveCodebookBeamformingTestCase::DoRun (void)
+{
+  double bestGain;
+  double refGain = GetSelectedBeamPairGain (false, false, bestGain);
+  double batchedGain = GetSelectedBeamPairGain (true, false, bestGain);
+
+  NS_LOG_DEBUG ("reference gain " << refGain << " batched gain " << batchedGain);
+  NS_TEST_ASSERT_MSG_GT (refGain, 0.0, "The selected beam pair should have a positive gain");
+  NS_TEST_ASSERT_MSG_EQ_TOL (batchedGain, refGain, 1e-9 * refGain,
+                             "The batched search should select a beam pair with the same gain");
+  NS_TEST_ASSERT_MSG_EQ_TOL (batchedGain, bestGain, 1e-9 * bestGain,
+                             "The batched search should select the pair with the highest gain");
+
+  // with many clusters, the batched search maximizes the per-cluster power sum
+  batchedGain = GetSelectedBeamPairGain (true, true, bestGain);
+  NS_LOG_DEBUG ("multipath batched gain " << batchedGain << " best gain " << bestGain);
+  NS_TEST_ASSERT_MSG_GT (bestGain, 0.0, "The best beam pair should have a positive gain");
+  NS_TEST_ASSERT_MSG_EQ_TOL (batchedGain, bestGain, 1e-9 * bestGain,
+                             "The batched search should select the pair with the highest multipath gain");
+}
+
 /**
 * This suite tests if the beamforming module works properly
 */
@@ -337,6 +741,8 @@ MmWaveBeamformingTest::MmWaveBeamformingTest ()
   // TestDuration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
   AddTestCase (new MmWaveDftBeamformingTestCase, TestCase::QUICK);
   AddTestCase (new MmWaveSvdBeamformingTestCase, TestCase::QUICK);
+  AddTestCase (new MmWaveSvdMultipathBeamformingTestCase, TestCase::QUICK);
+  AddTestCase (new MmWaveCodebookBeamformingTestCase, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite
@@ -0,0 +1,166 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License version 2 as
+*   published by the Free Software Foundation;
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "ns3/mmwave-bearer-stats-calculator.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+#include <cstdio>
+#include <fstream>
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveBearerStatsTest");
+
+using namespace ns3;
+using namespace mmwave;
+
+/**
+* This test case notifies the PDUs of many bearers to the
+* MmWaveBearerStatsCalculator, and checks the per-bearer statistics and the
+* number of lines written to the output files
+*/
+class MmWaveBearerStatsTestCase : public TestCase
+{
+public:
+  /**
+  * Constructor
+  */
+  MmWaveBearerStatsTestCase ();
+
+  /**
+  * Destructor
+  */
+  virtual ~MmWaveBearerStatsTestCase ();
+
+private:
+  /**
+  * Run the test
+  */
+  virtual void DoRun (void);
+
+  /**
+  * Count the lines of a file
+  * \param fileName the name of the file
+  * \return the number of lines
+  */
+  static uint32_t CountLines (std::string fileName);
+};
+
+MmWaveBearerStatsTestCase::MmWaveBearerStatsTestCase ()
+  : TestCase ("Checks the per-bearer statistics of MmWaveBearerStatsCalculator")
+{
+}
+
+MmWaveBearerStatsTestCase::~MmWaveBearerStatsTestCase ()
+{
+}
+
+uint32_t
+MmWaveBearerStatsTestCase::CountLines (std::string fileName)
+{
+  std::ifstream file (fileName.c_str ());
+  std::string line;
+  uint32_t numLines = 0;
+  while (std::getline (file, line))
+    {
+      numLines++;
+    }
+  return numLines;
+}
+
+void
+MmWaveBearerStatsTestCase::DoRun (void)
+{
+  std::string ulFileName = CreateTempDirFilename ("mmwave-bearer-stats-test-ul.txt");
+  std::string dlFileName = CreateTempDirFilename ("mmwave-bearer-stats-test-dl.txt");
+  Ptr<MmWaveBearerStatsCalculator> calculator = CreateObject<MmWaveBearerStatsCalculator> ();
+  calculator->SetDlOutputFilename (dlFileName);
+  calculator->SetUlOutputFilename (ulFileName);
+
+  // IMSI i has i + 1 PDUs of 100 * lcid bytes on each of its two LCIDs,
+  // the DL PDUs are received with a delay of 1000 * (j + 1) ns
+  const uint32_t numUes = 200;
+  uint32_t numPdus = 0;
+  for (uint64_t imsi = 1; imsi <= numUes; ++imsi)
+    {
+      for (uint8_t lcid = 3; lcid <= 4; ++lcid)
+        {
+          for (uint32_t j = 0; j <= imsi; ++j)
+            {
+              calculator->DlTxPdu (1, imsi, imsi + 100, lcid, 100 * lcid);
+              calculator->DlRxPdu (1, imsi, imsi + 100, lcid, 100 * lcid, 1000 * (j + 1));
+              calculator->UlTxPdu (2, imsi, imsi + 100, lcid, 100 * lcid);
+              numPdus++;
+            }
+        }
+    }
+
+  for (uint64_t imsi = 1; imsi <= numUes; ++imsi)
+    {
+      for (uint8_t lcid = 3; lcid <= 4; ++lcid)
+        {
+          uint32_t n = imsi + 1;
+          NS_TEST_ASSERT_MSG_EQ (calculator->GetDlTxPackets (imsi, lcid), n, "Unexpected DL TX packets");
+          NS_TEST_ASSERT_MSG_EQ (calculator->GetDlRxPackets (imsi, lcid), n, "Unexpected DL RX packets");
+          NS_TEST_ASSERT_MSG_EQ (calculator->GetDlTxData (imsi, lcid), n * 100 * lcid, "Unexpected DL TX data");
+          NS_TEST_ASSERT_MSG_EQ (calculator->GetDlCellId (imsi, lcid), 1, "Unexpected DL cell ID");
+          NS_TEST_ASSERT_MSG_EQ (calculator->GetUlTxPackets (imsi, lcid), n, "Unexpected UL TX packets");
+          NS_TEST_ASSERT_MSG_EQ (calculator->GetUlRxPackets (imsi, lcid), 0, "Unexpected UL RX packets");
+          NS_TEST_ASSERT_MSG_EQ (calculator->GetUlCellId (imsi, lcid), 2, "Unexpected UL cell ID");
+
+          std::vector<double> delayStats = calculator->GetDlDelayStats (imsi, lcid);
+          NS_TEST_ASSERT_MSG_EQ_TOL (delayStats[0], 1000.0 * (n + 1) / 2, 1e-6, "Unexpected average DL delay");
+          NS_TEST_ASSERT_MSG_EQ_TOL (delayStats[2], 1000.0, 1e-6, "Unexpected minimum DL delay");
+          NS_TEST_ASSERT_MSG_EQ_TOL (delayStats[3], 1000.0 * n, 1e-6, "Unexpected maximum DL delay");
+          std::vector<double> sizeStats = calculator->GetDlPduSizeStats (imsi, lcid);
+          NS_TEST_ASSERT_MSG_EQ_TOL (sizeStats[0], 100.0 * lcid, 1e-6, "Unexpected average DL PDU size");
+          NS_TEST_ASSERT_MSG_EQ_TOL (sizeStats[1], 0.0, 1e-6, "Unexpected DL PDU size deviation");
+        }
+    }
+  std::vector<double> noStats = calculator->GetUlDelayStats (1, 3);
+  NS_TEST_ASSERT_MSG_EQ (noStats.size (), 4, "The UL delay statistics should have 4 values");
+  NS_TEST_ASSERT_MSG_EQ (noStats[0], 0.0, "No UL PDU has been received");
+  NS_TEST_ASSERT_MSG_EQ (calculator->GetDlTxPackets (numUes + 1, 3), 0, "The bearer does not exist");
+
+  // the lines are flushed when the simulator is destroyed
+  Simulator::Destroy ();
+  NS_TEST_ASSERT_MSG_EQ (CountLines (dlFileName), 2 * numPdus, "Unexpected number of DL lines");
+  NS_TEST_ASSERT_MSG_EQ (CountLines (ulFileName), numPdus, "Unexpected number of UL lines");
+
+  calculator->Dispose ();
+  calculator = 0;
+  std::remove (ulFileName.c_str ());
+  std::remove (dlFileName.c_str ());
+}
+
+/**
+* This suite tests the bearer statistics
+*/
+class MmWaveBearerStatsTest : public TestSuite
+{
+public:
+  MmWaveBearerStatsTest ();
+};
+
+MmWaveBearerStatsTest::MmWaveBearerStatsTest ()
+  : TestSuite ("mmwave-bearer-stats-test", UNIT)
+{
+  // TestDuration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
+  AddTestCase (new MmWaveBearerStatsTestCase, TestCase::QUICK);
+}
+
+// Do not forget to allocate an instance of this TestSuite
+static MmWaveBearerStatsTest mmwaveBearerStatsTestSuite;
@@ -0,0 +1,191 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License version 2 as
+*   published by the Free Software Foundation;
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "ns3/mmwave-binary-trace.h"
+#include "ns3/log.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/test.h"
+#include <cstdio>
+#include <sstream>
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveBinaryTraceTest");
+
+using namespace ns3;
+using namespace mmwave;
+
+/**
+* This test case writes random records to a binary trace, through buffers
+* smaller than the trace, and checks that the conversion of the binary file
+* gives the same text of the text trace
+*/
+class MmWaveBinaryTraceTestCase : public TestCase
+{
+public:
+  /**
+  * Constructor
+  */
+  MmWaveBinaryTraceTestCase ();
+
+  /**
+  * Destructor
+  */
+  virtual ~MmWaveBinaryTraceTestCase ();
+
+private:
+  /**
+  * Run the test
+  */
+  virtual void DoRun (void);
+
+  /**
+  * Write random records to a binary file and to a text stream, and compare
+  * the conversion of the binary file with the text
+  * \param numRecords the number of records
+  * \param createRecord the function which creates a random record
+  */
+  template <class T>
+  void CheckConversion (uint32_t numRecords, T (MmWaveBinaryTraceTestCase::*createRecord) (void));
+
+  /**
+  * \return a random PHY transmission record
+  */
+  MmWaveTtiTraceRecord CreateTtiRecord (void);
+
+  /**
+  * \return a random PHY reception record
+  */
+  MmWaveRxPacketTraceRecord CreateRxPacketRecord (void);
+
+  Ptr<UniformRandomVariable> m_uniform; //!< random variable used to generate the records
+};
+
+MmWaveBinaryTraceTestCase::MmWaveBinaryTraceTestCase ()
+  : TestCase ("Checks that the binary traces are converted to the text traces")
+{
+}
+
+MmWaveBinaryTraceTestCase::~MmWaveBinaryTraceTestCase ()
+{
+}
+
+MmWaveTtiTraceRecord
+MmWaveBinaryTraceTestCase::CreateTtiRecord (void)
+{
+  MmWaveTtiTraceRecord record;
+  record.m_frameNum = m_uniform->GetInteger (0, 1023);
+  record.m_sfNum = m_uniform->GetInteger (0, 9);
+  record.m_slotNum = m_uniform->GetInteger (0, 7);
+  record.m_rnti = m_uniform->GetInteger (0, 65535);
+  record.m_symStart = m_uniform->GetInteger (0, 23);
+  record.m_numSym = m_uniform->GetInteger (1, 24);
+  record.m_ttiType = m_uniform->GetInteger (0, 2);
+  record.m_tddMode = m_uniform->GetInteger (0, 1);
+  record.m_rv = m_uniform->GetInteger (0, 3);
+  record.m_ccId = m_uniform->GetInteger (0, 255);
+  return record;
+}
+
+MmWaveRxPacketTraceRecord
+MmWaveBinaryTraceTestCase::CreateRxPacketRecord (void)
+{
+  MmWaveRxPacketTraceRecord record;
+  record.m_downlink = m_uniform->GetInteger (0, 1);
+  record.m_time = m_uniform->GetValue (0, 100);
+  record.m_frameNum = m_uniform->GetInteger (0, 1023);
+  record.m_sfNum = m_uniform->GetInteger (0, 9);
+  record.m_slotNum = m_uniform->GetInteger (0, 7);
+  record.m_symStart = m_uniform->GetInteger (0, 23);
+  record.m_numSym = m_uniform->GetInteger (1, 24);
+  record.m_cellId = m_uniform->GetInteger (1, 100);
+  record.m_rnti = m_uniform->GetInteger (0, 65535);
+  record.m_ccId = m_uniform->GetInteger (0, 3);
+  record.m_tbSize = m_uniform->GetInteger (0, 100000);
+  record.m_mcs = m_uniform->GetInteger (0, 28);
+  record.m_rv = m_uniform->GetInteger (0, 3);
+  record.m_sinrDb = m_uniform->GetValue (-20, 40);
+  record.m_corrupt = m_uniform->GetInteger (0, 1);
+  record.m_tbler = m_uniform->GetValue (0, 1);
+  return record;
+}
+
+template <class T>
+void
+MmWaveBinaryTraceTestCase::CheckConversion (uint32_t numRecords, T (MmWaveBinaryTraceTestCase::*createRecord) (void))
+{
+  std::string fileName = CreateTempDirFilename ("mmwave-binary-trace-test.bin");
+  std::ostringstream expected;
+  expected << T::GetHeader () << "\n";
+  {
+    // the buffers hold 100 records, so that the background thread writes
+    // many of them
+    MmWaveBinaryTraceWriter writer (fileName, T::TYPE, sizeof (T), 100 * sizeof (T));
+    for (uint32_t i = 0; i < numRecords; ++i)
+      {
+        T record = (this->*createRecord) ();
+        record.Print (expected);
+        writer.Write (record);
+        if (i == numRecords / 2)
+          {
+            writer.Flush ();
+          }
+      }
+  }
+
+  std::ostringstream converted;
+  bool success = MmWaveBinaryTraceWriter::ConvertToText (fileName, converted);
+  NS_TEST_ASSERT_MSG_EQ (success, true, "The binary trace could not be converted");
+  NS_TEST_ASSERT_MSG_EQ ((converted.str () == expected.str ()), true, "The converted trace differs from the text trace");
+  std::remove (fileName.c_str ());
+}
+
+void
+MmWaveBinaryTraceTestCase::DoRun (void)
+{
+  m_uniform = CreateObject<UniformRandomVariable> ();
+  m_uniform->SetStream (1);
+
+  CheckConversion<MmWaveTtiTraceRecord> (10000, &MmWaveBinaryTraceTestCase::CreateTtiRecord);
+  CheckConversion<MmWaveRxPacketTraceRecord> (10000, &MmWaveBinaryTraceTestCase::CreateRxPacketRecord);
+
+  // a file which is not a binary trace
+  std::string fileName = CreateTempDirFilename ("mmwave-binary-trace-test.txt");
+  std::ofstream file (fileName.c_str ());
+  file << MmWaveTtiTraceRecord::GetHeader () << "\n";
+  file.close ();
+  std::ostringstream converted;
+  NS_TEST_ASSERT_MSG_EQ (MmWaveBinaryTraceWriter::ConvertToText (fileName, converted), false, "A text trace should not be converted");
+  std::remove (fileName.c_str ());
+}
+
+/**
+* This suite tests the binary traces
+*/
+class MmWaveBinaryTraceTest : public TestSuite
+{
+public:
+  MmWaveBinaryTraceTest ();
+};
+
+MmWaveBinaryTraceTest::MmWaveBinaryTraceTest ()
+  : TestSuite ("mmwave-binary-trace-test", UNIT)
+{
+  // TestDuration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
+  AddTestCase (new MmWaveBinaryTraceTestCase, TestCase::QUICK);
+}
+
+// Do not forget to allocate an instance of this TestSuite
+static MmWaveBinaryTraceTest mmwaveBinaryTraceTestSuite;
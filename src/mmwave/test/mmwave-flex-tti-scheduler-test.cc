@@ -0,0 +1,204 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License version 2 as
+*   published by the Free Software Foundation;
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "ns3/mmwave-flex-tti-maxrate-mac-scheduler.h"
+#include "ns3/mmwave-phy-mac-common.h"
+#include "ns3/boolean.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+#include <map>
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveFlexTtiSchedulerTest");
+
+using namespace ns3;
+using namespace mmwave;
+
+/**
+* MmWaveMacSchedSapUser which stores the last allocation of the scheduler
+*/
+class MmWaveTestMacSchedSapUser : public MmWaveMacSchedSapUser
+{
+public:
+  virtual void SchedConfigInd (const struct SchedConfigIndParameters& params)
+  {
+    m_params = params;
+  }
+
+  SchedConfigIndParameters m_params; //!< the last allocation
+};
+
+/**
+* This test case checks the allocation of the flex-TTI scheduler: the HARQ
+* retransmissions are served first, and the symbols left are split among the
+* UEs with the same metric, with the extra symbols given to the lowest RNTIs
+*/
+class MmWaveFlexTtiSchedulerTestCase : public TestCase
+{
+public:
+  /**
+  * Constructor
+  */
+  MmWaveFlexTtiSchedulerTestCase ();
+
+  /**
+  * Destructor
+  */
+  virtual ~MmWaveFlexTtiSchedulerTestCase ();
+
+private:
+  /**
+  * Run the test
+  */
+  virtual void DoRun (void);
+
+  /**
+  * Collect the DL data TTIs of an allocation
+  * \param params the allocation
+  * \param retx if true, the retransmissions are collected, otherwise the new transmissions
+  * \return the DCIs of the TTIs, indexed by RNTI
+  */
+  static std::map<uint16_t, DciInfoElementTdma> GetDlDcis (const MmWaveMacSchedSapUser::SchedConfigIndParameters &params, bool retx);
+};
+
+MmWaveFlexTtiSchedulerTestCase::MmWaveFlexTtiSchedulerTestCase ()
+  : TestCase ("Check the symbol split, the RNTI tie break and the HARQ priority of the flex-TTI scheduler")
+{
+}
+
+MmWaveFlexTtiSchedulerTestCase::~MmWaveFlexTtiSchedulerTestCase ()
+{
+}
+
+std::map<uint16_t, DciInfoElementTdma>
+MmWaveFlexTtiSchedulerTestCase::GetDlDcis (const MmWaveMacSchedSapUser::SchedConfigIndParameters &params, bool retx)
+{
+  std::map<uint16_t, DciInfoElementTdma> dcis;
+  for (const TtiAllocInfo &tti : params.m_slotAllocInfo.m_ttiAllocInfo)
+    {
+      if (tti.m_tddMode == TtiAllocInfo::DL_slotAllocInfo && tti.m_ttiType == TtiAllocInfo::CTRL_DATA
+          && (tti.m_dci.m_rv > 0) == retx)
+        {
+          dcis[tti.m_rnti] = tti.m_dci;
+        }
+    }
+  return dcis;
+}
+
+void
+MmWaveFlexTtiSchedulerTestCase::DoRun (void)
+{
+  Ptr<MmWavePhyMacCommon> config = CreateObject<MmWavePhyMacCommon> ();
+  Ptr<MmWaveFlexTtiMaxRateMacScheduler> scheduler = CreateObject<MmWaveFlexTtiMaxRateMacScheduler> ();
+  scheduler->SetAttribute ("HarqEnabled", BooleanValue (true));
+  scheduler->ConfigureCommonParameters (config);
+  MmWaveTestMacSchedSapUser schedSapUser;
+  scheduler->SetMacSchedSapUser (&schedSapUser);
+
+  // the UEs are added out of RNTI order, none of them has a CQI, hence they
+  // have the same MCS and DL buffers larger than the whole slot
+  uint16_t rntis[] = {5, 3, 1, 4, 2};
+  for (uint16_t rnti : rntis)
+    {
+      MmWaveMacCschedSapProvider::CschedUeConfigReqParameters ueParams;
+      ueParams.m_rnti = rnti;
+      ueParams.m_transmissionMode = 0;
+      scheduler->GetMacCschedSapProvider ()->CschedUeConfigReq (ueParams);
+
+      MmWaveMacSchedSapProvider::SchedDlRlcBufferReqParameters bufParams;
+      bufParams.m_rnti = rnti;
+      bufParams.m_logicalChannelIdentity = 3;
+      bufParams.m_rlcTransmissionQueueSize = 100000;
+      bufParams.m_rlcRetransmissionQueueSize = 0;
+      bufParams.m_rlcStatusPduSize = 0;
+      scheduler->GetMacSchedSapProvider ()->SchedDlRlcBufferReq (bufParams);
+    }
+
+  unsigned symAvail = config->GetSymbPerSlot () - config->GetDlCtrlSymbols () - config->GetUlCtrlSymbols ();
+  NS_TEST_ASSERT_MSG_EQ ((symAvail % 5 != 0), true, "The symbols should not be split evenly among the UEs");
+
+  // first slot: the symbols are split evenly, and the lowest RNTIs get the
+  // extra symbols
+  MmWaveMacSchedSapProvider::SchedTriggerReqParameters triggerParams;
+  triggerParams.m_snfSf = SfnSf (1, 0, 0);
+  scheduler->GetMacSchedSapProvider ()->SchedTriggerReq (triggerParams);
+  std::map<uint16_t, DciInfoElementTdma> newTx = GetDlDcis (schedSapUser.m_params, false);
+  NS_TEST_ASSERT_MSG_EQ (newTx.size (), 5, "All the UEs should be allocated");
+  NS_TEST_ASSERT_MSG_EQ (GetDlDcis (schedSapUser.m_params, true).size (), 0, "There should be no retransmissions");
+  unsigned symTot = 0;
+  for (uint16_t rnti = 1; rnti <= 5; rnti++)
+    {
+      unsigned expSym = symAvail / 5 + (rnti <= symAvail % 5 ? 1 : 0);
+      NS_TEST_ASSERT_MSG_EQ ((unsigned)newTx[rnti].m_numSym, expSym, "Unexpected number of symbols of UE " << rnti);
+      symTot += newTx[rnti].m_numSym;
+    }
+  NS_TEST_ASSERT_MSG_EQ (symTot, symAvail, "All the symbols should be allocated");
+
+  // second slot: the NACKed transmission of UE 4 is retransmitted before the
+  // new data, which takes the symbols left
+  DciInfoElementTdma nackedDci = newTx[4];
+  DlHarqInfo harqInfo;
+  harqInfo.m_rnti = 4;
+  harqInfo.m_harqProcessId = nackedDci.m_harqProcess;
+  harqInfo.m_harqStatus = DlHarqInfo::NACK;
+  triggerParams.m_snfSf = SfnSf (1, 0, 1);
+  triggerParams.m_dlHarqInfoList.push_back (harqInfo);
+  scheduler->GetMacSchedSapProvider ()->SchedTriggerReq (triggerParams);
+
+  std::map<uint16_t, DciInfoElementTdma> reTx = GetDlDcis (schedSapUser.m_params, true);
+  NS_TEST_ASSERT_MSG_EQ (reTx.size (), 1, "Only UE 4 should have a retransmission");
+  NS_TEST_ASSERT_MSG_EQ (reTx.count (4), 1, "The retransmission should be of UE 4");
+  NS_TEST_ASSERT_MSG_EQ ((unsigned)reTx[4].m_symStart, (unsigned)config->GetDlCtrlSymbols (), "The retransmission should be the first data TTI");
+  NS_TEST_ASSERT_MSG_EQ ((unsigned)reTx[4].m_numSym, (unsigned)nackedDci.m_numSym, "The retransmission should keep its symbols");
+  NS_TEST_ASSERT_MSG_EQ ((unsigned)reTx[4].m_harqProcess, (unsigned)nackedDci.m_harqProcess, "The retransmission should keep its HARQ process");
+  NS_TEST_ASSERT_MSG_EQ ((unsigned)reTx[4].m_rv, 1, "Unexpected redundancy version of the retransmission");
+
+  newTx = GetDlDcis (schedSapUser.m_params, false);
+  NS_TEST_ASSERT_MSG_EQ (newTx.size (), 5, "All the UEs should be allocated new data");
+  unsigned symLeft = symAvail - nackedDci.m_numSym;
+  symTot = 0;
+  for (uint16_t rnti = 1; rnti <= 5; rnti++)
+    {
+      unsigned expSym = symLeft / 5 + (rnti <= symLeft % 5 ? 1 : 0);
+      NS_TEST_ASSERT_MSG_EQ ((unsigned)newTx[rnti].m_numSym, expSym, "Unexpected number of symbols of UE " << rnti << " after the retransmission");
+      NS_TEST_ASSERT_MSG_GT (newTx[rnti].m_symStart, reTx[4].m_symStart, "The new data should follow the retransmission");
+      symTot += newTx[rnti].m_numSym;
+    }
+  NS_TEST_ASSERT_MSG_EQ (symTot, symLeft, "All the symbols left should be allocated");
+
+  scheduler->Dispose ();
+  Simulator::Destroy ();
+}
+
+/**
+* This suite tests the flex-TTI MAC scheduler
+*/
+class MmWaveFlexTtiSchedulerTest : public TestSuite
+{
+public:
+  MmWaveFlexTtiSchedulerTest ();
+};
+
+MmWaveFlexTtiSchedulerTest::MmWaveFlexTtiSchedulerTest ()
+  : TestSuite ("mmwave-flex-tti-scheduler-test", UNIT)
+{
+  // TestDuration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
+  AddTestCase (new MmWaveFlexTtiSchedulerTestCase, TestCase::QUICK);
+}
+
+// Do not forget to allocate an instance of this TestSuite
+static MmWaveFlexTtiSchedulerTest mmwaveFlexTtiSchedulerTestSuite;
@@ -0,0 +1,149 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License version 2 as
+*   published by the Free Software Foundation;
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "ns3/mmwave-interference.h"
+#include "ns3/mmwave-chunk-processor.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveInterferenceTest");
+
+using namespace ns3;
+using namespace mmwave;
+
+/**
+* This test case checks the SINR computed by mmWaveInterference when some
+* interfering signals end together and when a reception starts after all the
+* interferers ended
+*/
+class MmWaveInterferenceTestCase : public TestCase
+{
+public:
+  /**
+  * Constructor
+  */
+  MmWaveInterferenceTestCase ();
+
+  /**
+  * Destructor
+  */
+  virtual ~MmWaveInterferenceTestCase ();
+
+private:
+  /**
+  * Run the test
+  */
+  virtual void DoRun (void);
+
+  /**
+  * Receive a signal, after adding it to the interference
+  * \param interference the interference
+  * \param psd the PSD of the signal
+  * \param duration the duration of the signal
+  */
+  static void StartRx (Ptr<mmWaveInterference> interference, Ptr<SpectrumValue> psd, Time duration);
+
+  /**
+  * Store the SINR reported at the end of a reception
+  * \param sinr the average SINR
+  */
+  void ReportSinr (const SpectrumValue &sinr);
+
+  std::vector<SpectrumValue> m_sinr; //!< the reported SINRs
+};
+
+MmWaveInterferenceTestCase::MmWaveInterferenceTestCase ()
+  : TestCase ("Checks the SINR computed by mmWaveInterference")
+{
+}
+
+MmWaveInterferenceTestCase::~MmWaveInterferenceTestCase ()
+{
+}
+
+void
+MmWaveInterferenceTestCase::StartRx (Ptr<mmWaveInterference> interference, Ptr<SpectrumValue> psd, Time duration)
+{
+  interference->AddSignal (psd, duration);
+  interference->StartRx (psd);
+  Simulator::Schedule (duration, &mmWaveInterference::EndRx, interference);
+}
+
+void
+MmWaveInterferenceTestCase::ReportSinr (const SpectrumValue &sinr)
+{
+  m_sinr.push_back (sinr);
+}
+
+void
+MmWaveInterferenceTestCase::DoRun (void)
+{
+  std::vector<double> centerFrequencies;
+  centerFrequencies.push_back (28e9);
+  centerFrequencies.push_back (28.001e9);
+  Ptr<SpectrumModel> model = Create<SpectrumModel> (centerFrequencies);
+
+  Ptr<SpectrumValue> noise = Create<SpectrumValue> (model);
+  (*noise) = 1.0;
+  Ptr<SpectrumValue> interferer1 = Create<SpectrumValue> (model);
+  (*interferer1) = 2.0;
+  Ptr<SpectrumValue> interferer2 = Create<SpectrumValue> (model);
+  (*interferer2) = 3.0;
+  Ptr<SpectrumValue> signal = Create<SpectrumValue> (model);
+  (*signal)[0] = 10.0;
+
+  Ptr<mmWaveInterference> interference = CreateObject<mmWaveInterference> ();
+  interference->SetNoisePowerSpectralDensity (noise);
+  Ptr<mmWaveChunkProcessor> sinrProcessor = Create<mmWaveChunkProcessor> ();
+  sinrProcessor->AddCallback (MakeCallback (&MmWaveInterferenceTestCase::ReportSinr, this));
+  interference->AddSinrChunkProcessor (sinrProcessor);
+
+  // the two interferers end together, after half of the first reception,
+  // and the second reception starts when no interferer is active
+  interference->AddSignal (interferer1, MilliSeconds (1));
+  interference->AddSignal (interferer2, MilliSeconds (1));
+  StartRx (interference, signal, MilliSeconds (2));
+  Simulator::Schedule (MilliSeconds (3), &MmWaveInterferenceTestCase::StartRx, interference, signal, MilliSeconds (1));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_sinr.size (), 2, "Unexpected number of SINR reports");
+  NS_TEST_ASSERT_MSG_EQ_TOL (m_sinr[0][0], (10.0 / 6 + 10.0) / 2, 1e-12, "Unexpected SINR of the first reception");
+  NS_TEST_ASSERT_MSG_EQ (m_sinr[0][1], 0.0, "Unexpected SINR in the band without signal");
+  NS_TEST_ASSERT_MSG_EQ_TOL (m_sinr[1][0], 10.0, 1e-12, "The interferers should have been subtracted");
+
+  Simulator::Destroy ();
+}
+
+/**
+* This suite tests the interference and SINR computation
+*/
+class MmWaveInterferenceTest : public TestSuite
+{
+public:
+  MmWaveInterferenceTest ();
+};
+
+MmWaveInterferenceTest::MmWaveInterferenceTest ()
+  : TestSuite ("mmwave-interference-test", UNIT)
+{
+  // TestDuration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
+  AddTestCase (new MmWaveInterferenceTestCase, TestCase::QUICK);
+}
+
+// Do not forget to allocate an instance of this TestSuite
+static MmWaveInterferenceTest mmwaveInterferenceTestSuite;
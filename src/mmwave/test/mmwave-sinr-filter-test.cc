@@ -0,0 +1,304 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License version 2 as
+*   published by the Free Software Foundation;
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "ns3/mmwave-sinr-filter.h"
+#include "ns3/log.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/test.h"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <deque>
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveSinrFilterTest");
+
+using namespace ns3;
+using namespace mmwave;
+
+/**
+* This test case checks that the streaming SINR filter reports the same
+* samples of the batch filter computed from scratch over the window of
+* samples, in each of its branches
+*/
+class MmWaveSinrFilterTestCase : public TestCase
+{
+public:
+  /**
+  * Constructor
+  */
+  MmWaveSinrFilterTestCase ();
+
+  /**
+  * Destructor
+  */
+  virtual ~MmWaveSinrFilterTestCase ();
+
+private:
+  /**
+  * Run the test
+  */
+  virtual void DoRun (void);
+
+  /**
+  * Check whether the STABLE_WINDOW samples of the window preceding a sample
+  * all have a low variance, or all have a high SINR
+  * \param noisySinrDb the noisy SINR samples in the window, in dB
+  * \param var the two-sample variances of the noisy SINR samples in dB
+  * \param i the index of the sample in the window
+  * \return true if the samples preceding the i-th one are stable
+  */
+  static bool IsStableBefore (const std::vector<double> &noisySinrDb, const std::vector<double> &var, uint64_t i);
+
+  /**
+  * Find the interval of the window to be filtered, i.e., from the last
+  * sample preceded by stable samples to the last sample with high variance
+  * or low SINR. This is the reference implementation, which recomputes
+  * everything over the window as MmWaveEnbPhy::ApplyFilter did.
+  * \param noisySinr the noisy SINR samples in the window
+  * \param start the index of the first sample of the interval in the window
+  * \param end the index of the sample which ends the interval in the window
+  */
+  static void FindInterval (const std::deque<double> &noisySinr, uint64_t &start, uint64_t &end);
+
+  /**
+  * Filter the samples in [start, end) with the alpha that best tracks the
+  * real SINR in the interval, and return the output of the filter up to the
+  * second-last sample of the interval, i.e., the sample to report, as
+  * MmWaveEnbPhy::MakeFilter did
+  * \param noisySinr the noisy SINR samples
+  * \param realSinr the real SINR samples
+  * \param start the index of the first sample of the interval
+  * \param end the index of the sample which ends the interval
+  * \return the sample to report
+  */
+  static double FilterInterval (const std::vector<double> &noisySinr, const std::vector<double> &realSinr, uint64_t start, uint64_t end);
+};
+
+MmWaveSinrFilterTestCase::MmWaveSinrFilterTestCase ()
+  : TestCase ("Checks the streaming SINR filter against the filter computed over the whole window")
+{
+}
+
+MmWaveSinrFilterTestCase::~MmWaveSinrFilterTestCase ()
+{
+}
+
+bool
+MmWaveSinrFilterTestCase::IsStableBefore (const std::vector<double> &noisySinrDb, const std::vector<double> &var, uint64_t i)
+{
+  if (i <= MmWaveSinrFilter::STABLE_WINDOW)
+    {
+      return false;
+    }
+  bool lowVar = std::all_of (var.begin () + i - MmWaveSinrFilter::STABLE_WINDOW, var.begin () + i - 1,
+                             [] (double v) { return v < 1 && !std::isnan (v); });
+  bool highSinr = std::all_of (noisySinrDb.begin () + i - MmWaveSinrFilter::STABLE_WINDOW, noisySinrDb.begin () + i,
+                               [] (double s) { return s > 10; });
+  return lowVar || highSinr;
+}
+
+void
+MmWaveSinrFilterTestCase::FindInterval (const std::deque<double> &noisySinr, uint64_t &start, uint64_t &end)
+{
+  uint64_t n = noisySinr.size ();
+  start = 0;
+  end = 0;
+  if (n < 2)
+    {
+      return;
+    }
+
+  std::vector<double> noisySinrDb (n);
+  for (uint64_t i = 0; i < n; ++i)
+    {
+      noisySinrDb[i] = 10 * std::log10 (noisySinr[i]);
+    }
+  std::vector<double> var (n - 1);
+  for (uint64_t i = 0; i < n - 1; ++i)
+    {
+      double mean = (noisySinrDb[i] + noisySinrDb[i + 1]) / 2;
+      var[i] = (std::pow (noisySinrDb[i] - mean, 2) + std::pow (noisySinrDb[i + 1] - mean, 2)) / 2;
+    }
+
+  // the filter ends at the last sample with high variance or low SINR
+  for (uint64_t i = n - 2; i > 0; --i)
+    {
+      if (var[i] > 5 || std::isnan (var[i]) || noisySinr[i + 1] < 10)
+        {
+          end = i + 1;
+          break;
+        }
+    }
+
+  // the filter starts after the last window of stable samples
+  for (uint64_t i = end; i > MmWaveSinrFilter::STABLE_WINDOW; --i)
+    {
+      if (IsStableBefore (noisySinrDb, var, i))
+        {
+          start = i;
+          break;
+        }
+    }
+}
+
+double
+MmWaveSinrFilterTestCase::FilterInterval (const std::vector<double> &noisySinr, const std::vector<double> &realSinr, uint64_t start, uint64_t end)
+{
+  if (end - start < 2)
+    {
+      return noisySinr[end == start ? end : end - 1];
+    }
+
+  // find the best alpha
+  std::vector<double> meanError (MmWaveSinrFilter::NUM_ALPHA);
+  for (uint32_t a = 0; a < MmWaveSinrFilter::NUM_ALPHA; ++a)
+    {
+      double alpha = a * 0.01;
+      double x = 0;
+      double error = 0;
+      for (uint64_t i = start; i < end; ++i)
+        {
+          x = (1 - alpha) * x + alpha * noisySinr[i];
+          error += std::abs (x - realSinr[i]);
+        }
+      meanError[a] = error / (end - start);
+    }
+  uint32_t minAlphaIndex = std::distance (meanError.begin (), std::min_element (meanError.begin (), meanError.end ())) + 1;
+  if (minAlphaIndex > 50)
+    {
+      minAlphaIndex = 20;
+    }
+  double minAlpha = minAlphaIndex * 0.01;
+
+  // the reported sample is the output of the filter up to the second-last sample
+  double x = 0;
+  for (uint64_t i = start; i + 1 < end; ++i)
+    {
+      x = (1 - minAlpha) * x + minAlpha * noisySinr[i];
+    }
+  return x;
+}
+
+void
+MmWaveSinrFilterTestCase::DoRun (void)
+{
+  // generate a SINR trace alternating LOS periods (high SINR) and blockages
+  // (low SINR), and add Gaussian noise as in MmWaveEnbPhy::AddGaussianNoise
+  const uint32_t windowSize = 60;
+  const uint32_t transientSamples = 50;
+  const uint32_t numSamples = 2000;
+  const double tolerance = 1e-9;
+
+  Ptr<NormalRandomVariable> noise = CreateObject<NormalRandomVariable> ();
+  noise->SetStream (1);
+  Ptr<UniformRandomVariable> blockage = CreateObject<UniformRandomVariable> ();
+  blockage->SetStream (2);
+
+  MmWaveSinrFilter filter (windowSize);
+  std::deque<double> noisyWindow;
+  std::vector<double> noisyHistory;
+  std::vector<double> realHistory;
+  bool blocked = false;
+
+  uint32_t numNotFiltered = 0;
+  uint32_t numFromStableSample = 0;
+  uint32_t numFromWindowStart = 0;
+  for (uint32_t t = 0; t < numSamples; ++t)
+    {
+      if (blockage->GetValue () < 0.05)
+        {
+          blocked = !blocked;
+        }
+      double realSinrDb = blocked ? -5 + 10 * blockage->GetValue () : 25 + blockage->GetValue ();
+      double realSinr = std::pow (10, realSinrDb / 10);
+      double n0 = 3.98107170e-12;
+      std::complex<double> gaussianNoise (std::sqrt (0.5 * n0) * noise->GetValue (), std::sqrt (0.5 * n0) * noise->GetValue ());
+      double noisySinr = (std::pow (std::abs (std::sqrt (realSinr * n0) + gaussianNoise), 2) - n0) / n0;
+
+      bool transient = t < transientSamples;
+      if (!transient)
+        {
+          noisyWindow.pop_front ();
+        }
+      noisyWindow.push_back (noisySinr);
+      noisyHistory.push_back (noisySinr);
+      realHistory.push_back (realSinr);
+
+      double sinr = filter.Update (realSinr, noisySinr, transient);
+      NS_TEST_ASSERT_MSG_EQ (filter.GetWindowSize (), noisyWindow.size (), "Unexpected window size at sample " << t);
+
+      uint64_t start = 0;
+      uint64_t end = 0;
+      FindInterval (noisyWindow, start, end);
+
+      if (transient)
+        {
+          NS_TEST_ASSERT_MSG_EQ (sinr, noisySinr, "The samples should not be filtered during the transient");
+          continue;
+        }
+
+      double expected = noisySinr;
+      uint64_t windowStart = t + 1 - noisyWindow.size ();
+      if (end == 0 || end + 1 < noisyWindow.size ())
+        {
+          // no blockage at the current sample
+          numNotFiltered++;
+        }
+      else
+        {
+          // the samples of the window in [start, end) are filtered, where
+          // start is either a stable sample or the beginning of the window
+          expected = FilterInterval (noisyHistory, realHistory, windowStart + start, t);
+          if (start > 0)
+            {
+              numFromStableSample++;
+            }
+          else
+            {
+              numFromWindowStart++;
+            }
+        }
+      // the streaming filter accumulates the errors of the alphas in a
+      // different order, hence the results can differ by rounding errors
+      NS_TEST_ASSERT_MSG_EQ_TOL (sinr, expected, std::abs (expected) * tolerance, "Unexpected filtered SINR at sample " << t);
+    }
+
+  // every branch of the filter has to be exercised
+  NS_TEST_ASSERT_MSG_GT (numNotFiltered, 0, "No sample has been reported without filtering");
+  NS_TEST_ASSERT_MSG_GT (numFromStableSample, 0, "No sample has been filtered from a stable sample");
+  NS_TEST_ASSERT_MSG_GT (numFromWindowStart, 0, "No sample has been filtered from the beginning of the window");
+  NS_TEST_ASSERT_MSG_EQ (numNotFiltered + numFromStableSample + numFromWindowStart, numSamples - transientSamples, "Some samples have not been checked");
+}
+
+/**
+* This suite tests the filter of the noisy SINR samples
+*/
+class MmWaveSinrFilterTest : public TestSuite
+{
+public:
+  MmWaveSinrFilterTest ();
+};
+
+MmWaveSinrFilterTest::MmWaveSinrFilterTest ()
+  : TestSuite ("mmwave-sinr-filter-test", UNIT)
+{
+  // TestDuration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
+  AddTestCase (new MmWaveSinrFilterTestCase, TestCase::QUICK);
+}
+
+// Do not forget to allocate an instance of this TestSuite
+static MmWaveSinrFilterTest mmwaveSinrFilterTestSuite;
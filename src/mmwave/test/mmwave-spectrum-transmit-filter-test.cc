@@ -0,0 +1,187 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License version 2 as
+*   published by the Free Software Foundation;
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the Free Software
+*   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+*/
+
+#include "ns3/mmwave-spectrum-transmit-filter.h"
+#include "ns3/mmwave-spectrum-phy.h"
+#include "ns3/mmwave-enb-net-device.h"
+#include "ns3/mmwave-ue-net-device.h"
+#include "ns3/spectrum-signal-parameters.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/double.h"
+#include "ns3/pointer.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+
+NS_LOG_COMPONENT_DEFINE ("MmWaveSpectrumTransmitFilterTest");
+
+using namespace ns3;
+using namespace mmwave;
+
+/**
+* MmWaveEnbNetDevice without the RRC and the component carriers, which are
+* not needed by the filter and are not set without the helper
+*/
+class MmWaveTestEnbNetDevice : public MmWaveEnbNetDevice
+{
+public:
+  virtual void DoDispose (void) override
+  {
+    MmWaveNetDevice::DoDispose ();
+  }
+};
+
+/**
+* MmWaveUeNetDevice without the RRC, the NAS and the component carriers,
+* which are not needed by the filter and are not set without the helper
+*/
+class MmWaveTestUeNetDevice : public MmWaveUeNetDevice
+{
+public:
+  virtual void DoDispose (void) override
+  {
+    MmWaveNetDevice::DoDispose ();
+  }
+};
+
+/**
+* This test case checks that MmWaveSpectrumTransmitFilter drops the signals
+* between devices with the same role, and the signals towards the receivers
+* with a path gain lower than MinPathGainDb, if the threshold is set
+*/
+class MmWaveSpectrumTransmitFilterTestCase : public TestCase
+{
+public:
+  /**
+  * Constructor
+  */
+  MmWaveSpectrumTransmitFilterTestCase ();
+
+  /**
+  * Destructor
+  */
+  virtual ~MmWaveSpectrumTransmitFilterTestCase ();
+
+private:
+  /**
+  * Run the test
+  */
+  virtual void DoRun (void);
+
+  /**
+  * Create a MmWaveSpectrumPhy attached to a device
+  * \param device the device of the PHY
+  * \param position the position of the PHY
+  * \return the PHY
+  */
+  static Ptr<MmWaveSpectrumPhy> CreatePhy (Ptr<NetDevice> device, Vector position);
+
+  /**
+  * Create the parameters of a signal
+  * \param txPhy the transmitting PHY
+  * \return the parameters of the signal
+  */
+  static Ptr<SpectrumSignalParameters> CreateParams (Ptr<SpectrumPhy> txPhy);
+};
+
+MmWaveSpectrumTransmitFilterTestCase::MmWaveSpectrumTransmitFilterTestCase ()
+  : TestCase ("Check the same-role drop and the path gain threshold of the mmWave transmit filter")
+{
+}
+
+MmWaveSpectrumTransmitFilterTestCase::~MmWaveSpectrumTransmitFilterTestCase ()
+{
+}
+
+Ptr<MmWaveSpectrumPhy>
+MmWaveSpectrumTransmitFilterTestCase::CreatePhy (Ptr<NetDevice> device, Vector position)
+{
+  Ptr<ConstantPositionMobilityModel> mobility = CreateObject<ConstantPositionMobilityModel> ();
+  mobility->SetPosition (position);
+  Ptr<MmWaveSpectrumPhy> phy = CreateObject<MmWaveSpectrumPhy> ();
+  phy->SetDevice (device);
+  phy->SetMobility (mobility);
+  return phy;
+}
+
+Ptr<SpectrumSignalParameters>
+MmWaveSpectrumTransmitFilterTestCase::CreateParams (Ptr<SpectrumPhy> txPhy)
+{
+  Ptr<SpectrumSignalParameters> params = Create<SpectrumSignalParameters> ();
+  params->duration = MilliSeconds (1);
+  params->txPhy = txPhy;
+  return params;
+}
+
+void
+MmWaveSpectrumTransmitFilterTestCase::DoRun (void)
+{
+  // at 5.15 GHz, the default frequency of the Friis model, the path gain is
+  // about -66 dB at 10 m and -126 dB at 10 km
+  Ptr<MmWaveSpectrumPhy> enb1 = CreatePhy (CreateObject<MmWaveTestEnbNetDevice> (), Vector (0, 0, 0));
+  Ptr<MmWaveSpectrumPhy> enb2 = CreatePhy (CreateObject<MmWaveTestEnbNetDevice> (), Vector (0, 10, 0));
+  Ptr<MmWaveSpectrumPhy> ueNear = CreatePhy (CreateObject<MmWaveTestUeNetDevice> (), Vector (10, 0, 0));
+  Ptr<MmWaveSpectrumPhy> ueNear2 = CreatePhy (CreateObject<MmWaveTestUeNetDevice> (), Vector (-10, 0, 0));
+  Ptr<MmWaveSpectrumPhy> ueFar = CreatePhy (CreateObject<MmWaveTestUeNetDevice> (), Vector (10000, 0, 0));
+
+  Ptr<SpectrumSignalParameters> enbParams = CreateParams (enb1);
+  Ptr<SpectrumSignalParameters> ueParams = CreateParams (ueNear);
+
+  Ptr<MmWaveSpectrumTransmitFilter> filter = CreateObject<MmWaveSpectrumTransmitFilter> ();
+  filter->SetAttribute ("PropagationLossModel", PointerValue (CreateObject<FriisPropagationLossModel> ()));
+
+  // the threshold is disabled by default, so only the role is considered
+  NS_TEST_ASSERT_MSG_EQ (filter->Filter (enbParams, enb2), true, "The eNB to eNB signal should be filtered");
+  NS_TEST_ASSERT_MSG_EQ (filter->Filter (ueParams, ueNear2), true, "The UE to UE signal should be filtered");
+  NS_TEST_ASSERT_MSG_EQ (filter->Filter (enbParams, ueNear), false, "The eNB to UE signal should not be filtered");
+  NS_TEST_ASSERT_MSG_EQ (filter->Filter (ueParams, enb1), false, "The UE to eNB signal should not be filtered");
+  NS_TEST_ASSERT_MSG_EQ (filter->Filter (enbParams, ueFar), false, "The far UE should not be filtered without threshold");
+
+  filter->SetAttribute ("MinPathGainDb", DoubleValue (-100));
+  NS_TEST_ASSERT_MSG_EQ (filter->Filter (enbParams, ueNear), false, "The near UE should be above the threshold");
+  NS_TEST_ASSERT_MSG_EQ (filter->Filter (ueParams, enb1), false, "The eNB should be above the threshold");
+  NS_TEST_ASSERT_MSG_EQ (filter->Filter (enbParams, ueFar), true, "The far UE should be below the threshold");
+  NS_TEST_ASSERT_MSG_EQ (filter->Filter (enbParams, enb2), true, "The eNB to eNB signal should still be filtered");
+
+  // without a propagation loss model the threshold cannot be checked
+  Ptr<MmWaveSpectrumTransmitFilter> noLossFilter = CreateObject<MmWaveSpectrumTransmitFilter> ();
+  noLossFilter->SetAttribute ("MinPathGainDb", DoubleValue (-100));
+  NS_TEST_ASSERT_MSG_EQ (noLossFilter->Filter (enbParams, ueFar), false, "The threshold should be ignored without a propagation loss model");
+  NS_TEST_ASSERT_MSG_EQ (noLossFilter->Filter (enbParams, enb2), true, "The eNB to eNB signal should be filtered without a propagation loss model");
+
+  Simulator::Destroy ();
+}
+
+/**
+* This suite tests the mmWave transmit filter
+*/
+class MmWaveSpectrumTransmitFilterTest : public TestSuite
+{
+public:
+  MmWaveSpectrumTransmitFilterTest ();
+};
+
+MmWaveSpectrumTransmitFilterTest::MmWaveSpectrumTransmitFilterTest ()
+  : TestSuite ("mmwave-spectrum-transmit-filter-test", UNIT)
+{
+  // TestDuration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
+  AddTestCase (new MmWaveSpectrumTransmitFilterTestCase, TestCase::QUICK);
+}
+
+// Do not forget to allocate an instance of this TestSuite
+static MmWaveSpectrumTransmitFilterTest mmwaveSpectrumTransmitFilterTestSuite;
@@ -20,6 +20,8 @@
  */
 
 #include "matrix-based-channel-model.h"
+#include "ns3/abort.h"
+#include <algorithm>
 
 namespace ns3 {
 
@@ -27,4 +29,101 @@ MatrixBasedChannelModel::~MatrixBasedChannelModel()
 {
 }
 
+MatrixBasedChannelModel::ComplexTensor3D::ComplexTensor3D ()
+  : m_uSize (0),
+    m_sSize (0),
+    m_nSize (0),
+    m_layout (ELEMENT_MAJOR),
+    m_uStride (0),
+    m_sStride (0),
+    m_nStride (0)
+{
+}
+
+MatrixBasedChannelModel::ComplexTensor3D::ComplexTensor3D (size_t uSize, size_t sSize, size_t nSize, Layout layout)
+  : ComplexTensor3D ()
+{
+  Resize (uSize, sSize, nSize, layout);
+}
+
+MatrixBasedChannelModel::ComplexTensor3D::ComplexTensor3D (const Complex3DVector &h)
+  : ComplexTensor3D ()
+{
+  size_t uSize = h.size ();
+  size_t sSize = uSize > 0 ? h[0].size () : 0;
+  size_t nSize = sSize > 0 ? h[0][0].size () : 0;
+  Resize (uSize, sSize, nSize);
+  for (size_t uIndex = 0; uIndex < uSize; uIndex++)
+    {
+      NS_ABORT_MSG_IF (h[uIndex].size () != sSize, "All the rows of H must have the same size");
+      for (size_t sIndex = 0; sIndex < sSize; sIndex++)
+        {
+          NS_ABORT_MSG_IF (h[uIndex][sIndex].size () != nSize, "All the (u, s) pairs of H must have the same number of clusters");
+          std::copy (h[uIndex][sIndex].begin (), h[uIndex][sIndex].end (), &(*this) (uIndex, sIndex, 0));
+        }
+    }
+}
+
+void
+MatrixBasedChannelModel::ComplexTensor3D::Resize (size_t uSize, size_t sSize, size_t nSize, Layout layout)
+{
+  m_uSize = uSize;
+  m_sSize = sSize;
+  m_nSize = nSize;
+  m_layout = layout;
+  if (layout == ELEMENT_MAJOR)
+    {
+      m_nStride = 1;
+      m_sStride = nSize;
+      m_uStride = sSize * nSize;
+    }
+  else
+    {
+      m_sStride = 1;
+      m_uStride = sSize;
+      m_nStride = uSize * sSize;
+    }
+  m_values.assign (uSize * sSize * nSize, std::complex<double> (0.0, 0.0));
+}
+
+MatrixBasedChannelModel::ComplexTensor3D
+MatrixBasedChannelModel::ComplexTensor3D::ToLayout (Layout layout) const
+{
+  ComplexTensor3D h (m_uSize, m_sSize, m_nSize, layout);
+  for (size_t uIndex = 0; uIndex < m_uSize; uIndex++)
+    {
+      for (size_t sIndex = 0; sIndex < m_sSize; sIndex++)
+        {
+          for (size_t nIndex = 0; nIndex < m_nSize; nIndex++)
+            {
+              h (uIndex, sIndex, nIndex) = (*this) (uIndex, sIndex, nIndex);
+            }
+        }
+    }
+  return h;
+}
+
+MatrixBasedChannelModel::Complex3DVector
+MatrixBasedChannelModel::ComplexTensor3D::ToComplex3DVector () const
+{
+  Complex3DVector h (m_uSize, Complex2DVector (m_sSize, PhasedArrayModel::ComplexVector (m_nSize)));
+  for (size_t uIndex = 0; uIndex < m_uSize; uIndex++)
+    {
+      for (size_t sIndex = 0; sIndex < m_sSize; sIndex++)
+        {
+          for (size_t nIndex = 0; nIndex < m_nSize; nIndex++)
+            {
+              h[uIndex][sIndex][nIndex] = (*this) (uIndex, sIndex, nIndex);
+            }
+        }
+    }
+  return h;
+}
+
+void
+MatrixBasedChannelModel::ComplexTensor3D::CheckRange (size_t idx, size_t size)
+{
+  NS_ABORT_MSG_IF (idx >= size, "ComplexTensor3D: index " << idx << " out of range, size=" << size);
+}
+
 }
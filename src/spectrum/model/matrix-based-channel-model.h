@@ -54,13 +54,197 @@ public:
   typedef std::vector<PhasedArrayModel::ComplexVector> Complex2DVector; //!< type definition for complex matrices
   typedef std::vector<Complex2DVector> Complex3DVector; //!< type definition for complex 3D matrices
 
+  /**
+   * Flat, contiguous storage for the channel coefficients H[u][s][n].
+   *
+   * All the coefficients are stored in a single buffer, and the position of
+   * H[u][s][n] is u * GetUStride () + s * GetSStride () + n * GetNStride ().
+   * Two layouts are supported:
+   * - ELEMENT_MAJOR: the clusters of each (u, s) pair are contiguous,
+   *   this is the default layout
+   * - CLUSTER_MAJOR: the u x s matrix of each cluster is contiguous and
+   *   stored row-major
+   *
+   * For compatibility with code written for the Complex3DVector type,
+   * the coefficients can also be accessed as H[u][s][n], H.at (u).at (s).at (n)
+   * and the dimensions as H.size (), H[u].size (), H[u][s].size ().
+   * A Complex3DVector can be assigned to this type, and converted back with
+   * ToComplex3DVector.
+   */
+  class ComplexTensor3D
+  {
+  public:
+    /**
+     * Memory layout of the coefficients
+     */
+    enum Layout
+    {
+      ELEMENT_MAJOR, //!< H[u][s][n] with n the fastest varying index
+      CLUSTER_MAJOR  //!< H[n][u][s] with s the fastest varying index
+    };
+
+    /**
+     * Create an empty tensor
+     */
+    ComplexTensor3D ();
+
+    /**
+     * Create a tensor with all the coefficients set to zero
+     * \param uSize the number of u elements
+     * \param sSize the number of s elements
+     * \param nSize the number of clusters
+     * \param layout the memory layout
+     */
+    ComplexTensor3D (size_t uSize, size_t sSize, size_t nSize, Layout layout = ELEMENT_MAJOR);
+
+    /**
+     * Create a tensor from a Complex3DVector H[u][s][n], using the
+     * ELEMENT_MAJOR layout
+     * \param h the channel coefficients
+     */
+    ComplexTensor3D (const Complex3DVector &h);
+
+    /**
+     * Change the dimensions of the tensor and set all the coefficients to zero
+     * \param uSize the number of u elements
+     * \param sSize the number of s elements
+     * \param nSize the number of clusters
+     * \param layout the memory layout
+     */
+    void Resize (size_t uSize, size_t sSize, size_t nSize, Layout layout = ELEMENT_MAJOR);
+
+    /**
+     * Returns a copy of this tensor stored with the given layout
+     * \param layout the memory layout
+     * \return the copy
+     */
+    ComplexTensor3D ToLayout (Layout layout) const;
+
+    /**
+     * Returns a copy of the coefficients as nested vectors
+     * \return the Complex3DVector H[u][s][n]
+     */
+    Complex3DVector ToComplex3DVector () const;
+
+    size_t GetUSize () const { return m_uSize; } //!< \return the number of u elements
+    size_t GetSSize () const { return m_sSize; } //!< \return the number of s elements
+    size_t GetNumClusters () const { return m_nSize; } //!< \return the number of clusters
+    Layout GetLayout () const { return m_layout; } //!< \return the memory layout
+    size_t GetUStride () const { return m_uStride; } //!< \return the distance between consecutive u elements
+    size_t GetSStride () const { return m_sStride; } //!< \return the distance between consecutive s elements
+    size_t GetNStride () const { return m_nStride; } //!< \return the distance between consecutive clusters
+    bool IsEmpty () const { return m_values.empty (); } //!< \return true if there are no coefficients
+
+    /**
+     * \return a pointer to the first coefficient of the buffer
+     */
+    std::complex<double> *GetData () { return m_values.data (); }
+    /**
+     * \return a pointer to the first coefficient of the buffer
+     */
+    const std::complex<double> *GetData () const { return m_values.data (); }
+
+    /**
+     * \param u the u element index
+     * \param s the s element index
+     * \param n the cluster index
+     * \return a reference to H[u][s][n]
+     */
+    std::complex<double> &operator() (size_t u, size_t s, size_t n)
+    {
+      return m_values[u * m_uStride + s * m_sStride + n * m_nStride];
+    }
+
+    /**
+     * \param u the u element index
+     * \param s the s element index
+     * \param n the cluster index
+     * \return a const reference to H[u][s][n]
+     */
+    const std::complex<double> &operator() (size_t u, size_t s, size_t n) const
+    {
+      return m_values[u * m_uStride + s * m_sStride + n * m_nStride];
+    }
+
+    /**
+     * Compatibility view of the coefficients of a (u, s) pair
+     */
+    template <class T, class R>
+    class ClusterView
+    {
+    public:
+      ClusterView (T *h, size_t u, size_t s) : m_h (h), m_u (u), m_s (s) {}
+      R operator[] (size_t n) const { return (*m_h) (m_u, m_s, n); }
+      R at (size_t n) const { CheckRange (n, size ()); return (*m_h) (m_u, m_s, n); }
+      size_t size () const { return m_h->GetNumClusters (); }
+    private:
+      T *m_h;
+      size_t m_u;
+      size_t m_s;
+    };
+
+    /**
+     * Compatibility view of the coefficients of a u element
+     */
+    template <class T, class R>
+    class ElementView
+    {
+    public:
+      ElementView (T *h, size_t u) : m_h (h), m_u (u) {}
+      ClusterView<T, R> operator[] (size_t s) const { return ClusterView<T, R> (m_h, m_u, s); }
+      ClusterView<T, R> at (size_t s) const { CheckRange (s, size ()); return ClusterView<T, R> (m_h, m_u, s); }
+      size_t size () const { return m_h->GetSSize (); }
+    private:
+      T *m_h;
+      size_t m_u;
+    };
+
+    ElementView<ComplexTensor3D, std::complex<double> &> operator[] (size_t u)
+    {
+      return ElementView<ComplexTensor3D, std::complex<double> &> (this, u);
+    }
+    ElementView<const ComplexTensor3D, const std::complex<double> &> operator[] (size_t u) const
+    {
+      return ElementView<const ComplexTensor3D, const std::complex<double> &> (this, u);
+    }
+    ElementView<ComplexTensor3D, std::complex<double> &> at (size_t u)
+    {
+      CheckRange (u, m_uSize);
+      return ElementView<ComplexTensor3D, std::complex<double> &> (this, u);
+    }
+    ElementView<const ComplexTensor3D, const std::complex<double> &> at (size_t u) const
+    {
+      CheckRange (u, m_uSize);
+      return ElementView<const ComplexTensor3D, const std::complex<double> &> (this, u);
+    }
+    size_t size () const { return m_uSize; } //!< \return the number of u elements
+
+  private:
+    /**
+     * Aborts if idx >= size. Like std::vector::at, the check is kept in
+     * optimized builds
+     * \param idx the index
+     * \param size the size of the dimension
+     */
+    static void CheckRange (size_t idx, size_t size);
+
+    size_t m_uSize; //!< number of u elements
+    size_t m_sSize; //!< number of s elements
+    size_t m_nSize; //!< number of clusters
+    Layout m_layout; //!< memory layout
+    size_t m_uStride; //!< distance between consecutive u elements
+    size_t m_sStride; //!< distance between consecutive s elements
+    size_t m_nStride; //!< distance between consecutive clusters
+    std::vector<std::complex<double> > m_values; //!< the coefficients
+  };
+
 
   /**
    * Data structure that stores a channel realization
    */
   struct ChannelMatrix : public SimpleRefCount<ChannelMatrix>
   {
-    Complex3DVector    m_channel; //!< channel matrix H[u][s][n].
+    ComplexTensor3D    m_channel; //!< channel matrix H[u][s][n].
     DoubleVector       m_delay; //!< cluster delay in nanoseconds.
     Double2DVector     m_angle; //!< cluster angle angle[direction][n], where direction = 0(AOA), 1(ZOA), 2(AOD), 3(ZOD) in degree.
     Time               m_generatedTime; //!< generation time
@@ -112,6 +112,12 @@ SingleModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
     {
       if ((*rxPhyIterator) != txParams->txPhy)
         {
+          if (m_filter != 0 && m_filter->Filter (txParams, *rxPhyIterator))
+            {
+              NS_LOG_LOGIC ("signal filtered for receiver " << *rxPhyIterator);
+              continue;
+            }
+
           Time delay  = MicroSeconds (0);
 
           Ptr<MobilityModel> receiverMobility = (*rxPhyIterator)->GetMobility ();
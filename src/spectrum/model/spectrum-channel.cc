@@ -47,6 +47,11 @@ SpectrumChannel::DoDispose ()
   m_propagationLoss = 0;
   m_propagationDelay = 0;
   m_spectrumPropagationLoss = 0;
+  if (m_filter != 0)
+    {
+      m_filter->Dispose ();
+    }
+  m_filter = 0;
 }
 
 TypeId
@@ -135,6 +140,24 @@ SpectrumChannel::AddSpectrumPropagationLossModel (Ptr<SpectrumPropagationLossMod
   m_spectrumPropagationLoss = loss;
 }
 
+void
+SpectrumChannel::AddSpectrumTransmitFilter (Ptr<SpectrumTransmitFilter> filter)
+{
+  NS_LOG_FUNCTION (this << filter);
+  if (m_filter)
+    {
+      filter->SetNext (m_filter);
+    }
+  m_filter = filter;
+}
+
+Ptr<SpectrumTransmitFilter>
+SpectrumChannel::GetSpectrumTransmitFilter (void)
+{
+  NS_LOG_FUNCTION (this);
+  return m_filter;
+}
+
 void
 SpectrumChannel::SetPropagationDelayModel (Ptr<PropagationDelayModel> delay)
 {
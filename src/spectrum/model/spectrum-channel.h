@@ -27,6 +27,7 @@
 #include <ns3/channel.h>
 #include <ns3/spectrum-signal-parameters.h>
 #include <ns3/spectrum-propagation-loss-model.h>
+#include <ns3/spectrum-transmit-filter.h>
 #include <ns3/propagation-delay-model.h>
 #include <ns3/propagation-loss-model.h>
 #include <ns3/spectrum-phy.h>
@@ -101,6 +102,20 @@ public:
    */
   Ptr<PropagationLossModel> GetPropagationLossModel (void);
 
+  /**
+   * Add the transmit filter to be used to skip the receivers of a signal.
+   * If a filter is already set, the new filter is chained to it.
+   *
+   * \param filter a pointer to the transmit filter to be used
+   */
+  void AddSpectrumTransmitFilter (Ptr<SpectrumTransmitFilter> filter);
+
+  /**
+   * Get the transmit filter.
+   * \returns a pointer to the first transmit filter of the chain.
+   */
+  Ptr<SpectrumTransmitFilter> GetSpectrumTransmitFilter (void);
+
   /**
    * Used by attached PHY instances to transmit signals on the channel
    *
@@ -198,6 +213,12 @@ protected:
    */
   Ptr<SpectrumPropagationLossModel> m_spectrumPropagationLoss;
 
+  /**
+   * Transmit filter to be used with this channel, to skip the receivers
+   * which would discard a signal.
+   */
+  Ptr<SpectrumTransmitFilter> m_filter;
+
 
 };
 
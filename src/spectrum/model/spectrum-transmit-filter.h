@@ -0,0 +1,89 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2020 SIGNET Lab, Department of Information Engineering,
+ * University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SPECTRUM_TRANSMIT_FILTER_H
+#define SPECTRUM_TRANSMIT_FILTER_H
+
+#include <ns3/object.h>
+
+namespace ns3 {
+
+class SpectrumPhy;
+struct SpectrumSignalParameters;
+
+/**
+ * \ingroup spectrum
+ *
+ * \brief spectrum-aware transmit filter object
+ *
+ * Interface for transmit filters, which are used by the SpectrumChannel to
+ * skip the receivers that would discard a signal anyway, before the copy of
+ * the signal parameters and the computation of the propagation and spectrum
+ * losses towards them. Filters can be chained: a signal is filtered if any
+ * of the filters in the chain filters it.
+ */
+class SpectrumTransmitFilter : public Object
+{
+public:
+  SpectrumTransmitFilter ();
+  virtual ~SpectrumTransmitFilter ();
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId ();
+
+  /**
+   * Used to chain various instances of SpectrumTransmitFilter
+   *
+   * \param next the filter to be checked after this one
+   */
+  void SetNext (Ptr<SpectrumTransmitFilter> next);
+
+  /**
+   * Evaluate whether the signal to be scheduled on the receiving Phy should
+   * be filtered (dropped) or not
+   *
+   * \param params the parameters of the signals being transmitted
+   * \param receiverPhy the receiving Phy
+   * \return true if the signal should be filtered, false otherwise
+   */
+  bool Filter (Ptr<const SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiverPhy) const;
+
+protected:
+  virtual void DoDispose ();
+
+private:
+  /**
+   * Evaluate whether the signal to be scheduled on the receiving Phy should
+   * be filtered (dropped) or not, according to this filter only
+   *
+   * \param params the parameters of the signals being transmitted
+   * \param receiverPhy the receiving Phy
+   * \return true if the signal should be filtered, false otherwise
+   */
+  virtual bool DoFilter (Ptr<const SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiverPhy) const = 0;
+
+  Ptr<SpectrumTransmitFilter> m_next; //!< SpectrumTransmitFilter chained to this one.
+};
+
+} // namespace ns3
+
+#endif /* SPECTRUM_TRANSMIT_FILTER_H */
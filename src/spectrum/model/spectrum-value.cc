@@ -404,6 +404,42 @@ Integral (const SpectrumValue& arg)
 }
 
 
+double
+SumOfProduct (const SpectrumValue& lhs, const SpectrumValue& rhs)
+{
+  NS_ASSERT (lhs.m_spectrumModel == rhs.m_spectrumModel);
+  double s = 0;
+  Values::const_iterator it1 = lhs.ConstValuesBegin ();
+  Values::const_iterator it2 = rhs.ConstValuesBegin ();
+  while (it1 != lhs.ConstValuesEnd ())
+    {
+      NS_ASSERT (it2 != rhs.ConstValuesEnd ());
+      s += (*it1) * (*it2);
+      ++it1;
+      ++it2;
+    }
+  return s;
+}
+
+
+double
+SumOfRatio (const SpectrumValue& lhs, const SpectrumValue& rhs)
+{
+  NS_ASSERT (lhs.m_spectrumModel == rhs.m_spectrumModel);
+  double s = 0;
+  Values::const_iterator it1 = lhs.ConstValuesBegin ();
+  Values::const_iterator it2 = rhs.ConstValuesBegin ();
+  while (it1 != lhs.ConstValuesEnd ())
+    {
+      NS_ASSERT (it2 != rhs.ConstValuesEnd ());
+      s += (*it1) / (*it2);
+      ++it1;
+      ++it2;
+    }
+  return s;
+}
+
+
 
 Ptr<SpectrumValue>
 SpectrumValue::Copy () const
@@ -676,6 +712,25 @@ SpectrumValue::operator= (double rhs)
 
 
 
+SpectrumValue&
+SpectrumValue::AddScaled (const SpectrumValue& x, double a)
+{
+  Values::iterator it1 = m_values.begin ();
+  Values::const_iterator it2 = x.m_values.begin ();
+
+  NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
+
+  while (it1 != m_values.end ())
+    {
+      NS_ASSERT (it2 != x.m_values.end ());
+      *it1 += (*it2) * a;
+      ++it1;
+      ++it2;
+    }
+  return *this;
+}
+
+
 SpectrumValue
 SpectrumValue::operator<< (int n) const
 {
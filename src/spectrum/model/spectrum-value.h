@@ -420,6 +420,17 @@ public:
    */
   SpectrumValue& operator= (double rhs);
 
+  /**
+   * Add x scaled by a to *this, component by component, i.e., compute
+   * *this += a * x without creating a temporary SpectrumValue
+   *
+   * @param x the SpectrumValue to add
+   * @param a the scaling factor
+   *
+   * @return a reference to *this
+   */
+  SpectrumValue& AddScaled (const SpectrumValue& x, double a);
+
 
 
   /**
@@ -451,6 +462,26 @@ public:
   friend double Prod (const SpectrumValue& x);
 
 
+  /**
+   * @param lhs the first operand
+   * @param rhs the second operand
+   *
+   * @return the sum of the products of the values of lhs and rhs, i.e.,
+   * Sum (lhs * rhs) without the temporary SpectrumValue
+   */
+  friend double SumOfProduct (const SpectrumValue& lhs, const SpectrumValue& rhs);
+
+
+  /**
+   * @param lhs the numerators
+   * @param rhs the denominators
+   *
+   * @return the sum of the ratios of the values of lhs and rhs, i.e.,
+   * Sum (lhs / rhs) without the temporary SpectrumValue
+   */
+  friend double SumOfRatio (const SpectrumValue& lhs, const SpectrumValue& rhs);
+
+
   /**
    *
    *
@@ -624,6 +655,8 @@ std::ostream& operator << (std::ostream& os, const SpectrumValue& pvf);
 double Norm (const SpectrumValue& x);
 double Sum (const SpectrumValue& x);
 double Prod (const SpectrumValue& x);
+double SumOfProduct (const SpectrumValue& lhs, const SpectrumValue& rhs);
+double SumOfRatio (const SpectrumValue& lhs, const SpectrumValue& rhs);
 SpectrumValue Pow (const SpectrumValue& lhs, double rhs);
 SpectrumValue Pow (double lhs, const SpectrumValue& rhs);
 SpectrumValue Log10 (const SpectrumValue& arg);
@@ -27,12 +27,19 @@
 #include "ns3/double.h"
 #include "ns3/string.h"
 #include "ns3/integer.h"
+#include "ns3/uinteger.h"
 #include <algorithm>
 #include <random>
 #include "ns3/log.h"
 #include <ns3/simulator.h>
+#include <ns3/abort.h>
+#include <ns3/rng-seed-manager.h>
 #include "ns3/mobility-model.h"
 #include "ns3/pointer.h"
+#include <ns3/core-config.h>
+#ifdef HAVE_PTHREAD_H
+#include <ns3/system-thread.h>
+#endif
 
 namespace ns3 {
 
@@ -161,6 +168,9 @@ static const double sqrtC_office_NLOS[6][6] = {
 };
 
 ThreeGppChannelModel::ThreeGppChannelModel ()
+  : m_prefetchEpoch (-1),
+    m_linkStream (0),
+    m_linkStreamAssigned (false)
 {
   NS_LOG_FUNCTION (this);
   m_uniformRv = CreateObject<UniformRandomVariable> ();
@@ -179,6 +189,7 @@ void
 ThreeGppChannelModel::DoDispose ()
 {
   m_channelMap.clear ();
+  m_prefetchLinks.clear ();
   m_channelConditionModel->Dispose ();
   m_channelConditionModel = nullptr;
 }
@@ -214,6 +225,17 @@ ThreeGppChannelModel::GetTypeId (void)
                    TimeValue (MilliSeconds (0)),
                    MakeTimeAccessor (&ThreeGppChannelModel::m_updatePeriod),
                    MakeTimeChecker ())
+    .AddAttribute ("PrefetchThreads",
+                   "If greater than 0 and UpdatePeriod is not zero, the realizations "
+                   "of the links requested during the previous update epoch are "
+                   "regenerated when a new epoch (a multiple of UpdatePeriod) is "
+                   "entered, on this number of threads, "
+                   "and each link draws from its own random stream. If 0, the "
+                   "realizations are regenerated when they are requested after "
+                   "UpdatePeriod.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&ThreeGppChannelModel::m_prefetchThreads),
+                   MakeUintegerChecker<uint32_t> ())
     // attributes for the blockage model
     .AddAttribute ("Blockage",
                    "Enable blockage model A (sec 7.6.4.1)",
@@ -747,11 +769,24 @@ ThreeGppChannelModel::GetChannel (Ptr<const MobilityModel> aMob,
 {
   NS_LOG_FUNCTION (this);
 
+  bool prefetch = IsPrefetchEnabled ();
+  if (prefetch)
+    {
+      PrefetchChannels ();
+    }
+
   // Compute the channel key. The key is reciprocal, i.e., key (a, b) = key (b, a)
   uint32_t x1 = std::min (aMob->GetObject<Node> ()->GetId (), bMob->GetObject<Node> ()->GetId ());
   uint32_t x2 = std::max (aMob->GetObject<Node> ()->GetId (), bMob->GetObject<Node> ()->GetId ());
   uint32_t channelId = GetKey (x1, x2);
 
+  PrefetchLink *link = 0;
+  if (prefetch)
+    {
+      link = &GetPrefetchLink (channelId);
+      link->m_lastEpoch = m_prefetchEpoch;
+    }
+
   // retrieve the channel condition
   Ptr<const ChannelCondition> condition = m_channelConditionModel->GetChannelCondition (aMob, bMob);
   bool los = (condition->GetLosCondition () == ChannelCondition::LosConditionValue::LOS);
@@ -782,40 +817,286 @@ ThreeGppChannelModel::GetChannel (Ptr<const MobilityModel> aMob,
   if (notFound || update)
     {
       // channel matrix not found or has to be updated, generate a new one
-      Angles txAngle (bMob->GetPosition (), aMob->GetPosition ());
-      Angles rxAngle (aMob->GetPosition (), bMob->GetPosition ());
+      ChannelRng modelRng (PeekPointer (m_normalRv), PeekPointer (m_uniformRv));
+      ChannelRng *rng = &modelRng;
+      if (prefetch)
+        {
+          // the link is regenerated with the same devices in the following epochs
+          link->m_aMob = aMob;
+          link->m_bMob = bMob;
+          link->m_aAntenna = aAntenna;
+          link->m_bAntenna = bAntenna;
+          rng = &link->m_rng;
+        }
 
-      double x = aMob->GetPosition ().x - bMob->GetPosition ().x;
-      double y = aMob->GetPosition ().y - bMob->GetPosition ().y;
-      double distance2D = sqrt (x * x + y * y);
+      GenerationTask task = PrepareGeneration (channelId, aMob, bMob, aAntenna, bAntenna, los, o2i, rng);
+      Generate (task);
+      channelMatrix = StoreChannel (task);
+  }
 
-      // NOTE we assume hUT = min (height(a), height(b)) and
-      // hBS = max (height (a), height (b))
-      double hUt = std::min (aMob->GetPosition ().z, bMob->GetPosition ().z);
-      double hBs = std::max (aMob->GetPosition ().z, bMob->GetPosition ().z);
+  return channelMatrix;
+}
 
-      // TODO this is not currently used, it is needed for the computation of the
-      // additional blockage in case of spatial consistent update
-      // I do not know who is the UT, I can use the relative distance between
-      // tx and rx instead
-      Vector locUt = Vector (0.0, 0.0, 0.0);
+ThreeGppChannelModel::GenerationTask
+ThreeGppChannelModel::PrepareGeneration (uint32_t channelId,
+                                         Ptr<const MobilityModel> aMob,
+                                         Ptr<const MobilityModel> bMob,
+                                         Ptr<const PhasedArrayModel> aAntenna,
+                                         Ptr<const PhasedArrayModel> bAntenna,
+                                         bool los, bool o2i, ChannelRng *rng)
+{
+  GenerationTask task;
+  task.m_channelId = channelId;
+  task.m_nodeIds = std::make_pair (aMob->GetObject<Node> ()->GetId (), bMob->GetObject<Node> ()->GetId ());
+  task.m_los = los;
+  task.m_o2i = o2i;
+  task.m_aAntenna = PeekPointer (aAntenna);
+  task.m_bAntenna = PeekPointer (bAntenna);
+  task.m_txAngle = Angles (bMob->GetPosition (), aMob->GetPosition ());
+  task.m_rxAngle = Angles (aMob->GetPosition (), bMob->GetPosition ());
+
+  double x = aMob->GetPosition ().x - bMob->GetPosition ().x;
+  double y = aMob->GetPosition ().y - bMob->GetPosition ().y;
+  task.m_distance2D = sqrt (x * x + y * y);
+
+  // NOTE we assume hUT = min (height(a), height(b)) and
+  // hBS = max (height (a), height (b))
+  task.m_hUt = std::min (aMob->GetPosition ().z, bMob->GetPosition ().z);
+  task.m_hBs = std::max (aMob->GetPosition ().z, bMob->GetPosition ().z);
+  task.m_rng = rng;
+  return task;
+}
 
-      channelMatrix = GetNewChannel (locUt, los, o2i, aAntenna, bAntenna, rxAngle, txAngle, distance2D, hBs, hUt);
-      channelMatrix->m_nodeIds = std::make_pair (aMob->GetObject<Node> ()->GetId (), bMob->GetObject<Node> ()->GetId ());
+void
+ThreeGppChannelModel::Generate (GenerationTask &task) const
+{
+  // TODO this is not currently used, it is needed for the computation of the
+  // additional blockage in case of spatial consistent update
+  // I do not know who is the UT, I can use the relative distance between
+  // tx and rx instead
+  Vector locUt = Vector (0.0, 0.0, 0.0);
+
+  task.m_channel = GetNewChannel (locUt, task.m_los, task.m_o2i, task.m_aAntenna, task.m_bAntenna,
+                                  task.m_rxAngle, task.m_txAngle, task.m_distance2D, task.m_hBs, task.m_hUt,
+                                  *task.m_rng);
+}
 
-      // store or replace the channel matrix in the channel map
-      m_channelMap[channelId] = channelMatrix;
-  }
+Ptr<ThreeGppChannelModel::ThreeGppChannelMatrix>
+ThreeGppChannelModel::StoreChannel (const GenerationTask &task)
+{
+  task.m_channel->m_generatedTime = Simulator::Now ();
+  task.m_channel->m_nodeIds = task.m_nodeIds;
 
-  return channelMatrix;
+  // store or replace the channel matrix in the channel map
+  m_channelMap[task.m_channelId] = task.m_channel;
+  return task.m_channel;
+}
+
+/**
+ * Realizations generated by a thread of GenerateChannels
+ */
+struct ThreeGppChannelModel::GenerationWorkerTask
+{
+  const ThreeGppChannelModel *model; //!< the model
+  std::vector<GenerationTask *> tasks; //!< the tasks assigned to the thread
+};
+
+void
+ThreeGppChannelModel::GenerationWorker (GenerationWorkerTask *task)
+{
+  // the tasks refer to the shared objects through raw pointers, since their
+  // reference counts are not thread safe
+  for (GenerationTask *generationTask : task->tasks)
+    {
+      task->model->Generate (*generationTask);
+    }
+}
+
+void
+ThreeGppChannelModel::GenerateChannels (std::vector<GenerationTask> &tasks, uint32_t numThreads) const
+{
+  NS_LOG_FUNCTION (this << tasks.size () << numThreads);
+  NS_ABORT_MSG_IF (numThreads == 0, "At least one thread is needed");
+  if (tasks.empty ())
+    {
+      return;
+    }
+
+  // each thread gets a contiguous block of tasks
+  numThreads = std::min<size_t> (numThreads, tasks.size ());
+  std::vector<GenerationWorkerTask> workerTasks (numThreads);
+  for (size_t i = 0; i < tasks.size (); ++i)
+    {
+      GenerationWorkerTask &workerTask = workerTasks[i * numThreads / tasks.size ()];
+      workerTask.model = this;
+      workerTask.tasks.push_back (&tasks[i]);
+    }
+
+#ifdef HAVE_PTHREAD_H
+  std::vector<Ptr<SystemThread> > threads;
+  for (uint32_t i = 1; i < numThreads; ++i)
+    {
+      threads.push_back (Create<SystemThread> (MakeBoundCallback (&ThreeGppChannelModel::GenerationWorker, &workerTasks[i])));
+      threads.back ()->Start ();
+    }
+  GenerationWorker (&workerTasks[0]);
+  for (auto &thread : threads)
+    {
+      thread->Join ();
+    }
+#else
+  for (GenerationWorkerTask &workerTask : workerTasks)
+    {
+      GenerationWorker (&workerTask);
+    }
+#endif
+}
+
+bool
+ThreeGppChannelModel::IsPrefetchEnabled (void) const
+{
+  return m_prefetchThreads > 0 && !m_updatePeriod.IsZero ();
+}
+
+void
+ThreeGppChannelModel::PrefetchChannels (void)
+{
+  int64_t epoch = Simulator::Now ().GetTimeStep () / m_updatePeriod.GetTimeStep ();
+  if (epoch <= m_prefetchEpoch)
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (this << epoch);
+  m_prefetchEpoch = epoch;
+  Time epochStart = TimeStep (epoch * m_updatePeriod.GetTimeStep ());
+
+  // the links are visited by key, so that the channel condition model is
+  // always queried in the same order
+  std::vector<uint32_t> channelIds;
+  channelIds.reserve (m_prefetchLinks.size ());
+  for (const auto &link : m_prefetchLinks)
+    {
+      channelIds.push_back (link.first);
+    }
+  std::sort (channelIds.begin (), channelIds.end ());
+
+  std::vector<GenerationTask> tasks;
+  tasks.reserve (channelIds.size ());
+  for (uint32_t channelId : channelIds)
+    {
+      auto channelIt = m_channelMap.find (channelId);
+      if (channelIt != m_channelMap.end () && channelIt->second->m_generatedTime >= epochStart)
+        {
+          continue;
+        }
+      PrefetchLink &link = m_prefetchLinks.at (channelId);
+      if (link.m_lastEpoch < epoch - 1)
+        {
+          // the link has not been requested during the previous epoch, hence
+          // its devices are released and it is regenerated only if requested
+          // again. It keeps its random numbers, so that its realizations do
+          // not repeat.
+          link.m_aMob = 0;
+          link.m_bMob = 0;
+          link.m_aAntenna = 0;
+          link.m_bAntenna = 0;
+          continue;
+        }
+      Ptr<const ChannelCondition> condition = m_channelConditionModel->GetChannelCondition (link.m_aMob, link.m_bMob);
+      bool los = (condition->GetLosCondition () == ChannelCondition::LosConditionValue::LOS);
+      bool o2i = false; // TODO include the o2i condition in the channel condition model
+      tasks.push_back (PrepareGeneration (channelId, link.m_aMob, link.m_bMob, link.m_aAntenna, link.m_bAntenna,
+                                          los, o2i, &link.m_rng));
+    }
+
+  NS_LOG_DEBUG ("Regenerating " << tasks.size () << " realizations in epoch " << epoch);
+  GenerateChannels (tasks, m_prefetchThreads);
+  for (const GenerationTask &task : tasks)
+    {
+      StoreChannel (task);
+    }
+}
+
+ThreeGppChannelModel::PrefetchLink::PrefetchLink (uint32_t seed, uint64_t stream, uint64_t substream)
+  : m_rng (seed, stream, substream),
+    m_lastEpoch (-1)
+{
+}
+
+ThreeGppChannelModel::PrefetchLink&
+ThreeGppChannelModel::GetPrefetchLink (uint32_t channelId)
+{
+  auto it = m_prefetchLinks.find (channelId);
+  if (it != m_prefetchLinks.end ())
+    {
+      return it->second;
+    }
+
+  if (!m_linkStreamAssigned)
+    {
+      // as RandomVariableStream does, the first 2^63 streams are reserved
+      // for automatic stream number assignment
+      m_linkStream = RngSeedManager::GetNextStreamIndex ();
+      m_linkStreamAssigned = true;
+    }
+
+  // the substream of a link is identified by the run number and the channel
+  // key, so that it does not depend on the order in which the links are
+  // created. The substreams are 2^76 draws apart and the streams 2^127, hence
+  // the run number has to be smaller than 2^19.
+  uint64_t run = RngSeedManager::GetRun ();
+  NS_ABORT_MSG_IF (run >= (1ULL << 19), "The run number is too large for the link substreams");
+  uint64_t substream = (run << 32) | channelId;
+  return m_prefetchLinks.emplace (channelId, PrefetchLink (RngSeedManager::GetSeed (), m_linkStream, substream)).first->second;
+}
+
+uint8_t
+ThreeGppChannelModel::GetSubClusterIndex (uint8_t mIndex)
+{
+  // mapping of the rays to the sub-clusters, see Table 7.5-5
+  switch (mIndex)
+    {
+    case 9:
+    case 10:
+    case 11:
+    case 12:
+    case 17:
+    case 18:
+      return 1;
+    case 13:
+    case 14:
+    case 15:
+    case 16:
+      return 2;
+    default: //case 1,2,3,4,5,6,7,8,19,20
+      return 0;
+    }
+}
+
+std::complex<double>
+ThreeGppChannelModel::SumRayProducts (const std::complex<double> *uSteer,
+                                      const std::complex<double> *sSteer,
+                                      uint8_t begin, uint8_t end)
+{
+  // accumulate real and imaginary parts separately to let the compiler
+  // vectorize the loop
+  double re = 0.0;
+  double im = 0.0;
+  for (uint8_t rIndex = begin; rIndex < end; rIndex++)
+    {
+      re += uSteer[rIndex].real () * sSteer[rIndex].real () - uSteer[rIndex].imag () * sSteer[rIndex].imag ();
+      im += uSteer[rIndex].real () * sSteer[rIndex].imag () + uSteer[rIndex].imag () * sSteer[rIndex].real ();
+    }
+  return std::complex<double> (re, im);
 }
 
 Ptr<ThreeGppChannelModel::ThreeGppChannelMatrix>
 ThreeGppChannelModel::GetNewChannel (Vector locUT, bool los, bool o2i,
-                                     Ptr<const PhasedArrayModel> sAntenna,
-                                     Ptr<const PhasedArrayModel> uAntenna,
+                                     const PhasedArrayModel *sAntenna,
+                                     const PhasedArrayModel *uAntenna,
                                      Angles &uAngle, Angles &sAngle,
-                                     double dis2D, double hBS, double hUT) const
+                                     double dis2D, double hBS, double hUT,
+                                     ChannelRng &rng) const
 {
   NS_LOG_FUNCTION (this);
 
@@ -832,7 +1113,6 @@ ThreeGppChannelModel::GetNewChannel (Vector locUT, bool los, bool o2i,
   Ptr<ThreeGppChannelMatrix> channelParams = Create<ThreeGppChannelMatrix> ();
   channelParams->m_los = los; // set the LOS condition
   channelParams->m_o2i = o2i; // set the O2I condition
-  channelParams->m_generatedTime = Simulator::Now ();
 
   // compute the 3D distance using eq. 7.4-1
   double dis3D = std::sqrt (dis2D * dis2D + (hBS - hUT) * (hBS - hUT));
@@ -851,7 +1131,7 @@ ThreeGppChannelModel::GetNewChannel (Vector locUT, bool los, bool o2i,
   //Generate paramNum independent LSPs.
   for (uint8_t iter = 0; iter < paramNum; iter++)
     {
-      LSPsIndep.push_back (m_normalRv->GetValue ());
+      LSPsIndep.push_back (rng.GetNormal ());
     }
   for (uint8_t row = 0; row < paramNum; row++)
     {
@@ -899,7 +1179,7 @@ ThreeGppChannelModel::GetNewChannel (Vector locUT, bool los, bool o2i,
   double minTau = 100.0;
   for (uint8_t cIndex = 0; cIndex < numOfCluster; cIndex++)
     {
-      double tau = -1*table3gpp->m_rTau*DS*log (m_uniformRv->GetValue (0,1)); //(7.5-1)
+      double tau = -1*table3gpp->m_rTau*DS*log (rng.GetUniform (0,1)); //(7.5-1)
       if (minTau > tau)
         {
           minTau = tau;
@@ -922,7 +1202,7 @@ ThreeGppChannelModel::GetNewChannel (Vector locUT, bool los, bool o2i,
   for (uint8_t cIndex = 0; cIndex < numOfCluster; cIndex++)
     {
       double power = exp (-1 * clusterDelay[cIndex] * (table3gpp->m_rTau - 1) / table3gpp->m_rTau / DS) *
-        pow (10,-1 * m_normalRv->GetValue () * table3gpp->m_perClusterShadowingStd / 10);                       //(7.5-5)
+        pow (10,-1 * rng.GetNormal () * table3gpp->m_perClusterShadowingStd / 10);                       //(7.5-5)
       powerSum += power;
       clusterPower.push_back (power);
     }
@@ -1099,21 +1379,21 @@ ThreeGppChannelModel::GetNewChannel (Vector locUT, bool los, bool o2i,
   for (uint8_t cIndex = 0; cIndex < numReducedCluster; cIndex++)
     {
       int Xn = 1;
-      if (m_uniformRv->GetValue (0,1) < 0.5)
+      if (rng.GetUniform (0,1) < 0.5)
         {
           Xn = -1;
         }
-      clusterAoa[cIndex] = clusterAoa[cIndex] * Xn + (m_normalRv->GetValue () * ASA / 7) + uAngle.phi * 180 / M_PI;        //(7.5-11)
-      clusterAod[cIndex] = clusterAod[cIndex] * Xn + (m_normalRv->GetValue () * ASD / 7) + sAngle.phi * 180 / M_PI;
+      clusterAoa[cIndex] = clusterAoa[cIndex] * Xn + (rng.GetNormal () * ASA / 7) + uAngle.phi * 180 / M_PI;        //(7.5-11)
+      clusterAod[cIndex] = clusterAod[cIndex] * Xn + (rng.GetNormal () * ASD / 7) + sAngle.phi * 180 / M_PI;
       if (o2i)
         {
-          clusterZoa[cIndex] = clusterZoa[cIndex] * Xn + (m_normalRv->GetValue () * ZSA / 7) + 90;            //(7.5-16)
+          clusterZoa[cIndex] = clusterZoa[cIndex] * Xn + (rng.GetNormal () * ZSA / 7) + 90;            //(7.5-16)
         }
       else
         {
-          clusterZoa[cIndex] = clusterZoa[cIndex] * Xn + (m_normalRv->GetValue () * ZSA / 7) + uAngle.theta * 180 / M_PI;            //(7.5-16)
+          clusterZoa[cIndex] = clusterZoa[cIndex] * Xn + (rng.GetNormal () * ZSA / 7) + uAngle.theta * 180 / M_PI;            //(7.5-16)
         }
-      clusterZod[cIndex] = clusterZod[cIndex] * Xn + (m_normalRv->GetValue () * ZSD / 7) + sAngle.theta * 180 / M_PI + table3gpp->m_offsetZOD;        //(7.5-19)
+      clusterZod[cIndex] = clusterZod[cIndex] * Xn + (rng.GetNormal () * ZSD / 7) + sAngle.theta * 180 / M_PI + table3gpp->m_offsetZOD;        //(7.5-19)
 
     }
 
@@ -1275,7 +1555,7 @@ ThreeGppChannelModel::GetNewChannel (Vector locUT, bool los, bool o2i,
   DoubleVector attenuation_dB;
   if (m_blockage)
     {
-      attenuation_dB = CalcAttenuationOfBlockage (channelParams, clusterAoa, clusterZoa);
+      attenuation_dB = CalcAttenuationOfBlockage (channelParams, clusterAoa, clusterZoa, rng);
       for (uint8_t cInd = 0; cInd < numReducedCluster; cInd++)
         {
           clusterPower[cInd] = clusterPower[cInd] / pow (10,attenuation_dB[cInd] / 10);
@@ -1309,11 +1589,11 @@ ThreeGppChannelModel::GetNewChannel (Vector locUT, bool los, bool o2i,
           double uXprLinear = pow (10, table3gpp->m_uXpr / 10); // convert to linear
           double sigXprLinear = pow (10, table3gpp->m_sigXpr / 10); // convert to linear
 
-          temp.push_back (std::pow (10, (m_normalRv->GetValue () * sigXprLinear + uXprLinear) / 10));
+          temp.push_back (std::pow (10, (rng.GetNormal () * sigXprLinear + uXprLinear) / 10));
           DoubleVector temp3; // used to store the PHI valuse
           for (uint8_t pInd = 0; pInd < 4; pInd++)
             {
-              temp3.push_back (m_uniformRv->GetValue (-1 * M_PI, M_PI));
+              temp3.push_back (rng.GetUniform (-1 * M_PI, M_PI));
             }
           temp2.push_back (temp3);
         }
@@ -1325,8 +1605,6 @@ ThreeGppChannelModel::GetNewChannel (Vector locUT, bool los, bool o2i,
   //Step 11: Generate channel coefficients for each cluster n and each receiver
   // and transmitter element pair u,s.
 
-  Complex3DVector H_NLOS; // channel coefficients H_NLOS [u][s][n],
-  // where u and s are receive and transmit antenna element, n is cluster index.
   uint64_t uSize = uAntenna->GetNumberOfElements ();
   uint64_t sSize = sAntenna->GetNumberOfElements ();
 
@@ -1352,163 +1630,158 @@ ThreeGppChannelModel::GetNewChannel (Vector locUT, bool los, bool o2i,
 
   NS_LOG_INFO ("1st strongest cluster:" << (int)cluster1st << ", 2nd strongest cluster:" << (int)cluster2nd);
 
-  Complex3DVector H_usn;  //channel coffecient H_usn[u][s][n];
   // NOTE Since each of the strongest 2 clusters are divided into 3 sub-clusters,
   // the total cluster will be numReducedCLuster + 4.
+  uint8_t numSubClusters = (cluster1st == cluster2nd) ? 2 : 4;
+  uint8_t numTotalCluster = numReducedCluster + numSubClusters;
 
-  H_usn.resize (uSize);
+  ComplexTensor3D H_usn (uSize, sSize, numTotalCluster);  //channel coffecient H_usn[u][s][n];
+
+  // The element locations do not depend on the rays, retrieve them only once
+  std::vector<Vector> uLoc (uSize);
   for (uint64_t uIndex = 0; uIndex < uSize; uIndex++)
     {
-      H_usn[uIndex].resize (sSize);
-      for (uint64_t sIndex = 0; sIndex < sSize; sIndex++)
+      uLoc[uIndex] = uAntenna->GetElementLocation (uIndex);
+    }
+  std::vector<Vector> sLoc (sSize);
+  for (uint64_t sIndex = 0; sIndex < sSize; sIndex++)
+    {
+      sLoc[sIndex] = sAntenna->GetElementLocation (sIndex);
+    }
+
+  // Sort the rays by sub-cluster (Table 7.5-5), so that the rays of each
+  // sub-cluster of the 2 strongest clusters are contiguous.
+  // subClusterBound[i] is the position of the first ray of the i-th sub-cluster
+  std::vector<uint8_t> rayOrder;
+  rayOrder.reserve (raysPerCluster);
+  uint8_t subClusterBound[4];
+  for (uint8_t subIndex = 0; subIndex < 3; subIndex++)
+    {
+      subClusterBound[subIndex] = rayOrder.size ();
+      for (uint8_t mIndex = 0; mIndex < raysPerCluster; mIndex++)
         {
-          H_usn[uIndex][sIndex].resize (numReducedCluster);
+          if (GetSubClusterIndex (mIndex) == subIndex)
+            {
+              rayOrder.push_back (mIndex);
+            }
         }
     }
-
-  // The following for loops computes the channel coefficients
-  for (uint64_t uIndex = 0; uIndex < uSize; uIndex++)
+  subClusterBound[3] = raysPerCluster;
+
+  // The element field patterns, the polarization terms and the direction of
+  // arrival and departure depend only on the ray, thus they are computed once
+  // per ray. The coefficients are then obtained as
+  // H_usn[u][s][n] = sum_m uSteer[u][m] * sSteer[s][m], (7.5-22) and (7.5-28)
+  // where the per-ray polarization term and the cluster power are included
+  // in sSteer. The steering matrices are stored row-major, with the rays of
+  // each element in contiguous memory.
+  PhasedArrayModel::ComplexVector uSteer (uSize * raysPerCluster); // uSteer[uIndex * raysPerCluster + rIndex]
+  PhasedArrayModel::ComplexVector sSteer (sSize * raysPerCluster); // sSteer[sIndex * raysPerCluster + rIndex]
+  uint8_t subClusterIndex = numReducedCluster; // index of the next sub-cluster
+  for (uint8_t nIndex = 0; nIndex < numReducedCluster; nIndex++)
     {
-      Vector uLoc = uAntenna->GetElementLocation (uIndex);
-
-      for (uint64_t sIndex = 0; sIndex < sSize; sIndex++)
+      double clusterAmplitude = sqrt (clusterPower[nIndex] / raysPerCluster);
+      for (uint8_t rIndex = 0; rIndex < raysPerCluster; rIndex++)
         {
+          uint8_t mIndex = rayOrder[rIndex];
+          double aoa = rayAoa_radian[nIndex][mIndex];
+          double zoa = rayZoa_radian[nIndex][mIndex];
+          double aod = rayAod_radian[nIndex][mIndex];
+          double zod = rayZod_radian[nIndex][mIndex];
+
+          double rxFieldPatternPhi, rxFieldPatternTheta, txFieldPatternPhi, txFieldPatternTheta;
+          std::tie (rxFieldPatternPhi, rxFieldPatternTheta) = uAntenna->GetElementFieldPattern (Angles (aoa, zoa));
+          std::tie (txFieldPatternPhi, txFieldPatternTheta) = sAntenna->GetElementFieldPattern (Angles (aod, zod));
+
+          const DoubleVector &initialPhase = clusterPhase[nIndex][mIndex];
+          double k = crossPolarizationPowerRatios[nIndex][mIndex];
+          std::complex<double> rayCoeff = (exp (std::complex<double> (0, initialPhase[0])) * rxFieldPatternTheta * txFieldPatternTheta +
+                                           +exp (std::complex<double> (0, initialPhase[1])) * std::sqrt (1 / k) * rxFieldPatternTheta * txFieldPatternPhi +
+                                           +exp (std::complex<double> (0, initialPhase[2])) * std::sqrt (1 / k) * rxFieldPatternPhi * txFieldPatternTheta +
+                                           +exp (std::complex<double> (0, initialPhase[3])) * rxFieldPatternPhi * txFieldPatternPhi)
+            * clusterAmplitude;
+
+          //lambda_0 is accounted in the antenna spacing uLoc and sLoc.
+          Vector rxDir (2 * M_PI * sin (zoa) * cos (aoa), 2 * M_PI * sin (zoa) * sin (aoa), 2 * M_PI * cos (zoa));
+          Vector txDir (2 * M_PI * sin (zod) * cos (aod), 2 * M_PI * sin (zod) * sin (aod), 2 * M_PI * cos (zod));
+          for (uint64_t uIndex = 0; uIndex < uSize; uIndex++)
+            {
+              double rxPhaseDiff = rxDir.x * uLoc[uIndex].x + rxDir.y * uLoc[uIndex].y + rxDir.z * uLoc[uIndex].z;
+              uSteer[uIndex * raysPerCluster + rIndex] = std::polar (1.0, rxPhaseDiff);
+            }
+          for (uint64_t sIndex = 0; sIndex < sSize; sIndex++)
+            {
+              double txPhaseDiff = txDir.x * sLoc[sIndex].x + txDir.y * sLoc[sIndex].y + txDir.z * sLoc[sIndex].z;
+              sSteer[sIndex * raysPerCluster + rIndex] = rayCoeff * std::polar (1.0, txPhaseDiff);
+            }
+        }
+      // NOTE Doppler is computed in the CalcBeamformingGain function and is simplified to only account for the center anngle of each cluster.
 
-          Vector sLoc = sAntenna->GetElementLocation (sIndex);
-
-          for (uint8_t nIndex = 0; nIndex < numReducedCluster; nIndex++)
+      bool strongest = (nIndex == cluster1st || nIndex == cluster2nd);
+      for (uint64_t uIndex = 0; uIndex < uSize; uIndex++)
+        {
+          const std::complex<double> *uRow = &uSteer[uIndex * raysPerCluster];
+          for (uint64_t sIndex = 0; sIndex < sSize; sIndex++)
             {
-              //Compute the N-2 weakest cluster, only vertical polarization. (7.5-22)
-              if (nIndex != cluster1st && nIndex != cluster2nd)
+              const std::complex<double> *sRow = &sSteer[sIndex * raysPerCluster];
+              if (!strongest) //Compute the N-2 weakest cluster, only vertical polarization. (7.5-22)
                 {
-                  std::complex<double> rays (0,0);
-                  for (uint8_t mIndex = 0; mIndex < raysPerCluster; mIndex++)
-                    {
-                      DoubleVector initialPhase = clusterPhase[nIndex][mIndex];
-                      double k = crossPolarizationPowerRatios[nIndex][mIndex];
-                      //lambda_0 is accounted in the antenna spacing uLoc and sLoc.
-                      double rxPhaseDiff = 2 * M_PI * (sin (rayZoa_radian[nIndex][mIndex]) * cos (rayAoa_radian[nIndex][mIndex]) * uLoc.x
-                                                       + sin (rayZoa_radian[nIndex][mIndex]) * sin (rayAoa_radian[nIndex][mIndex]) * uLoc.y
-                                                       + cos (rayZoa_radian[nIndex][mIndex]) * uLoc.z);
-
-                      double txPhaseDiff = 2 * M_PI * (sin (rayZod_radian[nIndex][mIndex]) * cos (rayAod_radian[nIndex][mIndex]) * sLoc.x
-                                                       + sin (rayZod_radian[nIndex][mIndex]) * sin (rayAod_radian[nIndex][mIndex]) * sLoc.y
-                                                       + cos (rayZod_radian[nIndex][mIndex]) * sLoc.z);
-                      // NOTE Doppler is computed in the CalcBeamformingGain function and is simplified to only account for the center anngle of each cluster.
-
-                      double rxFieldPatternPhi, rxFieldPatternTheta, txFieldPatternPhi, txFieldPatternTheta;
-                      std::tie (rxFieldPatternPhi, rxFieldPatternTheta) = uAntenna->GetElementFieldPattern (Angles (rayAoa_radian[nIndex][mIndex], rayZoa_radian[nIndex][mIndex]));
-                      std::tie (txFieldPatternPhi, txFieldPatternTheta) = sAntenna->GetElementFieldPattern (Angles (rayAod_radian[nIndex][mIndex], rayZod_radian[nIndex][mIndex]));
-
-                      rays += (exp (std::complex<double> (0, initialPhase[0])) * rxFieldPatternTheta * txFieldPatternTheta +
-                               +exp (std::complex<double> (0, initialPhase[1])) * std::sqrt (1 / k) * rxFieldPatternTheta * txFieldPatternPhi +
-                               +exp (std::complex<double> (0, initialPhase[2])) * std::sqrt (1 / k) * rxFieldPatternPhi * txFieldPatternTheta +
-                               +exp (std::complex<double> (0, initialPhase[3])) * rxFieldPatternPhi * txFieldPatternPhi)
-                        * exp (std::complex<double> (0, rxPhaseDiff))
-                        * exp (std::complex<double> (0, txPhaseDiff));
-                    }
-                  rays *= sqrt (clusterPower[nIndex] / raysPerCluster);
-                  H_usn[uIndex][sIndex][nIndex] = rays;
+                  H_usn (uIndex, sIndex, nIndex) = SumRayProducts (uRow, sRow, 0, raysPerCluster);
                 }
-              else  //(7.5-28)
+              else //(7.5-28)
                 {
-                  std::complex<double> raysSub1 (0,0);
-                  std::complex<double> raysSub2 (0,0);
-                  std::complex<double> raysSub3 (0,0);
-
-                  for (uint8_t mIndex = 0; mIndex < raysPerCluster; mIndex++)
-                    {
-                      double k = crossPolarizationPowerRatios[nIndex][mIndex];
-
-                      //ZML:Just remind me that the angle offsets for the 3 subclusters were not generated correctly.
-
-                      DoubleVector initialPhase = clusterPhase[nIndex][mIndex];
-                      double rxPhaseDiff = 2 * M_PI * (sin (rayZoa_radian[nIndex][mIndex]) * cos (rayAoa_radian[nIndex][mIndex]) * uLoc.x
-                                                       + sin (rayZoa_radian[nIndex][mIndex]) * sin (rayAoa_radian[nIndex][mIndex]) * uLoc.y
-                                                       + cos (rayZoa_radian[nIndex][mIndex]) * uLoc.z);
-                      double txPhaseDiff = 2 * M_PI * (sin (rayZod_radian[nIndex][mIndex]) * cos (rayAod_radian[nIndex][mIndex]) * sLoc.x
-                                                       + sin (rayZod_radian[nIndex][mIndex]) * sin (rayAod_radian[nIndex][mIndex]) * sLoc.y
-                                                       + cos (rayZod_radian[nIndex][mIndex]) * sLoc.z);
-
-                      double rxFieldPatternPhi, rxFieldPatternTheta, txFieldPatternPhi, txFieldPatternTheta;
-                      std::tie (rxFieldPatternPhi, rxFieldPatternTheta) = uAntenna->GetElementFieldPattern (Angles (rayAoa_radian[nIndex][mIndex], rayZoa_radian[nIndex][mIndex]));
-                      std::tie (txFieldPatternPhi, txFieldPatternTheta) = sAntenna->GetElementFieldPattern (Angles (rayAod_radian[nIndex][mIndex], rayZod_radian[nIndex][mIndex]));
-
-                      switch (mIndex)
-                        {
-                        case 9:
-                        case 10:
-                        case 11:
-                        case 12:
-                        case 17:
-                        case 18:
-                          raysSub2 += (exp (std::complex<double> (0, initialPhase[0])) * rxFieldPatternTheta * txFieldPatternTheta +
-                                       +exp (std::complex<double> (0, initialPhase[1])) * std::sqrt (1 / k) * rxFieldPatternTheta * txFieldPatternPhi +
-                                       +exp (std::complex<double> (0, initialPhase[2])) * std::sqrt (1 / k) * rxFieldPatternPhi * txFieldPatternTheta +
-                                       +exp (std::complex<double> (0, initialPhase[3])) * rxFieldPatternPhi * txFieldPatternPhi)
-                            * exp (std::complex<double> (0, rxPhaseDiff))
-                            * exp (std::complex<double> (0, txPhaseDiff));
-                          break;
-                        case 13:
-                        case 14:
-                        case 15:
-                        case 16:
-                          raysSub3 += (exp (std::complex<double> (0, initialPhase[0])) * rxFieldPatternTheta * txFieldPatternTheta +
-                                       +exp (std::complex<double> (0, initialPhase[1])) * std::sqrt (1 / k) * rxFieldPatternTheta * txFieldPatternPhi +
-                                       +exp (std::complex<double> (0, initialPhase[2])) * std::sqrt (1 / k) * rxFieldPatternPhi * txFieldPatternTheta +
-                                       +exp (std::complex<double> (0, initialPhase[3])) * rxFieldPatternPhi * txFieldPatternPhi)
-                            * exp (std::complex<double> (0, rxPhaseDiff))
-                            * exp (std::complex<double> (0, txPhaseDiff));
-                          break;
-                        default:                        //case 1,2,3,4,5,6,7,8,19,20
-                          raysSub1 += (exp (std::complex<double> (0, initialPhase[0])) * rxFieldPatternTheta * txFieldPatternTheta +
-                                       +exp (std::complex<double> (0, initialPhase[1])) * std::sqrt (1 / k) * rxFieldPatternTheta * txFieldPatternPhi +
-                                       +exp (std::complex<double> (0, initialPhase[2])) * std::sqrt (1 / k) * rxFieldPatternPhi * txFieldPatternTheta +
-                                       +exp (std::complex<double> (0, initialPhase[3])) * rxFieldPatternPhi * txFieldPatternPhi)
-                            * exp (std::complex<double> (0, rxPhaseDiff))
-                            * exp (std::complex<double> (0, txPhaseDiff));
-                          break;
-                        }
-                    }
-                  raysSub1 *= sqrt (clusterPower[nIndex] / raysPerCluster);
-                  raysSub2 *= sqrt (clusterPower[nIndex] / raysPerCluster);
-                  raysSub3 *= sqrt (clusterPower[nIndex] / raysPerCluster);
-                  H_usn[uIndex][sIndex][nIndex] = raysSub1;
-                  H_usn[uIndex][sIndex].push_back (raysSub2);
-                  H_usn[uIndex][sIndex].push_back (raysSub3);
-
+                  H_usn (uIndex, sIndex, nIndex) = SumRayProducts (uRow, sRow, subClusterBound[0], subClusterBound[1]);
+                  H_usn (uIndex, sIndex, subClusterIndex) = SumRayProducts (uRow, sRow, subClusterBound[1], subClusterBound[2]);
+                  H_usn (uIndex, sIndex, subClusterIndex + 1) = SumRayProducts (uRow, sRow, subClusterBound[2], subClusterBound[3]);
                 }
             }
-          if (los) //(7.5-29) && (7.5-30)
+        }
+      if (strongest)
+        {
+          subClusterIndex += 2;
+        }
+    }
+
+  if (los) //(7.5-29) && (7.5-30)
+    {
+      double rxFieldPatternPhi, rxFieldPatternTheta, txFieldPatternPhi, txFieldPatternTheta;
+      std::tie (rxFieldPatternPhi, rxFieldPatternTheta) = uAntenna->GetElementFieldPattern (Angles (uAngle.phi, uAngle.theta));
+      std::tie (txFieldPatternPhi, txFieldPatternTheta) = sAntenna->GetElementFieldPattern (Angles (sAngle.phi, sAngle.theta));
+
+      double lambda = 3e8 / m_frequency; // the wavelength of the carrier frequency
+      double K_linear = pow (10,K_factor / 10);
+
+      // the LOS path should be attenuated if blockage is enabled.
+      std::complex<double> losCoeff = (rxFieldPatternTheta * txFieldPatternTheta - rxFieldPatternPhi * txFieldPatternPhi)
+        * exp (std::complex<double> (0, - 2 * M_PI * dis3D / lambda))
+        * sqrt (K_linear / (1 + K_linear)) / pow (10,attenuation_dB[0] / 10);
+
+      Vector rxDir (2 * M_PI * sin (uAngle.theta) * cos (uAngle.phi), 2 * M_PI * sin (uAngle.theta) * sin (uAngle.phi), 2 * M_PI * cos (uAngle.theta));
+      Vector txDir (2 * M_PI * sin (sAngle.theta) * cos (sAngle.phi), 2 * M_PI * sin (sAngle.theta) * sin (sAngle.phi), 2 * M_PI * cos (sAngle.theta));
+      PhasedArrayModel::ComplexVector uLosSteer (uSize);
+      for (uint64_t uIndex = 0; uIndex < uSize; uIndex++)
+        {
+          double rxPhaseDiff = rxDir.x * uLoc[uIndex].x + rxDir.y * uLoc[uIndex].y + rxDir.z * uLoc[uIndex].z;
+          uLosSteer[uIndex] = losCoeff * std::polar (1.0, rxPhaseDiff);
+        }
+      PhasedArrayModel::ComplexVector sLosSteer (sSize);
+      for (uint64_t sIndex = 0; sIndex < sSize; sIndex++)
+        {
+          double txPhaseDiff = txDir.x * sLoc[sIndex].x + txDir.y * sLoc[sIndex].y + txDir.z * sLoc[sIndex].z;
+          sLosSteer[sIndex] = std::polar (1.0, txPhaseDiff);
+        }
+
+      double nlosScaling = sqrt (1 / (K_linear + 1));
+      for (uint64_t uIndex = 0; uIndex < uSize; uIndex++)
+        {
+          for (uint64_t sIndex = 0; sIndex < sSize; sIndex++)
             {
-              std::complex<double> ray (0,0);
-              double rxPhaseDiff = 2 * M_PI * (sin (uAngle.theta) * cos (uAngle.phi) * uLoc.x
-                                               + sin (uAngle.theta) * sin (uAngle.phi) * uLoc.y
-                                               + cos (uAngle.theta) * uLoc.z);
-              double txPhaseDiff = 2 * M_PI * (sin (sAngle.theta) * cos (sAngle.phi) * sLoc.x
-                                               + sin (sAngle.theta) * sin (sAngle.phi) * sLoc.y
-                                               + cos (sAngle.theta) * sLoc.z);
-
-              double rxFieldPatternPhi, rxFieldPatternTheta, txFieldPatternPhi, txFieldPatternTheta;
-              std::tie (rxFieldPatternPhi, rxFieldPatternTheta) = uAntenna->GetElementFieldPattern (Angles (uAngle.phi, uAngle.theta));
-              std::tie (txFieldPatternPhi, txFieldPatternTheta) = sAntenna->GetElementFieldPattern (Angles (sAngle.phi, sAngle.theta));
-
-              double lambda = 3e8 / m_frequency; // the wavelength of the carrier frequency
-
-              ray = (rxFieldPatternTheta * txFieldPatternTheta - rxFieldPatternPhi * txFieldPatternPhi)
-                  * exp (std::complex<double> (0, - 2 * M_PI * dis3D / lambda))
-                  * exp (std::complex<double> (0, rxPhaseDiff))
-                  * exp (std::complex<double> (0, txPhaseDiff));
-
-              double K_linear = pow (10,K_factor / 10);
-              // the LOS path should be attenuated if blockage is enabled.
-              H_usn[uIndex][sIndex][0] = sqrt (1 / (K_linear + 1)) * H_usn[uIndex][sIndex][0] + sqrt (K_linear / (1 + K_linear)) * ray / pow (10,attenuation_dB[0] / 10);           //(7.5-30) for tau = tau1
-              double tempSize = H_usn[uIndex][sIndex].size ();
-              for (uint8_t nIndex = 1; nIndex < tempSize; nIndex++)
+              std::complex<double> *h = &H_usn (uIndex, sIndex, 0);
+              h[0] = nlosScaling * h[0] + uLosSteer[uIndex] * sLosSteer[sIndex]; //(7.5-30) for tau = tau1
+              for (uint8_t nIndex = 1; nIndex < numTotalCluster; nIndex++)
                 {
-                  H_usn[uIndex][sIndex][nIndex] *= sqrt (1 / (K_linear + 1)); //(7.5-30) for tau = tau2...taunN
+                  h[nIndex] *= nlosScaling; //(7.5-30) for tau = tau2...taunN
                 }
-
             }
         }
     }
@@ -1572,9 +1845,9 @@ ThreeGppChannelModel::GetNewChannel (Vector locUT, bool los, bool o2i,
 
     }
 
-  NS_LOG_INFO ("size of coefficient matrix =[" << H_usn.size () << "][" << H_usn[0].size () << "][" << H_usn[0][0].size () << "]");
+  NS_LOG_INFO ("size of coefficient matrix =[" << H_usn.GetUSize () << "][" << H_usn.GetSSize () << "][" << H_usn.GetNumClusters () << "]");
 
-  channelParams->m_channel = H_usn;
+  channelParams->m_channel = std::move (H_usn);
   channelParams->m_delay = clusterDelay;
 
   channelParams->m_angle.clear ();
@@ -1589,7 +1862,8 @@ ThreeGppChannelModel::GetNewChannel (Vector locUT, bool los, bool o2i,
 MatrixBasedChannelModel::DoubleVector
 ThreeGppChannelModel::CalcAttenuationOfBlockage (Ptr<ThreeGppChannelModel::ThreeGppChannelMatrix> params,
                                                  const DoubleVector &clusterAOA,
-                                                 const DoubleVector &clusterZOA) const
+                                                 const DoubleVector &clusterZOA,
+                                                 ChannelRng &rng) const
 {
   NS_LOG_FUNCTION (this);
 
@@ -1627,17 +1901,17 @@ ThreeGppChannelModel::CalcAttenuationOfBlockage (Ptr<ThreeGppChannelModel::Three
         {
           //draw value from table 7.6.4.1-2 Blocking region parameters
           DoubleVector table;
-          table.push_back (m_normalRv->GetValue ()); //phi_k: store the normal RV that will be mapped to uniform (0,360) later.
+          table.push_back (rng.GetNormal ()); //phi_k: store the normal RV that will be mapped to uniform (0,360) later.
           if (m_scenario == "InH-OfficeMixed" || m_scenario == "InH-OfficeOpen")
             {
-              table.push_back (m_uniformRv->GetValue (15, 45)); //x_k
+              table.push_back (rng.GetUniform (15, 45)); //x_k
               table.push_back (90);  //Theta_k
-              table.push_back (m_uniformRv->GetValue (5, 15)); //y_k
+              table.push_back (rng.GetUniform (5, 15)); //y_k
               table.push_back (2);  //r
             }
           else
             {
-              table.push_back (m_uniformRv->GetValue (5, 15)); //x_k
+              table.push_back (rng.GetUniform (5, 15)); //x_k
               table.push_back (90);  //Theta_k
               table.push_back (5);  //y_k
               table.push_back (10);  //r
@@ -1700,7 +1974,7 @@ ThreeGppChannelModel::CalcAttenuationOfBlockage (Ptr<ThreeGppChannelModel::Three
 
               //Generate a new correlated normal RV with the following formula
               params->m_nonSelfBlocking[blockInd][PHI_INDEX] =
-                R * params->m_nonSelfBlocking[blockInd][PHI_INDEX] + sqrt (1 - R * R) * m_normalRv->GetValue ();
+                R * params->m_nonSelfBlocking[blockInd][PHI_INDEX] + sqrt (1 - R * R) * rng.GetNormal ();
             }
         }
 
@@ -1812,7 +2086,66 @@ ThreeGppChannelModel::AssignStreams (int64_t stream)
   NS_LOG_FUNCTION (this << stream);
   m_normalRv->SetStream (stream);
   m_uniformRv->SetStream (stream + 1);
-  return 2;
+  // as RandomVariableStream does, the last 2^63 streams are reserved for
+  // deterministic stream number assignment
+  m_linkStream = (1ULL << 63) + stream + 2;
+  m_linkStreamAssigned = true;
+  return 3;
+}
+
+ThreeGppChannelModel::ChannelRng::ChannelRng (NormalRandomVariable *normalRv, UniformRandomVariable *uniformRv)
+  : m_normalRv (normalRv),
+    m_uniformRv (uniformRv),
+    m_nextNormal (0.0),
+    m_nextNormalValid (false)
+{
+}
+
+ThreeGppChannelModel::ChannelRng::ChannelRng (uint32_t seed, uint64_t stream, uint64_t substream)
+  : m_normalRv (nullptr),
+    m_uniformRv (nullptr),
+    m_stream (new RngStream (seed, stream, substream)),
+    m_nextNormal (0.0),
+    m_nextNormalValid (false)
+{
+}
+
+double
+ThreeGppChannelModel::ChannelRng::GetNormal (void)
+{
+  if (m_normalRv)
+    {
+      return m_normalRv->GetValue ();
+    }
+  if (m_nextNormalValid)
+    {
+      m_nextNormalValid = false;
+      return m_nextNormal;
+    }
+  // polar method, as in NormalRandomVariable
+  while (true)
+    {
+      double v1 = 2 * m_stream->RandU01 () - 1;
+      double v2 = 2 * m_stream->RandU01 () - 1;
+      double w = v1 * v1 + v2 * v2;
+      if (w <= 1.0 && w > 0.0)
+        {
+          double y = std::sqrt ((-2 * std::log (w)) / w);
+          m_nextNormal = v2 * y;
+          m_nextNormalValid = true;
+          return v1 * y;
+        }
+    }
+}
+
+double
+ThreeGppChannelModel::ChannelRng::GetUniform (double min, double max)
+{
+  if (m_uniformRv)
+    {
+      return m_uniformRv->GetValue (min, max);
+    }
+  return min + m_stream->RandU01 () * (max - min);
 }
 
 }  // namespace ns3
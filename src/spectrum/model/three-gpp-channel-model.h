@@ -27,8 +27,11 @@
 #include <ns3/object.h>
 #include <ns3/nstime.h>
 #include <ns3/random-variable-stream.h>
+#include <ns3/rng-stream.h>
 #include <ns3/boolean.h>
+#include <memory>
 #include <unordered_map>
+#include <vector>
 #include <ns3/channel-condition-model.h>
 #include <ns3/matrix-based-channel-model.h>
 
@@ -43,6 +46,15 @@ class MobilityModel;
  * The class implements the channel matrix generation procedure
  * described in 3GPP TR 38.901.
  *
+ * If the attribute PrefetchThreads is greater than 0 and UpdatePeriod is not
+ * zero, the simulation time is divided into update epochs of UpdatePeriod.
+ * The first call to GetChannel in an epoch regenerates the realizations of
+ * the links requested during the previous epoch, in parallel on
+ * PrefetchThreads threads. The other links are regenerated when they are
+ * requested again. In this mode each link draws from its own RNG substream,
+ * hence its realizations do not depend on the number of threads nor on the
+ * order in which the links are generated.
+ *
  * \see GetChannel
  */
 class ThreeGppChannelModel : public MatrixBasedChannelModel
@@ -123,12 +135,60 @@ public:
    * \brief Assign a fixed random variable stream number to the random variables
    * used by this model.
    *
+   * The third stream is split into the substreams of the links in prefetch
+   * mode.
+   *
    * \param stream first stream index to use
    * \return the number of stream indices assigned by this model
    */
   int64_t AssignStreams (int64_t stream);
 
 private:
+  /**
+   * Source of the random numbers of the channel generation procedure. It
+   * draws either from the random variables of the model or from a RngStream
+   * owned by a link.
+   */
+  class ChannelRng
+  {
+  public:
+    /**
+     * Constructor, the numbers are drawn from the random variables of the model
+     * \param normalRv the normal random variable, with zero mean and unit variance
+     * \param uniformRv the uniform random variable
+     */
+    ChannelRng (NormalRandomVariable *normalRv, UniformRandomVariable *uniformRv);
+
+    /**
+     * Constructor, the numbers are drawn from a new RngStream
+     * \param seed the seed
+     * \param stream the stream index
+     * \param substream the substream index
+     */
+    ChannelRng (uint32_t seed, uint64_t stream, uint64_t substream);
+
+    /**
+     * Draw a normal random number, as NormalRandomVariable does
+     * \return a normal random number with zero mean and unit variance
+     */
+    double GetNormal (void);
+
+    /**
+     * Draw a uniform random number, as UniformRandomVariable does
+     * \param min the lower bound
+     * \param max the upper bound
+     * \return a uniform random number in [min, max)
+     */
+    double GetUniform (double min, double max);
+
+  private:
+    NormalRandomVariable *m_normalRv; //!< the normal random variable, null if m_stream is used
+    UniformRandomVariable *m_uniformRv; //!< the uniform random variable, null if m_stream is used
+    std::unique_ptr<RngStream> m_stream; //!< the stream of the link
+    double m_nextNormal; //!< the second normal number generated by the last polar transform
+    bool m_nextNormalValid; //!< true if m_nextNormal has not been returned yet
+  };
+
   /**
    * Extends the struct ChannelMatrix by including information that are used
    * within the class ThreeGppChannelModel
@@ -211,24 +271,162 @@ private:
    * \param dis2D the 2D distance between tx and rx
    * \param hBS the height of the BS
    * \param hUT the height of the UT
-   * \return the channel realization
+   * \param rng the source of the random numbers
+   * \return the channel realization, whose generation time and node IDs
+   *         have to be set by the caller
    */
   Ptr<ThreeGppChannelMatrix> GetNewChannel (Vector locUT, bool los, bool o2i,
-                                            Ptr<const PhasedArrayModel> sAntenna,
-                                            Ptr<const PhasedArrayModel> uAntenna,
+                                            const PhasedArrayModel *sAntenna,
+                                            const PhasedArrayModel *uAntenna,
                                             Angles &uAngle, Angles &sAngle,
-                                            double dis2D, double hBS, double hUT) const;
+                                            double dis2D, double hBS, double hUT,
+                                            ChannelRng &rng) const;
+
+  /**
+   * Inputs and output of the generation of a channel realization. Only raw
+   * pointers to the shared objects are stored, so that the realizations can
+   * be generated by other threads.
+   */
+  struct GenerationTask
+  {
+    uint32_t m_channelId; //!< the channel key
+    std::pair<uint32_t, uint32_t> m_nodeIds; //!< the IDs of the a and b nodes
+    bool m_los; //!< the LOS/NLOS condition
+    bool m_o2i; //!< whether if it is an outdoor to indoor transmission
+    const PhasedArrayModel *m_aAntenna; //!< the antenna of the a device
+    const PhasedArrayModel *m_bAntenna; //!< the antenna of the b device
+    Angles m_rxAngle; //!< the angle of the b device seen from the a device
+    Angles m_txAngle; //!< the angle of the a device seen from the b device
+    double m_distance2D; //!< the 2D distance between the devices
+    double m_hBs; //!< the height of the BS
+    double m_hUt; //!< the height of the UT
+    ChannelRng *m_rng; //!< the source of the random numbers
+    Ptr<ThreeGppChannelMatrix> m_channel; //!< the generated realization
+  };
+
+  /**
+   * Gather the inputs of the generation of a channel realization
+   * \param channelId the channel key
+   * \param aMob mobility model of the a device
+   * \param bMob mobility model of the b device
+   * \param aAntenna antenna of the a device
+   * \param bAntenna antenna of the b device
+   * \param los the LOS/NLOS condition
+   * \param o2i whether if it is an outdoor to indoor transmission
+   * \param rng the source of the random numbers
+   * \return the generation task
+   */
+  static GenerationTask PrepareGeneration (uint32_t channelId,
+                                           Ptr<const MobilityModel> aMob,
+                                           Ptr<const MobilityModel> bMob,
+                                           Ptr<const PhasedArrayModel> aAntenna,
+                                           Ptr<const PhasedArrayModel> bAntenna,
+                                           bool los, bool o2i, ChannelRng *rng);
+
+  /**
+   * Generate the channel realization of a task
+   * \param task the task
+   */
+  void Generate (GenerationTask &task) const;
+
+  /**
+   * Store the generated realization of a task in m_channelMap
+   * \param task the task
+   * \return the realization
+   */
+  Ptr<ThreeGppChannelMatrix> StoreChannel (const GenerationTask &task);
+
+  struct GenerationWorkerTask;
+
+  /**
+   * Generate the realizations assigned to a thread
+   * \param task the tasks of the thread
+   */
+  static void GenerationWorker (GenerationWorkerTask *task);
+
+  /**
+   * Generate the realizations of the tasks on numThreads threads. The
+   * results do not depend on the number of threads, provided that the tasks
+   * do not share their ChannelRng.
+   * \param tasks the tasks
+   * \param numThreads the number of threads
+   */
+  void GenerateChannels (std::vector<GenerationTask> &tasks, uint32_t numThreads) const;
+
+  /**
+   * \return true if the realizations are regenerated at the beginning of
+   *         each update epoch
+   */
+  bool IsPrefetchEnabled (void) const;
+
+  /**
+   * In prefetch mode, regenerate the realizations of the links requested
+   * during the previous update epoch, which were generated before the
+   * current one, when it is entered
+   */
+  void PrefetchChannels (void);
+
+  /**
+   * Devices and random numbers of a link, stored in prefetch mode to
+   * regenerate its realization in the following update epochs
+   */
+  struct PrefetchLink
+  {
+    /**
+     * Constructor
+     * \param seed the seed of the RngStream of the link
+     * \param stream the stream index of the RngStream of the link
+     * \param substream the substream index of the RngStream of the link
+     */
+    PrefetchLink (uint32_t seed, uint64_t stream, uint64_t substream);
+
+    Ptr<const MobilityModel> m_aMob; //!< mobility model of the a device
+    Ptr<const MobilityModel> m_bMob; //!< mobility model of the b device
+    Ptr<const PhasedArrayModel> m_aAntenna; //!< antenna of the a device
+    Ptr<const PhasedArrayModel> m_bAntenna; //!< antenna of the b device
+    ChannelRng m_rng; //!< the random numbers of the link
+    int64_t m_lastEpoch; //!< the index of the last update epoch in which the link was requested
+  };
+
+  /**
+   * Get the stored information of a link, and create it if needed
+   * \param channelId the channel key
+   * \return the link
+   */
+  PrefetchLink& GetPrefetchLink (uint32_t channelId);
+
+  /**
+   * Returns the index of the sub-cluster a ray belongs to, when the cluster
+   * is split into 3 sub-clusters, see 3GPP TR 38.901 Table 7.5-5
+   * \param mIndex the ray index
+   * \return the sub-cluster index, in [0, 2]
+   */
+  static uint8_t GetSubClusterIndex (uint8_t mIndex);
+
+  /**
+   * Computes sum_m uSteer[m] * sSteer[m] over the rays in [begin, end)
+   * \param uSteer the per-ray terms of the u element
+   * \param sSteer the per-ray terms of the s element
+   * \param begin the first ray
+   * \param end the last ray (excluded)
+   * \return the sum of the per-ray products
+   */
+  static std::complex<double> SumRayProducts (const std::complex<double> *uSteer,
+                                              const std::complex<double> *sSteer,
+                                              uint8_t begin, uint8_t end);
 
   /**
    * Applies the blockage model A described in 3GPP TR 38.901
    * \param params the channel matrix
    * \param clusterAOA vector containing the azimuth angle of arrival for each cluster
    * \param clusterZOA vector containing the zenith angle of arrival for each cluster
+   * \param rng the source of the random numbers
    * \return vector containing the power attenuation for each cluster
    */
   DoubleVector CalcAttenuationOfBlockage (Ptr<ThreeGppChannelMatrix> params,
                                           const DoubleVector &clusterAOA,
-                                          const DoubleVector &clusterZOA) const;
+                                          const DoubleVector &clusterZOA,
+                                          ChannelRng &rng) const;
 
   /**
    * Check if the channel matrix has to be updated
@@ -245,6 +443,11 @@ private:
   Ptr<ChannelConditionModel> m_channelConditionModel; //!< the channel condition model
   Ptr<UniformRandomVariable> m_uniformRv; //!< uniform random variable
   Ptr<NormalRandomVariable> m_normalRv; //!< normal random variable
+  uint32_t m_prefetchThreads; //!< the number of threads which regenerate the realizations, 0 to regenerate them when needed
+  std::unordered_map<uint32_t, PrefetchLink> m_prefetchLinks; //!< the links, in prefetch mode
+  int64_t m_prefetchEpoch; //!< the index of the last update epoch whose realizations have been regenerated
+  uint64_t m_linkStream; //!< the RngStream index whose substreams are assigned to the links
+  bool m_linkStreamAssigned; //!< true if m_linkStream has been assigned
 
   // parameters for the blockage model
   bool m_blockage; //!< enables the blockage model A
@@ -30,7 +30,14 @@
 #include "ns3/string.h"
 #include "ns3/simulator.h"
 #include "ns3/pointer.h"
+#include "ns3/abort.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-thread.h"
+#endif
+#include <algorithm>
 #include <map>
+#include <set>
 
 namespace ns3 {
 
@@ -53,6 +60,7 @@ ThreeGppSpectrumPropagationLossModel::DoDispose ()
 {
   m_deviceAntennaMap.clear ();
   m_longTermMap.clear ();
+  m_gainCacheMap.clear ();
   m_channelModel->Dispose ();
   m_channelModel = nullptr;
 }
@@ -113,114 +121,238 @@ ThreeGppSpectrumPropagationLossModel::GetChannelModelAttribute (const std::strin
   m_channelModel->GetAttribute (name, value);
 }
 
-PhasedArrayModel::ComplexVector
-ThreeGppSpectrumPropagationLossModel::CalcLongTerm (Ptr<const MatrixBasedChannelModel::ChannelMatrix> params,
+void
+ThreeGppSpectrumPropagationLossModel::CalcLongTerm (const MatrixBasedChannelModel::ChannelMatrix &params,
                                                     const PhasedArrayModel::ComplexVector &sW,
-                                                    const PhasedArrayModel::ComplexVector &uW) const
+                                                    const PhasedArrayModel::ComplexVector &uW,
+                                                    PhasedArrayModel::ComplexVector &longTerm) const
 {
   NS_LOG_FUNCTION (this);
 
-  uint16_t sAntenna = static_cast<uint16_t> (sW.size ());
-  uint16_t uAntenna = static_cast<uint16_t> (uW.size ());
+  size_t sAntenna = sW.size ();
+  size_t uAntenna = uW.size ();
 
   NS_LOG_DEBUG ("CalcLongTerm with sAntenna " << sAntenna << " uAntenna " << uAntenna);
   //store the long term part to reduce computation load
   //only the small scale fading needs to be updated if the large scale parameters and antenna weights remain unchanged.
-  PhasedArrayModel::ComplexVector longTerm;
-  uint8_t numCluster = static_cast<uint8_t> (params->m_channel[0][0].size ());
+  const MatrixBasedChannelModel::ComplexTensor3D &h = params.m_channel;
+  size_t numCluster = h.GetNumClusters ();
+  longTerm.assign (numCluster, std::complex<double> (0.0, 0.0));
+  if (numCluster == 0)
+    {
+      return;
+    }
 
-  for (uint8_t cIndex = 0; cIndex < numCluster; cIndex++)
+  // with the default layout the coefficients of the clusters are contiguous
+  // for each (u, s) pair, accumulate w_u * w_s * H[u][s][:] over all the
+  // element pairs
+  size_t nStride = h.GetNStride ();
+  for (size_t uIndex = 0; uIndex < uAntenna; uIndex++)
     {
-      std::complex<double> txSum (0,0);
-      for (uint16_t sIndex = 0; sIndex < sAntenna; sIndex++)
+      for (size_t sIndex = 0; sIndex < sAntenna; sIndex++)
         {
-          std::complex<double> rxSum (0,0);
-          for (uint16_t uIndex = 0; uIndex < uAntenna; uIndex++)
+          std::complex<double> w = uW[uIndex] * sW[sIndex];
+          const std::complex<double> *hus = &h (uIndex, sIndex, 0);
+          for (size_t cIndex = 0; cIndex < numCluster; cIndex++)
             {
-              rxSum = rxSum + uW[uIndex] * params->m_channel[uIndex][sIndex][cIndex];
+              longTerm[cIndex] += w * hus[cIndex * nStride];
             }
-          txSum = txSum + sW[sIndex] * rxSum;
         }
-      longTerm.push_back (txSum);
     }
-  return longTerm;
 }
 
-Ptr<SpectrumValue>
-ThreeGppSpectrumPropagationLossModel::CalcBeamformingGain (Ptr<SpectrumValue> txPsd,
-                                                           PhasedArrayModel::ComplexVector longTerm,
+Ptr<ThreeGppSpectrumPropagationLossModel::GainCache>
+ThreeGppSpectrumPropagationLossModel::GetGainCache (uint32_t linkId,
+                                                    Ptr<const MatrixBasedChannelModel::ChannelMatrix> params,
+                                                    Ptr<const SpectrumModel> sm,
+                                                    const Vector &sSpeed, const Vector &uSpeed) const
+{
+  NS_LOG_FUNCTION (this);
+
+  Ptr<GainCache> &cache = m_gainCacheMap[linkId];
+  if (!cache)
+    {
+      cache = Create<GainCache> ();
+    }
+
+  // the frequency is needed only to update the Doppler rates
+  bool updateDoppler = (cache->m_channel != params || cache->m_sSpeed != sSpeed || cache->m_uSpeed != uSpeed);
+  UpdateGainCache (*cache, PeekPointer (params), *sm, sSpeed, uSpeed, updateDoppler ? GetFrequency () : 0.0);
+  cache->m_channel = params;
+  return cache;
+}
+
+void
+ThreeGppSpectrumPropagationLossModel::UpdateGainCache (GainCache &cache,
+                                                       const MatrixBasedChannelModel::ChannelMatrix *params,
+                                                       const SpectrumModel &sm,
+                                                       const Vector &sSpeed, const Vector &uSpeed,
+                                                       double frequency)
+{
+  size_t numCluster = params->m_channel.GetNumClusters ();
+  bool newChannel = (PeekPointer (cache.m_channel) != params);
+
+  // the delay phasors depend only on the channel realization and on the
+  // frequencies of the sub-bands
+  if (newChannel || cache.m_spectrumModelUid != sm.GetUid ())
+    {
+      NS_LOG_DEBUG ("compute the delay phasors");
+      cache.m_delayPhasors.resize (sm.GetNumBands () * numCluster);
+      auto phasorIt = cache.m_delayPhasors.begin ();
+      for (auto sbit = sm.Begin (); sbit != sm.End (); sbit++)
+        {
+          double fsb = (*sbit).fc; // center frequency of the sub-band
+          for (size_t cIndex = 0; cIndex < numCluster; cIndex++)
+            {
+              double delay = -2 * M_PI * fsb * (params->m_delay[cIndex]);
+              *phasorIt++ = std::polar (1.0, delay);
+            }
+        }
+      cache.m_spectrumModelUid = sm.GetUid ();
+    }
+
+  // the Doppler rates depend on the cluster angles and on the node speeds
+  // NOTE the update of Doppler is simplified by only taking the center angle of
+  // each cluster in to consideration.
+  if (newChannel || cache.m_sSpeed != sSpeed || cache.m_uSpeed != uSpeed)
+    {
+      NS_LOG_DEBUG ("compute the Doppler rates");
+      cache.m_dopplerRate.resize (numCluster);
+      for (size_t cIndex = 0; cIndex < numCluster; cIndex++)
+        {
+          //cluster angle angle[direction][n],where, direction = 0(aoa), 1(zoa).
+          // TODO should I include the "alfa" term for the Doppler of delayed paths?
+          double zoa = params->m_angle[MatrixBasedChannelModel::ZOA_INDEX][cIndex] * M_PI / 180;
+          double aoa = params->m_angle[MatrixBasedChannelModel::AOA_INDEX][cIndex] * M_PI / 180;
+          double zod = params->m_angle[MatrixBasedChannelModel::ZOD_INDEX][cIndex] * M_PI / 180;
+          double aod = params->m_angle[MatrixBasedChannelModel::AOD_INDEX][cIndex] * M_PI / 180;
+          cache.m_dopplerRate[cIndex] = 2 * M_PI * ((sin (zoa) * cos (aoa) * uSpeed.x
+                                                      + sin (zoa) * sin (aoa) * uSpeed.y
+                                                      + cos (zoa) * uSpeed.z)
+                                                     + (sin (zod) * cos (aod) * sSpeed.x
+                                                        + sin (zod) * sin (aod) * sSpeed.y
+                                                        + cos (zod) * sSpeed.z))
+            * frequency / 3e8;
+        }
+      cache.m_sSpeed = sSpeed;
+      cache.m_uSpeed = uSpeed;
+      cache.m_doppler.clear (); // force an exact evaluation of the Doppler terms
+    }
+}
+
+void
+ThreeGppSpectrumPropagationLossModel::UpdateDoppler (GainCache &cache, Time now)
+{
+  size_t numCluster = cache.m_dopplerRate.size ();
+
+  if (!cache.m_doppler.empty () && now == cache.m_dopplerTime)
+    {
+      return;
+    }
+
+  Time step = now - cache.m_dopplerTime;
+  if (!cache.m_doppler.empty ()
+      && step == cache.m_dopplerStep
+      && cache.m_numRotations < MAX_DOPPLER_ROTATIONS)
+    {
+      // same time step as in the previous update, advance the Doppler terms
+      // by an incremental phase rotation
+      for (size_t cIndex = 0; cIndex < numCluster; cIndex++)
+        {
+          cache.m_doppler[cIndex] *= cache.m_dopplerRotation[cIndex];
+        }
+      cache.m_numRotations++;
+    }
+  else
+    {
+      // exact evaluation, and update of the rotation for the new time step
+      bool validStep = !cache.m_doppler.empty ();
+      double t = now.GetSeconds ();
+      double dt = step.GetSeconds ();
+      cache.m_doppler.resize (numCluster);
+      cache.m_dopplerRotation.resize (numCluster);
+      for (size_t cIndex = 0; cIndex < numCluster; cIndex++)
+        {
+          cache.m_doppler[cIndex] = std::polar (1.0, cache.m_dopplerRate[cIndex] * t);
+          if (validStep)
+            {
+              cache.m_dopplerRotation[cIndex] = std::polar (1.0, cache.m_dopplerRate[cIndex] * dt);
+            }
+        }
+      cache.m_dopplerStep = validStep ? step : Time (0);
+      cache.m_numRotations = 0;
+    }
+  cache.m_dopplerTime = now;
+}
+
+void
+ThreeGppSpectrumPropagationLossModel::CalcBeamformingGain (Ptr<SpectrumValue> psd,
+                                                           uint32_t linkId,
+                                                           const PhasedArrayModel::ComplexVector &longTerm,
                                                            Ptr<const MatrixBasedChannelModel::ChannelMatrix> params,
                                                            const ns3::Vector &sSpeed, const ns3::Vector &uSpeed) const
 {
   NS_LOG_FUNCTION (this);
 
-  Ptr<SpectrumValue> tempPsd = Copy<SpectrumValue> (txPsd);
+  // retrieve the delay phasors and compute the doppler term
+  Ptr<GainCache> cache = GetGainCache (linkId, params, psd->GetSpectrumModel (), sSpeed, uSpeed);
+  UpdateDoppler (*cache, Simulator::Now ());
+
+  cache->m_coeff.assign (longTerm.begin (), longTerm.end ());
+  ApplyBeamformingGain (*psd, *cache);
+}
 
+void
+ThreeGppSpectrumPropagationLossModel::ApplyBeamformingGain (SpectrumValue &psd, GainCache &cache)
+{
   //channel[rx][tx][cluster]
-  uint8_t numCluster = static_cast<uint8_t> (params->m_channel[0][0].size ());
+  size_t numCluster = cache.m_coeff.size ();
 
-  // compute the doppler term
-  // NOTE the update of Doppler is simplified by only taking the center angle of
-  // each cluster in to consideration.
-  double slotTime = Simulator::Now ().GetSeconds ();
-  PhasedArrayModel::ComplexVector doppler;
-  for (uint8_t cIndex = 0; cIndex < numCluster; cIndex++)
+  // apply the doppler term to the long term component
+  for (size_t cIndex = 0; cIndex < numCluster; cIndex++)
     {
-      //cluster angle angle[direction][n],where, direction = 0(aoa), 1(zoa).
-      // TODO should I include the "alfa" term for the Doppler of delayed paths?
-      double temp_doppler = 2 * M_PI * ((sin (params->m_angle[MatrixBasedChannelModel::ZOA_INDEX][cIndex] * M_PI / 180) * cos (params->m_angle[MatrixBasedChannelModel::AOA_INDEX][cIndex] * M_PI / 180) * uSpeed.x
-                                         + sin (params->m_angle[MatrixBasedChannelModel::ZOA_INDEX][cIndex] * M_PI / 180) * sin (params->m_angle[MatrixBasedChannelModel::AOA_INDEX][cIndex] * M_PI / 180) * uSpeed.y
-                                         + cos (params->m_angle[MatrixBasedChannelModel::ZOA_INDEX][cIndex] * M_PI / 180) * uSpeed.z)
-                                         + (sin (params->m_angle[MatrixBasedChannelModel::ZOD_INDEX][cIndex] * M_PI / 180) * cos (params->m_angle[MatrixBasedChannelModel::AOD_INDEX][cIndex] * M_PI / 180) * sSpeed.x
-                                         + sin (params->m_angle[MatrixBasedChannelModel::ZOD_INDEX][cIndex] * M_PI / 180) * sin (params->m_angle[MatrixBasedChannelModel::AOD_INDEX][cIndex] * M_PI / 180) * sSpeed.y
-                                         + cos (params->m_angle[MatrixBasedChannelModel::ZOD_INDEX][cIndex] * M_PI / 180) * sSpeed.z))
-        * slotTime * GetFrequency () / 3e8;
-      doppler.push_back (exp (std::complex<double> (0, temp_doppler)));
+      cache.m_coeff[cIndex] *= cache.m_doppler[cIndex];
     }
 
-  // apply the doppler term and the propagation delay to the long term component
-  // to obtain the beamforming gain
-  auto vit = tempPsd->ValuesBegin (); // psd iterator
-  auto sbit = tempPsd->ConstBandsBegin(); // band iterator
-  while (vit != tempPsd->ValuesEnd ())
+  // apply the propagation delay to obtain the beamforming gain of each
+  // sub-band, real and imaginary parts are accumulated separately to let the
+  // compiler vectorize the inner loop
+  const std::complex<double> *coeff = cache.m_coeff.data ();
+  const std::complex<double> *phasor = cache.m_delayPhasors.data ();
+  for (auto vit = psd.ValuesBegin (); vit != psd.ValuesEnd (); vit++, phasor += numCluster)
     {
-      std::complex<double> subsbandGain (0.0,0.0);
       if ((*vit) != 0.00)
         {
-          double fsb = (*sbit).fc; // center frequency of the sub-band
-          for (uint8_t cIndex = 0; cIndex < numCluster; cIndex++)
+          double gainRe = 0.0;
+          double gainIm = 0.0;
+          for (size_t cIndex = 0; cIndex < numCluster; cIndex++)
             {
-              double delay = -2 * M_PI * fsb * (params->m_delay[cIndex]);
-              subsbandGain = subsbandGain + longTerm[cIndex] * doppler[cIndex] * exp (std::complex<double> (0, delay));
+              gainRe += coeff[cIndex].real () * phasor[cIndex].real () - coeff[cIndex].imag () * phasor[cIndex].imag ();
+              gainIm += coeff[cIndex].real () * phasor[cIndex].imag () + coeff[cIndex].imag () * phasor[cIndex].real ();
             }
-          *vit = (*vit) * (norm (subsbandGain));
+          *vit = (*vit) * (gainRe * gainRe + gainIm * gainIm);
         }
-      vit++;
-      sbit++;
     }
-  return tempPsd;
 }
 
-PhasedArrayModel::ComplexVector
+const PhasedArrayModel::ComplexVector &
 ThreeGppSpectrumPropagationLossModel::GetLongTerm (uint32_t aId, uint32_t bId,
                                                    Ptr<const MatrixBasedChannelModel::ChannelMatrix> channelMatrix,
-                                                   const PhasedArrayModel::ComplexVector &aW,
-                                                   const PhasedArrayModel::ComplexVector &bW) const
+                                                   Ptr<const PhasedArrayModel> aAntenna,
+                                                   Ptr<const PhasedArrayModel> bAntenna) const
 {
-  PhasedArrayModel::ComplexVector longTerm; // vector containing the long term component for each cluster
-
   // check if the channel matrix was generated considering a as the s-node and
   // b as the u-node or viceversa
-  PhasedArrayModel::ComplexVector sW, uW;
+  Ptr<const PhasedArrayModel> sAntenna, uAntenna;
   if (!channelMatrix->IsReverse (aId, bId))
   {
-    sW = aW;
-    uW = bW;
+    sAntenna = aAntenna;
+    uAntenna = bAntenna;
   }
   else
   {
-    sW = bW;
-    uW = aW;
+    sAntenna = bAntenna;
+    uAntenna = aAntenna;
   }
 
   // compute the long term key, the key is unique for each tx-rx pair
@@ -228,46 +360,33 @@ ThreeGppSpectrumPropagationLossModel::GetLongTerm (uint32_t aId, uint32_t bId,
   uint32_t x2 = std::max (aId, bId);
   uint32_t longTermId = MatrixBasedChannelModel::GetKey (x1, x2);
 
-  bool update = false; // indicates whether the long term has to be updated
-  bool notFound = false; // indicates if the long term has not been computed yet
-
-  // look for the long term in the map and check if it is valid
-  if (m_longTermMap.find (longTermId) != m_longTermMap.end ())
-  {
-    NS_LOG_DEBUG ("found the long term component in the map");
-    longTerm = m_longTermMap[longTermId]->m_longTerm;
-
-    // check if the channel matrix has been updated
-    // or the s beam has been changed
-    // or the u beam has been changed
-    update = (m_longTermMap[longTermId]->m_channel->m_generatedTime != channelMatrix->m_generatedTime
-              || m_longTermMap[longTermId]->m_sW != sW
-              || m_longTermMap[longTermId]->m_uW != uW);
+  // look for the long term in the map, a new entry is created if not found
+  LongTerm &longTermItem = m_longTermMap[longTermId];
 
-  }
-  else
-  {
-    NS_LOG_DEBUG ("long term component NOT found");
-    notFound = true;
-  }
+  // check if the long term has not been computed yet,
+  // or the channel matrix has been updated
+  // or the s beam has been changed
+  // or the u beam has been changed
+  bool update = (!longTermItem.m_channel
+                 || longTermItem.m_channel->m_generatedTime != channelMatrix->m_generatedTime
+                 || longTermItem.m_sWEpoch != sAntenna->GetBeamformingVectorEpoch ()
+                 || longTermItem.m_uWEpoch != uAntenna->GetBeamformingVectorEpoch ());
 
-  if (update || notFound)
+  if (update)
     {
       NS_LOG_DEBUG ("compute the long term");
-      // compute the long term component
-      longTerm = CalcLongTerm (channelMatrix, sW, uW);
-
-      // store the long term
-      Ptr<LongTerm> longTermItem = Create<LongTerm> ();
-      longTermItem->m_longTerm = longTerm;
-      longTermItem->m_channel = channelMatrix;
-      longTermItem->m_sW = sW;
-      longTermItem->m_uW = uW;
-
-      m_longTermMap[longTermId] = longTermItem;
+      // compute and store the long term component
+      CalcLongTerm (*channelMatrix, sAntenna->GetBeamformingVector (), uAntenna->GetBeamformingVector (), longTermItem.m_longTerm);
+      longTermItem.m_channel = channelMatrix;
+      longTermItem.m_sWEpoch = sAntenna->GetBeamformingVectorEpoch ();
+      longTermItem.m_uWEpoch = uAntenna->GetBeamformingVectorEpoch ();
+    }
+  else
+    {
+      NS_LOG_DEBUG ("found the long term component in the map");
     }
 
-  return longTerm;
+  return longTermItem.m_longTerm;
 }
 
 Ptr<SpectrumValue>
@@ -297,18 +416,165 @@ ThreeGppSpectrumPropagationLossModel::DoCalcRxPowerSpectralDensity (Ptr<const Sp
 
   Ptr<const MatrixBasedChannelModel::ChannelMatrix> channelMatrix = m_channelModel->GetChannel (a, b, aAntenna, bAntenna);
 
-  // get the precoding and combining vectors
-  PhasedArrayModel::ComplexVector aW = aAntenna->GetBeamformingVector ();
-  PhasedArrayModel::ComplexVector bW = bAntenna->GetBeamformingVector ();
-
   // retrieve the long term component
-  PhasedArrayModel::ComplexVector longTerm = GetLongTerm (aId, bId, channelMatrix, aW, bW);
+  const PhasedArrayModel::ComplexVector &longTerm = GetLongTerm (aId, bId, channelMatrix, aAntenna, bAntenna);
 
-  // apply the beamforming gain
-  rxPsd = CalcBeamformingGain (rxPsd, longTerm, channelMatrix, a->GetVelocity (), b->GetVelocity ());
+  // apply the beamforming gain, the key of the cached terms depends on the
+  // direction of the link since the node speeds are not swapped
+  uint32_t linkId = MatrixBasedChannelModel::GetKey (aId, bId);
+  CalcBeamformingGain (rxPsd, linkId, longTerm, channelMatrix, a->GetVelocity (), b->GetVelocity ());
 
   return rxPsd;
 }
 
+ThreeGppSpectrumPropagationLossModel::RxPsdTask
+ThreeGppSpectrumPropagationLossModel::PrepareRxPsd (Ptr<const SpectrumValue> txPsd,
+                                                    Ptr<const MobilityModel> a,
+                                                    Ptr<const MobilityModel> b) const
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t aId = a->GetObject<Node> ()->GetId (); // id of the node a
+  uint32_t bId = b->GetObject<Node> ()->GetId (); // id of the node b
+
+  NS_ASSERT (aId != bId);
+
+  NS_ASSERT_MSG (a->GetDistanceFrom (b) > 0.0, "The position of a and b devices cannot be the same");
+
+  NS_ASSERT_MSG (m_deviceAntennaMap.find (aId) != m_deviceAntennaMap.end (), "Antenna not found for node " << aId);
+  Ptr<const PhasedArrayModel> aAntenna = m_deviceAntennaMap.at (aId);
+  NS_ASSERT_MSG (m_deviceAntennaMap.find (bId) != m_deviceAntennaMap.end (), "Antenna not found for device " << bId);
+  Ptr<const PhasedArrayModel> bAntenna = m_deviceAntennaMap.at (bId);
+
+  RxPsdTask task;
+  task.m_psd = Copy<SpectrumValue> (txPsd);
+  task.m_channel = m_channelModel->GetChannel (a, b, aAntenna, bAntenna);
+
+  // copy the beamforming vectors with the orientation of the channel matrix
+  if (!task.m_channel->IsReverse (aId, bId))
+    {
+      task.m_sW = aAntenna->GetBeamformingVector ();
+      task.m_uW = bAntenna->GetBeamformingVector ();
+    }
+  else
+    {
+      task.m_sW = bAntenna->GetBeamformingVector ();
+      task.m_uW = aAntenna->GetBeamformingVector ();
+    }
+
+  task.m_linkId = MatrixBasedChannelModel::GetKey (aId, bId);
+  task.m_aSpeed = a->GetVelocity ();
+  task.m_bSpeed = b->GetVelocity ();
+  return task;
+}
+
+/**
+ * Links assigned to a thread by CalcRxPsds
+ */
+struct ThreeGppSpectrumPropagationLossModel::RxPsdWorkerTask
+{
+  /**
+   * A link whose rx PSD is computed by the thread
+   */
+  struct Item
+  {
+    RxPsdTask *task; //!< the task of the link
+    GainCache *cache; //!< the GainCache of the link
+    const SpectrumModel *sm; //!< the spectrum model of the PSD
+  };
+
+  const ThreeGppSpectrumPropagationLossModel *model; //!< the model
+  double frequency; //!< the operating frequency in Hz
+  Time now; //!< the current time
+  std::vector<Item> items; //!< the links assigned to the thread
+};
+
+void
+ThreeGppSpectrumPropagationLossModel::RxPsdWorker (RxPsdWorkerTask *task)
+{
+  // only raw pointers and objects of the links of this thread are used here,
+  // since the reference counts of the shared objects are not thread safe: the
+  // channel of each GainCache is stored by CalcRxPsds, after the threads end
+  for (RxPsdWorkerTask::Item &item : task->items)
+    {
+      const MatrixBasedChannelModel::ChannelMatrix *params = PeekPointer (item.task->m_channel);
+      UpdateGainCache (*item.cache, params, *item.sm, item.task->m_aSpeed, item.task->m_bSpeed, task->frequency);
+      UpdateDoppler (*item.cache, task->now);
+      task->model->CalcLongTerm (*params, item.task->m_sW, item.task->m_uW, item.cache->m_coeff);
+      ApplyBeamformingGain (*item.task->m_psd, *item.cache);
+    }
+}
+
+void
+ThreeGppSpectrumPropagationLossModel::CalcRxPsds (std::vector<RxPsdTask> &tasks, uint32_t numThreads) const
+{
+  NS_LOG_FUNCTION (this << tasks.size () << numThreads);
+  NS_ABORT_MSG_IF (numThreads == 0, "At least one thread is needed");
+  if (tasks.empty ())
+    {
+      return;
+    }
+
+  numThreads = std::min<size_t> (numThreads, tasks.size ());
+  std::vector<RxPsdWorkerTask> workerTasks (numThreads);
+  double frequency = GetFrequency ();
+  for (RxPsdWorkerTask &workerTask : workerTasks)
+    {
+      workerTask.model = this;
+      workerTask.frequency = frequency;
+      workerTask.now = Simulator::Now ();
+    }
+
+  // the GainCaches are created here, since the threads cannot modify
+  // m_gainCacheMap, and each thread gets a contiguous block of tasks. Each
+  // link must appear once, otherwise two threads could update its GainCache.
+#ifdef NS3_ASSERT_ENABLE
+  std::set<uint32_t> linkIds;
+#endif
+  for (size_t i = 0; i < tasks.size (); ++i)
+    {
+#ifdef NS3_ASSERT_ENABLE
+      bool newLink = linkIds.insert (tasks[i].m_linkId).second;
+      NS_ASSERT_MSG (newLink, "Link " << tasks[i].m_linkId << " appears in more than one task");
+#endif
+      Ptr<GainCache> &cache = m_gainCacheMap[tasks[i].m_linkId];
+      if (!cache)
+        {
+          cache = Create<GainCache> ();
+        }
+      RxPsdWorkerTask::Item item;
+      item.task = &tasks[i];
+      item.cache = PeekPointer (cache);
+      item.sm = PeekPointer (tasks[i].m_psd->GetSpectrumModel ());
+      workerTasks[i * numThreads / tasks.size ()].items.push_back (item);
+    }
+
+#ifdef HAVE_PTHREAD_H
+  // the threads are created at each call, as the other parallel sections of
+  // the simulator do, since their cost is small compared to the computation
+  // of the PSDs of a transmission
+  std::vector<Ptr<SystemThread> > threads;
+  for (uint32_t i = 1; i < numThreads; ++i)
+    {
+      threads.push_back (Create<SystemThread> (MakeBoundCallback (&ThreeGppSpectrumPropagationLossModel::RxPsdWorker, &workerTasks[i])));
+      threads.back ()->Start ();
+    }
+  RxPsdWorker (&workerTasks[0]);
+  for (auto &thread : threads)
+    {
+      thread->Join ();
+    }
+#else
+  for (RxPsdWorkerTask &workerTask : workerTasks)
+    {
+      RxPsdWorker (&workerTask);
+    }
+#endif
+
+  for (RxPsdTask &task : tasks)
+    {
+      m_gainCacheMap[task.m_linkId]->m_channel = task.m_channel;
+    }
+}
+
 
 }  // namespace ns3
@@ -26,6 +26,7 @@
 #include <complex.h>
 #include <map>
 #include <unordered_map>
+#include <vector>
 #include "ns3/matrix-based-channel-model.h"
 
 namespace ns3 {
@@ -129,18 +130,145 @@ public:
                                                            Ptr<const MobilityModel> a,
                                                            Ptr<const MobilityModel> b) const override;
 
+  /**
+   * A received PSD prepared by PrepareRxPsd and computed by CalcRxPsds
+   */
+  struct RxPsdTask
+  {
+    Ptr<SpectrumValue> m_psd; //!< the tx PSD, replaced by the rx PSD by CalcRxPsds
+    Ptr<const MatrixBasedChannelModel::ChannelMatrix> m_channel; //!< the channel matrix of the link
+    PhasedArrayModel::ComplexVector m_sW; //!< the beamforming vector of the s node when the task was prepared
+    PhasedArrayModel::ComplexVector m_uW; //!< the beamforming vector of the u node when the task was prepared
+    uint32_t m_linkId; //!< the key of the tx-rx pair
+    Vector m_aSpeed; //!< speed of the a node
+    Vector m_bSpeed; //!< speed of the b node
+  };
+
+  /**
+   * Prepare the computation of the received PSD of a link. The channel
+   * matrix is retrieved, and possibly generated, and the current
+   * beamforming vectors of the two devices are copied in the task, so that
+   * the antennas can be reconfigured before the PSD is computed by
+   * CalcRxPsds.
+   * \param txPsd tx PSD
+   * \param a first node mobility model
+   * \param b second node mobility model
+   * \return the task
+   */
+  RxPsdTask PrepareRxPsd (Ptr<const SpectrumValue> txPsd,
+                          Ptr<const MobilityModel> a,
+                          Ptr<const MobilityModel> b) const;
+
+  /**
+   * Compute the received PSDs of a set of tasks prepared by PrepareRxPsd,
+   * with the same result of DoCalcRxPowerSpectralDensity for the beamforming
+   * vectors of the tasks. The tasks are split among numThreads threads, and
+   * the result does not depend on the number of threads. The tasks must
+   * refer to distinct tx-rx pairs.
+   * \param tasks the tasks, whose tx PSDs are replaced by the rx PSDs
+   * \param numThreads the number of threads
+   */
+  void CalcRxPsds (std::vector<RxPsdTask> &tasks, uint32_t numThreads) const;
+
 private:
   /**
    * Data structure that stores the long term component for a tx-rx pair
    */
-  struct LongTerm : public SimpleRefCount<LongTerm>
+  struct LongTerm
   {
     PhasedArrayModel::ComplexVector m_longTerm; //!< vector containing the long term component for each cluster
     Ptr<const MatrixBasedChannelModel::ChannelMatrix> m_channel; //!< pointer to the channel matrix used to compute the long term
-    PhasedArrayModel::ComplexVector m_sW; //!< the beamforming vector for the node s used to compute the long term
-    PhasedArrayModel::ComplexVector m_uW; //!< the beamforming vector for the node u used to compute the long term
+    uint64_t m_sWEpoch {0}; //!< the epoch of the beamforming vector of node s used to compute the long term
+    uint64_t m_uWEpoch {0}; //!< the epoch of the beamforming vector of node u used to compute the long term
+  };
+
+  /**
+   * Data structure that stores the frequency and time dependent terms used
+   * to compute the beamforming gain of a tx-rx pair, i.e., the delay phasors
+   * of each sub-band and cluster, which depend only on the channel
+   * realization and on the spectrum model, and the Doppler terms, which are
+   * advanced by an incremental phase rotation when the time step between two
+   * consecutive evaluations does not change
+   */
+  struct GainCache : public SimpleRefCount<GainCache>
+  {
+    Ptr<const MatrixBasedChannelModel::ChannelMatrix> m_channel; //!< pointer to the channel matrix used to compute the cached terms
+    SpectrumModelUid_t m_spectrumModelUid {0}; //!< uid of the spectrum model used to compute the delay phasors
+    PhasedArrayModel::ComplexVector m_delayPhasors; //!< exp(-j 2 pi f_k tau_n), stored as m_delayPhasors[k * numClusters + n]
+    Vector m_sSpeed; //!< speed of the s node used to compute the Doppler rates
+    Vector m_uSpeed; //!< speed of the u node used to compute the Doppler rates
+    MatrixBasedChannelModel::DoubleVector m_dopplerRate; //!< Doppler angular rate of each cluster in rad/s
+    PhasedArrayModel::ComplexVector m_doppler; //!< Doppler term of each cluster at time m_dopplerTime, empty if not valid
+    PhasedArrayModel::ComplexVector m_dopplerRotation; //!< phase rotation of each cluster for a time step m_dopplerStep
+    Time m_dopplerTime; //!< time instant at which m_doppler was computed
+    Time m_dopplerStep; //!< time step corresponding to m_dopplerRotation
+    uint32_t m_numRotations {0}; //!< number of incremental rotations since the last exact evaluation
+    PhasedArrayModel::ComplexVector m_coeff; //!< scratch buffer for the Doppler-shifted long term component
   };
 
+  /**
+   * Looks for the GainCache of a tx-rx pair and updates the delay phasors and
+   * the Doppler rates, if the channel realization, the spectrum model or the
+   * speeds of the nodes changed
+   * \param linkId the key of the tx-rx pair
+   * \param params the channel matrix
+   * \param sm the spectrum model of the PSD
+   * \param sSpeed speed of the first node
+   * \param uSpeed speed of the second node
+   * \return the updated GainCache
+   */
+  Ptr<GainCache> GetGainCache (uint32_t linkId,
+                               Ptr<const MatrixBasedChannelModel::ChannelMatrix> params,
+                               Ptr<const SpectrumModel> sm,
+                               const Vector &sSpeed, const Vector &uSpeed) const;
+
+  /**
+   * Updates the delay phasors and the Doppler rates of a GainCache, if the
+   * channel realization, the spectrum model or the speeds of the nodes
+   * changed. Only the GainCache is modified, and its channel is not
+   * replaced by params: the caller has to store it after the update, since
+   * this method may run outside of the main thread.
+   * \param cache the GainCache
+   * \param params the channel matrix
+   * \param sm the spectrum model of the PSD
+   * \param sSpeed speed of the first node
+   * \param uSpeed speed of the second node
+   * \param frequency the operating frequency in Hz, used only if the Doppler
+   *        rates have to be updated
+   */
+  static void UpdateGainCache (GainCache &cache,
+                               const MatrixBasedChannelModel::ChannelMatrix *params,
+                               const SpectrumModel &sm,
+                               const Vector &sSpeed, const Vector &uSpeed,
+                               double frequency);
+
+  /**
+   * Brings the Doppler terms of a GainCache to a time instant
+   * \param cache the GainCache
+   * \param now the time instant
+   */
+  static void UpdateDoppler (GainCache &cache, Time now);
+
+  /**
+   * Applies the Doppler terms to the long term component stored in the
+   * m_coeff buffer of a GainCache, and the resulting beamforming gain to a
+   * PSD
+   * \param psd the tx PSD, replaced by the rx PSD
+   * \param cache the GainCache
+   */
+  static void ApplyBeamformingGain (SpectrumValue &psd, GainCache &cache);
+
+  /**
+   * Links assigned to a thread by CalcRxPsds
+   */
+  struct RxPsdWorkerTask;
+
+  /**
+   * Body of the threads of CalcRxPsds
+   * \param task the links assigned to the thread
+   */
+  static void RxPsdWorker (RxPsdWorkerTask *task);
+
   /**
    * Get the operating frequency
    * \return the operating frequency in Hz
@@ -149,46 +277,52 @@ private:
 
   /**
    * Looks for the long term component in m_longTermMap. If found, checks
-   * whether it has to be updated. If not found or if it has to be updated,
-   * calls the method CalcLongTerm to compute it.
+   * whether it has to be updated, i.e., if the channel realization or the
+   * epoch of the beamforming vectors changed. If not found or if it has to
+   * be updated, calls the method CalcLongTerm to compute it.
    * \param aId id of the first node
    * \param bId id of the second node
    * \param channelMatrix the channel matrix
-   * \param aW the beamforming vector of the first device
-   * \param bW the beamforming vector of the second device
-   * \return vector containing the long term compoenent for each cluster
+   * \param aAntenna the antenna array of the first device
+   * \param bAntenna the antenna array of the second device
+   * \return vector containing the long term compoenent for each cluster,
+   *         valid until the next call
    */
-  PhasedArrayModel::ComplexVector GetLongTerm (uint32_t aId, uint32_t bId,
-                                                        Ptr<const MatrixBasedChannelModel::ChannelMatrix> channelMatrix,
-                                                        const PhasedArrayModel::ComplexVector &aW,
-                                                        const PhasedArrayModel::ComplexVector &bW) const;
+  const PhasedArrayModel::ComplexVector &GetLongTerm (uint32_t aId, uint32_t bId,
+                                                      Ptr<const MatrixBasedChannelModel::ChannelMatrix> channelMatrix,
+                                                      Ptr<const PhasedArrayModel> aAntenna,
+                                                      Ptr<const PhasedArrayModel> bAntenna) const;
   /**
    * Computes the long term component
    * \param channelMatrix the channel matrix H
    * \param sW the beamforming vector of the s device
    * \param uW the beamforming vector of the u device
-   * \return the long term component
+   * \param longTerm vector where the long term component is stored
    */
-  PhasedArrayModel::ComplexVector CalcLongTerm (Ptr<const MatrixBasedChannelModel::ChannelMatrix> channelMatrix,
-                                                         const PhasedArrayModel::ComplexVector &sW,
-                                                         const PhasedArrayModel::ComplexVector &uW) const;
+  void CalcLongTerm (const MatrixBasedChannelModel::ChannelMatrix &channelMatrix,
+                     const PhasedArrayModel::ComplexVector &sW,
+                     const PhasedArrayModel::ComplexVector &uW,
+                     PhasedArrayModel::ComplexVector &longTerm) const;
 
   /**
-   * Computes the beamforming gain and applies it to the tx PSD
-   * \param txPsd the tx PSD
+   * Computes the beamforming gain and applies it to the PSD, in place
+   * \param psd the tx PSD, replaced by the rx PSD
+   * \param linkId the key of the tx-rx pair
    * \param longTerm the long term component
    * \param params The channel matrix
    * \param sSpeed speed of the first node
    * \param uSpeed speed of the second node
-   * \return the rx PSD
    */
-  Ptr<SpectrumValue> CalcBeamformingGain (Ptr<SpectrumValue> txPsd,
-                                          PhasedArrayModel::ComplexVector longTerm,
-                                          Ptr<const MatrixBasedChannelModel::ChannelMatrix> params,
-                                          const Vector &sSpeed, const Vector &uSpeed) const;
+  void CalcBeamformingGain (Ptr<SpectrumValue> psd,
+                            uint32_t linkId,
+                            const PhasedArrayModel::ComplexVector &longTerm,
+                            Ptr<const MatrixBasedChannelModel::ChannelMatrix> params,
+                            const Vector &sSpeed, const Vector &uSpeed) const;
 
   std::unordered_map <uint32_t, Ptr<const PhasedArrayModel> > m_deviceAntennaMap; //!< map containig the <node, antenna> associations
-  mutable std::unordered_map < uint32_t, Ptr<const LongTerm> > m_longTermMap; //!< map containing the long term components
+  mutable std::unordered_map < uint32_t, LongTerm > m_longTermMap; //!< map containing the long term components
+  mutable std::unordered_map < uint32_t, Ptr<GainCache> > m_gainCacheMap; //!< map containing the delay phasors and Doppler terms
+  static const uint32_t MAX_DOPPLER_ROTATIONS = 100; //!< maximum number of incremental Doppler rotations before an exact evaluation
   Ptr<MatrixBasedChannelModel> m_channelModel; //!< the model to generate the channel matrix
 };
 } // namespace ns3
@@ -0,0 +1,231 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2020 SIGNET Lab, Department of Information Engineering,
+ * University of Padova
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <ns3/core-module.h>
+#include <ns3/test.h>
+#include <ns3/spectrum-module.h>
+#include <ns3/mobility-module.h>
+#include <ns3/propagation-loss-model.h>
+#include <set>
+
+NS_LOG_COMPONENT_DEFINE ("SpectrumTransmitFilterTest");
+
+using namespace ns3;
+
+/**
+ * SpectrumPhy which only counts the received signals
+ */
+class CountingSpectrumPhy : public SpectrumPhy
+{
+public:
+  /**
+   * Constructor
+   * \param position the position of the PHY
+   * \param rxSpectrumModel the spectrum model of the PHY
+   */
+  CountingSpectrumPhy (Vector position, Ptr<const SpectrumModel> rxSpectrumModel)
+    : m_rxSpectrumModel (rxSpectrumModel),
+      m_numRx (0)
+  {
+    m_mobility = CreateObject<ConstantPositionMobilityModel> ();
+    m_mobility->SetPosition (position);
+  }
+
+  virtual void SetDevice (Ptr<NetDevice> d)
+  {
+  }
+  virtual Ptr<NetDevice> GetDevice () const
+  {
+    return 0;
+  }
+  virtual void SetMobility (Ptr<MobilityModel> m)
+  {
+    m_mobility = m;
+  }
+  virtual Ptr<MobilityModel> GetMobility ()
+  {
+    return m_mobility;
+  }
+  virtual void SetChannel (Ptr<SpectrumChannel> c)
+  {
+  }
+  virtual Ptr<const SpectrumModel> GetRxSpectrumModel () const
+  {
+    return m_rxSpectrumModel;
+  }
+  virtual Ptr<AntennaModel> GetRxAntenna ()
+  {
+    return 0;
+  }
+  virtual void StartRx (Ptr<SpectrumSignalParameters> params)
+  {
+    m_numRx++;
+  }
+
+  /**
+   * \return the number of received signals
+   */
+  uint32_t GetNumRx (void) const
+  {
+    return m_numRx;
+  }
+
+private:
+  Ptr<MobilityModel> m_mobility; //!< the mobility model
+  Ptr<const SpectrumModel> m_rxSpectrumModel; //!< the spectrum model
+  uint32_t m_numRx; //!< the number of received signals
+};
+
+/**
+ * Transmit filter which filters a given set of receivers
+ */
+class SetSpectrumTransmitFilter : public SpectrumTransmitFilter
+{
+public:
+  /**
+   * Filter a receiver
+   * \param phy the receiver to filter
+   */
+  void AddFilteredPhy (Ptr<SpectrumPhy> phy)
+  {
+    m_filtered.insert (phy);
+  }
+
+private:
+  virtual bool DoFilter (Ptr<const SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiverPhy) const
+  {
+    return m_filtered.find (receiverPhy) != m_filtered.end ();
+  }
+
+  std::set<Ptr<SpectrumPhy> > m_filtered; //!< the receivers to filter
+};
+
+/**
+ * Test case for the SpectrumTransmitFilter. It checks that the chained
+ * filters and the MaxLossDb attribute of the MultiModelSpectrumChannel skip
+ * the receivers before their gains are computed
+ */
+class SpectrumTransmitFilterTestCase : public TestCase
+{
+public:
+  SpectrumTransmitFilterTestCase ();
+  virtual ~SpectrumTransmitFilterTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Callback for the Gain trace of the channel
+   * \param txMobility the mobility model of the transmitter
+   * \param rxMobility the mobility model of the receiver
+   * \param txAntennaGain the transmitter antenna gain, in dB
+   * \param rxAntennaGain the receiver antenna gain, in dB
+   * \param propagationGain the propagation gain, in dB
+   * \param pathloss the path loss, in dB
+   */
+  void GainTrace (Ptr<const MobilityModel> txMobility, Ptr<const MobilityModel> rxMobility,
+                  double txAntennaGain, double rxAntennaGain, double propagationGain, double pathloss);
+
+  uint32_t m_numGains; //!< number of times the gain has been computed
+};
+
+SpectrumTransmitFilterTestCase::SpectrumTransmitFilterTestCase ()
+  : TestCase ("Check that the transmit filters and the maximum loss skip the receivers"),
+    m_numGains (0)
+{
+}
+
+SpectrumTransmitFilterTestCase::~SpectrumTransmitFilterTestCase ()
+{
+}
+
+void
+SpectrumTransmitFilterTestCase::GainTrace (Ptr<const MobilityModel> txMobility, Ptr<const MobilityModel> rxMobility,
+                                           double txAntennaGain, double rxAntennaGain, double propagationGain, double pathloss)
+{
+  m_numGains++;
+}
+
+void
+SpectrumTransmitFilterTestCase::DoRun (void)
+{
+  std::vector<double> centerFreqs;
+  centerFreqs.push_back (5.15e9);
+  centerFreqs.push_back (5.16e9);
+  Ptr<SpectrumModel> spectrumModel = Create<SpectrumModel> (centerFreqs);
+
+  Ptr<MultiModelSpectrumChannel> channel = CreateObject<MultiModelSpectrumChannel> ();
+  channel->AddPropagationLossModel (CreateObject<FriisPropagationLossModel> ());
+  channel->SetAttribute ("MaxLossDb", DoubleValue (100));
+  channel->TraceConnectWithoutContext ("Gain", MakeCallback (&SpectrumTransmitFilterTestCase::GainTrace, this));
+
+  // at 5.15 GHz the loss is about 66 dB at 10 m and 126 dB at 10 km
+  Ptr<CountingSpectrumPhy> tx = Create<CountingSpectrumPhy> (Vector (0, 0, 0), spectrumModel);
+  Ptr<CountingSpectrumPhy> rxNear = Create<CountingSpectrumPhy> (Vector (10, 0, 0), spectrumModel);
+  Ptr<CountingSpectrumPhy> rxFiltered1 = Create<CountingSpectrumPhy> (Vector (0, 10, 0), spectrumModel);
+  Ptr<CountingSpectrumPhy> rxFiltered2 = Create<CountingSpectrumPhy> (Vector (-10, 0, 0), spectrumModel);
+  Ptr<CountingSpectrumPhy> rxFar = Create<CountingSpectrumPhy> (Vector (10000, 0, 0), spectrumModel);
+  channel->AddRx (tx);
+  channel->AddRx (rxNear);
+  channel->AddRx (rxFiltered1);
+  channel->AddRx (rxFiltered2);
+  channel->AddRx (rxFar);
+
+  Ptr<SetSpectrumTransmitFilter> filter1 = CreateObject<SetSpectrumTransmitFilter> ();
+  filter1->AddFilteredPhy (rxFiltered1);
+  channel->AddSpectrumTransmitFilter (filter1);
+  Ptr<SetSpectrumTransmitFilter> filter2 = CreateObject<SetSpectrumTransmitFilter> ();
+  filter2->AddFilteredPhy (rxFiltered2);
+  channel->AddSpectrumTransmitFilter (filter2);
+  NS_TEST_ASSERT_MSG_EQ (channel->GetSpectrumTransmitFilter (), filter2, "The last filter should be the first of the chain");
+
+  Ptr<SpectrumSignalParameters> params = Create<SpectrumSignalParameters> ();
+  params->psd = Create<SpectrumValue> (spectrumModel);
+  (*params->psd) = 1e-3;
+  params->duration = MilliSeconds (1);
+  params->txPhy = tx;
+  channel->StartTx (params);
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (tx->GetNumRx (), 0, "The transmitter should not receive its own signal");
+  NS_TEST_ASSERT_MSG_EQ (rxNear->GetNumRx (), 1, "The near receiver should receive the signal");
+  NS_TEST_ASSERT_MSG_EQ (rxFiltered1->GetNumRx (), 0, "The receiver should have been filtered by the first filter");
+  NS_TEST_ASSERT_MSG_EQ (rxFiltered2->GetNumRx (), 0, "The receiver should have been filtered by the second filter");
+  NS_TEST_ASSERT_MSG_EQ (rxFar->GetNumRx (), 0, "The far receiver should be beyond range");
+  NS_TEST_ASSERT_MSG_EQ (m_numGains, 2, "The gain should be computed only for the receivers not filtered");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * Test suite for the SpectrumTransmitFilter
+ */
+class SpectrumTransmitFilterTestSuite : public TestSuite
+{
+public:
+  SpectrumTransmitFilterTestSuite ();
+};
+
+SpectrumTransmitFilterTestSuite::SpectrumTransmitFilterTestSuite ()
+  : TestSuite ("spectrum-transmit-filter", UNIT)
+{
+  AddTestCase (new SpectrumTransmitFilterTestCase, TestCase::QUICK);
+}
+
+static SpectrumTransmitFilterTestSuite g_spectrumTransmitFilterTestSuite;
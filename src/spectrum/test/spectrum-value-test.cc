@@ -242,6 +242,24 @@ SpectrumValueTestSuite::SpectrumValueTestSuite ()
   AddTestCase (new SpectrumValueTestCase (tv1rs3, v1rs3, "tv1rs3 = v1 >> 3"), TestCase::QUICK);
 
 
+  // the fused operations
+  SpectrumValue tv3c (f);
+  tv3c = v1;
+  tv3c.AddScaled (v2, 1.0);
+  AddTestCase (new SpectrumValueTestCase (tv3c, v3, "tv3c.AddScaled (v2, 1)"), TestCase::QUICK);
+
+  SpectrumValue tv8c (f);
+  tv8c = v1;
+  tv8c.AddScaled (v2, -doubleValue);
+  AddTestCase (new SpectrumValueTestCase (tv8c, v1 - doubleValue * v2, "tv8c.AddScaled (v2, -doubleValue)"), TestCase::QUICK);
+
+  SpectrumValue sumOfProduct (f), sumOfRatio (f);
+  sumOfProduct = SumOfProduct (v1, v2);
+  sumOfRatio = SumOfRatio (v1, v2);
+  AddTestCase (new SpectrumValueTestCase (sumOfProduct, SpectrumValue (f) + Sum (v5), "SumOfProduct (v1, v2)"), TestCase::QUICK);
+  AddTestCase (new SpectrumValueTestCase (sumOfRatio, SpectrumValue (f) + Sum (v6), "SumOfRatio (v1, v2)"), TestCase::QUICK);
+
+
 }
 
 
@@ -27,6 +27,7 @@
 #include "ns3/pointer.h"
 #include "ns3/node-container.h"
 #include "ns3/constant-position-mobility-model.h"
+#include "ns3/constant-velocity-mobility-model.h"
 #include "ns3/phased-array-model.h"
 #include "ns3/uniform-planar-array.h"
 #include "ns3/isotropic-antenna-model.h"
@@ -541,6 +542,339 @@ ThreeGppSpectrumPropagationLossModelTest::DoRun ()
   Simulator::Destroy ();
 }
 
+/**
+ * Test case for the parallel computation of the rx PSDs of the
+ * ThreeGppSpectrumPropagationLossModel class. A base station points its beam
+ * towards each of the moving users in turn, and the rx PSDs computed by
+ * CalcRxPsds with 1 and 4 threads are compared with those computed by
+ * DoCalcRxPowerSpectralDensity.
+ */
+class ThreeGppRxPsdTasksTest : public TestCase
+{
+public:
+  /**
+   * Constructor
+   */
+  ThreeGppRxPsdTasksTest ();
+
+  /**
+   * Destructor
+   */
+  virtual ~ThreeGppRxPsdTasksTest ();
+
+private:
+  /**
+   * Build the test scenario
+   */
+  virtual void DoRun (void);
+
+  /**
+   * Compute the rx PSDs of all the users and compare them
+   * \param batchFirst if true, the rx PSDs are computed by CalcRxPsds before
+   *        DoCalcRxPowerSpectralDensity, so that the threads update the cached
+   *        delay and Doppler terms
+   */
+  void CheckRxPsds (bool batchFirst);
+
+  /**
+   * Points the beam of an antenna towards a node
+   * \param thisMob the mobility model of the node of the antenna
+   * \param thisAntenna the antenna
+   * \param otherMob the mobility model of the other node
+   */
+  static void DoBeamforming (Ptr<MobilityModel> thisMob, Ptr<PhasedArrayModel> thisAntenna, Ptr<MobilityModel> otherMob);
+
+  Ptr<ThreeGppSpectrumPropagationLossModel> m_lossModel; //!< the loss model
+  Ptr<SpectrumValue> m_txPsd; //!< the tx PSD of the users
+  Ptr<MobilityModel> m_bsMob; //!< the mobility model of the base station
+  Ptr<PhasedArrayModel> m_bsAntenna; //!< the antenna of the base station
+  std::vector<Ptr<MobilityModel> > m_utMobs; //!< the mobility models of the users
+  std::vector<Ptr<PhasedArrayModel> > m_utAntennas; //!< the antennas of the users
+};
+
+ThreeGppRxPsdTasksTest::ThreeGppRxPsdTasksTest ()
+  : TestCase ("Test case for the parallel computation of the rx PSDs of the ThreeGppSpectrumPropagationLossModel class")
+{
+}
+
+ThreeGppRxPsdTasksTest::~ThreeGppRxPsdTasksTest ()
+{
+}
+
+void
+ThreeGppRxPsdTasksTest::DoBeamforming (Ptr<MobilityModel> thisMob, Ptr<PhasedArrayModel> thisAntenna, Ptr<MobilityModel> otherMob)
+{
+  Angles completeAngle (otherMob->GetPosition (), thisMob->GetPosition ());
+  thisAntenna->SetBeamformingVector (thisAntenna->GetBeamformingVector (completeAngle));
+}
+
+void
+ThreeGppRxPsdTasksTest::CheckRxPsds (bool batchFirst)
+{
+  std::vector<ThreeGppSpectrumPropagationLossModel::RxPsdTask> tasks1;
+  std::vector<ThreeGppSpectrumPropagationLossModel::RxPsdTask> tasks4;
+  for (size_t i = 0; i < m_utMobs.size (); ++i)
+    {
+      DoBeamforming (m_bsMob, m_bsAntenna, m_utMobs[i]);
+      DoBeamforming (m_utMobs[i], m_utAntennas[i], m_bsMob);
+      tasks1.push_back (m_lossModel->PrepareRxPsd (m_txPsd, m_utMobs[i], m_bsMob));
+      tasks4.push_back (m_lossModel->PrepareRxPsd (m_txPsd, m_utMobs[i], m_bsMob));
+    }
+
+  // the beam of the base station now points towards the last user
+  if (batchFirst)
+    {
+      m_lossModel->CalcRxPsds (tasks4, 4);
+      m_lossModel->CalcRxPsds (tasks1, 1);
+    }
+  std::vector<Ptr<SpectrumValue> > expected;
+  for (size_t i = 0; i < m_utMobs.size (); ++i)
+    {
+      DoBeamforming (m_bsMob, m_bsAntenna, m_utMobs[i]);
+      DoBeamforming (m_utMobs[i], m_utAntennas[i], m_bsMob);
+      expected.push_back (m_lossModel->DoCalcRxPowerSpectralDensity (m_txPsd, m_utMobs[i], m_bsMob));
+    }
+  if (!batchFirst)
+    {
+      m_lossModel->CalcRxPsds (tasks1, 1);
+      m_lossModel->CalcRxPsds (tasks4, 4);
+    }
+
+  for (size_t i = 0; i < m_utMobs.size (); ++i)
+    {
+      for (size_t j = 0; j < m_txPsd->GetSpectrumModel ()->GetNumBands (); ++j)
+        {
+          NS_TEST_ASSERT_MSG_EQ ((*tasks1[i].m_psd)[j], (*expected[i])[j], "Unexpected rx PSD with 1 thread for user " << i);
+          NS_TEST_ASSERT_MSG_EQ ((*tasks4[i].m_psd)[j], (*expected[i])[j], "Unexpected rx PSD with 4 threads for user " << i);
+        }
+    }
+}
+
+void
+ThreeGppRxPsdTasksTest::DoRun ()
+{
+  Config::SetDefault ("ns3::ThreeGppChannelModel::UpdatePeriod", TimeValue (MilliSeconds (100)));
+  const uint32_t numUts = 10;
+
+  m_lossModel = CreateObject<ThreeGppSpectrumPropagationLossModel> ();
+  m_lossModel->SetChannelModelAttribute ("Frequency", DoubleValue (2.4e9));
+  m_lossModel->SetChannelModelAttribute ("Scenario", StringValue ("UMa"));
+  m_lossModel->SetChannelModelAttribute ("ChannelConditionModel", PointerValue (CreateObject<AlwaysLosChannelConditionModel> ()));
+
+  NodeContainer nodes;
+  nodes.Create (numUts + 1);
+  for (uint32_t i = 0; i <= numUts; ++i)
+    {
+      Ptr<SimpleNetDevice> dev = CreateObject<SimpleNetDevice> ();
+      nodes.Get (i)->AddDevice (dev);
+      dev->SetNode (nodes.Get (i));
+
+      uint32_t numElements = (i == 0) ? 8 : 2;
+      Ptr<PhasedArrayModel> antenna = CreateObjectWithAttributes<UniformPlanarArray> ("NumColumns", UintegerValue (numElements),
+                                                                                      "NumRows", UintegerValue (numElements),
+                                                                                      "AntennaElement", PointerValue (CreateObject<IsotropicAntennaModel> ()));
+      m_lossModel->AddDevice (dev, antenna);
+
+      if (i == 0)
+        {
+          m_bsMob = CreateObject<ConstantPositionMobilityModel> ();
+          m_bsMob->SetPosition (Vector (0.0, 0.0, 25.0));
+          nodes.Get (i)->AggregateObject (m_bsMob);
+          m_bsAntenna = antenna;
+        }
+      else
+        {
+          Ptr<ConstantVelocityMobilityModel> utMob = CreateObject<ConstantVelocityMobilityModel> ();
+          utMob->SetPosition (Vector (20.0 + 10.0 * i, 5.0 * i, 1.5));
+          utMob->SetVelocity (Vector (1.0 * i, -2.0, 0.0));
+          nodes.Get (i)->AggregateObject (utMob);
+          m_utMobs.push_back (utMob);
+          m_utAntennas.push_back (antenna);
+        }
+    }
+
+  WifiSpectrumValue5MhzFactory sf;
+  m_txPsd = sf.CreateTxPowerSpectralDensity (0.1, 1);
+
+  // the Doppler terms are evaluated exactly at 0 and 10 ms, and advanced by
+  // a rotation at 20 and 30 ms, and the channels are updated after 100 ms
+  Simulator::Schedule (MilliSeconds (0), &ThreeGppRxPsdTasksTest::CheckRxPsds, this, false);
+  Simulator::Schedule (MilliSeconds (10), &ThreeGppRxPsdTasksTest::CheckRxPsds, this, true);
+  Simulator::Schedule (MilliSeconds (20), &ThreeGppRxPsdTasksTest::CheckRxPsds, this, false);
+  Simulator::Schedule (MilliSeconds (30), &ThreeGppRxPsdTasksTest::CheckRxPsds, this, true);
+  Simulator::Schedule (MilliSeconds (150), &ThreeGppRxPsdTasksTest::CheckRxPsds, this, true);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  m_lossModel = 0;
+}
+
+/**
+ * Test case for the prefetch mode of the ThreeGppChannelModel class. The
+ * realizations of the links between a base station and moving users are
+ * requested at the same times from a model which regenerates them on 1
+ * thread, visiting the users in order, and from a model which regenerates
+ * them on 4 threads, visiting the users in reverse order. The realizations
+ * have to be the same.
+ */
+class ThreeGppChannelPrefetchTest : public TestCase
+{
+public:
+  /**
+   * Constructor
+   */
+  ThreeGppChannelPrefetchTest ();
+
+  /**
+   * Destructor
+   */
+  virtual ~ThreeGppChannelPrefetchTest ();
+
+private:
+  /**
+   * Build the test scenario
+   */
+  virtual void DoRun (void);
+
+  /**
+   * Request the realizations of the links at the times of the test
+   * \param numThreads the number of threads which regenerate the realizations
+   * \param reverse if true, the users are visited in reverse order
+   * \return the realizations, sorted by time and user
+   */
+  std::vector<Ptr<const MatrixBasedChannelModel::ChannelMatrix> > RunScenario (uint32_t numThreads, bool reverse);
+
+  /**
+   * Request the realizations of the links of some users
+   * \param channelModel the channel model
+   * \param reverse if true, the users are visited in reverse order
+   * \param numUts the number of users whose realization is requested
+   * \param channels the vector where the realizations are appended, sorted by user
+   */
+  void DoGetChannels (Ptr<ThreeGppChannelModel> channelModel, bool reverse, uint32_t numUts,
+                      std::vector<Ptr<const MatrixBasedChannelModel::ChannelMatrix> > *channels);
+
+  Ptr<MobilityModel> m_bsMob; //!< the mobility model of the base station
+  Ptr<PhasedArrayModel> m_bsAntenna; //!< the antenna of the base station
+  std::vector<Ptr<ConstantVelocityMobilityModel> > m_utMobs; //!< the mobility models of the users
+  std::vector<Ptr<PhasedArrayModel> > m_utAntennas; //!< the antennas of the users
+};
+
+ThreeGppChannelPrefetchTest::ThreeGppChannelPrefetchTest ()
+  : TestCase ("Test case for the prefetch mode of the ThreeGppChannelModel class")
+{
+}
+
+ThreeGppChannelPrefetchTest::~ThreeGppChannelPrefetchTest ()
+{
+}
+
+void
+ThreeGppChannelPrefetchTest::DoGetChannels (Ptr<ThreeGppChannelModel> channelModel, bool reverse, uint32_t numUts,
+                                            std::vector<Ptr<const MatrixBasedChannelModel::ChannelMatrix> > *channels)
+{
+  std::vector<Ptr<const MatrixBasedChannelModel::ChannelMatrix> > timeChannels (numUts);
+  for (uint32_t j = 0; j < numUts; ++j)
+    {
+      uint32_t i = reverse ? numUts - 1 - j : j;
+      timeChannels[i] = channelModel->GetChannel (m_bsMob, m_utMobs[i], m_bsAntenna, m_utAntennas[i]);
+    }
+  channels->insert (channels->end (), timeChannels.begin (), timeChannels.end ());
+}
+
+std::vector<Ptr<const MatrixBasedChannelModel::ChannelMatrix> >
+ThreeGppChannelPrefetchTest::RunScenario (uint32_t numThreads, bool reverse)
+{
+  // the users restart from the same positions
+  for (uint32_t i = 0; i < m_utMobs.size (); ++i)
+    {
+      m_utMobs[i]->SetPosition (Vector (20.0 + 10.0 * i, 5.0 * i, 1.5));
+      m_utMobs[i]->SetVelocity (Vector (1.0 * i, -2.0, 0.0));
+    }
+
+  Ptr<ThreeGppChannelModel> channelModel = CreateObject<ThreeGppChannelModel> ();
+  channelModel->SetAttribute ("Frequency", DoubleValue (28.0e9));
+  channelModel->SetAttribute ("Scenario", StringValue ("UMa"));
+  channelModel->SetAttribute ("ChannelConditionModel", PointerValue (CreateObject<AlwaysLosChannelConditionModel> ()));
+  channelModel->SetAttribute ("UpdatePeriod", TimeValue (MilliSeconds (10)));
+  channelModel->SetAttribute ("PrefetchThreads", UintegerValue (numThreads));
+  channelModel->AssignStreams (1);
+
+  // half of the users appear at 0 ms, the others in the middle of the
+  // second epoch. At 27 ms the realizations of the second epoch are
+  // regenerated in advance, while at 50 ms, since no link has been requested
+  // in the previous epoch, they are regenerated on demand.
+  std::vector<Ptr<const MatrixBasedChannelModel::ChannelMatrix> > channels;
+  const uint32_t times[] = {0, 5, 10, 15, 17, 27, 50};
+  for (uint32_t t : times)
+    {
+      uint32_t numUts = (t < 15) ? m_utMobs.size () / 2 : m_utMobs.size ();
+      Simulator::Schedule (MilliSeconds (t), &ThreeGppChannelPrefetchTest::DoGetChannels, this,
+                           channelModel, reverse, numUts, &channels);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+  return channels;
+}
+
+void
+ThreeGppChannelPrefetchTest::DoRun ()
+{
+  const uint32_t numUts = 8;
+
+  NodeContainer nodes;
+  nodes.Create (numUts + 1);
+  for (uint32_t i = 0; i <= numUts; ++i)
+    {
+      uint32_t numElements = (i == 0) ? 4 : 2;
+      Ptr<PhasedArrayModel> antenna = CreateObjectWithAttributes<UniformPlanarArray> ("NumColumns", UintegerValue (numElements),
+                                                                                      "NumRows", UintegerValue (numElements),
+                                                                                      "AntennaElement", PointerValue (CreateObject<IsotropicAntennaModel> ()));
+      if (i == 0)
+        {
+          m_bsMob = CreateObject<ConstantPositionMobilityModel> ();
+          m_bsMob->SetPosition (Vector (0.0, 0.0, 25.0));
+          nodes.Get (i)->AggregateObject (m_bsMob);
+          m_bsAntenna = antenna;
+        }
+      else
+        {
+          Ptr<ConstantVelocityMobilityModel> utMob = CreateObject<ConstantVelocityMobilityModel> ();
+          nodes.Get (i)->AggregateObject (utMob);
+          m_utMobs.push_back (utMob);
+          m_utAntennas.push_back (antenna);
+        }
+    }
+
+  std::vector<Ptr<const MatrixBasedChannelModel::ChannelMatrix> > channels1 = RunScenario (1, false);
+  std::vector<Ptr<const MatrixBasedChannelModel::ChannelMatrix> > channels4 = RunScenario (4, true);
+
+  NS_TEST_ASSERT_MSG_EQ (channels1.size (), channels4.size (), "Unexpected number of realizations");
+  for (size_t k = 0; k < channels1.size (); ++k)
+    {
+      const MatrixBasedChannelModel::ComplexTensor3D &h1 = channels1[k]->m_channel;
+      const MatrixBasedChannelModel::ComplexTensor3D &h4 = channels4[k]->m_channel;
+      NS_TEST_ASSERT_MSG_EQ (h1.GetNumClusters (), h4.GetNumClusters (), "Unexpected number of clusters of realization " << k);
+      NS_TEST_ASSERT_MSG_EQ (channels1[k]->m_generatedTime, channels4[k]->m_generatedTime, "Unexpected generation time of realization " << k);
+      for (size_t u = 0; u < h1.GetUSize (); ++u)
+        {
+          for (size_t s = 0; s < h1.GetSSize (); ++s)
+            {
+              for (size_t n = 0; n < h1.GetNumClusters (); ++n)
+                {
+                  NS_TEST_ASSERT_MSG_EQ (h1 (u, s, n), h4 (u, s, n), "Unexpected coefficient of realization " << k);
+                }
+            }
+        }
+    }
+
+  // the realizations are regenerated once per epoch: the 4 users of the
+  // first request time are at the beginning of the vector
+  NS_TEST_ASSERT_MSG_EQ ((channels1[0] == channels1[4]), true, "The realization should not change within an epoch");
+  NS_TEST_ASSERT_MSG_EQ ((channels1[4] != channels1[8]), true, "The realization should change in a new epoch");
+  NS_TEST_ASSERT_MSG_EQ (channels1[8]->m_generatedTime, MilliSeconds (10), "Unexpected generation time");
+  NS_TEST_ASSERT_MSG_EQ ((channels1[0]->m_channel (0, 0, 0) != channels1[1]->m_channel (0, 0, 0)), true, "The links should have different realizations");
+}
+
 /**
  * \ingroup spectrum
  *
@@ -561,6 +895,8 @@ ThreeGppChannelTestSuite::ThreeGppChannelTestSuite ()
   AddTestCase (new ThreeGppChannelMatrixComputationTest, TestCase::QUICK);
   AddTestCase (new ThreeGppChannelMatrixUpdateTest, TestCase::QUICK);
   AddTestCase (new ThreeGppSpectrumPropagationLossModelTest, TestCase::QUICK);
+  AddTestCase (new ThreeGppRxPsdTasksTest, TestCase::QUICK);
+  AddTestCase (new ThreeGppChannelPrefetchTest, TestCase::QUICK);
 }
 
 static ThreeGppChannelTestSuite myTestSuite;